@@ -124,18 +124,19 @@ std::pair<size_t, size_t> KmflKeyboard::processKey(long keyId, std::basic_string
     for (UINT i = 0; i < contextLen; i++, iKmfl++)
     {
         // Skip over dead keys in kmfl history, since they aren't in the real context
-        while (mKmsi->history[iKmfl] & 0x5000000)
+        while (kmfl_history_item(mKmsi, static_cast<UINT>(iKmfl)) & 0x5000000)
         {
             ++iKmfl;
         }
         contextItems[i] = context[contextLen - 1 - i];
         // have a peek at the raw history and see if we need to set it
         // otherwise, we may lose dead keys.
-        if (mKmsi->nhistory < iKmfl ||
-            (mKmsi->history[iKmfl] & 0xffffff) != contextItems[i])
+        if (kmfl_history_length(mKmsi) < iKmfl ||
+            (kmfl_history_item(mKmsi, static_cast<UINT>(iKmfl)) & 0xffffff) != contextItems[i])
         {
             MessageLogger::logMessage("KMFL reset history %d,%d %x!=%x len %d\n", i, iKmfl,
-                 contextItems[i], mKmsi->history[iKmfl], mKmsi->nhistory);
+                 contextItems[i], kmfl_history_item(mKmsi, static_cast<UINT>(iKmfl)),
+                 kmfl_history_length(mKmsi));
             replaceHistory = true;
         }
     }
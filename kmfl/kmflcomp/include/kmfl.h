@@ -31,7 +31,8 @@ extern "C" {
 #endif
 
 
-#define FILE_VERSION	"1"
+#define FILE_VERSION	"2"
+#define FILE_VERSION_1	"1"		// version without a section directory, which can still be loaded
 #define BASE_VERSION	"320"
 #define LAST_VERSION	"700"
 
@@ -70,11 +71,18 @@ extern "C" {
 #define UNDEFINED		(-1)	// redefine this value for our own use
 #define NAMELEN 		64	    // maximum length of names for stores, groups or deadkeys
 #define MAX_HISTORY 	128 	// number of output (32-bit) characters remembered
+#define HISTORY_SIZE	256 	// size of history buffer (a power of 2, greater than MAX_HISTORY+1)
 #define MAX_OUTPUT		128 	// maximum length of output allowed from any one key event
-#define MAX_KEYBOARDS	64		// maximum number of keyboards that can be loaded
 #define MAX_INSTANCES	255 	// maximum number of keyboard instances that can be supported
 #define VERSION_ZERO	1000	// lowest valid version
 
+// Storage class for variables that have a separate copy in each thread
+#ifdef _MSC_VER
+#define KMFL_THREAD	__declspec(thread)
+#else
+#define KMFL_THREAD	__thread
+#endif
+
 // Variable types and structures
 #ifdef _WIN32
 	typedef unsigned int UINT; 	// 32-bit unsigned integer (general purpose)
@@ -173,6 +181,128 @@ struct _xkeyboard {
 
 typedef struct _xkeyboard XKEYBOARD;
 
+// Sections of a compiled keyboard (version 2). The header is followed by an XDIRECTORY and its 
+// XSECTION entries, then by the sections, each starting at a multiple of XS_ALIGN bytes from the
+// start of the keyboard so that the tables of a mapped file are aligned. A version 1 keyboard 
+// has no directory: its stores, groups, rules and string table simply follow the header.
+#define XS_ALIGN			16
+#define XS_ALIGNED(n)		(((n)+XS_ALIGN-1) & ~(unsigned long)(XS_ALIGN-1))
+#define XS_CHECKSUM_INIT	0x811c9dc5
+
+enum {XS_STORES=1,XS_GROUPS,XS_RULES,XS_STRINGS,XS_DISPATCH,XS_STOREINDEX,XS_LINES};
+
+struct _xsection {
+	UINT id;				// section type (XS_STORES etc.)
+	OFFSET offset;			// offset of the section from the start of the keyboard
+	UINT size;				// size of the section in bytes
+	UINT checksum;			// kmfl_checksum() of the section
+};
+
+typedef struct _xsection XSECTION;
+
+struct _xdirectory {
+	UINT size;				// size of the compiled keyboard in bytes, including all sections
+	UINT nsections;			// number of section entries following the directory
+	UINT nrules;			// total number of rules in all groups
+	UINT checksum;			// kmfl_checksum() of the header and the section entries
+};
+
+typedef struct _xdirectory XDIRECTORY;
+
+// Optional sections, holding the tables that the interpreter would otherwise build when the
+// keyboard is loaded. Offsets are in UINTs from the start of the section.
+
+// Version of the layout of these sections. Increase it whenever the layout or the tables
+// held in them change, so that keyboards saved in the compiled keyboard cache are rebuilt
+#define XS_INDEX_VERSION	"1"
+
+// XS_DISPATCH: one record per group, followed by the tables of each group in the order
+// buckets (nbuckets+1), rules, wildcards, trie nodes, trie edges and any() edges
+struct _xdispatchrec {
+	UINT nbuckets;			// number of buckets (a power of 2)
+	UINT nwild;				// number of wildcard rules
+	UINT nlisted;			// number of bucketed rule entries
+	UINT nnodes;			// number of trie nodes (0 if the group has no automaton)
+	UINT nedges;			// number of trie edges other than any()
+	UINT nanys;				// number of any() edges
+	OFFSET tables;			// offset of the tables of the group
+};
+
+typedef struct _xdispatchrec XDISPATCHREC;
+
+// XS_STOREINDEX: one record per store, followed by the lookup tables of the indexed stores
+struct _xstoreindexrec {
+	UINT mask;				// number of slots less one (0 if the store is not indexed)
+	OFFSET slots;			// offset of the slots keyed by the full item (those keyed by the
+							// item without its type follow them)
+};
+
+typedef struct _xstoreindexrec XSTOREINDEXREC;
+
+// XS_LINES: the source line of each group statement, followed by the source line of each 
+// rule, for reports on the rules used (written by the compiler, and not needed to interpret
+// the keyboard)
+
+// Matching automaton for a group, built by the interpreter when a keyboard is loaded for groups
+// whose rules only use characters, keysyms, deadkeys, any() and notany(). It is a trie of the 
+// reversed input rules: each edge is a rule item, compared with successive history items 
+// starting from the keystroke (or from the last character for groups that do not use keys).
+#define TRIE_NO_RULE	0xffffffff
+
+struct _xtrienode {
+	UINT rule;				// first rule ending at this node (relative to rule1), or TRIE_NO_RULE
+	UINT best;				// first rule ending at or below this node
+	UINT edge1;				// index of the first edge from this node
+	UINT nliteral;			// number of character and deadkey edges (sorted by item)
+	UINT nkeysym;			// number of keysym edges that follow them (sorted by key)
+	UINT nedges;			// number of edges (the others are sorted by best rule)
+	UINT any1;				// index of the first any() entry from this node
+	UINT nany;				// number of any() entries (one per store item, sorted by item)
+};
+
+typedef struct _xtrienode XTRIENODE;
+
+struct _xtrieedge {
+	ITEM item;				// rule item to match
+	UINT node;				// node reached if it matches
+};
+
+typedef struct _xtrieedge XTRIEEDGE;
+
+// Rule dispatch index for one group (built by the interpreter when a keyboard is loaded, 
+// unless it has an XS_DISPATCH section).
+// Rules are bucketed by the low 16 bits of the last item of the input (match) rule, which 
+// is the item compared with the keystroke (or with the last character for groups that do 
+// not use keys). Rules whose last item could match anything go in the wildcard list.
+struct _xdispatch {
+	UINT nbuckets;			// number of buckets (always a power of 2)
+	UINT nwild;				// number of wildcard rules
+	UINT *buckets;			// nbuckets+1 offsets of each bucket in the rule list
+	UINT *rules;			// bucketed rule numbers (relative to rule1), in sorted order
+	UINT *wild; 			// wildcard rule numbers (relative to rule1), in sorted order
+	XTRIENODE *trie;		// matching automaton (or NULL if the rules must be tried in turn)
+	XTRIEEDGE *edges;		// edges of the matching automaton (other than any())
+	XTRIEEDGE *anys;		// any() edges of the matching automaton, for each store item
+	UINT nnodes;			// number of nodes of the matching automaton
+	UINT nedges;			// number of its edges other than any()
+	UINT nanys;				// number of its any() edges
+	UINT mapped;			// tables are in the compiled keyboard (not allocated)
+};
+
+typedef struct _xdispatch XDISPATCH;
+
+// Lookup tables for the items of one store used by any() or notany() (built by the 
+// interpreter when a keyboard is loaded, unless it has an XS_STOREINDEX section). Each 
+// table is an open-addressed hash of (item, index+1) pairs giving the first matching item
+// in the store.
+struct _xstoreindex {
+	UINT mask;				// number of slots less one (0 if the store is not indexed)
+	UINT *items;			// slots keyed by the full item
+	UINT *chars;			// slots keyed by the item without its type
+};
+
+typedef struct _xstoreindex XSTOREINDEX;
+
 // Keyboard mapping server instance
 struct _kmsi {
 	void *connection;				// instance identification passed by server
@@ -183,12 +313,21 @@ struct _kmsi {
 	XRULE *rules;					// pointer to list of rules in loaded keyboard
 	XSTORE *stores; 				// pointer to list of stores in loaded keyboard
 	ITEM *strings;					// pointer to (32-bit) string table in loaded keyboard
-	ITEM *history;					// (32-bit) character output history
+	XDISPATCH *dispatch;			// pointer to rule dispatch index of each group (or NULL)
+	XSTOREINDEX *store_index;		// pointer to lookup tables of each store (or NULL)
+	ITEM *history_buffer;			// (32-bit) character output history, as a circular buffer
+	UINT history_start; 			// buffer index of history item 0 (the keystroke)
 	UINT nhistory;					// valid history count
 	ITEM output_queue[MAX_OUTPUT];
 	UINT noutput_queue;
-	struct _kmsi *next; 				// link to next instance
+	struct _kmflbatch *batch;		// edit script being made by kmfl_interpret_batch() (or NULL)
+	struct _kmflprofile *profile;	// profile started by kmfl_start_profile() (or NULL)
+	struct _kmflkeyboard *loaded;	// loaded keyboard holding the tables above (or NULL)
+	struct _kmflinstalled *installed;	// installed keyboard the instance is attached to (or NULL)
+	struct _kmsi *next; 				// link to next instance (or next free instance)
 	struct _kmsi *last; 				// link to previous instance
+	struct _kmsi *kbd_next;			// link to next instance using the same keyboard
+	struct _kmsi *kbd_last;			// link to previous instance using the same keyboard
 };
 
 typedef struct _kmsi KMSI;
@@ -20,6 +20,10 @@
  */
 
 #ifndef KMFLCOMP_H
+#define KMFLCOMP_H
+
+#include "kmfl.h"
+
 #ifdef  __cplusplus
 extern "C" {
 #endif
@@ -27,20 +31,44 @@ extern "C" {
 extern int opt_debug;
 extern int opt_force;
 extern int opt_verbose;
+extern int opt_optimize;
+extern int opt_report;
 extern int errcount, errlimit, warnings, warnlimit;
 extern int yydebug;
 extern jmp_buf fatal_error_buf;
 
-#ifdef _WIN32
-#define KMFL_EXPORT __declspec(dllexport)
-#else
-#define KMFL_EXPORT
+#ifdef _WIN32
+#define KMFL_EXPORT __declspec(dllexport)
+#else
+#define KMFL_EXPORT
 #endif
 
 KMFL_EXPORT
 unsigned long compile_keyboard_to_buffer(const char * infile, void ** keyboard_buffer);
 KMFL_EXPORT
-void write_keyboard(char * fname, void *keyboard_buffer, int keyboard_buffer_size);
+const char *compiler_version(void);
+KMFL_EXPORT
+void write_keyboard(char * infile, void *keyboard_buffer, int keyboard_buffer_size);
+KMFL_EXPORT
+UINT kmfl_checksum(UINT sum, const void *data, unsigned long size);
+
+// Reentrant versions, compiling in a context owned by the caller (one per thread)
+typedef struct _kmflcomp_context KMFLCOMP_CONTEXT;
+
+KMFL_EXPORT
+KMFLCOMP_CONTEXT *kmflcomp_create_context(void);
+KMFL_EXPORT
+void kmflcomp_delete_context(KMFLCOMP_CONTEXT *ctx);
+KMFL_EXPORT
+unsigned long compile_keyboard_to_buffer_r(KMFLCOMP_CONTEXT *ctx, const char * infile, void ** keyboard_buffer);
+KMFL_EXPORT
+int write_keyboard_r(KMFLCOMP_CONTEXT *ctx, char * infile, void *keyboard_buffer, int keyboard_buffer_size);
+KMFL_EXPORT
+int kmflcomp_error_count(KMFLCOMP_CONTEXT *ctx);
+KMFL_EXPORT
+int kmflcomp_warning_count(KMFLCOMP_CONTEXT *ctx);
+KMFL_EXPORT
+const char *kmflcomp_error_message(KMFLCOMP_CONTEXT *ctx);
 
 #ifdef  __cplusplus
 }
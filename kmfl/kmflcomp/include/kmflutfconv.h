@@ -72,6 +72,15 @@ KMFL_EXPORT
 size_t IConvertUTF32toUTF16 (
 		const UTF32** sourceStart, const UTF32* sourceEnd, 
 		UTF16** targetStart, UTF16* targetEnd);
+
+#ifndef KMFL_NO_ICONV
+// Conversion between other code pages, using iconv
+KMFL_EXPORT
+size_t UTFConvert (
+		char * sourceCode, char * targetCode,
+		const void ** sourceStart, const void * sourceEnd, 
+		void ** targetStart, void * targetEnd);
+#endif
 #ifdef  __cplusplus
 }
 #endif
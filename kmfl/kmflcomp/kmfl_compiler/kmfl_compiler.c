@@ -41,21 +41,46 @@ const char * VERSION= "0.9.8";
 #else
 	#include <getopt.h>
 	#include <sys/types.h>
+	#include <sys/time.h>
 	#include <unistd.h>
+	#include <dirent.h>
+	#include <pthread.h>
 	#define O_BINARY 	0
 	#define DIRDELIM	'/'
 #endif
 
 #include <fcntl.h>
 #include <kmflcomp.h>
+#ifdef _WIN32
+#define OPTIONS	"dfhOrVvy"
+const char * usagemsg=
+"usage: kmflcomp [OPTION...] file\n" \
+" -d     debug\n" \
+" -f     force compilation\n" \
+" -h     print this help message\n" \
+" -O     optimize: leave out rules, groups and stores that can never be used\n" \
+" -r     report what the optimizer left out (implies -O)\n" \
+" -V     verbose\n" \
+" -v     print program version\n" \
+" -y     yydebug\n";
+#else
+#define OPTIONS	"bdfhj:Ors:Vvy"
 const char * usagemsg=
 "usage: kmflcomp [OPTION...] file\n" \
+"       kmflcomp [OPTION...] -b file|directory...\n" \
+" -b     batch mode: compile several files, or all .kmn files in directories\n" \
 " -d     debug\n" \
 " -f     force compilation\n" \
 " -h     print this help message\n" \
+" -j N   number of keyboards compiled at once in batch mode\n" \
+"        (default: number of processors)\n" \
+" -O     optimize: leave out rules, groups and stores that can never be used\n" \
+" -r     report what the optimizer left out (implies -O)\n" \
+" -s F   write the batch summary to file F (default: standard output)\n" \
 " -V     verbose\n" \
 " -v     print program version\n" \
 " -y     yydebug\n";
+#endif
 
 void usage(void)
 {
@@ -64,6 +89,220 @@ void usage(void)
 	exit(1);
 }
 
+#ifndef _WIN32
+
+// Batch compilation. Each keyboard is compiled on one of a pool of worker threads,
+// each with its own compiler context, and a summary of the results is written in
+// JSON format once all the keyboards have been compiled
+
+typedef struct _batch_job {
+	char *infile;				// keyboard source file
+	int compiled;				// 1 if the compiled keyboard was saved
+	unsigned long size;			// size of the compiled keyboard
+	int errors;					// number of errors
+	int warnings;				// number of warnings
+	double ms;					// time taken to compile and save the keyboard
+	char message[512];			// first error, or reason for failure
+} BATCH_JOB;
+
+static BATCH_JOB *jobs=NULL;
+static int njobs=0, maxjobs=0, next_job=0;
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double now_ms(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return 1000.0 * tv.tv_sec + tv.tv_usec / 1000.0;
+}
+
+static void add_job(const char *infile)
+{
+	if(njobs == maxjobs)
+	{
+		maxjobs = maxjobs ? 2*maxjobs : 64;
+		if((jobs=(BATCH_JOB *)realloc(jobs, maxjobs*sizeof(BATCH_JOB))) == NULL)
+		{
+			fprintf(stderr, "kmflcomp: out of memory\n");
+			exit(1);
+		}
+	}
+	memset(jobs+njobs, 0, sizeof(BATCH_JOB));
+	jobs[njobs++].infile = strdup(infile);
+}
+
+static int is_keyboard_source(const struct dirent *entry)
+{
+	const char *ext=strrchr(entry->d_name, '.');
+	return (entry->d_name[0] != '.' && ext != NULL && strcasecmp(ext, ".kmn") == 0);
+}
+
+// Add a file, or all the keyboard sources in a directory (in name order)
+static void add_jobs(const char *path)
+{
+	struct stat fileinfo;
+	struct dirent **entries;
+	char *infile;
+	int n, k;
+
+	if(stat(path, &fileinfo) != 0 || !S_ISDIR(fileinfo.st_mode))
+	{
+		add_job(path);
+		return;
+	}
+
+	if((n=scandir(path, &entries, is_keyboard_source, alphasort)) < 0)
+	{
+		fprintf(stderr, "kmflcomp: cannot read directory %s\n", path);
+		exit(1);
+	}
+
+	for(k=0; k<n; k++)
+	{
+		infile = (char *)malloc(strlen(path)+strlen(entries[k]->d_name)+2);
+		if(infile == NULL)
+		{
+			fprintf(stderr, "kmflcomp: out of memory\n");
+			exit(1);
+		}
+		sprintf(infile, "%s%s%s", path, (path[strlen(path)-1] == DIRDELIM) ? "" : "/", entries[k]->d_name);
+		add_job(infile);
+		free(infile);
+		free(entries[k]);
+	}
+	free(entries);
+}
+
+// Take keyboards from the list and compile them until there are none left
+static void *batch_worker(void *arg)
+{
+	KMFLCOMP_CONTEXT *ctx;
+	BATCH_JOB *jp;
+	void *keyboard_buffer;
+	double start;
+
+	if((ctx=kmflcomp_create_context()) == NULL) return NULL;
+
+	for(;;)
+	{
+		pthread_mutex_lock(&job_lock);
+		jp = (next_job < njobs) ? jobs+next_job++ : NULL;
+		pthread_mutex_unlock(&job_lock);
+		if(jp == NULL) break;
+
+		start = now_ms();
+		jp->size = compile_keyboard_to_buffer_r(ctx, jp->infile, &keyboard_buffer);
+		if(jp->size > 0)
+		{
+			jp->compiled = (write_keyboard_r(ctx, jp->infile, keyboard_buffer, jp->size) == 0);
+			free(keyboard_buffer);
+		}
+		jp->ms = now_ms() - start;
+		jp->errors = kmflcomp_error_count(ctx);
+		jp->warnings = kmflcomp_warning_count(ctx);
+		strcpy(jp->message, kmflcomp_error_message(ctx));
+		if(!jp->compiled && jp->message[0] == 0)
+			strcpy(jp->message, "compilation failed");
+	}
+
+	kmflcomp_delete_context(ctx);
+	return NULL;
+}
+
+static void write_json_string(FILE *fp, const char *s)
+{
+	fputc('"', fp);
+	for(; *s; s++)
+	{
+		if(*s == '"' || *s == '\\')
+			fprintf(fp, "\\%c", *s);
+		else if((unsigned char)*s < 0x20)
+			fprintf(fp, "\\u%04x", (unsigned char)*s);
+		else
+			fputc(*s, fp);
+	}
+	fputc('"', fp);
+}
+
+// Write the results of a batch compilation
+static void write_summary(FILE *fp, int nworkers, double ms)
+{
+	BATCH_JOB *jp;
+	int n, nfailed;
+
+	for(n=0, nfailed=0; n<njobs; n++)
+		if(!jobs[n].compiled) nfailed++;
+
+	fprintf(fp, "{\n  \"workers\": %d,\n  \"ms\": %.3f,\n", nworkers, ms);
+	fprintf(fp, "  \"compiled\": %d,\n  \"failed\": %d,\n  \"files\": [", njobs-nfailed, nfailed);
+
+	for(n=0, jp=jobs; n<njobs; n++, jp++)
+	{
+		fprintf(fp, "%s\n    {\"file\": ", n ? "," : "");
+		write_json_string(fp, jp->infile);
+		fprintf(fp, ", \"status\": \"%s\", \"size\": %lu, \"errors\": %d, \"warnings\": %d, \"ms\": %.3f",
+			jp->compiled ? "ok" : "failed", jp->compiled ? jp->size : 0, jp->errors, jp->warnings, jp->ms);
+		if(jp->message[0])
+		{
+			fprintf(fp, ", \"message\": ");
+			write_json_string(fp, jp->message);
+		}
+		fprintf(fp, "}");
+	}
+	fprintf(fp, "\n  ]\n}\n");
+}
+
+// Compile the keyboards on nworkers threads. Returns the number that failed
+static int compile_batch(int nworkers, const char *summary)
+{
+	pthread_t *workers;
+	FILE *fp=stdout;
+	double start;
+	int n, nfailed;
+
+	if(nworkers <= 0) nworkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if(nworkers > njobs) nworkers = njobs;
+	if(nworkers <= 0) nworkers = 1;
+
+	if((workers=(pthread_t *)malloc(nworkers*sizeof(pthread_t))) == NULL)
+	{
+		fprintf(stderr, "kmflcomp: out of memory\n");
+		exit(1);
+	}
+
+	start = now_ms();
+	for(n=0; n<nworkers; n++)
+	{
+		if(pthread_create(workers+n, NULL, batch_worker, NULL) != 0)
+			break;
+	}
+	if(n == 0)
+		batch_worker(NULL);
+	else
+		nworkers = n;
+	for(n--; n>=0; n--)
+		pthread_join(workers[n], NULL);
+	free(workers);
+
+	if(summary && (fp=fopen(summary, "w")) == NULL)
+	{
+		fprintf(stderr, "kmflcomp: cannot write summary to %s\n", summary);
+		fp = stdout;
+	}
+	write_summary(fp, nworkers, now_ms() - start);
+	if(fp != stdout) fclose(fp);
+
+	for(n=0, nfailed=0; n<njobs; n++)
+	{
+		if(!jobs[n].compiled) nfailed++;
+		free(jobs[n].infile);
+	}
+	free(jobs);
+	return nfailed;
+}
+
+#endif
+
 int main(int argc, char *argv[]) 
 {
 	int opt,nopt=0;
@@ -71,8 +310,12 @@ int main(int argc, char *argv[])
 	unsigned long keyboard_buffer_size;
 	int errcode;
     char *fname="(stdin)";
+#ifndef _WIN32
+	int batch=0, nworkers=0;
+	char *summary=NULL;
+#endif
 
-	while((opt=getopt(argc,argv,"dfhVvy"))!=EOF) 
+	while((opt=getopt(argc,argv,OPTIONS))!=EOF) 
 	{
 		switch (opt) 
 		{
@@ -85,6 +328,12 @@ int main(int argc, char *argv[])
 		case 'h':
 			usage();
 			break;
+		case 'O':
+			opt_optimize=1;
+			break;
+		case 'r':
+			opt_optimize=opt_report=1;
+			break;
 		case 'V':
 			opt_verbose = 1;
 			break;
@@ -94,10 +343,51 @@ int main(int argc, char *argv[])
 		case 'y':
 			yydebug = 1;
 			break;
+#ifndef _WIN32
+		case 'b':
+			batch = 1;
+			break;
+		case 'j':
+			batch = 1;
+			nworkers = atoi(optarg);
+			break;
+		case 's':
+			batch = 1;
+			summary = optarg;
+			break;
+		case '?':
+			usage();
+			break;
+#endif
 		}
 		nopt++;
 	}
 
+#ifndef _WIN32
+	nopt = optind-1;
+
+	// Compile several keyboards, or a directory of them, in batch mode
+	if(argc > optind+1) batch = 1;
+	if(argc == optind+1 && !batch)
+	{
+		struct stat fileinfo;
+		if(stat(argv[optind], &fileinfo) == 0 && S_ISDIR(fileinfo.st_mode)) batch = 1;
+	}
+
+	if(batch)
+	{
+		if(argc <= optind) usage();
+
+		if(opt_verbose) 
+		   errlimit = warnlimit = 1000;
+
+		for(opt=optind; opt<argc; opt++)
+			add_jobs(argv[opt]);
+
+		exit(compile_batch(nworkers, summary) > 0 ? 1 : 0);
+	}
+#endif
+
 	if(argc > nopt+1)
 		fname=argv[argc-1];
 	else
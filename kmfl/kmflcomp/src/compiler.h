@@ -23,11 +23,16 @@
 
 // Include constants, structures, types and prototypes used by both compiler and interpreter
 
+#include <setjmp.h>
 #include <kmfl.h>
 
 #define BUFSIZE		256			// output buffer limit for converting from UTF16
 #define NOSHIFTPROCESSING 0x8000 // For XKEY Symbols, don't process shift state
 
+// Version of the compiler output. Increase the last number whenever a source file
+// compiles to a different keyboard, so that cached compiled keyboards are rebuilt
+#define COMPILER_VERSION	"0.9.8-4"
+
 //	The types KEYBOARD, GROUP, RULE, STORE and DEADKEY are used only by the compiler,
 //  and are defined in this header.  The types XKEYBOARD, XGROUP, XSTORE and XRULE are 
 //  used by both the compiler and the interpreter, and are defined in kmfl.h.
@@ -73,6 +78,7 @@ struct _group {
 	ITEM *match;				// match rule (rhs)
 	ITEM *nomatch;				// nomatch rule (rhs)
 	RULE *rules;				// linked list of rules
+	INT line;					// line of group statement
 	struct _group *next;		// pointer to next group
 };
 
@@ -101,6 +107,38 @@ struct _keyboard {
 
 typedef struct _keyboard KEYBOARD;
 
+// List of items being built by the parser. The grammar adds each item in front of
+// the items that follow it, so the items are kept in reverse order until list_items()
+struct _itemvec {
+	ITEM *items;				// items, last item first
+	unsigned int len;			// number of items
+	unsigned int size;			// number of items allocated
+};
+
+typedef struct _itemvec ITEMVEC;
+
+// Index of the stores, groups or deadkeys of a keyboard, by number (their position in
+// the linked list) and by name (a case-insensitive hash table of numbers)
+struct _nameindex {
+	void **objects;				// objects by number
+	char **names;				// names by number
+	unsigned int count;			// number of objects
+	unsigned int size;			// size of the objects and names arrays
+	unsigned int *slots;		// hash table of object numbers plus one (0 if empty)
+	unsigned int nslots;		// size of the hash table (a power of two)
+};
+
+typedef struct _nameindex NAMEINDEX;
+
+// Sequence of items to be saved in the string table of the compiled keyboard
+struct _stringrun {
+	ITEM *items;				// items of the sequence
+	UINT len;					// number of items
+	UINT offset;				// offset of the sequence in the string table
+};
+
+typedef struct _stringrun STRINGRUN;
+
 // Routine prototypes
 FILE *UTF16toUTF8(FILE *fp, char ** pName);
 
@@ -126,9 +164,10 @@ GROUP *new_group(char *name, int line);
 void set_start_group(char *groupname, int mode, int line);
 
 DEADKEY *new_deadkey(char *name, int line);
-ITEM *new_list(ITEM q);
-ITEM *add_lists(ITEM *s1, ITEM *s2);
-ITEM *add_item_to_list(ITEM *s1, ITEM q);
+ITEMVEC *new_list(ITEM q);
+ITEMVEC *add_lists(ITEMVEC *vp, ITEM *ip);
+ITEMVEC *add_item_to_list(ITEMVEC *vp, ITEM q);
+ITEM *list_items(ITEMVEC *vp);
 unsigned int count_items(ITEM *p);
 
 char *items_to_string(ITEM *p);
@@ -151,24 +190,47 @@ int check_bitmap_file(STORE *sp, int line);
 
 void *checked_alloc(size_t n, size_t sz);
 void sort_rules(GROUP *gp);
+void optimize_keyboard(KEYBOARD *kbp);
 
 void debug(int line, char *s, ...);
 void kmflcomp_warn(int line, char *s, ...);
 void kmflcomp_error(int line, char *s, ...);
 void fail(int errcode, char *s, ...);
 
-// External references used while parsing
-extern KEYBOARD *kbp;
-extern int errcount, lineno, done;
+// State of a compilation. The compiler routines use the context of the compilation
+// in progress on the current thread (kmflcomp_ctx), so that keyboards can be compiled
+// concurrently on different threads
+struct _kmflcomp_context {
+	KEYBOARD keyboard;			// the keyboard being compiled
+	char version[6];			// keyboard version and file version
+	const char *fname;			// source file name
+	int nerrors;				// number of errors
+	int nwarnings;				// number of warnings
+	int lineno;					// current line number in source file
+	int done;					// end of source file reached
+	int file_format;			// KF_UNICODE or KF_ANSI
+	DEADKEY *last_deadkey;		// last deadkey defined
+	STORE *last_store;			// last store defined
+	NAMEINDEX store_index;		// stores by name and number
+	NAMEINDEX group_index;		// groups by name and number
+	NAMEINDEX deadkey_index;	// deadkeys by name and number
+	FILE *input;				// source file being read
+	void *scanner;				// scanner reading the source file (a yyscan_t)
+	int caller, caller0;		// scanner start conditions to return to
+	char qchar;					// quote character of the string being scanned
+	jmp_buf *fatal_error;		// where to return to on a fatal error
+	jmp_buf error_buf;			// fatal error return used by compile_keyboard_to_buffer_r()
+	char message[512];			// first error reported, or reason for failure
+};
+
+extern KMFL_THREAD struct _kmflcomp_context *kmflcomp_ctx;
 
-// Prototypes and references used by yacc/lex
-int yylex(void);
-int yyparse(void);
-void yyerror(char *);
-void yyrestart( FILE *input_file );
-void yycleanup(void);
+// Prototypes and references used by yacc/lex. The parser and scanner are reentrant:
+// the scanner of a compilation is kept in its context, and its extra data is the context
+int yylex_init_extra(struct _kmflcomp_context *ctx, void **scanner);
+void yyset_in(FILE *in_str, void *scanner);
+int yylex_destroy(void *scanner);
 
-extern FILE *yyin, *yyout;
 extern int yydebug;
 
 // Add some function equivalents for Windows
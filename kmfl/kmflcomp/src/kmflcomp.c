@@ -29,9 +29,9 @@
 #include <setjmp.h>
 
 #include "kmflutfconv.h"
+#include <kmflcomp.h>
 #include "compiler.h"
 #include "yacc.h"
-#include <kmflcomp.h>
 #include "memman.h"
 
 #ifdef _WIN32
@@ -45,6 +45,7 @@
 	char *GetInputFile(void);
 #else
 	#include <X11/Xlib.h>
+	#include <pthread.h>
 	#include <getopt.h>
 	#include <sys/types.h>
 	#include <unistd.h>
@@ -62,22 +63,27 @@ void log_message(const char *fmt, ...);
 int opt_debug=0;
 int opt_force=0;
 int opt_verbose=0;
+int opt_optimize=0;
+int opt_report=0;
 
 // Fatal error variables
 jmp_buf fatal_error_buf;
 
-// The keyboard being compiled, and version string
-KEYBOARD keyboard, *kbp=&keyboard;
-char Version[6]=BASE_VERSION FILE_VERSION;	// Concatenate keyboard version and file version
+int warnlimit=10, errlimit=10;
 
-int warncount=0, warnlimit=10, errlimit=10, file_format=KF_UNICODE;
+// The context used by compile_keyboard_to_buffer() and write_keyboard(), and the
+// context of the compilation in progress on each thread
+static KMFLCOMP_CONTEXT default_context;
+KMFL_THREAD KMFLCOMP_CONTEXT *kmflcomp_ctx=&default_context;
 
-DEADKEY *last_deadkey=NULL;
-STORE *last_store=NULL;
+// Error count of the last keyboard compiled with the default context, for callers
+// of compile_keyboard_to_buffer()
+int errcount=0;
 
-extern FILE *yyin;
-static const char * fname=NULL;
-static int firstkeyboard = 1;
+#ifndef _WIN32
+static pthread_mutex_t display_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t umask_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 // forward function declarations
 unsigned long create_keyboard_buffer(const char *infile, void ** kb_buf);
@@ -85,11 +91,35 @@ char * checked_strcpy(char * dst, char * src, int len, char * type, int line);
 int get_char_shift_state(ITEM q);
 
 
+// Create and open a temporary file named from the template tmpname, which ends in XXXXXX
+static int open_temporary_file(char *tmpname)
+{
+#ifdef _WIN32
+	if(_mktemp(tmpname) == NULL) return -1;
+	return open(tmpname,O_WRONLY|O_BINARY|O_CREAT|O_EXCL,00666);
+#else
+	int out;
+	mode_t mask;
+
+	if((out=mkstemp(tmpname)) < 0) return -1;
+
+	// mkstemp() makes the file private. Give it the mode open() would have, as the
+	// compiled keyboard is read by other users. umask() can only be read by setting it
+	pthread_mutex_lock(&umask_lock);
+	mask = umask(0);
+	umask(mask);
+	pthread_mutex_unlock(&umask_lock);
+	fchmod(out, 00666 & ~mask);
+	return out;
+#endif
+}
+
 // Write the compiled keyboard to the output file
 long save_keyboard(const char *infile, void * keyboard_buffer, unsigned long size)
 {
-	char *outfile, *pdot;
-	unsigned long n, out;
+	char *outfile, *tmpname, *pdot;
+	unsigned long n;
+	int out, ok;
 	struct stat fstat;
 
 	// Create file names from input file name
@@ -99,17 +129,40 @@ long save_keyboard(const char *infile, void * keyboard_buffer, unsigned long siz
 	strcpy(outfile,infile); pdot = rindex(outfile,'.');
 	if(pdot) strcpy(pdot, ".kmfl"); else strcat(outfile,".kmfl");
 
+	// Write to a temporary file first, then rename it, so that the keyboard is 
+	// replaced as a whole (processes that have the old file mapped keep the old copy).
+	// Each compilation has a file of its own, as the same keyboard may be compiled twice
+	if(!(tmpname=(char *)mem_alloc(n+7))) 
+	{
+		mem_free(outfile);
+		return(-1);
+	}
+	strcpy(tmpname,outfile); strcat(tmpname,".XXXXXX");
 
 	// Open output file, rule table and string table
-	if((out=open(outfile,O_WRONLY|O_BINARY|O_CREAT|O_TRUNC,00666)) < 0) return(-2);
-
-    
-    	if (write(out, keyboard_buffer, size) < 0)
-    		fail(1, "cannot write compiled keyboard file %s", outfile);
-    
-	close(out);
-     
+	if((out=open_temporary_file(tmpname)) < 0)
+	{
+		mem_free(tmpname);
+		mem_free(outfile);
+		return(-2);
+	}
+
+	ok = (write(out, keyboard_buffer, size) == (long)size);
+	if(close(out) != 0) ok = 0;
+
+#ifdef _WIN32
+	if(ok) remove(outfile);	// rename will not replace an existing file
+#endif
+	if(!ok || rename(tmpname,outfile) != 0)
+	{
+		remove(tmpname);
+		mem_free(tmpname);
+		mem_free(outfile);
+		fail(1, "cannot write the compiled keyboard file of %s", infile);
+	}
+
 	stat(outfile,&fstat);
+	mem_free(tmpname);
 	mem_free(outfile);
 	
 	size = fstat.st_size;
@@ -123,95 +176,130 @@ void write_keyboard(char * infile, void *keyboard_buffer, int keyboard_buffer_si
 	// Save the output file
 	if((filesize=save_keyboard(infile, keyboard_buffer, keyboard_buffer_size)) > 0)
 	{
-		if(errcount > 0 || warncount > 0)
+		if(kmflcomp_ctx->nerrors > 0 || kmflcomp_ctx->nwarnings > 0)
 		{
-			if(errcount > 0 ) 
+			if(kmflcomp_ctx->nerrors > 0 ) 
 				fprintf(stderr,"  Warning: %d error%s ignored - compiled keyboard may fail!\n",
-					errcount,(errcount==1?"":"s"));
+					kmflcomp_ctx->nerrors,(kmflcomp_ctx->nerrors==1?"":"s"));
 
-			if(warncount > warnlimit)
-				fprintf(stderr,"  Total warnings: %d\n",warncount);
+			if(kmflcomp_ctx->nwarnings > warnlimit)
+				fprintf(stderr,"  Total warnings: %d\n",kmflcomp_ctx->nwarnings);
 		}
 
-		if(Version[2] > '0') 
+		if(kmflcomp_ctx->version[2] > '0') 
 			fprintf(stderr,"Keyboard '%s' (Version %c.%c%c) compiled to %ld bytes\n",
-				kbp->name,Version[0],Version[1],Version[2],filesize);
+				kmflcomp_ctx->keyboard.name,kmflcomp_ctx->version[0],kmflcomp_ctx->version[1],kmflcomp_ctx->version[2],filesize);
 		else
 			fprintf(stderr,"Keyboard '%s' (Version %c.%c) compiled to %ld bytes\n",
-				kbp->name,Version[0],Version[1],filesize);
+				kmflcomp_ctx->keyboard.name,kmflcomp_ctx->version[0],kmflcomp_ctx->version[1],filesize);
 	}
 	else 
 		fail(3,"unable to save output file!");
 }
 
-unsigned long compile_keyboard_to_buffer(const char * infile, void ** keyboard_buffer) 
+// Return the version of the compiler output
+const char *compiler_version(void)
+{
+	return COMPILER_VERSION;
+}
+
+// Checksum a section of a compiled keyboard (FNV-1a over 32-bit words), continuing from sum
+UINT kmfl_checksum(UINT sum, const void *data, unsigned long size)
+{
+	const UINT *p=(const UINT *)data;
+	const BYTE *q;
+	unsigned long n;
+
+	for(n=size/sizeof(UINT); n>0; n--)
+		sum = (sum ^ *p++) * 0x01000193;
+	for(n=size%sizeof(UINT), q=(const BYTE *)p; n>0; n--)
+		sum = (sum ^ *q++) * 0x01000193;
+	return sum;
+}
+
+// Close the source file of a compilation and delete its scanner
+static void release_input(KMFLCOMP_CONTEXT *ctx)
+{
+	if(ctx->scanner) yylex_destroy(ctx->scanner);
+	ctx->scanner = NULL;
+	if(ctx->input) fclose(ctx->input);
+	ctx->input = NULL;
+}
+
+// Compile a keyboard in the current context
+static unsigned long compile_keyboard(const char * infile, void ** keyboard_buffer) 
 {
+	KEYBOARD *kbp=&kmflcomp_ctx->keyboard;
 	GROUP *gp;
 	BYTE BOM[4]={0};
 	unsigned
     long size;
 	char * pTempName;
 
-	fname = infile;
+	kmflcomp_ctx->fname = infile;
+	kmflcomp_ctx->message[0] = 0;
+	kmflcomp_ctx->nerrors=0;
+	kmflcomp_ctx->nwarnings=0;
+
 	// Open input file
-	yyin =  fopen(infile,"r");
-	if(!yyin)
+	kmflcomp_ctx->input =  fopen(infile,"r");
+	if(!kmflcomp_ctx->input)
 	{
 		char *ftmp;
 		ftmp = (char *)checked_alloc(strlen(infile)+6,1);
 		strcpy(ftmp,infile); strcat(ftmp,".kmn");
-		yyin = fopen(ftmp,"r");
+		kmflcomp_ctx->input = fopen(ftmp,"r");
 		mem_free(ftmp);
 	}
-	if(!yyin) fail(1,"cannot open %s",infile);
+	if(!kmflcomp_ctx->input) fail(1,"cannot open %s",infile);
 
 	// Initialize defaults and parameters
-	errcount=0;
-	warncount=0;
-	lineno=0;
-	done=0;
-	last_deadkey=NULL;
-	last_store=NULL;
-	kbp->deadkeys = NULL;
+	kmflcomp_ctx->lineno=0;
+	kmflcomp_ctx->done=0;
+	kmflcomp_ctx->last_deadkey=NULL;
+	kmflcomp_ctx->last_store=NULL;
+	memset(&kmflcomp_ctx->store_index,0,sizeof(NAMEINDEX));
+	memset(&kmflcomp_ctx->group_index,0,sizeof(NAMEINDEX));
+	memset(&kmflcomp_ctx->deadkey_index,0,sizeof(NAMEINDEX));
+	strcpy(kmflcomp_ctx->version,BASE_VERSION FILE_VERSION);
+	memset(kbp,0,sizeof(KEYBOARD));
 	kbp->mode = KF_ANSI;		// Must be ANSI if not specified
 	pTempName = NULL;
 
 	// Check for BOM at start of file 
-	if (fread(BOM,3,1,yyin) != 1)
+	if (fread(BOM,3,1,kmflcomp_ctx->input) != 1)
 		fail(1, "Cannot read byte order mark");
 		
 	if(BOM[0] == 0xEF && BOM[1] == 0xBB && BOM[2] == 0xBF)
 	{
-		file_format = KF_UNICODE;	// Set file format to Unicode if file is UTF-8 or UTF-16 
+		kmflcomp_ctx->file_format = KF_UNICODE;	// Set file format to Unicode if file is UTF-8 or UTF-16 
 	}
 	else
 	{
-		fseek(yyin,0,SEEK_SET);
-		file_format = KF_ANSI;		// Set file format to ansi
+		fseek(kmflcomp_ctx->input,0,SEEK_SET);
+		kmflcomp_ctx->file_format = KF_ANSI;		// Set file format to ansi
 	}
 
 	if(BOM[0] == 0xFF && BOM[1] == 0xFE)	// Is it UTF-16?
 	{
-		yyin = UTF16toUTF8(yyin, &pTempName);	// Make a temporary UTF-8 copy of the file
-		if (yyin == NULL)
+		kmflcomp_ctx->input = UTF16toUTF8(kmflcomp_ctx->input, &pTempName);	// Make a temporary UTF-8 copy of the file
+		if (kmflcomp_ctx->input == NULL)
 			return 0;
-		file_format = KF_UNICODE;	// And set file format to Unicode 
+		kmflcomp_ctx->file_format = KF_UNICODE;	// And set file format to Unicode 
 	}
 
 	// Define the reserved-name stores as the first numbered stores
 	initialize_special_stores();
 
-	// Parse the input file with yacc 
-	if (firstkeyboard)
-		firstkeyboard = 0;
-	else
-		yyrestart(yyin);
+	// Parse the input file with yacc, using a scanner of its own
+	if (yylex_init_extra(kmflcomp_ctx, &kmflcomp_ctx->scanner) != 0)
+		fail(1, "cannot create the scanner");
+	yyset_in(kmflcomp_ctx->input, kmflcomp_ctx->scanner);
 
-	yyparse();
-    yycleanup();
+	yyparse(kmflcomp_ctx->scanner);
+	release_input(kmflcomp_ctx);
  
 	fflush(stdout);	
-	fclose(yyin);
 	if (pTempName)
 	{
 		remove(pTempName);
@@ -223,16 +311,19 @@ unsigned long compile_keyboard_to_buffer(const char * infile, void ** keyboard_b
 	check_keyboard(kbp);
 
 	// Exit on error (unless forced)
-	if (errcount > 0 && !opt_force) 
+	if (kmflcomp_ctx->nerrors > 0 && !opt_force) 
 	{
-		fail(2,"%d error%s and %d warning%s",errcount,(errcount==1?"":"s"),
-			warncount,(warncount==1?"":"s"));
+		fail(2,"%d error%s and %d warning%s",kmflcomp_ctx->nerrors,(kmflcomp_ctx->nerrors==1?"":"s"),
+			kmflcomp_ctx->nwarnings,(kmflcomp_ctx->nwarnings==1?"":"s"));
         return 0;
 	}
 
 	// Sort the rules in each group
 	for(gp=kbp->groups; gp; gp=gp->next) sort_rules(gp);
 
+	// Leave out whatever can never be used, if asked to
+	if(opt_optimize) optimize_keyboard(kbp);
+
     size = create_keyboard_buffer(infile, keyboard_buffer);
     // cleanup memory
     mem_free_all();
@@ -240,9 +331,101 @@ unsigned long compile_keyboard_to_buffer(const char * infile, void ** keyboard_b
 
 }
 
+// Compile a keyboard using the default context. Fatal errors return to fatal_error_buf
+unsigned long compile_keyboard_to_buffer(const char * infile, void ** keyboard_buffer) 
+{
+	unsigned long size;
+
+	kmflcomp_ctx = &default_context;
+	default_context.fatal_error = &fatal_error_buf;
+
+	// Release what a compilation that ended with a fatal error left open
+	release_input(&default_context);
+
+	size = compile_keyboard(infile, keyboard_buffer);
+	errcount = default_context.nerrors;
+	return size;
+}
+
+// Create a context for compiling keyboards on the current thread
+KMFLCOMP_CONTEXT *kmflcomp_create_context(void)
+{
+	return (KMFLCOMP_CONTEXT *)calloc(1, sizeof(KMFLCOMP_CONTEXT));
+}
+
+void kmflcomp_delete_context(KMFLCOMP_CONTEXT *ctx)
+{
+	if(ctx) free(ctx);
+}
+
+// Compile a keyboard in a given context. Several keyboards can be compiled at the
+// same time on different threads, each with its own context. Returns the size of the
+// compiled keyboard, or 0 if compilation failed
+unsigned long compile_keyboard_to_buffer_r(KMFLCOMP_CONTEXT *ctx, const char * infile, void ** keyboard_buffer)
+{
+	KMFLCOMP_CONTEXT *previous=kmflcomp_ctx;
+	unsigned long size=0;
+
+	*keyboard_buffer = NULL;
+	kmflcomp_ctx = ctx;
+	ctx->fatal_error = &ctx->error_buf;
+
+	if(setjmp(ctx->error_buf) == 0)
+	{
+		size = compile_keyboard(infile, keyboard_buffer);
+	}
+	else
+	{
+		// Release everything left by the failed compilation
+		release_input(ctx);
+		mem_free_all();
+		size = 0;
+	}
+
+	kmflcomp_ctx = previous;
+	return size;
+}
+
+// Save a keyboard compiled with compile_keyboard_to_buffer_r(). Returns 0 on success
+int write_keyboard_r(KMFLCOMP_CONTEXT *ctx, char * infile, void *keyboard_buffer, int keyboard_buffer_size)
+{
+	KMFLCOMP_CONTEXT *previous=kmflcomp_ctx;
+	int result;
+
+	kmflcomp_ctx = ctx;
+	ctx->fatal_error = &ctx->error_buf;
+
+	if((result=setjmp(ctx->error_buf)) == 0)
+		write_keyboard(infile, keyboard_buffer, keyboard_buffer_size);
+
+	// Release the arena chunk used for the file names
+	mem_free_all();
+
+	kmflcomp_ctx = previous;
+	return result;
+}
+
+// Number of errors and warnings in the last keyboard compiled in a context
+int kmflcomp_error_count(KMFLCOMP_CONTEXT *ctx)
+{
+	return ctx->nerrors;
+}
+
+int kmflcomp_warning_count(KMFLCOMP_CONTEXT *ctx)
+{
+	return ctx->nwarnings;
+}
+
+// First error in the last compilation in a context, or why it failed (empty if neither)
+const char *kmflcomp_error_message(KMFLCOMP_CONTEXT *ctx)
+{
+	return ctx->message;
+}
+
 // Complete keyboard header, and check for validity
 void check_keyboard(KEYBOARD *kbp)
 {
+	const char *fname=kmflcomp_ctx->fname;
 	UTF32 *p1; 
 	UTF8 *p2;
 	STORE *sp;
@@ -276,122 +459,212 @@ void check_keyboard(KEYBOARD *kbp)
 	}
 }
 
-void * append_to_buffer(void * buffer, long * bufsize, void * chunk, int chunk_size)
+// Compare item sequences from their last items backwards, so that the sequences ending
+// with the same items are sorted next to each other, the longest first
+static int compare_runs(const void *arg1, const void *arg2)
 {
-    // don't use memory management for buffers because they will be used outside of kmflcomp
-    buffer=realloc(buffer, (*bufsize)+chunk_size);
-    if (buffer)
-    {
-        memcpy((char*)buffer+(*bufsize), chunk, chunk_size);
-        *bufsize+=chunk_size;
-    } else {
-        fail(4, "Out of memory\n");
-    }
+	const STRINGRUN *rp1=*(const STRINGRUN **)arg1, *rp2=*(const STRINGRUN **)arg2;
+	const ITEM *p1=rp1->items+rp1->len, *p2=rp2->items+rp2->len;
+	UINT n;
 
-    return buffer;
+	for(n=(rp1->len < rp2->len) ? rp1->len : rp2->len; n>0; n--)
+	{
+		p1--; p2--;
+		if(*p1 != *p2) return (*p1 > *p2) ? -1 : 1;
+	}
+
+	if(rp1->len != rp2->len) return (rp1->len > rp2->len) ? -1 : 1;
+
+	// Keep the layout of identical sequences in their original order
+	if(rp1 < rp2) return -1;
+	if(rp1 > rp2) return 1;
+	return 0;
+}
+
+// Work out where each item sequence will be saved in the string table, and return
+// the number of items in the table. A sequence that is the same as the end of another
+// sequence shares its items, so repeated outputs and contexts are only saved once
+static unsigned long layout_strings(STRINGRUN *runs, unsigned long nruns)
+{
+	STRINGRUN **order, *rp, *prev;
+	unsigned long n, nitems;
+
+	order = (STRINGRUN **)checked_alloc(nruns, sizeof(STRINGRUN *));
+	for(n=0; n<nruns; n++) order[n] = runs+n;
+
+	qsort((void *)order, (size_t)nruns, sizeof(STRINGRUN *), compare_runs);
+
+	// Any sequence ending another one follows it (or another sequence that it ends)
+	for(n=0, nitems=0, prev=NULL; n<nruns; n++)
+	{
+		rp = order[n];
+		if(rp->len == 0)
+		{
+			rp->offset = 0;
+		}
+		else if(prev != NULL && prev->len >= rp->len
+			&& memcmp(prev->items+prev->len-rp->len, rp->items, rp->len*ITEMSIZE) == 0)
+		{
+			rp->offset = prev->offset+prev->len-rp->len;
+		}
+		else
+		{
+			rp->offset = nitems;
+			nitems += rp->len;
+		}
+		prev = rp;
+	}
+
+	mem_free(order);
+	return nitems;
 }
-    
-// Create the keyboard buffer.
+
+// Create the keyboard buffer. The size of each table is worked out first, so that the
+// compiled keyboard can be written straight into a buffer of the right size. The tables
+// are written as the sections of a version 2 keyboard, listed in a directory after the header,
+// followed by the source lines of the groups and rules
 unsigned long create_keyboard_buffer(const char *infile, void ** kb_buf)
 {
-	XKEYBOARD xkbd={{0}};
-	XSTORE xstore;
-	XGROUP xgroup;
-	XRULE xrule;
+	KEYBOARD *kbp=&kmflcomp_ctx->keyboard;
+	XKEYBOARD *xkp;
+	XDIRECTORY *xdp;
+	XSECTION xs[5];
+	XSTORE *xsp;
+	XGROUP *xgp;
+	XRULE *xrp;
+	ITEM *stp;
+	UINT *glp, *rlp;
 	STORE *sp, *sp1;
 	GROUP *gp, *gp1;
 	RULE *rp;
 	DEADKEY *dp, *dp1;
+	STRINGRUN *runs, *run;
 	void * keyboard_buffer = NULL;
-	void * rtt_buffer = NULL;
-	void * stt_buffer = NULL;
-	long keyboard_buffer_size = 0;
-	long rtt_buffer_size = 0;
-	long stt_buffer_size = 0;
-	unsigned long i, j, n, index, offset;
-		
+	unsigned long keyboard_buffer_size;
+	unsigned long i, j, n, offset, nrules, nruns, nitems;
+
+	// Count the rules
+	for(j=0,nrules=0,gp=kbp->groups; j<kbp->ngroups; j++,gp=gp->next)
+		nrules += gp->nrules;
+
+	// List the item sequences to be saved in the string table: the contents of each
+	// store, then the match and nomatch rules of each group and the input and output
+	// of each of its rules, and work out where they will be saved
+	nruns = kbp->nstores+2*kbp->ngroups+2*nrules;
+	runs = run = (STRINGRUN *)checked_alloc(nruns, sizeof(STRINGRUN));
+
+	for(n=0,sp=kbp->stores; n<kbp->nstores; n++,sp=sp->next,run++)
+	{
+		run->items = sp->items;
+		run->len = sp->len;
+	}
+
+	for(j=0,gp=kbp->groups; j<kbp->ngroups; j++,gp=gp->next)
+	{
+		run->items = gp->match;		run->len = gp->mrlen;	run++;
+		run->items = gp->nomatch;	run->len = gp->nmrlen;	run++;
+		for(i=0,rp=gp->rules; i<gp->nrules; i++,rp=rp->next)
+		{
+			run->items = rp->lhs;	run->len = rp->ilen;	run++;
+			run->items = rp->rhs;	run->len = rp->olen;	run++;
+		}
+	}
+
+	nitems = layout_strings(runs, nruns);
+
+	// Lay out the sections
+	xs[0].id = XS_STORES;	xs[0].size = kbp->nstores*sizeof(XSTORE);
+	xs[1].id = XS_GROUPS;	xs[1].size = kbp->ngroups*sizeof(XGROUP);
+	xs[2].id = XS_RULES;	xs[2].size = nrules*sizeof(XRULE);
+	xs[3].id = XS_STRINGS;	xs[3].size = nitems*ITEMSIZE;
+	xs[4].id = XS_LINES;	xs[4].size = (kbp->ngroups+nrules)*sizeof(UINT);
+
+	offset = XS_ALIGNED(sizeof(XKEYBOARD)+sizeof(XDIRECTORY)+5*sizeof(XSECTION));
+	for(n=0; n<5; n++)
+	{
+		xs[n].offset = offset;
+		offset = XS_ALIGNED(offset+xs[n].size);
+	}
+	keyboard_buffer_size = xs[4].offset+xs[4].size;
+
+	// don't use memory management for the buffer because it will be used outside of kmflcomp
+	if((keyboard_buffer=calloc(keyboard_buffer_size,1)) == NULL)
+		fail(4, "Out of memory\n");
+
+	xkp = (XKEYBOARD *)keyboard_buffer;
+	xdp = (XDIRECTORY *)(xkp+1);
+	xsp = (XSTORE *)((char *)keyboard_buffer+xs[0].offset);
+	xgp = (XGROUP *)((char *)keyboard_buffer+xs[1].offset);
+	xrp = (XRULE *)((char *)keyboard_buffer+xs[2].offset);
+	stp = (ITEM *)((char *)keyboard_buffer+xs[3].offset);
+	glp = (UINT *)((char *)keyboard_buffer+xs[4].offset);
+	rlp = glp+kbp->ngroups;
+
 	// Fill the compiled keyboard header structure
-	memcpy(&xkbd,kbp,sizeof(XKEYBOARD));	
+	memcpy(xkp,kbp,sizeof(XKEYBOARD));	
 
 	// Set tag and version
-	memcpy(&xkbd.id,"KMFL",4);
-	memcpy(&xkbd.version,Version,4);
+	memcpy(&xkp->id,"KMFL",4);
+	memcpy(&xkp->version,kmflcomp_ctx->version,4);
 
-	// add the keyboard header
-	keyboard_buffer = append_to_buffer(keyboard_buffer, &keyboard_buffer_size, &xkbd, sizeof(XKEYBOARD));
+	// Fill the string table (no nulls). Shared items are simply written again
+	for(n=0,run=runs; n<nruns; n++,run++)
+	{
+		if(run->len > 0) memcpy(stp+run->offset, run->items, run->len*ITEMSIZE);
+	}
 
-	// Save each store, saving its contents in the string table (no nulls)
-	for(n=0,index=0,sp=kbp->stores; n<kbp->nstores; n++,sp=sp->next)
+	// Save each store, with the offset of its contents in the string table
+	for(n=0,run=runs,sp=kbp->stores; n<kbp->nstores; n++,sp=sp->next,xsp++,run++)
 	{		
-		if(sp->len > 0)
-		{
-			stt_buffer = append_to_buffer(stt_buffer, &stt_buffer_size,sp->items,sp->len*ITEMSIZE);	
-		}
 		if(sp->items) {
 			mem_free(sp->items);	// free string memory 
 			sp->items = NULL;
 		}
-		xstore.len = sp->len;
-		xstore.items = index;
-		keyboard_buffer = append_to_buffer(keyboard_buffer, &keyboard_buffer_size, &xstore,sizeof(XSTORE));
-		index += sp->len;
+		xsp->len = sp->len;
+		xsp->items = run->offset;
 	}
 		
-	// Save each group, saving rules in the rule table and rule strings in the string table
-	for(j=0,gp=kbp->groups,offset=0; j<kbp->ngroups; j++,gp=gp->next)
-	{
-		xgroup.flags = gp->flags;
-		xgroup.nrules = gp->nrules;
-		xgroup.rule1 = offset;
-		xgroup.mrlen = gp->mrlen;
-		xgroup.nmrlen = gp->nmrlen;
+	// Save each group, saving rules in the rule table
+	for(j=0,gp=kbp->groups,offset=0; j<kbp->ngroups; j++,gp=gp->next,xgp++)
+	{
+		*glp++ = gp->line;
+		xgp->flags = gp->flags;
+		xgp->nrules = gp->nrules;
+		xgp->rule1 = offset;
+		xgp->mrlen = gp->mrlen;
+		xgp->nmrlen = gp->nmrlen;
 		
 		if(gp->mrlen > 0)
 		{	
-			stt_buffer = append_to_buffer(stt_buffer, &stt_buffer_size, gp->match, gp->mrlen*ITEMSIZE);
 			mem_free(gp->match);	// free string memory 
-			xgroup.match = index;
-			index += gp->mrlen;
+			xgp->match = run->offset;
 		}
-		else xgroup.match = UNDEFINED;
+		else xgp->match = UNDEFINED;
+		run++;
 		
 		if(gp->nmrlen > 0)
 		{	
-			stt_buffer = append_to_buffer(stt_buffer, &stt_buffer_size, gp->nomatch, gp->nmrlen*ITEMSIZE);
 			mem_free(gp->nomatch); // free string memory 
-			xgroup.nomatch = index;
-			index += gp->nmrlen;
+			xgp->nomatch = run->offset;
 		}
-		else xgroup.nomatch = UNDEFINED;
-
-		keyboard_buffer = append_to_buffer(keyboard_buffer, &keyboard_buffer_size, &xgroup, sizeof(XGROUP));
+		else xgp->nomatch = UNDEFINED;
+		run++;
 
-		for(i=0,rp=gp->rules; i<gp->nrules; i++,rp=rp->next)
+		for(i=0,rp=gp->rules; i<gp->nrules; i++,rp=rp->next,xrp++)
 		{
-			xrule.ilen = rp->ilen;
-			xrule.olen = rp->olen;
-			stt_buffer = append_to_buffer(stt_buffer, &stt_buffer_size, rp->lhs, rp->ilen*ITEMSIZE);
+			*rlp++ = rp->line;
+			xrp->ilen = rp->ilen;
+			xrp->olen = rp->olen;
 			mem_free(rp->lhs);		// free string memory 
-			xrule.lhs = index;
-			index += rp->ilen;
-			stt_buffer = append_to_buffer(stt_buffer, &stt_buffer_size, rp->rhs,rp->olen*ITEMSIZE);
+			xrp->lhs = (run++)->offset;
 			mem_free(rp->rhs);		// free string memory 
-			xrule.rhs = index;
-			index += rp->olen;
-
-			rtt_buffer = append_to_buffer(rtt_buffer, &rtt_buffer_size, &xrule, sizeof(XRULE));
+			xrp->rhs = (run++)->offset;
 			offset++;
 		}
 	}
 
-    keyboard_buffer = append_to_buffer(keyboard_buffer, &keyboard_buffer_size, rtt_buffer, rtt_buffer_size);
-    
-    keyboard_buffer = append_to_buffer(keyboard_buffer, &keyboard_buffer_size, stt_buffer, stt_buffer_size);
+	mem_free(runs);
 
-    // don't use memory management for buffers because they will be used outside of kmflcomp
-    free(rtt_buffer);
-    free(stt_buffer);
-    
 	// Free deadkey memory
 	for(dp=kbp->deadkeys; dp!=NULL; dp=dp1) 
 	{
@@ -420,16 +693,92 @@ unsigned long create_keyboard_buffer(const char *infile, void ** kb_buf)
 		mem_free(gp);
 	}
 	kbp->groups = NULL;
+
+	// Fill the directory, with the checksum of each section
+	xdp->size = keyboard_buffer_size;
+	xdp->nsections = 5;
+	xdp->nrules = nrules;
+	for(n=0; n<5; n++)
+		xs[n].checksum = kmfl_checksum(XS_CHECKSUM_INIT, (char *)keyboard_buffer+xs[n].offset, xs[n].size);
+	memcpy(xdp+1, xs, sizeof(xs));
+	xdp->checksum = kmfl_checksum(kmfl_checksum(XS_CHECKSUM_INIT, xkp, sizeof(XKEYBOARD)), xs, sizeof(xs));
+
     *kb_buf = keyboard_buffer;
 	return keyboard_buffer_size;
 }
 
 
+// Routines for indexing stores, groups and deadkeys
+
+// Case-insensitive hash of a name
+static unsigned int name_hash(const char *name)
+{
+	unsigned int h=2166136261u;
+
+	for(; *name; name++)
+	{
+		h ^= (unsigned char)tolower((unsigned char)*name);
+		h *= 16777619u;
+	}
+	return h;
+}
+
+// Enter an object number in the hash table, after any others with the same name
+static void index_insert(NAMEINDEX *xp, unsigned int n)
+{
+	unsigned int k, mask=xp->nslots-1;
+
+	for(k=name_hash(xp->names[n])&mask; xp->slots[k]; k=(k+1)&mask);
+	xp->slots[k] = n+1;
+}
+
+// Add an object to an index, as the next number
+static void index_add(NAMEINDEX *xp, void *object, char *name)
+{
+	unsigned int n;
+
+	if(xp->count == xp->size)
+	{
+		xp->size = xp->size ? 2*xp->size : 64;
+		xp->objects = (void **)mem_realloc(xp->objects, xp->size*sizeof(void *));
+		xp->names = (char **)mem_realloc(xp->names, xp->size*sizeof(char *));
+		if(!xp->objects || !xp->names) fail(4,"out of memory!");
+	}
+	xp->objects[xp->count] = object;
+	xp->names[xp->count] = name;
+	xp->count++;
+
+	// Keep the hash table at most half full
+	if(2*xp->count > xp->nslots)
+	{
+		if(xp->slots) mem_free(xp->slots);
+		xp->nslots = xp->nslots ? 2*xp->nslots : 128;
+		xp->slots = (unsigned int *)checked_alloc(xp->nslots,sizeof(unsigned int));
+		for(n=0; n<xp->count; n++) index_insert(xp, n);
+	}
+	else index_insert(xp, xp->count-1);
+}
+
+// Find the number of the first object with a name (ignoring case), or -1 if none
+static int index_find(NAMEINDEX *xp, const char *name)
+{
+	unsigned int k, mask=xp->nslots-1;
+
+	if(xp->nslots == 0) return -1;
+
+	for(k=name_hash(name)&mask; xp->slots[k]; k=(k+1)&mask)
+	{
+		if(strcasecmp(name,xp->names[xp->slots[k]-1]) == 0) return xp->slots[k]-1;
+	}
+	return -1;
+}
+
 // Routines for manipulating rule groups 
 
 // Create a new group
 GROUP *new_group(char *name, int line)
 {  
+	KEYBOARD *kbp=&kmflcomp_ctx->keyboard;
 	GROUP *gp, *gp1;
 
 	if((gp=find_group(name)) == NULL)
@@ -440,7 +789,7 @@ GROUP *new_group(char *name, int line)
 		// and add it to the linked list of groups
 		if(kbp->groups)
 		{
-			for(gp1=kbp->groups; gp1->next; gp1=gp1->next);
+			gp1 = (GROUP *)kmflcomp_ctx->group_index.objects[kmflcomp_ctx->group_index.count-1];
 			gp1->next = gp;	
 			kbp->ngroups++;
 		}
@@ -449,6 +798,7 @@ GROUP *new_group(char *name, int line)
 			kbp->groups = gp;
 			kbp->ngroups = 1;
 		}
+		index_add(&kmflcomp_ctx->group_index, gp, gp->name);
 	}
 
 	return gp;
@@ -457,29 +807,22 @@ GROUP *new_group(char *name, int line)
 // Find a group by name
 GROUP *find_group(char *name)
 {
-	GROUP *gp;
-	for(gp=kbp->groups; gp!=NULL; gp=gp->next)
-	{
-		if(strcasecmp(name,gp->name) == 0) return gp;
-	}
-	return NULL;
+	int n=index_find(&kmflcomp_ctx->group_index, name);
+
+	return (n < 0) ? NULL : (GROUP *)kmflcomp_ctx->group_index.objects[n];
 }
 
 // Find the group number of a named group, and create a new group if necessary
 int group_number(char *name, int line)
 {
-	GROUP *gp;
 	int n;
 	
-	for(n=0,gp=kbp->groups; gp!=NULL; gp=gp->next,n++)
-	{
-		if(strcasecmp(name,gp->name) == 0) return n;
-	}
+	if((n=index_find(&kmflcomp_ctx->group_index, name)) >= 0) return n;
 	
 	// Create a new group and save the name	
-	gp = new_group(name, line);
+	new_group(name, line);
 
-	return n;
+	return kmflcomp_ctx->group_index.count-1;
 }
 
 // Count the groups in a linked list of groups
@@ -495,8 +838,8 @@ int count_groups(GROUP *gp)
 // Save the name of the starting group and set the mode flag
 void set_start_group(char *name, int mode, int line)
 {
-	kbp->group1 = group_number(name, line);
-	kbp->mode = mode;
+	kmflcomp_ctx->keyboard.group1 = group_number(name, line);
+	kmflcomp_ctx->keyboard.mode = mode;
 }
 
 // Routines for manipulating rules
@@ -602,14 +945,14 @@ ITEM *check_lhs(ITEM *lhs, unsigned int ilen, GROUP *gp, int line)
 	}
 	*p = 0;		// ensure rule string terminated after compacting 
 
-	if((gp->flags & GF_USEKEYS) && !goodplus && (Version[0] > '3'))		
+	if((gp->flags & GF_USEKEYS) && !goodplus && (kmflcomp_ctx->version[0] > '3'))		
 	{
 		kmflcomp_warn(line,"'+' should be used before the keystroke"); 
 	}
 
 	if(badplus)
 	{
-		if(Version[0] > '5')
+		if(kmflcomp_ctx->version[0] > '5')
 			kmflcomp_error(line,"use '+' only immediately before keystroke");
 		else 
 			kmflcomp_warn(line,"'+' used incorrectly (but ignored)");
@@ -764,6 +1107,401 @@ void sort_rules(GROUP *gp)
 	rp->next = NULL;
 }
 
+// Routines for optimizing the keyboard (compiler option -O). Rules that can never
+// match, because an earlier rule in the same group always matches first, are left out,
+// followed by the groups that cannot be reached from the starting group. Stores with
+// the same contents are then merged, and stores that are no longer used are left out
+
+// Report something left out by the optimizer (compiler option -r)
+static void optimize_report(int line, char *s, ...)
+{
+	char t[512];
+	va_list v1;
+
+	if(!opt_report) return;
+
+	va_start(v1,s); 
+	vsnprintf(t,511,s,v1);
+	va_end(v1);
+
+#ifdef EKAYA
+    log_message("  Optimized: %s (line %d)\n", t, line);
+#else
+	if(line)
+		fprintf(stderr, "  Optimized: %s (line %d)\n", t, line);
+	else
+		fprintf(stderr, "  Optimized: %s\n", t);
+#endif
+}
+
+// Can the optimizer compare this item with the item of another rule?
+static int simple_item(ITEM q)
+{
+	switch(ITEM_TYPE(q))
+	{
+	case ITEM_CHAR:
+	case ITEM_KEYSYM:
+	case ITEM_DEADKEY:
+	case ITEM_ANY:
+	case ITEM_NOTANY:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+// Is an item in a store? Items are compared as by find_in_store() in the interpreter
+static int store_has_item(STORE *sp, ITEM q, ITEM mask)
+{
+	UINT n;
+
+	for(n=0; n<sp->len; n++)
+	{
+		if((sp->items[n] & mask) == (q & mask)) return 1;
+	}
+	return 0;
+}
+
+// Is every item of store sp2 also in store sp1?
+static int store_contains(STORE *sp1, STORE *sp2)
+{
+	UINT n;
+
+	for(n=0; n<sp2->len; n++)
+	{
+		if(!store_has_item(sp1, sp2->items[n], 0xffffffff)) return 0;
+	}
+	return 1;
+}
+
+// Does rule item q1 match every history item that rule item q2 matches? Items are
+// compared without their type for the last item of a rule, as in match_rule()
+static int item_covers(ITEM q1, ITEM q2, int last)
+{
+	STORE *sp1, *sp2;
+	ITEM mask=last ? 0xffffff : 0xffffffff;
+
+	if(q1 == q2) return 1;
+	if(ITEM_TYPE(q1) != ITEM_ANY && ITEM_TYPE(q1) != ITEM_NOTANY) return 0;
+
+	sp1 = (STORE *)kmflcomp_ctx->store_index.objects[q1 & 0xffff];
+
+	switch(ITEM_TYPE(q2))
+	{
+	case ITEM_CHAR:
+	case ITEM_DEADKEY:
+		return store_has_item(sp1, q2, mask) == (ITEM_TYPE(q1) == ITEM_ANY);
+	case ITEM_ANY:
+	case ITEM_NOTANY:
+		if(ITEM_TYPE(q2) != ITEM_TYPE(q1)) return 0;
+		sp2 = (STORE *)kmflcomp_ctx->store_index.objects[q2 & 0xffff];
+		return (ITEM_TYPE(q1) == ITEM_ANY) ? store_contains(sp1, sp2) : store_contains(sp2, sp1);
+	}
+	return 0;
+}
+
+// Does rule rp1 match whenever rule rp2 (of the same length) matches? Rules using
+// context(), index(), nul or other items must be identical
+static int rule_covers(RULE *rp1, RULE *rp2)
+{
+	UINT n;
+
+	if(memcmp(rp1->lhs, rp2->lhs, rp1->ilen*sizeof(ITEM)) == 0) return 1;
+
+	for(n=0; n<rp1->ilen; n++)
+	{
+		if(!simple_item(rp1->lhs[n]) || !simple_item(rp2->lhs[n])) return 0;
+	}
+
+	for(n=0; n<rp1->ilen; n++)
+	{
+		if(!item_covers(rp1->lhs[n], rp2->lhs[n], n == rp1->ilen-1)) return 0;
+	}
+	return 1;
+}
+
+// Leave out the rules of a group that can never match. The rules have been sorted,
+// so a rule is never tried if an earlier rule of the same length always matches first
+static UINT optimize_rules(GROUP *gp)
+{
+	RULE *rp, *rp1, *rp2;
+	UINT n, k, first, nkept;
+
+	// Sorted groups of fewer than two rules are still linked lists, with nothing to remove
+	if(gp->nrules < 2) return 0;
+
+	for(n=0, first=0, nkept=0, rp=gp->rules; n<gp->nrules; n++, rp++)
+	{
+		// Find the first rule kept of the same length as this rule
+		if(rp->ilen != gp->rules[first].ilen) first = nkept;
+
+		for(k=first, rp1=gp->rules+first; k<nkept; k++, rp1++)
+		{
+			if(rule_covers(rp1, rp)) break;
+		}
+
+		if(k < nkept)
+		{
+			if(rp->olen == rp1->olen && memcmp(rp->rhs, rp1->rhs, rp->olen*sizeof(ITEM)) == 0)
+				optimize_report(rp->line, "duplicate of the rule at line %d left out", rp1->line);
+			else
+				optimize_report(rp->line, "rule left out, as the rule at line %d always matches first", rp1->line);
+			continue;
+		}
+
+		rp2 = gp->rules+nkept++;
+		if(rp2 != rp) *rp2 = *rp;
+	}
+
+	// Relink the list
+	for(n=0, rp=gp->rules; n<nkept; n++, rp++) rp->next = rp+1;
+	rp->next = NULL;
+
+	n = gp->nrules-nkept;
+	gp->nrules = nkept;
+	return n;
+}
+
+// Mark the groups used by a list of items, and those that they use in turn
+static void mark_groups(ITEM *p, UINT len, char *used)
+{
+	GROUP *gp;
+	RULE *rp;
+	UINT n, k;
+
+	for(n=0; n<len; n++, p++)
+	{
+		if(ITEM_TYPE(*p) != ITEM_USE) continue;
+
+		k = *p & 0xffff;
+		if(k >= kmflcomp_ctx->group_index.count || used[k]) continue;
+
+		used[k] = 1;
+		gp = (GROUP *)kmflcomp_ctx->group_index.objects[k];
+		mark_groups(gp->match, gp->mrlen, used);
+		mark_groups(gp->nomatch, gp->nmrlen, used);
+		for(k=0, rp=gp->rules; k<gp->nrules; k++, rp=rp->next)
+			mark_groups(rp->rhs, rp->olen, used);
+	}
+}
+
+// Change the group numbers in a list of items
+static void renumber_groups(ITEM *p, UINT len, UINT *number)
+{
+	UINT n;
+
+	for(n=0; n<len; n++, p++)
+	{
+		if(ITEM_TYPE(*p) == ITEM_USE && (*p & 0xffff) < kmflcomp_ctx->group_index.count)
+			*p = (*p & 0xffff0000) | number[*p & 0xffff];
+	}
+}
+
+// Count the references to each store in a list of items, or change them to the new
+// store numbers
+static void count_store_refs(ITEM *p, UINT len, UINT *refs)
+{
+	UINT n;
+
+	for(n=0; n<len; n++, p++)
+	{
+		switch(ITEM_TYPE(*p))
+		{
+		case ITEM_ANY:
+		case ITEM_NOTANY:
+		case ITEM_INDEX:
+		case ITEM_OUTS:
+			if((*p & 0xffff) < kmflcomp_ctx->store_index.count) refs[*p & 0xffff]++;
+			break;
+		}
+	}
+}
+
+static void renumber_stores(ITEM *p, UINT len, UINT *number)
+{
+	UINT n;
+
+	for(n=0; n<len; n++, p++)
+	{
+		switch(ITEM_TYPE(*p))
+		{
+		case ITEM_ANY:
+		case ITEM_NOTANY:
+		case ITEM_INDEX:
+		case ITEM_OUTS:
+			if((*p & 0xffff) < kmflcomp_ctx->store_index.count)
+				*p = (*p & 0xffff0000) | number[*p & 0xffff];
+			break;
+		}
+	}
+}
+
+// Count the references to each store in the rules of the keyboard, or renumber them
+static void store_refs(KEYBOARD *kbp, UINT *refs, UINT *number)
+{
+	GROUP *gp;
+	RULE *rp;
+	UINT n;
+
+	memset(refs, 0, kmflcomp_ctx->store_index.count*sizeof(UINT));
+
+	for(gp=kbp->groups; gp; gp=gp->next)
+	{
+		if(number)
+		{
+			renumber_stores(gp->match, gp->mrlen, number);
+			renumber_stores(gp->nomatch, gp->nmrlen, number);
+		}
+		count_store_refs(gp->match, gp->mrlen, refs);
+		count_store_refs(gp->nomatch, gp->nmrlen, refs);
+
+		for(n=0, rp=gp->rules; n<gp->nrules; n++, rp=rp->next)
+		{
+			if(number)
+			{
+				renumber_stores(rp->lhs, rp->ilen, number);
+				renumber_stores(rp->rhs, rp->olen, number);
+			}
+			count_store_refs(rp->lhs, rp->ilen, refs);
+			count_store_refs(rp->rhs, rp->olen, refs);
+		}
+	}
+}
+
+// Leave out the groups that cannot be reached from the starting group
+static UINT optimize_groups(KEYBOARD *kbp)
+{
+	GROUP *gp, *gp1;
+	RULE *rp;
+	char *used;
+	UINT *number, n, k, nremoved;
+	ITEM start;
+
+	if(kbp->group1 >= kmflcomp_ctx->group_index.count) return 0;
+
+	used = (char *)checked_alloc(kmflcomp_ctx->group_index.count, sizeof(char));
+	number = (UINT *)checked_alloc(kmflcomp_ctx->group_index.count, sizeof(UINT));
+
+	start = MAKE_ITEM(ITEM_USE, kbp->group1);
+	mark_groups(&start, 1, used);
+
+	// Number the groups that are kept, and unlink the others
+	for(n=0, k=0, gp1=NULL, gp=kbp->groups; gp; n++, gp=gp->next)
+	{
+		if(used[n])
+		{
+			number[n] = k++;
+			gp1 = gp;
+		}
+		else
+		{
+			optimize_report(0, "group %s left out, as it is never used", gp->name);
+			if(gp1) gp1->next = gp->next; else kbp->groups = gp->next;
+		}
+	}
+
+	nremoved = kbp->ngroups-k;
+	if(nremoved > 0)
+	{
+		kbp->ngroups = k;
+		kbp->group1 = number[kbp->group1];
+		for(gp=kbp->groups; gp; gp=gp->next)
+		{
+			renumber_groups(gp->match, gp->mrlen, number);
+			renumber_groups(gp->nomatch, gp->nmrlen, number);
+			for(n=0, rp=gp->rules; n<gp->nrules; n++, rp=rp->next)
+				renumber_groups(rp->rhs, rp->olen, number);
+		}
+	}
+
+	mem_free(number);
+	mem_free(used);
+	return nremoved;
+}
+
+// Merge stores with the same contents, then leave out the stores that are not used.
+// The special stores keep their numbers, and undefined stores are kept for the warning
+// given when the keyboard buffer is created. Returns the number of stores left out
+static UINT optimize_stores(KEYBOARD *kbp, UINT *nmerged)
+{
+	STORE *sp, *sp1, *sp2;
+	UINT *refs, *number, n, k, nstores;
+
+	nstores = kmflcomp_ctx->store_index.count;
+	refs = (UINT *)checked_alloc(nstores, sizeof(UINT));
+	number = (UINT *)checked_alloc(nstores, sizeof(UINT));
+
+	store_refs(kbp, refs, NULL);
+
+	// Refer to the first of the stores used with the same contents
+	for(n=0, *nmerged=0; n<nstores; n++)
+	{
+		number[n] = n;
+		sp = (STORE *)kmflcomp_ctx->store_index.objects[n];
+		if(n <= SS_AUTHOR || refs[n] == 0 || sp->len == 0) continue;
+
+		for(k=SS_AUTHOR+1; k<n; k++)
+		{
+			sp1 = (STORE *)kmflcomp_ctx->store_index.objects[k];
+			if(refs[k] > 0 && number[k] == k && sp1->len == sp->len
+				&& memcmp(sp1->items, sp->items, sp->len*sizeof(ITEM)) == 0) break;
+		}
+
+		if(k < n)
+		{
+			optimize_report(sp->lineno, "store %s merged with store %s", sp->name, sp1->name);
+			number[n] = k;
+			(*nmerged)++;
+		}
+	}
+
+	if(*nmerged > 0) store_refs(kbp, refs, number);
+
+	// Number the stores that are kept, and unlink the others
+	for(n=0, k=0, sp2=NULL, sp=kbp->stores; sp; n++, sp=sp->next)
+	{
+		if(n <= SS_AUTHOR || refs[n] > 0 || (sp->len == 0 && sp->name[0] != '&'))
+		{
+			number[n] = k++;
+			sp2 = sp;
+		}
+		else
+		{
+			if(refs[n] == 0 && number[n] == n)
+				optimize_report(sp->lineno, "store %s left out, as it is never used", sp->name);
+			if(sp2) sp2->next = sp->next; else kbp->stores = sp->next;
+		}
+	}
+
+	n = kbp->nstores-k;
+	if(n > 0)
+	{
+		kbp->nstores = k;
+		store_refs(kbp, refs, number);
+	}
+
+	mem_free(number);
+	mem_free(refs);
+	return n;
+}
+
+// Optimize the keyboard after its rules have been sorted
+void optimize_keyboard(KEYBOARD *kbp)
+{
+	GROUP *gp;
+	UINT nrules, ngroups, nstores, nmerged;
+
+	for(gp=kbp->groups, nrules=0; gp; gp=gp->next)
+		nrules += optimize_rules(gp);
+
+	ngroups = optimize_groups(kbp);
+	nstores = optimize_stores(kbp, &nmerged);
+
+	optimize_report(0, "%u rule%s, %u group%s and %u store%s left out (%u store%s merged)",
+		nrules, (nrules==1?"":"s"), ngroups, (ngroups==1?"":"s"),
+		nstores, (nstores==1?"":"s"), nmerged, (nmerged==1?"":"s"));
+}
+
 // Routines for manipulating deadkeys
 
 // Create a deadkey (I don't think this is ever needed - see deadkey_number)
@@ -774,11 +1512,13 @@ DEADKEY *new_deadkey(char *name, int line)
 	if((dp=find_deadkey(name)) == NULL)
 	{
 		dp = (DEADKEY *)checked_alloc(sizeof(DEADKEY),1);
-		if(last_deadkey != NULL) last_deadkey->next = dp;
-		last_deadkey = dp;
-		if(kbp->deadkeys == NULL) kbp->deadkeys = dp;	// initialize pointer to list of deadkeys
+		if(kmflcomp_ctx->last_deadkey != NULL) kmflcomp_ctx->last_deadkey->next = dp;
+		kmflcomp_ctx->last_deadkey = dp;
+		if(kmflcomp_ctx->keyboard.deadkeys == NULL) kmflcomp_ctx->keyboard.deadkeys = dp;	// initialize pointer to list of deadkeys
+		checked_strcpy(dp->name,name,NAMELEN, "deadkey", line);
+		index_add(&kmflcomp_ctx->deadkey_index, dp, dp->name);
 	}
-	checked_strcpy(dp->name,name,NAMELEN, "deadkey", line);
+	else checked_strcpy(dp->name,name,NAMELEN, "deadkey", line);
 
 	return dp;
 }
@@ -786,31 +1526,29 @@ DEADKEY *new_deadkey(char *name, int line)
 // Find a deadkey by name
 DEADKEY *find_deadkey(char *name)
 {
-	DEADKEY *p;
-	for(p=kbp->deadkeys; p!=NULL; p=p->next)
-	{
-		if(strcasecmp(name,p->name) == 0) return p;
-	}
-	return NULL;
+	int n=index_find(&kmflcomp_ctx->deadkey_index, name);
+
+	return (n < 0) ? NULL : (DEADKEY *)kmflcomp_ctx->deadkey_index.objects[n];
 }
 
 // Find a deadkey number
 int deadkey_number(char *name, int line)
 {
-	DEADKEY *dp, *dp0=NULL, *dp1;
+	DEADKEY *dp0=NULL, *dp1;
 	int n;
-	for(n=0,dp=kbp->deadkeys; dp!=NULL; dp0=dp,dp=dp->next,n++)
-	{
-		if(strcasecmp(name,dp->name) == 0) return n;
-	}
+
+	if((n=index_find(&kmflcomp_ctx->deadkey_index, name)) >= 0) return n;
+
 	// Create the deadkey if this is the first reference
+	if(kmflcomp_ctx->deadkey_index.count > 0) dp0 = (DEADKEY *)kmflcomp_ctx->deadkey_index.objects[kmflcomp_ctx->deadkey_index.count-1];
 	dp1 = (DEADKEY *)checked_alloc(sizeof(DEADKEY),1);
-	if(dp0) dp0->next = dp1; else kbp->deadkeys = dp1;
+	if(dp0) dp0->next = dp1; else kmflcomp_ctx->keyboard.deadkeys = dp1;
 	
-	kbp->ndeadkeys++;	
+	kmflcomp_ctx->keyboard.ndeadkeys++;	
 	checked_strcpy(dp1->name,name,NAMELEN, "deadkey", line);
+	index_add(&kmflcomp_ctx->deadkey_index, dp1, dp1->name);
 
-	return n;
+	return kmflcomp_ctx->deadkey_index.count-1;
 }
 
 
@@ -835,12 +1573,13 @@ STORE *new_store(char *name, ITEM *ip0, int line)
 	else
 	{
 		sp = (STORE *)checked_alloc(sizeof(STORE), 1);
-		if(kbp->stores == NULL) kbp->stores = sp;	// initialize pointer to list of stores
+		if(kmflcomp_ctx->keyboard.stores == NULL) kmflcomp_ctx->keyboard.stores = sp;	// initialize pointer to list of stores
 		checked_strcpy(sp->name,name,NAMELEN, "store", line);
 		sp->lineno=line;
-		if(last_store != NULL) last_store->next = sp;
-		last_store = sp;
+		if(kmflcomp_ctx->last_store != NULL) kmflcomp_ctx->last_store->next = sp;
+		kmflcomp_ctx->last_store = sp;
 		sp->next = NULL;
+		index_add(&kmflcomp_ctx->store_index, sp, sp->name);
 	}
 
 	// Allocate memory for this store, expanding any outs()
@@ -912,31 +1651,24 @@ STORE *new_store_from_string(char *name, char *string,int line)
 // Find a store by name
 STORE *find_store(char *name)
 {
-	STORE *p;
+	int n;
+
+	if(name != NULL && (n=index_find(&kmflcomp_ctx->store_index, name)) >= 0)
+		return (STORE *)kmflcomp_ctx->store_index.objects[n];
 
-	if(name != NULL) 
-	{
-		for(p=kbp->stores; p!=NULL; p=p->next)
-		{
-			if(strcasecmp(name,p->name) == 0) return p;
-		}
-	}
 	return NULL;
 }
 
 // Find a store number
 int store_number(char *name, int line)
 {
-	STORE *p;
 	int n;
-	for(n=0,p=kbp->stores; p!=NULL; p=p->next,n++)
-	{
-		if(strcasecmp(name,p->name) == 0) return n;
-	}
+
+	if((n=index_find(&kmflcomp_ctx->store_index, name)) >= 0) return n;
 
 	// create the store
 	if (new_store(name, NULL, line) != NULL)
-		return n;
+		return kmflcomp_ctx->store_index.count-1;
 
 	return UNDEFINED;
 }
@@ -944,13 +1676,9 @@ int store_number(char *name, int line)
 // Find a store name
 char *store_name(int number)
 {
-	STORE *sp;
-	int n;
-	for(n=0,sp=kbp->stores; sp!=NULL; sp=sp->next,n++)
-	{
-		if(n == number) return sp->name;
-	}
-	return NULL;
+	if(number < 0 || (unsigned)number >= kmflcomp_ctx->store_index.count) return NULL;
+
+	return kmflcomp_ctx->store_index.names[number];
 }
 
 // Count the stores in a linked list of stores
@@ -964,28 +1692,24 @@ int count_stores(STORE *sp)
 }
 
 // Create a new itemlist 
-ITEM *new_list(ITEM q)
+ITEMVEC *new_list(ITEM q)
 {
-	ITEM *p;
-	p = (ITEM *)checked_alloc(2,4);
-	*p = q; 
-	return p;
+	ITEMVEC *vp;
+	vp = (ITEMVEC *)checked_alloc(sizeof(ITEMVEC),1);
+	return add_item_to_list(vp, q);
 }
 
-// Add an item to an itemlist
-ITEM *add_item_to_list(ITEM *s1, ITEM q)
+// Add an item to the start of an itemlist
+ITEMVEC *add_item_to_list(ITEMVEC *vp, ITEM q)
 {
-	ITEM *p, *p0;
-	int i, n;
-
-	if((n=count_items(s1)) == 0) return new_list(q);
-	
-	p = p0 = (ITEM *)checked_alloc(n+1,4);
-	*p++ = q;
-	for(i=0; i<n; i++) *p++ = *(s1+i);
-	*p = 0;
-	mem_free(s1);
-	return p0;
+	if(vp->len == vp->size)
+	{
+		vp->size = vp->size ? 2*vp->size : 8;
+		if(!(vp->items=(ITEM *)mem_realloc(vp->items, (vp->size+1)*sizeof(ITEM))))
+			fail(4,"out of memory!");
+	}
+	vp->items[vp->len++] = q;
+	return vp;
 }
 
 // Count items in an item list
@@ -998,18 +1722,36 @@ unsigned int count_items(ITEM *p)
 	return n;
 }
 
-// Concatenate two item lists
-ITEM *add_lists(ITEM *s1, ITEM *s2)
+// Add a null-terminated list of items to the start of an itemlist (or to a new
+// itemlist if vp is NULL), and free the items
+ITEMVEC *add_lists(ITEMVEC *vp, ITEM *ip)
 {
-	ITEM *p, *p0;
-	int i, n1, n2;
-	n1 = count_items(s1); n2 = count_items(s2);
-	p = p0 = (ITEM *)checked_alloc(n1+n2+1,4);
-	for(i=0; i<n2; i++) *p++ = *(s2+i);
-	for(i=0; i<n1; i++)	*p++ = *(s1+i);
-	*p = 0;
-	mem_free(s1); mem_free(s2);
-	return p0;
+	int n;
+
+	if(vp == NULL) vp = (ITEMVEC *)checked_alloc(sizeof(ITEMVEC),1);
+
+	for(n=count_items(ip); n>0; n--) add_item_to_list(vp, ip[n-1]);
+	mem_free(ip);
+	return vp;
+}
+
+// Return the items of an itemlist in order as a null-terminated list, and free the rest
+ITEM *list_items(ITEMVEC *vp)
+{
+	ITEM *p, *q, t;
+
+	if(vp->items == NULL && !(vp->items=(ITEM *)mem_alloc(sizeof(ITEM))))
+		fail(4,"out of memory!");
+
+	p = vp->items;
+	for(q=p+vp->len; p+1<q; p++)
+	{
+		q--; t = *p; *p = *q; *q = t;
+	}
+	p = vp->items;
+	p[vp->len] = 0;
+	mem_free(vp);
+	return p;
 }
 
 // Create a new string
@@ -1048,7 +1790,7 @@ ITEM *items_from_string(char *sp, int line)
 	// Convert UTF-8 strings to Unicode if and only if file format is UTF-8 
 	// Note: The allocated memory will be longer than needed,but the string will be 
 	// released again as soon as the string is copied to a store or rule
-	if(file_format == KF_UNICODE)
+	if(kmflcomp_ctx->file_format == KF_UNICODE)
 	{
 		s0=sp;
 		result = IConvertUTF8toUTF32((const UTF8 **)&sp,(const UTF8 *)(sp+n),(UTF32 **)&p,(UTF32 *)(p0+n+1));
@@ -1072,7 +1814,7 @@ ITEM *items_from_string(char *sp, int line)
 // Convert an item list to a simple string (mainly for debugging)
 char *items_to_string(ITEM *p)
 {
-	static char temp[256];
+	static KMFL_THREAD char temp[256];
 
 	char *sp, *sp1;
 	int n;
@@ -1159,6 +1901,7 @@ void initialize_special_stores(void)
 // Copy special store contents to keyboard header as required
 void process_special_store(char *name, STORE *sp, int line)
 {
+	KEYBOARD *kbp=&kmflcomp_ctx->keyboard;
 	int n, kbver;
 	
 	// Identify store by name
@@ -1189,7 +1932,7 @@ void process_special_store(char *name, STORE *sp, int line)
 		break;
 	case SS_VERSION:
 		kbver = (int)(100.0*atof(items_to_string(sp->items))+0.5);
-		sprintf(Version,"%3.3d%1.1s",kbver,FILE_VERSION);
+		sprintf(kmflcomp_ctx->version,"%3.3d%1.1s",kbver,FILE_VERSION);
 		break;
 	case SS_BITMAP:
 		check_bitmap_file(sp,line);
@@ -1217,6 +1960,8 @@ void fail(int errcode, char *s, ...)
 	va_start(v1,s); 
 	vsnprintf(t,511,s,v1);
 	va_end(v1);
+	if(kmflcomp_ctx->message[0] == 0)
+		strcpy(kmflcomp_ctx->message, t);
 #ifdef EKAYA
     log_message("*** Compilation failed: %s ***\n", t);
 #else
@@ -1224,10 +1969,14 @@ void fail(int errcode, char *s, ...)
 	fflush(stderr);
 #endif
 
+	// The caller of compile_keyboard_to_buffer() reads the error count after a fatal error too
+	if(kmflcomp_ctx == &default_context)
+		errcount = default_context.nerrors;
+
 #ifdef _WIN32	
 	if(opt_debug) getch();
 #else
-    longjmp(fatal_error_buf, -errcode);
+    longjmp(kmflcomp_ctx->fatal_error ? *kmflcomp_ctx->fatal_error : fatal_error_buf, -errcode);
 #endif
 }
 
@@ -1236,15 +1985,23 @@ void kmflcomp_error(int lineno,char *s, ...)
 	char t[512];
 	va_list v1;
 
-	if(++errcount > errlimit) return;
+	if(++kmflcomp_ctx->nerrors > errlimit) return;
 
 	va_start(v1,s); 
 	vsnprintf(t,511,s,v1);
 	va_end(v1);
 
+	if(kmflcomp_ctx->message[0] == 0)
+	{
+		if(lineno)
+			snprintf(kmflcomp_ctx->message, sizeof(kmflcomp_ctx->message), "%.480s (line %d)", t, lineno);
+		else
+			strcpy(kmflcomp_ctx->message, t);
+	}
+
 #ifdef EKAYA
     log_message("  Error: %s (line %d)\n", t, lineno);
-    if(errcount == errlimit) 
+    if(kmflcomp_ctx->nerrors == errlimit) 
 		log_message("    -------(remaining errors unreported)-------\n");
 #else
 	if(lineno)
@@ -1252,7 +2009,7 @@ void kmflcomp_error(int lineno,char *s, ...)
 	else
 		fprintf(stderr, "  Error: %s\n", t);
 
-	if(errcount == errlimit) 
+	if(kmflcomp_ctx->nerrors == errlimit) 
 		fprintf(stderr, "    -------(remaining errors unreported)-------\n");
 #endif
 }
@@ -1276,7 +2033,7 @@ void kmflcomp_warn(int lineno,char *s, ...)
 	va_list v1;
     char buffer[512];
 	
-	if(++warncount > warnlimit) return;
+	if(++kmflcomp_ctx->nwarnings > warnlimit) return;
 
 	va_start(v1,s);
 #ifdef EKAYA
@@ -1296,7 +2053,7 @@ void kmflcomp_warn(int lineno,char *s, ...)
 		fprintf(stderr, "  \n");
 #endif
 
-	if(warncount == warnlimit) 
+	if(kmflcomp_ctx->nwarnings == warnlimit) 
     {
 #ifdef EKAYA
         log_message("    -------(remaining warnings unreported)-------\n");
@@ -1395,6 +2152,9 @@ ITEM make_keysym(int lineno, ITEM state, ITEM q)
         int shifted=((state & KS_SHIFT) == 0) ^ ((state & KS_CAPS) == 0);
 #ifndef _WIN32
         Display * display;
+
+        // Xlib may not have been initialized for threads
+        pthread_mutex_lock(&display_lock);
         display = XOpenDisplay(NULL);
 
         if (display)
@@ -1403,19 +2163,23 @@ ITEM make_keysym(int lineno, ITEM state, ITEM q)
             q=XKeycodeToKeysym(display, keycode, !shifted ? 0 : 1);
             XCloseDisplay(display);
         }
-        else
+        pthread_mutex_unlock(&display_lock);
+
+        if (display == NULL)
 #endif
-        if (isalpha(q))
         {
-            if (!shifted)
+            if (isalpha(q))
             {
-                q += 0x20;
+                if (!shifted)
+                {
+                    q += 0x20;
+                }
+            }
+            else if (((state & KS_SHIFT) == 0) || ((state & KS_CAPS) == 0))
+            {
+                kmflcomp_warn(lineno, "Non-alphabetic virtual key sequence used with K_SHIFT or K_CAPS outside of the X environment.\n"
+                "   KMFLCOMP cannot determined correct shifted keysym");
             }
-        }
-        else if (((state & KS_SHIFT) == 0) || ((state & KS_CAPS) == 0))
-        {
-            kmflcomp_warn(lineno, "Non-alphabetic virtual key sequence used with K_SHIFT or K_CAPS outside of the X environment.\n"
-            "   KMFLCOMP cannot determined correct shifted keysym");
         }
         state &= ~KS_CAPS;
     }
@@ -1471,6 +2235,7 @@ char *find_first_match(char *path)
 // of the name exists (different case, .bmp or .png suffixes)
 int check_bitmap_file(STORE *sp, int line)
 {
+	const char *fname=kmflcomp_ctx->fname;
 	const char *p;
     char *bmp_path=NULL,tname[64];
 	struct stat fstat;
@@ -118,24 +118,41 @@ typedef unsigned int flex_uint32_t;
  */
 #define YY_SC_TO_UI(c) ((unsigned int) (unsigned char) c)
 
+/* An opaque pointer. */
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
+/* For convenience, these vars (plus the bison vars far below)
+   are macros in the reentrant scanner. */
+#define yyin yyg->yyin_r
+#define yyout yyg->yyout_r
+#define yyextra yyg->yyextra_r
+#define yyleng yyg->yyleng_r
+#define yytext yyg->yytext_r
+#define yylineno (YY_CURRENT_BUFFER_LVALUE->yy_bs_lineno)
+#define yycolumn (YY_CURRENT_BUFFER_LVALUE->yy_bs_column)
+#define yy_flex_debug yyg->yy_flex_debug_r
+
 /* Enter a start condition.  This macro really ought to take a parameter,
  * but we do it the disgusting crufty way forced on us by the ()-less
  * definition of BEGIN.
  */
-#define BEGIN (yy_start) = 1 + 2 *
+#define BEGIN yyg->yy_start = 1 + 2 *
 
 /* Translate the current start state into a value that can be later handed
  * to BEGIN to return to the state.  The YYSTATE alias is for lex
  * compatibility.
  */
-#define YY_START (((yy_start) - 1) / 2)
+#define YY_START ((yyg->yy_start - 1) / 2)
 #define YYSTATE YY_START
 
 /* Action number for EOF rule of a given start state. */
 #define YY_STATE_EOF(state) (YY_END_OF_BUFFER + state + 1)
 
 /* Special action meaning "start processing a new file". */
-#define YY_NEW_FILE yyrestart(yyin  )
+#define YY_NEW_FILE yyrestart(yyin ,yyscanner )
 
 #define YY_END_OF_BUFFER_CHAR 0
 
@@ -153,10 +170,6 @@ typedef unsigned int flex_uint32_t;
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
 #endif
 
-extern int yyleng;
-
-extern FILE *yyin, *yyout;
-
 #define EOB_ACT_CONTINUE_SCAN 0
 #define EOB_ACT_END_OF_FILE 1
 #define EOB_ACT_LAST_MATCH 2
@@ -170,14 +183,14 @@ extern FILE *yyin, *yyout;
 		/* Undo effects of setting up yytext. */ \
         int yyless_macro_arg = (n); \
         YY_LESS_LINENO(yyless_macro_arg);\
-		*yy_cp = (yy_hold_char); \
+		*yy_cp = yyg->yy_hold_char; \
 		YY_RESTORE_YY_MORE_OFFSET \
-		(yy_c_buf_p) = yy_cp = yy_bp + yyless_macro_arg - YY_MORE_ADJ; \
+		yyg->yy_c_buf_p = yy_cp = yy_bp + yyless_macro_arg - YY_MORE_ADJ; \
 		YY_DO_BEFORE_ACTION; /* set up yytext again */ \
 		} \
 	while ( 0 )
 
-#define unput(c) yyunput( c, (yytext_ptr)  )
+#define unput(c) yyunput( c, yyg->yytext_ptr , yyscanner )
 
 #ifndef YY_TYPEDEF_YY_SIZE_T
 #define YY_TYPEDEF_YY_SIZE_T
@@ -249,71 +262,51 @@ struct yy_buffer_state
 	};
 #endif /* !YY_STRUCT_YY_BUFFER_STATE */
 
-/* Stack of input buffers. */
-static size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
-static size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
-static YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
-
 /* We provide macros for accessing buffer states in case in the
  * future we want to put the buffer states in a more general
  * "scanner state".
  *
  * Returns the top of the stack, or NULL.
  */
-#define YY_CURRENT_BUFFER ( (yy_buffer_stack) \
-                          ? (yy_buffer_stack)[(yy_buffer_stack_top)] \
+#define YY_CURRENT_BUFFER ( yyg->yy_buffer_stack \
+                          ? yyg->yy_buffer_stack[yyg->yy_buffer_stack_top] \
                           : NULL)
 
 /* Same as previous macro, but useful when we know that the buffer stack is not
  * NULL or when we need an lvalue. For internal use only.
  */
-#define YY_CURRENT_BUFFER_LVALUE (yy_buffer_stack)[(yy_buffer_stack_top)]
-
-/* yy_hold_char holds the character lost when yytext is formed. */
-static char yy_hold_char;
-static int yy_n_chars;		/* number of characters read into yy_ch_buf */
-int yyleng;
-
-/* Points to current character in buffer. */
-static char *yy_c_buf_p = (char *) 0;
-static int yy_init = 0;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
-
-/* Flag which is used to allow yywrap()'s to do buffer switches
- * instead of setting up a fresh yyin.  A bit of a hack ...
- */
-static int yy_did_buffer_switch_on_eof;
+#define YY_CURRENT_BUFFER_LVALUE yyg->yy_buffer_stack[yyg->yy_buffer_stack_top]
 
-void yyrestart (FILE *input_file  );
-void yy_switch_to_buffer (YY_BUFFER_STATE new_buffer  );
-YY_BUFFER_STATE yy_create_buffer (FILE *file,int size  );
-void yy_delete_buffer (YY_BUFFER_STATE b  );
-void yy_flush_buffer (YY_BUFFER_STATE b  );
-void yypush_buffer_state (YY_BUFFER_STATE new_buffer  );
-void yypop_buffer_state (void );
+void yyrestart (FILE *input_file ,yyscan_t yyscanner );
+void yy_switch_to_buffer (YY_BUFFER_STATE new_buffer ,yyscan_t yyscanner );
+YY_BUFFER_STATE yy_create_buffer (FILE *file,int size ,yyscan_t yyscanner );
+void yy_delete_buffer (YY_BUFFER_STATE b ,yyscan_t yyscanner );
+void yy_flush_buffer (YY_BUFFER_STATE b ,yyscan_t yyscanner );
+void yypush_buffer_state (YY_BUFFER_STATE new_buffer ,yyscan_t yyscanner );
+void yypop_buffer_state (yyscan_t yyscanner );
 
-static void yyensure_buffer_stack (void );
-static void yy_load_buffer_state (void );
-static void yy_init_buffer (YY_BUFFER_STATE b,FILE *file  );
+static void yyensure_buffer_stack (yyscan_t yyscanner );
+static void yy_load_buffer_state (yyscan_t yyscanner );
+static void yy_init_buffer (YY_BUFFER_STATE b,FILE *file ,yyscan_t yyscanner );
 
-#define YY_FLUSH_BUFFER yy_flush_buffer(YY_CURRENT_BUFFER )
+#define YY_FLUSH_BUFFER yy_flush_buffer(YY_CURRENT_BUFFER ,yyscanner)
 
-YY_BUFFER_STATE yy_scan_buffer (char *base,yy_size_t size  );
-YY_BUFFER_STATE yy_scan_string (yyconst char *yy_str  );
-YY_BUFFER_STATE yy_scan_bytes (yyconst char *bytes,int len  );
+YY_BUFFER_STATE yy_scan_buffer (char *base,yy_size_t size ,yyscan_t yyscanner );
+YY_BUFFER_STATE yy_scan_string (yyconst char *yy_str ,yyscan_t yyscanner );
+YY_BUFFER_STATE yy_scan_bytes (yyconst char *bytes,int len ,yyscan_t yyscanner );
 
-void *yyalloc (yy_size_t  );
-void *yyrealloc (void *,yy_size_t  );
-void yyfree (void *  );
+void *yyalloc (yy_size_t ,yyscan_t yyscanner );
+void *yyrealloc (void *,yy_size_t ,yyscan_t yyscanner );
+void yyfree (void * ,yyscan_t yyscanner );
 
 #define yy_new_buffer yy_create_buffer
 
 #define yy_set_interactive(is_interactive) \
 	{ \
 	if ( ! YY_CURRENT_BUFFER ){ \
-        yyensure_buffer_stack (); \
+        yyensure_buffer_stack (yyscanner); \
 		YY_CURRENT_BUFFER_LVALUE =    \
-            yy_create_buffer(yyin,YY_BUF_SIZE ); \
+            yy_create_buffer(yyin,YY_BUF_SIZE ,yyscanner); \
 	} \
 	YY_CURRENT_BUFFER_LVALUE->yy_is_interactive = is_interactive; \
 	}
@@ -321,9 +314,9 @@ void yyfree (void *  );
 #define yy_set_bol(at_bol) \
 	{ \
 	if ( ! YY_CURRENT_BUFFER ){\
-        yyensure_buffer_stack (); \
+        yyensure_buffer_stack (yyscanner); \
 		YY_CURRENT_BUFFER_LVALUE =    \
-            yy_create_buffer(yyin,YY_BUF_SIZE ); \
+            yy_create_buffer(yyin,YY_BUF_SIZE ,yyscanner); \
 	} \
 	YY_CURRENT_BUFFER_LVALUE->yy_at_bol = at_bol; \
 	}
@@ -335,31 +328,24 @@ void yyfree (void *  );
 
 typedef unsigned char YY_CHAR;
 
-FILE *yyin = (FILE *) 0, *yyout = (FILE *) 0;
-
 typedef int yy_state_type;
 
-extern int yylineno;
-
-int yylineno = 1;
+#define yytext_ptr yytext_r
 
-extern char *yytext;
-#define yytext_ptr yytext
-
-static yy_state_type yy_get_previous_state (void );
-static yy_state_type yy_try_NUL_trans (yy_state_type current_state  );
-static int yy_get_next_buffer (void );
-static void yy_fatal_error (yyconst char msg[]  );
+static yy_state_type yy_get_previous_state (yyscan_t yyscanner );
+static yy_state_type yy_try_NUL_trans (yy_state_type current_state  ,yyscan_t yyscanner);
+static int yy_get_next_buffer (yyscan_t yyscanner );
+static void yy_fatal_error (yyconst char msg[] ,yyscan_t yyscanner );
 
 /* Done after the current pattern has been matched and before the
  * corresponding action - sets up yytext.
  */
 #define YY_DO_BEFORE_ACTION \
-	(yytext_ptr) = yy_bp; \
+	yyg->yytext_ptr = yy_bp; \
 	yyleng = (size_t) (yy_cp - yy_bp); \
-	(yy_hold_char) = *yy_cp; \
+	yyg->yy_hold_char = *yy_cp; \
 	*yy_cp = '\0'; \
-	(yy_c_buf_p) = yy_cp;
+	yyg->yy_c_buf_p = yy_cp;
 
 #define YY_NUM_RULES 235
 #define YY_END_OF_BUFFER 236
@@ -1137,12 +1123,6 @@ static yyconst flex_int16_t yy_chk[2051] =
       742,  742,  742,  742,  742,  742,  742,  742,  742,  742
     } ;
 
-static yy_state_type yy_last_accepting_state;
-static char *yy_last_accepting_cpos;
-
-extern int yy_flex_debug;
-int yy_flex_debug = 0;
-
 /* The intent behind this definition is that it'll catch
  * any uses of REJECT which flex missed.
  */
@@ -1150,43 +1130,24 @@ int yy_flex_debug = 0;
 #define yymore() yymore_used_but_not_detected
 #define YY_MORE_ADJ 0
 #define YY_RESTORE_YY_MORE_OFFSET
-char *yytext;
 #line 1 "lex.l"
 #line 2 "lex.l"
 /* lex.l: Lex parser for Keyman keyboard source files for kmflcomp compiler */
 
 /* Derived from version written by David Gardner for k_tty */
 
+/* The scanner is reentrant: its state is kept in the scanner handle, and the state
+   of the compilation is its extra data, so that keyboards can be compiled
+   concurrently on different threads */
+
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "compiler.h"
 #include "yacc.h"
 
-void yyerror(char *);
-
-#if defined(FLEX_SCANNER) && ! defined(INITIAL)
-int caller=0,caller0=0;
-#else
-int caller= INITIAL,caller0=INITIAL;
-#endif
-
-char qchar;
-extern int lineno;
-extern int errcount;
-int done=0;
-
-void yycleanup(void)
-{
-    yy_delete_buffer(YY_CURRENT_BUFFER);
-}
-
-int yyterminate(void)
-{
-	yyerror("END\n");
-	fflush(stderr); 
-	return YY_NULL;
-}
+/* Each scanner starts by returning to the initial start condition */
+#define YY_USER_INIT	yyextra->caller=yyextra->caller0=INITIAL;
 
 
 
@@ -1198,7 +1159,7 @@ int yyterminate(void)
 
 
 
-#line 1202 "lex.c"
+#line 1163 "lex.c"
 
 #define INITIAL 0
 #define STOR 1
@@ -1220,40 +1181,86 @@ int yyterminate(void)
 #include <unistd.h>
 #endif
 
-#ifndef YY_EXTRA_TYPE
-#define YY_EXTRA_TYPE void *
-#endif
+#define YY_EXTRA_TYPE struct _kmflcomp_context *
+
+/* Holds the entire state of the reentrant scanner. */
+struct yyguts_t
+    {
+
+    /* User-defined. Not touched by flex. */
+    YY_EXTRA_TYPE yyextra_r;
+
+    /* The rest are the same as the globals declared in the non-reentrant scanner. */
+    FILE *yyin_r, *yyout_r;
+    size_t yy_buffer_stack_top; /**< index of top of stack. */
+    size_t yy_buffer_stack_max; /**< capacity of stack. */
+    YY_BUFFER_STATE * yy_buffer_stack; /**< Stack as an array. */
+    char yy_hold_char;
+    int yy_n_chars;
+    int yyleng_r;
+    char *yy_c_buf_p;
+    int yy_init;
+    int yy_start;
+    int yy_did_buffer_switch_on_eof;
+    int yy_start_stack_ptr;
+    int yy_start_stack_depth;
+    int *yy_start_stack;
+    yy_state_type yy_last_accepting_state;
+    char* yy_last_accepting_cpos;
+
+    int yylineno_r;
+    int yy_flex_debug_r;
+
+    char *yytext_r;
+    int yy_more_flag;
+    int yy_more_len;
 
-static int yy_init_globals (void );
+    YYSTYPE * yylval_r;
+
+    }; /* end struct yyguts_t */
+
+static int yy_init_globals (yyscan_t yyscanner );
+
+    /* This must go here because YYSTYPE and YYLTYPE are included
+     * from bison output in section 1.*/
+    #    define yylval yyg->yylval_r
+
+int yylex_init (yyscan_t* scanner);
+
+int yylex_init_extra (YY_EXTRA_TYPE user_defined,yyscan_t* scanner);
 
 /* Accessor methods to globals.
    These are made visible to non-reentrant scanners for convenience. */
 
-int yylex_destroy (void );
+int yylex_destroy (yyscan_t yyscanner );
+
+int yyget_debug (yyscan_t yyscanner );
 
-int yyget_debug (void );
+void yyset_debug (int debug_flag ,yyscan_t yyscanner );
 
-void yyset_debug (int debug_flag  );
+YY_EXTRA_TYPE yyget_extra (yyscan_t yyscanner );
 
-YY_EXTRA_TYPE yyget_extra (void );
+void yyset_extra (YY_EXTRA_TYPE user_defined ,yyscan_t yyscanner );
 
-void yyset_extra (YY_EXTRA_TYPE user_defined  );
+FILE *yyget_in (yyscan_t yyscanner );
 
-FILE *yyget_in (void );
+void yyset_in  (FILE * in_str ,yyscan_t yyscanner );
 
-void yyset_in  (FILE * in_str  );
+FILE *yyget_out (yyscan_t yyscanner );
 
-FILE *yyget_out (void );
+void yyset_out  (FILE * out_str ,yyscan_t yyscanner );
 
-void yyset_out  (FILE * out_str  );
+int yyget_leng (yyscan_t yyscanner );
 
-int yyget_leng (void );
+char *yyget_text (yyscan_t yyscanner );
 
-char *yyget_text (void );
+int yyget_lineno (yyscan_t yyscanner );
 
-int yyget_lineno (void );
+void yyset_lineno (int line_number ,yyscan_t yyscanner );
 
-void yyset_lineno (int line_number  );
+YYSTYPE * yyget_lval (yyscan_t yyscanner );
+
+void yyset_lval (YYSTYPE * yylval_param ,yyscan_t yyscanner );
 
 /* Macros after this point can all be overridden by user definitions in
  * section 1.
@@ -1261,28 +1268,28 @@ void yyset_lineno (int line_number  );
 
 #ifndef YY_SKIP_YYWRAP
 #ifdef __cplusplus
-extern "C" int yywrap (void );
+extern "C" int yywrap (yyscan_t yyscanner );
 #else
-extern int yywrap (void );
+extern int yywrap (yyscan_t yyscanner );
 #endif
 #endif
 
-    static void yyunput (int c,char *buf_ptr  );
+    static void yyunput (int c,char *buf_ptr  ,yyscan_t yyscanner);
     
 #ifndef yytext_ptr
-static void yy_flex_strncpy (char *,yyconst char *,int );
+static void yy_flex_strncpy (char *,yyconst char *,int ,yyscan_t yyscanner);
 #endif
 
 #ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (yyconst char * );
+static int yy_flex_strlen (yyconst char * ,yyscan_t yyscanner);
 #endif
 
 #ifndef YY_NO_INPUT
 
 #ifdef __cplusplus
-static int yyinput (void );
+static int yyinput (yyscan_t yyscanner );
 #else
-static int input (void );
+static int input (yyscan_t yyscanner );
 #endif
 
 #endif
@@ -1351,7 +1358,7 @@ static int input (void );
 
 /* Report a fatal error. */
 #ifndef YY_FATAL_ERROR
-#define YY_FATAL_ERROR(msg) yy_fatal_error( msg )
+#define YY_FATAL_ERROR(msg) yy_fatal_error( msg , yyscanner)
 #endif
 
 /* end tables serialization structures and prototypes */
@@ -1362,9 +1369,11 @@ static int input (void );
 #ifndef YY_DECL
 #define YY_DECL_IS_OURS 1
 
-extern int yylex (void);
+extern int yylex \
+               (YYSTYPE * yylval_param ,yyscan_t yyscanner);
 
-#define YY_DECL int yylex (void)
+#define YY_DECL int yylex \
+               (YYSTYPE * yylval_param , yyscan_t yyscanner)
 #endif /* !YY_DECL */
 
 /* Code executed at the beginning of each rule, after yytext and yyleng
@@ -1392,22 +1401,25 @@ YY_DECL
 	register yy_state_type yy_current_state;
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
-    
-#line 53 "lex.l"
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+#line 37 "lex.l"
 
 
-#line 1400 "lex.c"
+#line 1410 "lex.c"
 
-	if ( !(yy_init) )
+    yylval = yylval_param;
+
+	if ( !yyg->yy_init )
 		{
-		(yy_init) = 1;
+		yyg->yy_init = 1;
 
 #ifdef YY_USER_INIT
 		YY_USER_INIT;
 #endif
 
-		if ( ! (yy_start) )
-			(yy_start) = 1;	/* first start state */
+		if ( ! yyg->yy_start )
+			yyg->yy_start = 1;	/* first start state */
 
 		if ( ! yyin )
 			yyin = stdin;
@@ -1416,27 +1428,27 @@ YY_DECL
 			yyout = stdout;
 
 		if ( ! YY_CURRENT_BUFFER ) {
-			yyensure_buffer_stack ();
+			yyensure_buffer_stack (yyscanner);
 			YY_CURRENT_BUFFER_LVALUE =
-				yy_create_buffer(yyin,YY_BUF_SIZE );
+				yy_create_buffer(yyin,YY_BUF_SIZE ,yyscanner);
 		}
 
-		yy_load_buffer_state( );
+		yy_load_buffer_state(yyscanner );
 		}
 
 	while ( 1 )		/* loops until end-of-file is reached */
 		{
-		yy_cp = (yy_c_buf_p);
+		yy_cp = yyg->yy_c_buf_p;
 
 		/* Support of yytext. */
-		*yy_cp = (yy_hold_char);
+		*yy_cp = yyg->yy_hold_char;
 
 		/* yy_bp points to the position in yy_ch_buf of the start of
 		 * the current run.
 		 */
 		yy_bp = yy_cp;
 
-		yy_current_state = (yy_start);
+		yy_current_state = yyg->yy_start;
 		yy_current_state += YY_AT_BOL();
 yy_match:
 		do
@@ -1444,8 +1456,8 @@ yy_match:
 			register YY_CHAR yy_c = yy_ec[YY_SC_TO_UI(*yy_cp)];
 			if ( yy_accept[yy_current_state] )
 				{
-				(yy_last_accepting_state) = yy_current_state;
-				(yy_last_accepting_cpos) = yy_cp;
+				yyg->yy_last_accepting_state = yy_current_state;
+				yyg->yy_last_accepting_cpos = yy_cp;
 				}
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
@@ -1462,8 +1474,8 @@ yy_find_action:
 		yy_act = yy_accept[yy_current_state];
 		if ( yy_act == 0 )
 			{ /* have to back up */
-			yy_cp = (yy_last_accepting_cpos);
-			yy_current_state = (yy_last_accepting_state);
+			yy_cp = yyg->yy_last_accepting_cpos;
+			yy_current_state = yyg->yy_last_accepting_state;
 			yy_act = yy_accept[yy_current_state];
 			}
 
@@ -1475,20 +1487,20 @@ do_action:	/* This label is used only to access EOF actions. */
 	{ /* beginning of action switch */
 			case 0: /* must back up */
 			/* undo the effects of YY_DO_BEFORE_ACTION */
-			*yy_cp = (yy_hold_char);
-			yy_cp = (yy_last_accepting_cpos);
-			yy_current_state = (yy_last_accepting_state);
+			*yy_cp = yyg->yy_hold_char;
+			yy_cp = yyg->yy_last_accepting_cpos;
+			yy_current_state = yyg->yy_last_accepting_state;
 			goto yy_find_action;
 
 case 1:
 /* rule 1 can match eol */
 YY_RULE_SETUP
-#line 55 "lex.l"
-{lineno++;caller=INITIAL;BEGIN(INITIAL);return(TOK_NL);}
+#line 39 "lex.l"
+{yyextra->lineno++;yyextra->caller=INITIAL;BEGIN(INITIAL);return(TOK_NL);}
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 56 "lex.l"
+#line 40 "lex.l"
 {/* just ignore carriage returns */};
 	YY_BREAK
 case YY_STATE_EOF(INITIAL):
@@ -1502,1295 +1514,1295 @@ case YY_STATE_EOF(BITMAP):
 case YY_STATE_EOF(LNGCODE):
 case YY_STATE_EOF(SKIP):
 case YY_STATE_EOF(NAME):
-#line 58 "lex.l"
+#line 42 "lex.l"
 {
-				if(done){yyterminate();}
-				else    {done=1;lineno++;caller=INITIAL;BEGIN(INITIAL);return(TOK_NL);}
+				if(yyextra->done){yyterminate();}
+				else    {yyextra->done=1;yyextra->lineno++;yyextra->caller=INITIAL;BEGIN(INITIAL);return(TOK_NL);}
 			}
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 63 "lex.l"
+#line 47 "lex.l"
 {return TOK_NAME;}
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 64 "lex.l"
+#line 48 "lex.l"
 {BEGIN(BITMAP);return TOK_BITMAP;}
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 65 "lex.l"
-{caller=STOR;BEGIN(STOR);return TOK_HOTKEY;}
+#line 49 "lex.l"
+{yyextra->caller=STOR;BEGIN(STOR);return TOK_HOTKEY;}
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 66 "lex.l"
+#line 50 "lex.l"
 {BEGIN(KBDVER);return TOK_VERSION;}
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 67 "lex.l"
+#line 51 "lex.l"
 {BEGIN(LNGCODE);return TOK_LANGUAGE;}
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 68 "lex.l"
+#line 52 "lex.l"
 {return TOK_LAYOUT;}
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 69 "lex.l"
+#line 53 "lex.l"
 {return TOK_CAPSOFF;}
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 70 "lex.l"
+#line 54 "lex.l"
 {return TOK_CAPSON;}
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 71 "lex.l"
+#line 55 "lex.l"
 {return TOK_CAPSFREE;}
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 72 "lex.l"
+#line 56 "lex.l"
 {return TOK_COPYRIGHT;}
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 73 "lex.l"
+#line 57 "lex.l"
 {return TOK_MESSAGE;}
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 74 "lex.l"
+#line 58 "lex.l"
 {return TOK_MNEMONIC;}
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 75 "lex.l"
+#line 59 "lex.l"
 {return TOK_ETHNOLOGUE;}
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 76 "lex.l"
+#line 60 "lex.l"
 {return TOK_AUTHOR;}
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 77 "lex.l"
+#line 61 "lex.l"
 {return TOK_ANSI;}
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 78 "lex.l"
+#line 62 "lex.l"
 {return TOK_UNICODE;}
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 79 "lex.l"
+#line 63 "lex.l"
 {return TOK_ANSI;}
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 80 "lex.l"
-{caller=STOR;BEGIN(STOR);return TOK_STORE;}
+#line 64 "lex.l"
+{yyextra->caller=STOR;BEGIN(STOR);return TOK_STORE;}
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 81 "lex.l"
+#line 65 "lex.l"
 {return TOK_OUTS;}
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 82 "lex.l"
+#line 66 "lex.l"
 {return TOK_GROUP;}
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 83 "lex.l"
+#line 67 "lex.l"
 {return TOK_USINGKEYS;}
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 84 "lex.l"
+#line 68 "lex.l"
 {return TOK_USE;}
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 85 "lex.l"
+#line 69 "lex.l"
 {return TOK_CONTEXT;}
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 86 "lex.l"
+#line 70 "lex.l"
 {return TOK_ANY;}
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 87 "lex.l"
+#line 71 "lex.l"
 {return TOK_NOTANY;}
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 88 "lex.l"
+#line 72 "lex.l"
 {return TOK_BEEP;}
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 89 "lex.l"
+#line 73 "lex.l"
 {BEGIN(PLIST);return TOK_INDEX;}
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 90 "lex.l"
+#line 74 "lex.l"
 {return TOK_NOMATCH;}
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 91 "lex.l"
+#line 75 "lex.l"
 {return TOK_MATCH;}
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 92 "lex.l"
+#line 76 "lex.l"
 {return TOK_NUL;}
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 93 "lex.l"
+#line 77 "lex.l"
 {return TOK_DEADKEY;}
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 94 "lex.l"
+#line 78 "lex.l"
 {return TOK_DEADKEY;}
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 95 "lex.l"
+#line 79 "lex.l"
 {return TOK_RTN;}
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 96 "lex.l"
+#line 80 "lex.l"
 {return TOK_CALL;  /* not implemented */}
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 97 "lex.l"
+#line 81 "lex.l"
 {return TOK_SWITCH;/*  (obsolete) */}
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 98 "lex.l"
+#line 82 "lex.l"
 {return TOK_GT;}
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 99 "lex.l"
+#line 83 "lex.l"
 {return TOK_PLUS;}
 	YY_BREAK
 case 40:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp = yy_bp + 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 100 "lex.l"
+#line 84 "lex.l"
 {BEGIN(NAME);return TOK_DOLLAR;}
 	YY_BREAK
 
 case 41:
 YY_RULE_SETUP
-#line 103 "lex.l"
+#line 87 "lex.l"
 {/* ignore spaces */} 
 	YY_BREAK
 case 42:
 YY_RULE_SETUP
-#line 104 "lex.l"
+#line 88 "lex.l"
 {BEGIN(SKIP);}
 	YY_BREAK
 case 43:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp = yy_bp + 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 105 "lex.l"
+#line 89 "lex.l"
 {BEGIN(PARENS);return(TOK_BRKT);}
 	YY_BREAK
 case 44:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp = yy_bp + 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 106 "lex.l"
-{qchar='\'';BEGIN(QUOTE);return(TOK_QM);}
+#line 90 "lex.l"
+{yyextra->qchar='\'';BEGIN(QUOTE);return(TOK_QM);}
 	YY_BREAK
 case 45:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp = yy_bp + 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 107 "lex.l"
-{qchar='"';BEGIN(QUOTE);return(TOK_QM);}
+#line 91 "lex.l"
+{yyextra->qchar='"';BEGIN(QUOTE);return(TOK_QM);}
 	YY_BREAK
 case 46:
 YY_RULE_SETUP
-#line 108 "lex.l"
-{yylval.number=strtol(yytext,NULL,8);return(TOK_NUMBER);}
+#line 92 "lex.l"
+{yylval->number=strtol(yytext,NULL,8);return(TOK_NUMBER);}
 	YY_BREAK
 case 47:
 YY_RULE_SETUP
-#line 109 "lex.l"
-{yylval.number=atoi(yytext+1);return(TOK_NUMBER);}
+#line 93 "lex.l"
+{yylval->number=atoi(yytext+1);return(TOK_NUMBER);}
 	YY_BREAK
 case 48:
 YY_RULE_SETUP
-#line 110 "lex.l"
-{yylval.number=strtol(yytext+1,NULL,16);return(TOK_NUMBER);}
+#line 94 "lex.l"
+{yylval->number=strtol(yytext+1,NULL,16);return(TOK_NUMBER);}
 	YY_BREAK
 case 49:
 YY_RULE_SETUP
-#line 111 "lex.l"
-{yylval.number=strtol(yytext+2,NULL,16);return(TOK_NUMBER);}
+#line 95 "lex.l"
+{yylval->number=strtol(yytext+2,NULL,16);return(TOK_NUMBER);}
 	YY_BREAK
 case 50:
 YY_RULE_SETUP
-#line 112 "lex.l"
+#line 96 "lex.l"
 {BEGIN(KEYNAME);return(TOK_SB);}
 	YY_BREAK
 case 51:
 YY_RULE_SETUP
-#line 113 "lex.l"
+#line 97 "lex.l"
 {return(TOK_BEEP);}
 	YY_BREAK
 
 
 case 52:
 YY_RULE_SETUP
-#line 117 "lex.l"
+#line 101 "lex.l"
 {return(TOK_DEADKEY);}
 	YY_BREAK
 case 53:
 YY_RULE_SETUP
-#line 118 "lex.l"
+#line 102 "lex.l"
 {return(TOK_DEADKEY);}
 	YY_BREAK
 case 54:
 YY_RULE_SETUP
-#line 119 "lex.l"
+#line 103 "lex.l"
 {return(TOK_OUTS);}
 	YY_BREAK
 case 55:
 YY_RULE_SETUP
-#line 120 "lex.l"
+#line 104 "lex.l"
 {return(TOK_NUL);}
 	YY_BREAK
 case 56:
 YY_RULE_SETUP
-#line 121 "lex.l"
+#line 105 "lex.l"
 {return(TOK_ERROR);}
 	YY_BREAK
 
 
 case 57:
 YY_RULE_SETUP
-#line 125 "lex.l"
+#line 109 "lex.l"
 {/* ignore spaces */}
 	YY_BREAK
 case 58:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 126 "lex.l"
+#line 110 "lex.l"
 {/* ignore comments */}
 	YY_BREAK
 case 59:
 /* rule 59 can match eol */
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 127 "lex.l"
+#line 111 "lex.l"
 {/* before either EOL */}
 	YY_BREAK
 case 60:
 YY_RULE_SETUP
-#line 128 "lex.l"
+#line 112 "lex.l"
 {return TOK_QM;}
 	YY_BREAK
 case 61:
 YY_RULE_SETUP
-#line 129 "lex.l"
-{yylval.number=*yytext;return TOK_CHAR;}
+#line 113 "lex.l"
+{yylval->number=*yytext;return TOK_CHAR;}
 	YY_BREAK
 case 62:
 YY_RULE_SETUP
-#line 130 "lex.l"
-{yylval.number=*yytext;return TOK_CHAR;}
+#line 114 "lex.l"
+{yylval->number=*yytext;return TOK_CHAR;}
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
-#line 131 "lex.l"
+#line 115 "lex.l"
 {BEGIN(SKIP);}
 	YY_BREAK
 
 
 case 64:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 135 "lex.l"
+#line 119 "lex.l"
 {/* ignore anything after a space */}
 	YY_BREAK
 case 65:
 /* rule 65 can match eol */
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 136 "lex.l"
+#line 120 "lex.l"
 {/* including comments */}
 	YY_BREAK
 case 66:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp = yy_bp + 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 137 "lex.l"
-{qchar='\'';BEGIN(QUOTE);return(TOK_QM);}
+#line 121 "lex.l"
+{yyextra->qchar='\'';BEGIN(QUOTE);return(TOK_QM);}
 	YY_BREAK
 case 67:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp = yy_bp + 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 138 "lex.l"
-{qchar='"';BEGIN(QUOTE);return(TOK_QM);}
+#line 122 "lex.l"
+{yyextra->qchar='"';BEGIN(QUOTE);return(TOK_QM);}
 	YY_BREAK
 case 68:
 YY_RULE_SETUP
-#line 139 "lex.l"
-{yylval.number=*yytext;return TOK_CHAR;}
+#line 123 "lex.l"
+{yylval->number=*yytext;return TOK_CHAR;}
 	YY_BREAK
 case 69:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 140 "lex.l"
+#line 124 "lex.l"
 {/* also ignore anything after a comma */}
 	YY_BREAK
 case 70:
 /* rule 70 can match eol */
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 141 "lex.l"
+#line 125 "lex.l"
 {/* before either EOL */}
 	YY_BREAK
 
 
 case 71:
 YY_RULE_SETUP
-#line 145 "lex.l"
+#line 129 "lex.l"
 {/* ignore spaces */}
 	YY_BREAK
 case 72:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 146 "lex.l"
+#line 130 "lex.l"
 {/* ignore comments */}
 	YY_BREAK
 case 73:
 /* rule 73 can match eol */
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 147 "lex.l"
+#line 131 "lex.l"
 {/* before either EOL */}
 	YY_BREAK
 case 74:
 YY_RULE_SETUP
-#line 148 "lex.l"
-{yylval.number=strtoul(yytext,NULL,8);return(TOK_NUMBER);}
+#line 132 "lex.l"
+{yylval->number=strtoul(yytext,NULL,8);return(TOK_NUMBER);}
 	YY_BREAK
 case 75:
 YY_RULE_SETUP
-#line 149 "lex.l"
-{yylval.number=strtoul(yytext+1,NULL,10);return(TOK_NUMBER);}
+#line 133 "lex.l"
+{yylval->number=strtoul(yytext+1,NULL,10);return(TOK_NUMBER);}
 	YY_BREAK
 case 76:
 YY_RULE_SETUP
-#line 150 "lex.l"
-{yylval.number=strtoul(yytext+1,NULL,16);return(TOK_NUMBER);}
+#line 134 "lex.l"
+{yylval->number=strtoul(yytext+1,NULL,16);return(TOK_NUMBER);}
 	YY_BREAK
 case 77:
 YY_RULE_SETUP
-#line 151 "lex.l"
+#line 135 "lex.l"
 {/* ignore comma separator */}
 	YY_BREAK
 
 
 case 78:
 YY_RULE_SETUP
-#line 155 "lex.l"
-{if (*yytext==qchar) 
-					{BEGIN(caller);return(TOK_QM);} 
+#line 139 "lex.l"
+{if (*yytext==yyextra->qchar) 
+					{BEGIN(yyextra->caller);return(TOK_QM);} 
 				else 
-					{yylval.number=*yytext;return(TOK_CHAR);}
+					{yylval->number=*yytext;return(TOK_CHAR);}
 				}
 	YY_BREAK
 
 
 case 79:
 YY_RULE_SETUP
-#line 163 "lex.l"
+#line 147 "lex.l"
 
 	YY_BREAK
 case 80:
 YY_RULE_SETUP
-#line 164 "lex.l"
-{BEGIN(caller);return(TOK_BRKT);} 
+#line 148 "lex.l"
+{BEGIN(yyextra->caller);return(TOK_BRKT);} 
 	YY_BREAK
 case 81:
 YY_RULE_SETUP
-#line 165 "lex.l"
-{yylval.number=*yytext;return(TOK_CHAR);}
+#line 149 "lex.l"
+{yylval->number=*yytext;return(TOK_CHAR);}
 	YY_BREAK
 
 
 case 82:
 YY_RULE_SETUP
-#line 169 "lex.l"
+#line 153 "lex.l"
 {/* ignore */}
 	YY_BREAK
 case 83:
 YY_RULE_SETUP
-#line 170 "lex.l"
+#line 154 "lex.l"
 { return(TOK_COMMA);}
 	YY_BREAK
 case 84:
 YY_RULE_SETUP
-#line 171 "lex.l"
+#line 155 "lex.l"
 { return(TOK_BRKT);}
 	YY_BREAK
 case 85:
 YY_RULE_SETUP
-#line 172 "lex.l"
-{BEGIN(caller);return(TOK_BRKT);}
+#line 156 "lex.l"
+{BEGIN(yyextra->caller);return(TOK_BRKT);}
 	YY_BREAK
 case 86:
 YY_RULE_SETUP
-#line 173 "lex.l"
-{yylval.number=*yytext;return(TOK_CHAR);}
+#line 157 "lex.l"
+{yylval->number=*yytext;return(TOK_CHAR);}
 	YY_BREAK
 
 
 case 87:
 YY_RULE_SETUP
-#line 177 "lex.l"
-{yylval.number=*yytext;return(TOK_CHAR);}
+#line 161 "lex.l"
+{yylval->number=*yytext;return(TOK_CHAR);}
 	YY_BREAK
 case 88:
 YY_RULE_SETUP
-#line 178 "lex.l"
-{BEGIN(caller);}
+#line 162 "lex.l"
+{BEGIN(yyextra->caller);}
 	YY_BREAK
 
 
 case 89:
 YY_RULE_SETUP
-#line 182 "lex.l"
+#line 166 "lex.l"
 {/* ignore */}
 	YY_BREAK
 case 90:
 YY_RULE_SETUP
-#line 183 "lex.l"
-{yylval.number=KS_LSHIFT;return(TOK_SHIFT);}
+#line 167 "lex.l"
+{yylval->number=KS_LSHIFT;return(TOK_SHIFT);}
 	YY_BREAK
 case 91:
 YY_RULE_SETUP
-#line 184 "lex.l"
-{yylval.number=KS_CAPS;return(TOK_SHIFT);}
+#line 168 "lex.l"
+{yylval->number=KS_CAPS;return(TOK_SHIFT);}
 	YY_BREAK
 case 92:
 YY_RULE_SETUP
-#line 185 "lex.l"
-{yylval.number=KS_LCTRL;return(TOK_SHIFT);}
+#line 169 "lex.l"
+{yylval->number=KS_LCTRL;return(TOK_SHIFT);}
 	YY_BREAK
 case 93:
 YY_RULE_SETUP
-#line 186 "lex.l"
-{yylval.number=KS_LALT;return(TOK_SHIFT);}
+#line 170 "lex.l"
+{yylval->number=KS_LALT;return(TOK_SHIFT);}
 	YY_BREAK
 case 94:
 YY_RULE_SETUP
-#line 187 "lex.l"
-{yylval.number=KS_RSHIFT;return(TOK_SHIFT);}
+#line 171 "lex.l"
+{yylval->number=KS_RSHIFT;return(TOK_SHIFT);}
 	YY_BREAK
 case 95:
 YY_RULE_SETUP
-#line 188 "lex.l"
-{yylval.number=KS_NCAPS;return(TOK_SHIFT);}
+#line 172 "lex.l"
+{yylval->number=KS_NCAPS;return(TOK_SHIFT);}
 	YY_BREAK
 case 96:
 YY_RULE_SETUP
-#line 189 "lex.l"
-{yylval.number=KS_RCTRL;return(TOK_SHIFT);}
+#line 173 "lex.l"
+{yylval->number=KS_RCTRL;return(TOK_SHIFT);}
 	YY_BREAK
 case 97:
 YY_RULE_SETUP
-#line 190 "lex.l"
-{yylval.number=KS_RALT;return(TOK_SHIFT);}
+#line 174 "lex.l"
+{yylval->number=KS_RALT;return(TOK_SHIFT);}
 	YY_BREAK
 case 98:
 YY_RULE_SETUP
-#line 191 "lex.l"
-{yylval.number=KS_SHIFT;return(TOK_SHIFT);}
+#line 175 "lex.l"
+{yylval->number=KS_SHIFT;return(TOK_SHIFT);}
 	YY_BREAK
 case 99:
 YY_RULE_SETUP
-#line 192 "lex.l"
-{yylval.number=KS_CTRL;return(TOK_SHIFT);}
+#line 176 "lex.l"
+{yylval->number=KS_CTRL;return(TOK_SHIFT);}
 	YY_BREAK
 case 100:
 YY_RULE_SETUP
-#line 193 "lex.l"
-{yylval.number=KS_ALT;return(TOK_SHIFT);}
+#line 177 "lex.l"
+{yylval->number=KS_ALT;return(TOK_SHIFT);}
 	YY_BREAK
 case 101:
 YY_RULE_SETUP
-#line 195 "lex.l"
-{yylval.number=0x20;return(TOK_RAWKEY);}
+#line 179 "lex.l"
+{yylval->number=0x20;return(TOK_RAWKEY);}
 	YY_BREAK
 case 102:
 YY_RULE_SETUP
-#line 196 "lex.l"
-{yylval.number=0x27;return(TOK_RAWKEY);}
+#line 180 "lex.l"
+{yylval->number=0x27;return(TOK_RAWKEY);}
 	YY_BREAK
 case 103:
 YY_RULE_SETUP
-#line 197 "lex.l"
-{yylval.number=0x30;return(TOK_RAWKEY);}
+#line 181 "lex.l"
+{yylval->number=0x30;return(TOK_RAWKEY);}
 	YY_BREAK
 case 104:
 YY_RULE_SETUP
-#line 198 "lex.l"
-{yylval.number=0x31;return(TOK_RAWKEY);}
+#line 182 "lex.l"
+{yylval->number=0x31;return(TOK_RAWKEY);}
 	YY_BREAK
 case 105:
 YY_RULE_SETUP
-#line 199 "lex.l"
-{yylval.number=0x32;return(TOK_RAWKEY);}
+#line 183 "lex.l"
+{yylval->number=0x32;return(TOK_RAWKEY);}
 	YY_BREAK
 case 106:
 YY_RULE_SETUP
-#line 200 "lex.l"
-{yylval.number=0x33;return(TOK_RAWKEY);}
+#line 184 "lex.l"
+{yylval->number=0x33;return(TOK_RAWKEY);}
 	YY_BREAK
 case 107:
 YY_RULE_SETUP
-#line 201 "lex.l"
-{yylval.number=0x34;return(TOK_RAWKEY);}
+#line 185 "lex.l"
+{yylval->number=0x34;return(TOK_RAWKEY);}
 	YY_BREAK
 case 108:
 YY_RULE_SETUP
-#line 202 "lex.l"
-{yylval.number=0x35;return(TOK_RAWKEY);}
+#line 186 "lex.l"
+{yylval->number=0x35;return(TOK_RAWKEY);}
 	YY_BREAK
 case 109:
 YY_RULE_SETUP
-#line 203 "lex.l"
-{yylval.number=0x36;return(TOK_RAWKEY);}
+#line 187 "lex.l"
+{yylval->number=0x36;return(TOK_RAWKEY);}
 	YY_BREAK
 case 110:
 YY_RULE_SETUP
-#line 204 "lex.l"
-{yylval.number=0x37;return(TOK_RAWKEY);}
+#line 188 "lex.l"
+{yylval->number=0x37;return(TOK_RAWKEY);}
 	YY_BREAK
 case 111:
 YY_RULE_SETUP
-#line 205 "lex.l"
-{yylval.number=0x38;return(TOK_RAWKEY);}
+#line 189 "lex.l"
+{yylval->number=0x38;return(TOK_RAWKEY);}
 	YY_BREAK
 case 112:
 YY_RULE_SETUP
-#line 206 "lex.l"
-{yylval.number=0x39;return(TOK_RAWKEY);}
+#line 190 "lex.l"
+{yylval->number=0x39;return(TOK_RAWKEY);}
 	YY_BREAK
 case 113:
 YY_RULE_SETUP
-#line 207 "lex.l"
-{yylval.number=0x41;return(TOK_RAWKEY);}
+#line 191 "lex.l"
+{yylval->number=0x41;return(TOK_RAWKEY);}
 	YY_BREAK
 case 114:
 YY_RULE_SETUP
-#line 208 "lex.l"
-{yylval.number=0x42;return(TOK_RAWKEY);}
+#line 192 "lex.l"
+{yylval->number=0x42;return(TOK_RAWKEY);}
 	YY_BREAK
 case 115:
 YY_RULE_SETUP
-#line 209 "lex.l"
-{yylval.number=0x43;return(TOK_RAWKEY);}
+#line 193 "lex.l"
+{yylval->number=0x43;return(TOK_RAWKEY);}
 	YY_BREAK
 case 116:
 YY_RULE_SETUP
-#line 210 "lex.l"
-{yylval.number=0x44;return(TOK_RAWKEY);}
+#line 194 "lex.l"
+{yylval->number=0x44;return(TOK_RAWKEY);}
 	YY_BREAK
 case 117:
 YY_RULE_SETUP
-#line 211 "lex.l"
-{yylval.number=0x45;return(TOK_RAWKEY);}
+#line 195 "lex.l"
+{yylval->number=0x45;return(TOK_RAWKEY);}
 	YY_BREAK
 case 118:
 YY_RULE_SETUP
-#line 212 "lex.l"
-{yylval.number=0x46;return(TOK_RAWKEY);}
+#line 196 "lex.l"
+{yylval->number=0x46;return(TOK_RAWKEY);}
 	YY_BREAK
 case 119:
 YY_RULE_SETUP
-#line 213 "lex.l"
-{yylval.number=0x47;return(TOK_RAWKEY);}
+#line 197 "lex.l"
+{yylval->number=0x47;return(TOK_RAWKEY);}
 	YY_BREAK
 case 120:
 YY_RULE_SETUP
-#line 214 "lex.l"
-{yylval.number=0x48;return(TOK_RAWKEY);}
+#line 198 "lex.l"
+{yylval->number=0x48;return(TOK_RAWKEY);}
 	YY_BREAK
 case 121:
 YY_RULE_SETUP
-#line 215 "lex.l"
-{yylval.number=0x49;return(TOK_RAWKEY);}
+#line 199 "lex.l"
+{yylval->number=0x49;return(TOK_RAWKEY);}
 	YY_BREAK
 case 122:
 YY_RULE_SETUP
-#line 216 "lex.l"
-{yylval.number=0x4a;return(TOK_RAWKEY);}
+#line 200 "lex.l"
+{yylval->number=0x4a;return(TOK_RAWKEY);}
 	YY_BREAK
 case 123:
 YY_RULE_SETUP
-#line 217 "lex.l"
-{yylval.number=0x4b;return(TOK_RAWKEY);}
+#line 201 "lex.l"
+{yylval->number=0x4b;return(TOK_RAWKEY);}
 	YY_BREAK
 case 124:
 YY_RULE_SETUP
-#line 218 "lex.l"
-{yylval.number=0x4c;return(TOK_RAWKEY);}
+#line 202 "lex.l"
+{yylval->number=0x4c;return(TOK_RAWKEY);}
 	YY_BREAK
 case 125:
 YY_RULE_SETUP
-#line 219 "lex.l"
-{yylval.number=0x4d;return(TOK_RAWKEY);}
+#line 203 "lex.l"
+{yylval->number=0x4d;return(TOK_RAWKEY);}
 	YY_BREAK
 case 126:
 YY_RULE_SETUP
-#line 220 "lex.l"
-{yylval.number=0x4e;return(TOK_RAWKEY);}
+#line 204 "lex.l"
+{yylval->number=0x4e;return(TOK_RAWKEY);}
 	YY_BREAK
 case 127:
 YY_RULE_SETUP
-#line 221 "lex.l"
-{yylval.number=0x4f;return(TOK_RAWKEY);}
+#line 205 "lex.l"
+{yylval->number=0x4f;return(TOK_RAWKEY);}
 	YY_BREAK
 case 128:
 YY_RULE_SETUP
-#line 222 "lex.l"
-{yylval.number=0x50;return(TOK_RAWKEY);}
+#line 206 "lex.l"
+{yylval->number=0x50;return(TOK_RAWKEY);}
 	YY_BREAK
 case 129:
 YY_RULE_SETUP
-#line 223 "lex.l"
-{yylval.number=0x51;return(TOK_RAWKEY);}
+#line 207 "lex.l"
+{yylval->number=0x51;return(TOK_RAWKEY);}
 	YY_BREAK
 case 130:
 YY_RULE_SETUP
-#line 224 "lex.l"
-{yylval.number=0x52;return(TOK_RAWKEY);}
+#line 208 "lex.l"
+{yylval->number=0x52;return(TOK_RAWKEY);}
 	YY_BREAK
 case 131:
 YY_RULE_SETUP
-#line 225 "lex.l"
-{yylval.number=0x53;return(TOK_RAWKEY);}
+#line 209 "lex.l"
+{yylval->number=0x53;return(TOK_RAWKEY);}
 	YY_BREAK
 case 132:
 YY_RULE_SETUP
-#line 226 "lex.l"
-{yylval.number=0x54;return(TOK_RAWKEY);}
+#line 210 "lex.l"
+{yylval->number=0x54;return(TOK_RAWKEY);}
 	YY_BREAK
 case 133:
 YY_RULE_SETUP
-#line 227 "lex.l"
-{yylval.number=0x55;return(TOK_RAWKEY);}
+#line 211 "lex.l"
+{yylval->number=0x55;return(TOK_RAWKEY);}
 	YY_BREAK
 case 134:
 YY_RULE_SETUP
-#line 228 "lex.l"
-{yylval.number=0x56;return(TOK_RAWKEY);}
+#line 212 "lex.l"
+{yylval->number=0x56;return(TOK_RAWKEY);}
 	YY_BREAK
 case 135:
 YY_RULE_SETUP
-#line 229 "lex.l"
-{yylval.number=0x57;return(TOK_RAWKEY);}
+#line 213 "lex.l"
+{yylval->number=0x57;return(TOK_RAWKEY);}
 	YY_BREAK
 case 136:
 YY_RULE_SETUP
-#line 230 "lex.l"
-{yylval.number=0x58;return(TOK_RAWKEY);}
+#line 214 "lex.l"
+{yylval->number=0x58;return(TOK_RAWKEY);}
 	YY_BREAK
 case 137:
 YY_RULE_SETUP
-#line 231 "lex.l"
-{yylval.number=0x59;return(TOK_RAWKEY);}
+#line 215 "lex.l"
+{yylval->number=0x59;return(TOK_RAWKEY);}
 	YY_BREAK
 case 138:
 YY_RULE_SETUP
-#line 232 "lex.l"
-{yylval.number=0x5a;return(TOK_RAWKEY);}
+#line 216 "lex.l"
+{yylval->number=0x5a;return(TOK_RAWKEY);}
 	YY_BREAK
 case 139:
 YY_RULE_SETUP
-#line 233 "lex.l"
-{yylval.number=0x60;return(TOK_RAWKEY);}
+#line 217 "lex.l"
+{yylval->number=0x60;return(TOK_RAWKEY);}
 	YY_BREAK
 case 140:
 YY_RULE_SETUP
-#line 234 "lex.l"
-{yylval.number=0x2c;return(TOK_RAWKEY);}
+#line 218 "lex.l"
+{yylval->number=0x2c;return(TOK_RAWKEY);}
 	YY_BREAK
 case 141:
 YY_RULE_SETUP
-#line 235 "lex.l"
-{yylval.number=0x2d;return(TOK_RAWKEY);}
+#line 219 "lex.l"
+{yylval->number=0x2d;return(TOK_RAWKEY);}
 	YY_BREAK
 case 142:
 YY_RULE_SETUP
-#line 236 "lex.l"
-{yylval.number=0x2e;return(TOK_RAWKEY);}
+#line 220 "lex.l"
+{yylval->number=0x2e;return(TOK_RAWKEY);}
 	YY_BREAK
 case 143:
 YY_RULE_SETUP
-#line 237 "lex.l"
-{yylval.number=0x2f;return(TOK_RAWKEY);}
+#line 221 "lex.l"
+{yylval->number=0x2f;return(TOK_RAWKEY);}
 	YY_BREAK
 case 144:
 YY_RULE_SETUP
-#line 238 "lex.l"
-{yylval.number=0x3a;return(TOK_RAWKEY);}
+#line 222 "lex.l"
+{yylval->number=0x3a;return(TOK_RAWKEY);}
 	YY_BREAK
 case 145:
 YY_RULE_SETUP
-#line 239 "lex.l"
-{yylval.number=0x3d;return(TOK_RAWKEY);}
+#line 223 "lex.l"
+{yylval->number=0x3d;return(TOK_RAWKEY);}
 	YY_BREAK
 case 146:
 YY_RULE_SETUP
-#line 240 "lex.l"
-{yylval.number=0x5b;return(TOK_RAWKEY);}
+#line 224 "lex.l"
+{yylval->number=0x5b;return(TOK_RAWKEY);}
 	YY_BREAK
 case 147:
 YY_RULE_SETUP
-#line 241 "lex.l"
-{yylval.number=0x5c;return(TOK_RAWKEY);}
+#line 225 "lex.l"
+{yylval->number=0x5c;return(TOK_RAWKEY);}
 	YY_BREAK
 case 148:
 YY_RULE_SETUP
-#line 242 "lex.l"
-{yylval.number=0x5d;return(TOK_RAWKEY);}
+#line 226 "lex.l"
+{yylval->number=0x5d;return(TOK_RAWKEY);}
 	YY_BREAK
 case 149:
 YY_RULE_SETUP
-#line 243 "lex.l"
-{yylval.number=0xff08;return(TOK_RAWKEY);}
+#line 227 "lex.l"
+{yylval->number=0xff08;return(TOK_RAWKEY);}
 	YY_BREAK
 case 150:
 YY_RULE_SETUP
-#line 244 "lex.l"
-{yylval.number=0xff09;return(TOK_RAWKEY);}
+#line 228 "lex.l"
+{yylval->number=0xff09;return(TOK_RAWKEY);}
 	YY_BREAK
 case 151:
 YY_RULE_SETUP
-#line 245 "lex.l"
-{yylval.number=0xff0d;return(TOK_RAWKEY);}
+#line 229 "lex.l"
+{yylval->number=0xff0d;return(TOK_RAWKEY);}
 	YY_BREAK
 case 152:
 YY_RULE_SETUP
-#line 246 "lex.l"
-{yylval.number=0xff13;return(TOK_RAWKEY);}
+#line 230 "lex.l"
+{yylval->number=0xff13;return(TOK_RAWKEY);}
 	YY_BREAK
 case 153:
 YY_RULE_SETUP
-#line 247 "lex.l"
-{yylval.number=0xff14;return(TOK_RAWKEY);}
+#line 231 "lex.l"
+{yylval->number=0xff14;return(TOK_RAWKEY);}
 	YY_BREAK
 case 154:
 YY_RULE_SETUP
-#line 248 "lex.l"
-{yylval.number=0xff1b;return(TOK_RAWKEY);}
+#line 232 "lex.l"
+{yylval->number=0xff1b;return(TOK_RAWKEY);}
 	YY_BREAK
 case 155:
 YY_RULE_SETUP
-#line 249 "lex.l"
-{yylval.number=0xff50;return(TOK_RAWKEY);}
+#line 233 "lex.l"
+{yylval->number=0xff50;return(TOK_RAWKEY);}
 	YY_BREAK
 case 156:
 YY_RULE_SETUP
-#line 250 "lex.l"
-{yylval.number=0xff51;return(TOK_RAWKEY);}
+#line 234 "lex.l"
+{yylval->number=0xff51;return(TOK_RAWKEY);}
 	YY_BREAK
 case 157:
 YY_RULE_SETUP
-#line 251 "lex.l"
-{yylval.number=0xff52;return(TOK_RAWKEY);}
+#line 235 "lex.l"
+{yylval->number=0xff52;return(TOK_RAWKEY);}
 	YY_BREAK
 case 158:
 YY_RULE_SETUP
-#line 252 "lex.l"
-{yylval.number=0xff53;return(TOK_RAWKEY);}
+#line 236 "lex.l"
+{yylval->number=0xff53;return(TOK_RAWKEY);}
 	YY_BREAK
 case 159:
 YY_RULE_SETUP
-#line 253 "lex.l"
-{yylval.number=0xff54;return(TOK_RAWKEY);}
+#line 237 "lex.l"
+{yylval->number=0xff54;return(TOK_RAWKEY);}
 	YY_BREAK
 case 160:
 YY_RULE_SETUP
-#line 254 "lex.l"
-{yylval.number=0xff55;return(TOK_RAWKEY);}
+#line 238 "lex.l"
+{yylval->number=0xff55;return(TOK_RAWKEY);}
 	YY_BREAK
 case 161:
 YY_RULE_SETUP
-#line 255 "lex.l"
-{yylval.number=0xff56;return(TOK_RAWKEY);}
+#line 239 "lex.l"
+{yylval->number=0xff56;return(TOK_RAWKEY);}
 	YY_BREAK
 case 162:
 YY_RULE_SETUP
-#line 256 "lex.l"
-{yylval.number=0xff57;return(TOK_RAWKEY);}
+#line 240 "lex.l"
+{yylval->number=0xff57;return(TOK_RAWKEY);}
 	YY_BREAK
 case 163:
 YY_RULE_SETUP
-#line 257 "lex.l"
-{yylval.number=0xff63;return(TOK_RAWKEY);}
+#line 241 "lex.l"
+{yylval->number=0xff63;return(TOK_RAWKEY);}
 	YY_BREAK
 case 164:
 YY_RULE_SETUP
-#line 258 "lex.l"
-{yylval.number=0xff7f;return(TOK_RAWKEY);}
+#line 242 "lex.l"
+{yylval->number=0xff7f;return(TOK_RAWKEY);}
 	YY_BREAK
 case 165:
 YY_RULE_SETUP
-#line 259 "lex.l"
-{yylval.number=0xffaa;return(TOK_RAWKEY);}
+#line 243 "lex.l"
+{yylval->number=0xffaa;return(TOK_RAWKEY);}
 	YY_BREAK
 case 166:
 YY_RULE_SETUP
-#line 260 "lex.l"
-{yylval.number=0xffab;return(TOK_RAWKEY);}
+#line 244 "lex.l"
+{yylval->number=0xffab;return(TOK_RAWKEY);}
 	YY_BREAK
 case 167:
 YY_RULE_SETUP
-#line 261 "lex.l"
-{yylval.number=0xffad;return(TOK_RAWKEY);}
+#line 245 "lex.l"
+{yylval->number=0xffad;return(TOK_RAWKEY);}
 	YY_BREAK
 case 168:
 YY_RULE_SETUP
-#line 262 "lex.l"
-{yylval.number=0xffae;return(TOK_RAWKEY);}
+#line 246 "lex.l"
+{yylval->number=0xffae;return(TOK_RAWKEY);}
 	YY_BREAK
 case 169:
 YY_RULE_SETUP
-#line 263 "lex.l"
-{yylval.number=0xffaf;return(TOK_RAWKEY);}
+#line 247 "lex.l"
+{yylval->number=0xffaf;return(TOK_RAWKEY);}
 	YY_BREAK
 case 170:
 YY_RULE_SETUP
-#line 264 "lex.l"
-{yylval.number=0xffb0;return(TOK_RAWKEY);}
+#line 248 "lex.l"
+{yylval->number=0xffb0;return(TOK_RAWKEY);}
 	YY_BREAK
 case 171:
 YY_RULE_SETUP
-#line 265 "lex.l"
-{yylval.number=0xffb1;return(TOK_RAWKEY);}
+#line 249 "lex.l"
+{yylval->number=0xffb1;return(TOK_RAWKEY);}
 	YY_BREAK
 case 172:
 YY_RULE_SETUP
-#line 266 "lex.l"
-{yylval.number=0xffb2;return(TOK_RAWKEY);}
+#line 250 "lex.l"
+{yylval->number=0xffb2;return(TOK_RAWKEY);}
 	YY_BREAK
 case 173:
 YY_RULE_SETUP
-#line 267 "lex.l"
-{yylval.number=0xffb3;return(TOK_RAWKEY);}
+#line 251 "lex.l"
+{yylval->number=0xffb3;return(TOK_RAWKEY);}
 	YY_BREAK
 case 174:
 YY_RULE_SETUP
-#line 268 "lex.l"
-{yylval.number=0xffb4;return(TOK_RAWKEY);}
+#line 252 "lex.l"
+{yylval->number=0xffb4;return(TOK_RAWKEY);}
 	YY_BREAK
 case 175:
 YY_RULE_SETUP
-#line 269 "lex.l"
-{yylval.number=0xffb5;return(TOK_RAWKEY);}
+#line 253 "lex.l"
+{yylval->number=0xffb5;return(TOK_RAWKEY);}
 	YY_BREAK
 case 176:
 YY_RULE_SETUP
-#line 270 "lex.l"
-{yylval.number=0xffb6;return(TOK_RAWKEY);}
+#line 254 "lex.l"
+{yylval->number=0xffb6;return(TOK_RAWKEY);}
 	YY_BREAK
 case 177:
 YY_RULE_SETUP
-#line 271 "lex.l"
-{yylval.number=0xffb7;return(TOK_RAWKEY);}
+#line 255 "lex.l"
+{yylval->number=0xffb7;return(TOK_RAWKEY);}
 	YY_BREAK
 case 178:
 YY_RULE_SETUP
-#line 272 "lex.l"
-{yylval.number=0xffb8;return(TOK_RAWKEY);}
+#line 256 "lex.l"
+{yylval->number=0xffb8;return(TOK_RAWKEY);}
 	YY_BREAK
 case 179:
 YY_RULE_SETUP
-#line 273 "lex.l"
-{yylval.number=0xffb9;return(TOK_RAWKEY);}
+#line 257 "lex.l"
+{yylval->number=0xffb9;return(TOK_RAWKEY);}
 	YY_BREAK
 case 180:
 YY_RULE_SETUP
-#line 274 "lex.l"
-{yylval.number=0xffbe;return(TOK_RAWKEY);}
+#line 258 "lex.l"
+{yylval->number=0xffbe;return(TOK_RAWKEY);}
 	YY_BREAK
 case 181:
 YY_RULE_SETUP
-#line 275 "lex.l"
-{yylval.number=0xffbf;return(TOK_RAWKEY);}
+#line 259 "lex.l"
+{yylval->number=0xffbf;return(TOK_RAWKEY);}
 	YY_BREAK
 case 182:
 YY_RULE_SETUP
-#line 276 "lex.l"
-{yylval.number=0xffc0;return(TOK_RAWKEY);}
+#line 260 "lex.l"
+{yylval->number=0xffc0;return(TOK_RAWKEY);}
 	YY_BREAK
 case 183:
 YY_RULE_SETUP
-#line 277 "lex.l"
-{yylval.number=0xffc1;return(TOK_RAWKEY);}
+#line 261 "lex.l"
+{yylval->number=0xffc1;return(TOK_RAWKEY);}
 	YY_BREAK
 case 184:
 YY_RULE_SETUP
-#line 278 "lex.l"
-{yylval.number=0xffc2;return(TOK_RAWKEY);}
+#line 262 "lex.l"
+{yylval->number=0xffc2;return(TOK_RAWKEY);}
 	YY_BREAK
 case 185:
 YY_RULE_SETUP
-#line 279 "lex.l"
-{yylval.number=0xffc3;return(TOK_RAWKEY);}
+#line 263 "lex.l"
+{yylval->number=0xffc3;return(TOK_RAWKEY);}
 	YY_BREAK
 case 186:
 YY_RULE_SETUP
-#line 280 "lex.l"
-{yylval.number=0xffc4;return(TOK_RAWKEY);}
+#line 264 "lex.l"
+{yylval->number=0xffc4;return(TOK_RAWKEY);}
 	YY_BREAK
 case 187:
 YY_RULE_SETUP
-#line 281 "lex.l"
-{yylval.number=0xffc5;return(TOK_RAWKEY);}
+#line 265 "lex.l"
+{yylval->number=0xffc5;return(TOK_RAWKEY);}
 	YY_BREAK
 case 188:
 YY_RULE_SETUP
-#line 282 "lex.l"
-{yylval.number=0xffc6;return(TOK_RAWKEY);}
+#line 266 "lex.l"
+{yylval->number=0xffc6;return(TOK_RAWKEY);}
 	YY_BREAK
 case 189:
 YY_RULE_SETUP
-#line 283 "lex.l"
-{yylval.number=0xffc7;return(TOK_RAWKEY);}
+#line 267 "lex.l"
+{yylval->number=0xffc7;return(TOK_RAWKEY);}
 	YY_BREAK
 case 190:
 YY_RULE_SETUP
-#line 284 "lex.l"
-{yylval.number=0xffc8;return(TOK_RAWKEY);}
+#line 268 "lex.l"
+{yylval->number=0xffc8;return(TOK_RAWKEY);}
 	YY_BREAK
 case 191:
 YY_RULE_SETUP
-#line 285 "lex.l"
-{yylval.number=0xffc9;return(TOK_RAWKEY);}
+#line 269 "lex.l"
+{yylval->number=0xffc9;return(TOK_RAWKEY);}
 	YY_BREAK
 case 192:
 YY_RULE_SETUP
-#line 286 "lex.l"
-{yylval.number=0xffca;return(TOK_RAWKEY);}
+#line 270 "lex.l"
+{yylval->number=0xffca;return(TOK_RAWKEY);}
 	YY_BREAK
 case 193:
 YY_RULE_SETUP
-#line 287 "lex.l"
-{yylval.number=0xffcb;return(TOK_RAWKEY);}
+#line 271 "lex.l"
+{yylval->number=0xffcb;return(TOK_RAWKEY);}
 	YY_BREAK
 case 194:
 YY_RULE_SETUP
-#line 288 "lex.l"
-{yylval.number=0xffcc;return(TOK_RAWKEY);}
+#line 272 "lex.l"
+{yylval->number=0xffcc;return(TOK_RAWKEY);}
 	YY_BREAK
 case 195:
 YY_RULE_SETUP
-#line 289 "lex.l"
-{yylval.number=0xffcd;return(TOK_RAWKEY);}
+#line 273 "lex.l"
+{yylval->number=0xffcd;return(TOK_RAWKEY);}
 	YY_BREAK
 case 196:
 YY_RULE_SETUP
-#line 290 "lex.l"
-{yylval.number=0xffce;return(TOK_RAWKEY);}
+#line 274 "lex.l"
+{yylval->number=0xffce;return(TOK_RAWKEY);}
 	YY_BREAK
 case 197:
 YY_RULE_SETUP
-#line 291 "lex.l"
-{yylval.number=0xffcf;return(TOK_RAWKEY);}
+#line 275 "lex.l"
+{yylval->number=0xffcf;return(TOK_RAWKEY);}
 	YY_BREAK
 case 198:
 YY_RULE_SETUP
-#line 292 "lex.l"
-{yylval.number=0xffd0;return(TOK_RAWKEY);}
+#line 276 "lex.l"
+{yylval->number=0xffd0;return(TOK_RAWKEY);}
 	YY_BREAK
 case 199:
 YY_RULE_SETUP
-#line 293 "lex.l"
-{yylval.number=0xffd1;return(TOK_RAWKEY);}
+#line 277 "lex.l"
+{yylval->number=0xffd1;return(TOK_RAWKEY);}
 	YY_BREAK
 case 200:
 YY_RULE_SETUP
-#line 294 "lex.l"
-{yylval.number=0xffd2;return(TOK_RAWKEY);}
+#line 278 "lex.l"
+{yylval->number=0xffd2;return(TOK_RAWKEY);}
 	YY_BREAK
 case 201:
 YY_RULE_SETUP
-#line 295 "lex.l"
-{yylval.number=0xffd3;return(TOK_RAWKEY);}
+#line 279 "lex.l"
+{yylval->number=0xffd3;return(TOK_RAWKEY);}
 	YY_BREAK
 case 202:
 YY_RULE_SETUP
-#line 296 "lex.l"
-{yylval.number=0xffd4;return(TOK_RAWKEY);}
+#line 280 "lex.l"
+{yylval->number=0xffd4;return(TOK_RAWKEY);}
 	YY_BREAK
 case 203:
 YY_RULE_SETUP
-#line 297 "lex.l"
-{yylval.number=0xffd5;return(TOK_RAWKEY);}
+#line 281 "lex.l"
+{yylval->number=0xffd5;return(TOK_RAWKEY);}
 	YY_BREAK
 case 204:
 YY_RULE_SETUP
-#line 298 "lex.l"
-{yylval.number=0xffe1;return(TOK_RAWKEY);}
+#line 282 "lex.l"
+{yylval->number=0xffe1;return(TOK_RAWKEY);}
 	YY_BREAK
 case 205:
 YY_RULE_SETUP
-#line 299 "lex.l"
-{yylval.number=0xffe3;return(TOK_RAWKEY);}
+#line 283 "lex.l"
+{yylval->number=0xffe3;return(TOK_RAWKEY);}
 	YY_BREAK
 case 206:
 YY_RULE_SETUP
-#line 300 "lex.l"
-{yylval.number=0xffe5;return(TOK_RAWKEY);}
+#line 284 "lex.l"
+{yylval->number=0xffe5;return(TOK_RAWKEY);}
 	YY_BREAK
 case 207:
 YY_RULE_SETUP
-#line 301 "lex.l"
-{yylval.number=0xffe9;return(TOK_RAWKEY);}
+#line 285 "lex.l"
+{yylval->number=0xffe9;return(TOK_RAWKEY);}
 	YY_BREAK
 case 208:
 YY_RULE_SETUP
-#line 302 "lex.l"
-{yylval.number=0xffff;return(TOK_RAWKEY);}
+#line 286 "lex.l"
+{yylval->number=0xffff;return(TOK_RAWKEY);}
 	YY_BREAK
 case 209:
 YY_RULE_SETUP
-#line 303 "lex.l"
-{yylval.number=0x3c;return(TOK_RAWKEY); /* on German kbds only!*/}
+#line 287 "lex.l"
+{yylval->number=0x3c;return(TOK_RAWKEY); /* on German kbds only!*/}
 	YY_BREAK
 case 210:
 YY_RULE_SETUP
-#line 305 "lex.l"
-{yylval.number=text_to_keysym(yytext); if (yylval.number == -1) yyerror("unrecognised raw key"); else return(TOK_XKEYSYM);}
+#line 289 "lex.l"
+{yylval->number=text_to_keysym(yytext); if (yylval->number == -1) yyerror(yyscanner, "unrecognised raw key"); else return(TOK_XKEYSYM);}
 	YY_BREAK
 case 211:
 YY_RULE_SETUP
-#line 306 "lex.l"
-{ yyerror("unrecognised raw key");} 
+#line 290 "lex.l"
+{ yyerror(yyscanner, "unrecognised raw key");} 
 	YY_BREAK
 case 212:
 YY_RULE_SETUP
-#line 307 "lex.l"
-{caller0=caller;caller=KEYNAME;qchar='\'';BEGIN(QUOTE);return(TOK_QM);}
+#line 291 "lex.l"
+{yyextra->caller0=yyextra->caller;yyextra->caller=KEYNAME;yyextra->qchar='\'';BEGIN(QUOTE);return(TOK_QM);}
 	YY_BREAK
 case 213:
 YY_RULE_SETUP
-#line 308 "lex.l"
-{caller0=caller;caller=KEYNAME;qchar='\"';BEGIN(QUOTE);return(TOK_QM);}
+#line 292 "lex.l"
+{yyextra->caller0=yyextra->caller;yyextra->caller=KEYNAME;yyextra->qchar='\"';BEGIN(QUOTE);return(TOK_QM);}
 	YY_BREAK
 case 214:
 YY_RULE_SETUP
-#line 310 "lex.l"
+#line 294 "lex.l"
 {
-					if(caller==KEYNAME) caller=caller0;
-					BEGIN(caller);return(TOK_SB);
+					if(yyextra->caller==KEYNAME) yyextra->caller=yyextra->caller0;
+					BEGIN(yyextra->caller);return(TOK_SB);
 				} 
 	YY_BREAK
 
 case 215:
 /* rule 215 can match eol */
 YY_RULE_SETUP
-#line 316 "lex.l"
-{lineno++;	/* Join lines */}
+#line 300 "lex.l"
+{yyextra->lineno++;	/* Join lines */}
 	YY_BREAK
 case 216:
 /* rule 216 can match eol */
 YY_RULE_SETUP
-#line 317 "lex.l"
-{lineno++;	/* Join lines */}
+#line 301 "lex.l"
+{yyextra->lineno++;	/* Join lines */}
 	YY_BREAK
 case 217:
 /* rule 217 can match eol */
 YY_RULE_SETUP
-#line 318 "lex.l"
-{lineno++;	/* Join lines */}
+#line 302 "lex.l"
+{yyextra->lineno++;	/* Join lines */}
 	YY_BREAK
 case 218:
 /* rule 218 can match eol */
 YY_RULE_SETUP
-#line 319 "lex.l"
-{lineno++;	/* Join lines */}
+#line 303 "lex.l"
+{yyextra->lineno++;	/* Join lines */}
 	YY_BREAK
 case 219:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp = yy_bp + 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 321 "lex.l"
+#line 305 "lex.l"
 {/* ignore, use both /\r and /\n, not to work $ */}
 	YY_BREAK
 case 220:
 /* rule 220 can match eol */
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp = yy_bp + 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp = yy_bp + 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 322 "lex.l"
+#line 306 "lex.l"
 {/*   with either CR or CR/LF line ending */}
 	YY_BREAK
 case 221:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 323 "lex.l"
+#line 307 "lex.l"
 {/* ignore */}
 	YY_BREAK
 case 222:
 /* rule 222 can match eol */
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 324 "lex.l"
+#line 308 "lex.l"
 {/* ignore */}
 	YY_BREAK
 case 223:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 325 "lex.l"
+#line 309 "lex.l"
 {/* ignore */}
 	YY_BREAK
 case 224:
 /* rule 224 can match eol */
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 326 "lex.l"
+#line 310 "lex.l"
 {/* ignore */}
 	YY_BREAK
 case 225:
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 327 "lex.l"
+#line 311 "lex.l"
 {/* ignore even though it has \\ */}
 	YY_BREAK
 case 226:
 /* rule 226 can match eol */
-*yy_cp = (yy_hold_char); /* undo effects of setting up yytext */
-(yy_c_buf_p) = yy_cp -= 1;
+*yy_cp = yyg->yy_hold_char; /* undo effects of setting up yytext */
+yyg->yy_c_buf_p = yy_cp -= 1;
 YY_DO_BEFORE_ACTION; /* set up yytext again */
 YY_RULE_SETUP
-#line 328 "lex.l"
+#line 312 "lex.l"
 {/* ignore even though it has \\ */}
 	YY_BREAK
 case 227:
 YY_RULE_SETUP
-#line 330 "lex.l"
+#line 314 "lex.l"
 {BEGIN(SKIP);}
 	YY_BREAK
 case 228:
 YY_RULE_SETUP
-#line 332 "lex.l"
+#line 316 "lex.l"
 {/* Keyman platform conditional - just drop marker */}
 	YY_BREAK
 case 229:
 YY_RULE_SETUP
-#line 333 "lex.l"
+#line 317 "lex.l"
 {/* Kmfl platform conditional - just drop marker */}
 	YY_BREAK
 case 230:
 YY_RULE_SETUP
-#line 334 "lex.l"
+#line 318 "lex.l"
 {BEGIN(SKIP);} /* Platform Conditional */
 	YY_BREAK
 
 case 231:
 YY_RULE_SETUP
-#line 337 "lex.l"
+#line 321 "lex.l"
 {/* ignore everything until nl or EOF */}
 	YY_BREAK
 
 case 232:
 YY_RULE_SETUP
-#line 340 "lex.l"
-{fprintf(stderr,"Line %d: Unmatched closing parenthesis\n",lineno);return(TOK_BRKT);}
+#line 324 "lex.l"
+{fprintf(stderr,"Line %d: Unmatched closing parenthesis\n",yyextra->lineno);return(TOK_BRKT);}
 	YY_BREAK
 case 233:
 YY_RULE_SETUP
-#line 341 "lex.l"
-{yylval.number=yytext[0];fprintf(stderr,"Line %d: Unrecognized keyword '%s'\n", 
-					(int)lineno, yytext);errcount++;return(TOK_ERROR);}
+#line 325 "lex.l"
+{yylval->number=yytext[0];fprintf(stderr,"Line %d: Unrecognized keyword '%s'\n", 
+					(int)yyextra->lineno, yytext);yyextra->nerrors++;return(TOK_ERROR);}
 	YY_BREAK
 case 234:
 YY_RULE_SETUP
-#line 343 "lex.l"
-{yylval.number=yytext[0];fprintf(stderr,"Line %d: Unexpected char (%d) `%c'\n", 
-					(int)lineno, (int) yytext[0],(char) yytext[0]);errcount++;return(TOK_CHAR);}
+#line 327 "lex.l"
+{yylval->number=yytext[0];fprintf(stderr,"Line %d: Unexpected char (%d) `%c'\n", 
+					(int)yyextra->lineno, (int) yytext[0],(char) yytext[0]);yyextra->nerrors++;return(TOK_CHAR);}
 	YY_BREAK
 case 235:
 YY_RULE_SETUP
-#line 345 "lex.l"
+#line 329 "lex.l"
 ECHO;
 	YY_BREAK
-#line 2786 "lex.c"
+#line 2798 "lex.c"
 
 	case YY_END_OF_BUFFER:
 		{
 		/* Amount of text matched not including the EOB char. */
-		int yy_amount_of_matched_text = (int) (yy_cp - (yytext_ptr)) - 1;
+		int yy_amount_of_matched_text = (int) (yy_cp - yyg->yytext_ptr) - 1;
 
 		/* Undo the effects of YY_DO_BEFORE_ACTION. */
-		*yy_cp = (yy_hold_char);
+		*yy_cp = yyg->yy_hold_char;
 		YY_RESTORE_YY_MORE_OFFSET
 
 		if ( YY_CURRENT_BUFFER_LVALUE->yy_buffer_status == YY_BUFFER_NEW )
@@ -2804,7 +2816,7 @@ ECHO;
 			 * this is the first action (other than possibly a
 			 * back-up) that will match for the new input source.
 			 */
-			(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
+			yyg->yy_n_chars = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
 			YY_CURRENT_BUFFER_LVALUE->yy_input_file = yyin;
 			YY_CURRENT_BUFFER_LVALUE->yy_buffer_status = YY_BUFFER_NORMAL;
 			}
@@ -2816,13 +2828,13 @@ ECHO;
 		 * end-of-buffer state).  Contrast this with the test
 		 * in input().
 		 */
-		if ( (yy_c_buf_p) <= &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
+		if ( yyg->yy_c_buf_p <= &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] )
 			{ /* This was really a NUL. */
 			yy_state_type yy_next_state;
 
-			(yy_c_buf_p) = (yytext_ptr) + yy_amount_of_matched_text;
+			yyg->yy_c_buf_p = yyg->yytext_ptr + yy_amount_of_matched_text;
 
-			yy_current_state = yy_get_previous_state(  );
+			yy_current_state = yy_get_previous_state( yyscanner );
 
 			/* Okay, we're now positioned to make the NUL
 			 * transition.  We couldn't have
@@ -2833,32 +2845,32 @@ ECHO;
 			 * will run more slowly).
 			 */
 
-			yy_next_state = yy_try_NUL_trans( yy_current_state );
+			yy_next_state = yy_try_NUL_trans( yy_current_state , yyscanner);
 
-			yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+			yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 
 			if ( yy_next_state )
 				{
 				/* Consume the NUL. */
-				yy_cp = ++(yy_c_buf_p);
+				yy_cp = ++yyg->yy_c_buf_p;
 				yy_current_state = yy_next_state;
 				goto yy_match;
 				}
 
 			else
 				{
-				yy_cp = (yy_c_buf_p);
+				yy_cp = yyg->yy_c_buf_p;
 				goto yy_find_action;
 				}
 			}
 
-		else switch ( yy_get_next_buffer(  ) )
+		else switch ( yy_get_next_buffer( yyscanner ) )
 			{
 			case EOB_ACT_END_OF_FILE:
 				{
-				(yy_did_buffer_switch_on_eof) = 0;
+				yyg->yy_did_buffer_switch_on_eof = 0;
 
-				if ( yywrap( ) )
+				if ( yywrap(yyscanner ) )
 					{
 					/* Note: because we've taken care in
 					 * yy_get_next_buffer() to have set up
@@ -2869,7 +2881,7 @@ ECHO;
 					 * YY_NULL, it'll still work - another
 					 * YY_NULL will get returned.
 					 */
-					(yy_c_buf_p) = (yytext_ptr) + YY_MORE_ADJ;
+					yyg->yy_c_buf_p = yyg->yytext_ptr + YY_MORE_ADJ;
 
 					yy_act = YY_STATE_EOF(YY_START);
 					goto do_action;
@@ -2877,30 +2889,30 @@ ECHO;
 
 				else
 					{
-					if ( ! (yy_did_buffer_switch_on_eof) )
+					if ( ! yyg->yy_did_buffer_switch_on_eof )
 						YY_NEW_FILE;
 					}
 				break;
 				}
 
 			case EOB_ACT_CONTINUE_SCAN:
-				(yy_c_buf_p) =
-					(yytext_ptr) + yy_amount_of_matched_text;
+				yyg->yy_c_buf_p =
+					yyg->yytext_ptr + yy_amount_of_matched_text;
 
-				yy_current_state = yy_get_previous_state(  );
+				yy_current_state = yy_get_previous_state( yyscanner );
 
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+				yy_cp = yyg->yy_c_buf_p;
+				yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 				goto yy_match;
 
 			case EOB_ACT_LAST_MATCH:
-				(yy_c_buf_p) =
-				&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)];
+				yyg->yy_c_buf_p =
+				&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars];
 
-				yy_current_state = yy_get_previous_state(  );
+				yy_current_state = yy_get_previous_state( yyscanner );
 
-				yy_cp = (yy_c_buf_p);
-				yy_bp = (yytext_ptr) + YY_MORE_ADJ;
+				yy_cp = yyg->yy_c_buf_p;
+				yy_bp = yyg->yytext_ptr + YY_MORE_ADJ;
 				goto yy_find_action;
 			}
 		break;
@@ -2920,20 +2932,21 @@ ECHO;
  *	EOB_ACT_CONTINUE_SCAN - continue scanning from current position
  *	EOB_ACT_END_OF_FILE - end of file
  */
-static int yy_get_next_buffer (void)
+static int yy_get_next_buffer (yyscan_t yyscanner)
 {
-    	register char *dest = YY_CURRENT_BUFFER_LVALUE->yy_ch_buf;
-	register char *source = (yytext_ptr);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	register char *dest = YY_CURRENT_BUFFER_LVALUE->yy_ch_buf;
+	register char *source = yyg->yytext_ptr;
 	register int number_to_move, i;
 	int ret_val;
 
-	if ( (yy_c_buf_p) > &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] )
+	if ( yyg->yy_c_buf_p > &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars + 1] )
 		YY_FATAL_ERROR(
 		"fatal flex scanner internal error--end of buffer missed" );
 
 	if ( YY_CURRENT_BUFFER_LVALUE->yy_fill_buffer == 0 )
 		{ /* Don't try to fill the buffer, so this is an EOF. */
-		if ( (yy_c_buf_p) - (yytext_ptr) - YY_MORE_ADJ == 1 )
+		if ( yyg->yy_c_buf_p - yyg->yytext_ptr - YY_MORE_ADJ == 1 )
 			{
 			/* We matched a single character, the EOB, so
 			 * treat this as a final EOF.
@@ -2953,7 +2966,7 @@ static int yy_get_next_buffer (void)
 	/* Try to read more data. */
 
 	/* First move last chars to start of buffer. */
-	number_to_move = (int) ((yy_c_buf_p) - (yytext_ptr)) - 1;
+	number_to_move = (int) (yyg->yy_c_buf_p - yyg->yytext_ptr) - 1;
 
 	for ( i = 0; i < number_to_move; ++i )
 		*(dest++) = *(source++);
@@ -2962,7 +2975,7 @@ static int yy_get_next_buffer (void)
 		/* don't do the read, it's not guaranteed to return an EOF,
 		 * just force an EOF
 		 */
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars) = 0;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars = 0;
 
 	else
 		{
@@ -2976,7 +2989,7 @@ static int yy_get_next_buffer (void)
 			YY_BUFFER_STATE b = YY_CURRENT_BUFFER;
 
 			int yy_c_buf_p_offset =
-				(int) ((yy_c_buf_p) - b->yy_ch_buf);
+				(int) (yyg->yy_c_buf_p - b->yy_ch_buf);
 
 			if ( b->yy_is_our_buffer )
 				{
@@ -2989,7 +3002,7 @@ static int yy_get_next_buffer (void)
 
 				b->yy_ch_buf = (char *)
 					/* Include room in for 2 EOB chars. */
-					yyrealloc((void *) b->yy_ch_buf,b->yy_buf_size + 2  );
+					yyrealloc((void *) b->yy_ch_buf,b->yy_buf_size + 2 ,yyscanner );
 				}
 			else
 				/* Can't grow it, we don't own it. */
@@ -2999,7 +3012,7 @@ static int yy_get_next_buffer (void)
 				YY_FATAL_ERROR(
 				"fatal error - scanner input buffer overflow" );
 
-			(yy_c_buf_p) = &b->yy_ch_buf[yy_c_buf_p_offset];
+			yyg->yy_c_buf_p = &b->yy_ch_buf[yy_c_buf_p_offset];
 
 			num_to_read = YY_CURRENT_BUFFER_LVALUE->yy_buf_size -
 						number_to_move - 1;
@@ -3011,17 +3024,17 @@ static int yy_get_next_buffer (void)
 
 		/* Read in more data. */
 		YY_INPUT( (&YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[number_to_move]),
-			(yy_n_chars), (size_t) num_to_read );
+			yyg->yy_n_chars, (size_t) num_to_read );
 
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
-	if ( (yy_n_chars) == 0 )
+	if ( yyg->yy_n_chars == 0 )
 		{
 		if ( number_to_move == YY_MORE_ADJ )
 			{
 			ret_val = EOB_ACT_END_OF_FILE;
-			yyrestart(yyin  );
+			yyrestart(yyin ,yyscanner);
 			}
 
 		else
@@ -3035,40 +3048,41 @@ static int yy_get_next_buffer (void)
 	else
 		ret_val = EOB_ACT_CONTINUE_SCAN;
 
-	if ((yy_size_t) ((yy_n_chars) + number_to_move) > YY_CURRENT_BUFFER_LVALUE->yy_buf_size) {
+	if ((yy_size_t) (yyg->yy_n_chars + number_to_move) > YY_CURRENT_BUFFER_LVALUE->yy_buf_size) {
 		/* Extend the array by 50%, plus the number we really need. */
-		yy_size_t new_size = (yy_n_chars) + number_to_move + ((yy_n_chars) >> 1);
-		YY_CURRENT_BUFFER_LVALUE->yy_ch_buf = (char *) yyrealloc((void *) YY_CURRENT_BUFFER_LVALUE->yy_ch_buf,new_size  );
+		yy_size_t new_size = yyg->yy_n_chars + number_to_move + (yyg->yy_n_chars >> 1);
+		YY_CURRENT_BUFFER_LVALUE->yy_ch_buf = (char *) yyrealloc((void *) YY_CURRENT_BUFFER_LVALUE->yy_ch_buf,new_size ,yyscanner );
 		if ( ! YY_CURRENT_BUFFER_LVALUE->yy_ch_buf )
 			YY_FATAL_ERROR( "out of dynamic memory in yy_get_next_buffer()" );
 	}
 
-	(yy_n_chars) += number_to_move;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] = YY_END_OF_BUFFER_CHAR;
-	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars) + 1] = YY_END_OF_BUFFER_CHAR;
+	yyg->yy_n_chars += number_to_move;
+	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] = YY_END_OF_BUFFER_CHAR;
+	YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars + 1] = YY_END_OF_BUFFER_CHAR;
 
-	(yytext_ptr) = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[0];
+	yyg->yytext_ptr = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[0];
 
 	return ret_val;
 }
 
 /* yy_get_previous_state - get the state just before the EOB char was reached */
 
-    static yy_state_type yy_get_previous_state (void)
+    static yy_state_type yy_get_previous_state (yyscan_t yyscanner)
 {
 	register yy_state_type yy_current_state;
 	register char *yy_cp;
-    
-	yy_current_state = (yy_start);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	yy_current_state = yyg->yy_start;
 	yy_current_state += YY_AT_BOL();
 
-	for ( yy_cp = (yytext_ptr) + YY_MORE_ADJ; yy_cp < (yy_c_buf_p); ++yy_cp )
+	for ( yy_cp = yyg->yytext_ptr + YY_MORE_ADJ; yy_cp < yyg->yy_c_buf_p; ++yy_cp )
 		{
 		register YY_CHAR yy_c = (*yy_cp ? yy_ec[YY_SC_TO_UI(*yy_cp)] : 1);
 		if ( yy_accept[yy_current_state] )
 			{
-			(yy_last_accepting_state) = yy_current_state;
-			(yy_last_accepting_cpos) = yy_cp;
+			yyg->yy_last_accepting_state = yy_current_state;
+			yyg->yy_last_accepting_cpos = yy_cp;
 			}
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
@@ -3087,16 +3101,17 @@ static int yy_get_next_buffer (void)
  * synopsis
  *	next_state = yy_try_NUL_trans( current_state );
  */
-    static yy_state_type yy_try_NUL_trans  (yy_state_type yy_current_state )
+    static yy_state_type yy_try_NUL_trans  (yy_state_type yy_current_state , yyscan_t yyscanner)
 {
 	register int yy_is_jam;
-    	register char *yy_cp = (yy_c_buf_p);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner; /* This var may be unused depending upon options. */
+	register char *yy_cp = yyg->yy_c_buf_p;
 
 	register YY_CHAR yy_c = 1;
 	if ( yy_accept[yy_current_state] )
 		{
-		(yy_last_accepting_state) = yy_current_state;
-		(yy_last_accepting_cpos) = yy_cp;
+		yyg->yy_last_accepting_state = yy_current_state;
+		yyg->yy_last_accepting_cpos = yy_cp;
 		}
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
@@ -3110,19 +3125,20 @@ static int yy_get_next_buffer (void)
 	return yy_is_jam ? 0 : yy_current_state;
 }
 
-    static void yyunput (int c, register char * yy_bp )
+    static void yyunput (int c, register char * yy_bp , yyscan_t yyscanner)
 {
 	register char *yy_cp;
-    
-    yy_cp = (yy_c_buf_p);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+    yy_cp = yyg->yy_c_buf_p;
 
 	/* undo effects of setting up yytext */
-	*yy_cp = (yy_hold_char);
+	*yy_cp = yyg->yy_hold_char;
 
 	if ( yy_cp < YY_CURRENT_BUFFER_LVALUE->yy_ch_buf + 2 )
 		{ /* need to shift things up to make room */
 		/* +2 for EOB chars. */
-		register int number_to_move = (yy_n_chars) + 2;
+		register int number_to_move = yyg->yy_n_chars + 2;
 		register char *dest = &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[
 					YY_CURRENT_BUFFER_LVALUE->yy_buf_size + 2];
 		register char *source =
@@ -3134,7 +3150,7 @@ static int yy_get_next_buffer (void)
 		yy_cp += (int) (dest - source);
 		yy_bp += (int) (dest - source);
 		YY_CURRENT_BUFFER_LVALUE->yy_n_chars =
-			(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_buf_size;
+			yyg->yy_n_chars = YY_CURRENT_BUFFER_LVALUE->yy_buf_size;
 
 		if ( yy_cp < YY_CURRENT_BUFFER_LVALUE->yy_ch_buf + 2 )
 			YY_FATAL_ERROR( "flex scanner push-back overflow" );
@@ -3142,39 +3158,40 @@ static int yy_get_next_buffer (void)
 
 	*--yy_cp = (char) c;
 
-	(yytext_ptr) = yy_bp;
-	(yy_hold_char) = *yy_cp;
-	(yy_c_buf_p) = yy_cp;
+	yyg->yytext_ptr = yy_bp;
+	yyg->yy_hold_char = *yy_cp;
+	yyg->yy_c_buf_p = yy_cp;
 }
 
 #ifndef YY_NO_INPUT
 #ifdef __cplusplus
-    static int yyinput (void)
+    static int yyinput (yyscan_t yyscanner)
 #else
-    static int input  (void)
+    static int input  (yyscan_t yyscanner)
 #endif
 
 {
 	int c;
-    
-	*(yy_c_buf_p) = (yy_hold_char);
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	*yyg->yy_c_buf_p = yyg->yy_hold_char;
 
-	if ( *(yy_c_buf_p) == YY_END_OF_BUFFER_CHAR )
+	if ( *yyg->yy_c_buf_p == YY_END_OF_BUFFER_CHAR )
 		{
 		/* yy_c_buf_p now points to the character we want to return.
 		 * If this occurs *before* the EOB characters, then it's a
 		 * valid NUL; if not, then we've hit the end of the buffer.
 		 */
-		if ( (yy_c_buf_p) < &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[(yy_n_chars)] )
+		if ( yyg->yy_c_buf_p < &YY_CURRENT_BUFFER_LVALUE->yy_ch_buf[yyg->yy_n_chars] )
 			/* This was really a NUL. */
-			*(yy_c_buf_p) = '\0';
+			*yyg->yy_c_buf_p = '\0';
 
 		else
 			{ /* need more input */
-			int offset = (yy_c_buf_p) - (yytext_ptr);
-			++(yy_c_buf_p);
+			int offset = yyg->yy_c_buf_p - yyg->yytext_ptr;
+			++yyg->yy_c_buf_p;
 
-			switch ( yy_get_next_buffer(  ) )
+			switch ( yy_get_next_buffer( yyscanner ) )
 				{
 				case EOB_ACT_LAST_MATCH:
 					/* This happens because yy_g_n_b()
@@ -3188,34 +3205,34 @@ static int yy_get_next_buffer (void)
 					 */
 
 					/* Reset buffer status. */
-					yyrestart(yyin );
+					yyrestart(yyin ,yyscanner);
 
 					/*FALLTHROUGH*/
 
 				case EOB_ACT_END_OF_FILE:
 					{
-					if ( yywrap( ) )
+					if ( yywrap(yyscanner ) )
 						return EOF;
 
-					if ( ! (yy_did_buffer_switch_on_eof) )
+					if ( ! yyg->yy_did_buffer_switch_on_eof )
 						YY_NEW_FILE;
 #ifdef __cplusplus
-					return yyinput();
+					return yyinput(yyscanner);
 #else
-					return input();
+					return input(yyscanner);
 #endif
 					}
 
 				case EOB_ACT_CONTINUE_SCAN:
-					(yy_c_buf_p) = (yytext_ptr) + offset;
+					yyg->yy_c_buf_p = yyg->yytext_ptr + offset;
 					break;
 				}
 			}
 		}
 
-	c = *(unsigned char *) (yy_c_buf_p);	/* cast for 8-bit char's */
-	*(yy_c_buf_p) = '\0';	/* preserve yytext */
-	(yy_hold_char) = *++(yy_c_buf_p);
+	c = *(unsigned char *) yyg->yy_c_buf_p;	/* cast for 8-bit char's */
+	*yyg->yy_c_buf_p = '\0';	/* preserve yytext */
+	yyg->yy_hold_char = *++yyg->yy_c_buf_p;
 
 	YY_CURRENT_BUFFER_LVALUE->yy_at_bol = (c == '\n');
 
@@ -3228,60 +3245,63 @@ static int yy_get_next_buffer (void)
  * 
  * @note This function does not reset the start condition to @c INITIAL .
  */
-    void yyrestart  (FILE * input_file )
+    void yyrestart  (FILE * input_file , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	if ( ! YY_CURRENT_BUFFER ){
-        yyensure_buffer_stack ();
+        yyensure_buffer_stack (yyscanner);
 		YY_CURRENT_BUFFER_LVALUE =
-            yy_create_buffer(yyin,YY_BUF_SIZE );
+            yy_create_buffer(yyin,YY_BUF_SIZE ,yyscanner);
 	}
 
-	yy_init_buffer(YY_CURRENT_BUFFER,input_file );
-	yy_load_buffer_state( );
+	yy_init_buffer(YY_CURRENT_BUFFER,input_file ,yyscanner);
+	yy_load_buffer_state(yyscanner );
 }
 
 /** Switch to a different input buffer.
  * @param new_buffer The new input buffer.
  * 
  */
-    void yy_switch_to_buffer  (YY_BUFFER_STATE  new_buffer )
+    void yy_switch_to_buffer  (YY_BUFFER_STATE  new_buffer , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	/* TODO. We should be able to replace this entire function body
 	 * with
 	 *		yypop_buffer_state();
 	 *		yypush_buffer_state(new_buffer);
      */
-	yyensure_buffer_stack ();
+	yyensure_buffer_stack (yyscanner);
 	if ( YY_CURRENT_BUFFER == new_buffer )
 		return;
 
 	if ( YY_CURRENT_BUFFER )
 		{
 		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		*yyg->yy_c_buf_p = yyg->yy_hold_char;
+		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = yyg->yy_c_buf_p;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
 	YY_CURRENT_BUFFER_LVALUE = new_buffer;
-	yy_load_buffer_state( );
+	yy_load_buffer_state(yyscanner );
 
 	/* We don't actually know whether we did this switch during
 	 * EOF (yywrap()) processing, but the only time this flag
 	 * is looked at is after yywrap() is called, so it's safe
 	 * to go ahead and always set it.
 	 */
-	(yy_did_buffer_switch_on_eof) = 1;
+	yyg->yy_did_buffer_switch_on_eof = 1;
 }
 
-static void yy_load_buffer_state  (void)
+static void yy_load_buffer_state  (yyscan_t yyscanner)
 {
-    	(yy_n_chars) = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
-	(yytext_ptr) = (yy_c_buf_p) = YY_CURRENT_BUFFER_LVALUE->yy_buf_pos;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	yyg->yy_n_chars = YY_CURRENT_BUFFER_LVALUE->yy_n_chars;
+	yyg->yytext_ptr = yyg->yy_c_buf_p = YY_CURRENT_BUFFER_LVALUE->yy_buf_pos;
 	yyin = YY_CURRENT_BUFFER_LVALUE->yy_input_file;
-	(yy_hold_char) = *(yy_c_buf_p);
+	yyg->yy_hold_char = *yyg->yy_c_buf_p;
 }
 
 /** Allocate and initialize an input buffer state.
@@ -3290,11 +3310,11 @@ static void yy_load_buffer_state  (void)
  * 
  * @return the allocated buffer state.
  */
-    YY_BUFFER_STATE yy_create_buffer  (FILE * file, int  size )
+    YY_BUFFER_STATE yy_create_buffer  (FILE * file, int  size , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
     
-	b = (YY_BUFFER_STATE) yyalloc(sizeof( struct yy_buffer_state )  );
+	b = (YY_BUFFER_STATE) yyalloc(sizeof( struct yy_buffer_state ) ,yyscanner );
 	if ( ! b )
 		YY_FATAL_ERROR( "out of dynamic memory in yy_create_buffer()" );
 
@@ -3303,13 +3323,13 @@ static void yy_load_buffer_state  (void)
 	/* yy_ch_buf has to be 2 characters longer than the size given because
 	 * we need to put in 2 end-of-buffer characters.
 	 */
-	b->yy_ch_buf = (char *) yyalloc(b->yy_buf_size + 2  );
+	b->yy_ch_buf = (char *) yyalloc(b->yy_buf_size + 2 ,yyscanner );
 	if ( ! b->yy_ch_buf )
 		YY_FATAL_ERROR( "out of dynamic memory in yy_create_buffer()" );
 
 	b->yy_is_our_buffer = 1;
 
-	yy_init_buffer(b,file );
+	yy_init_buffer(b,file ,yyscanner);
 
 	return b;
 }
@@ -3318,9 +3338,10 @@ static void yy_load_buffer_state  (void)
  * @param b a buffer created with yy_create_buffer()
  * 
  */
-    void yy_delete_buffer (YY_BUFFER_STATE  b )
+    void yy_delete_buffer (YY_BUFFER_STATE  b , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
 	if ( ! b )
 		return;
 
@@ -3328,9 +3349,9 @@ static void yy_load_buffer_state  (void)
 		YY_CURRENT_BUFFER_LVALUE = (YY_BUFFER_STATE) 0;
 
 	if ( b->yy_is_our_buffer )
-		yyfree((void *) b->yy_ch_buf  );
+		yyfree((void *) b->yy_ch_buf ,yyscanner );
 
-	yyfree((void *) b  );
+	yyfree((void *) b ,yyscanner );
 }
 
 #ifndef __cplusplus
@@ -3341,12 +3362,13 @@ extern int isatty (int );
  * This function is sometimes called more than once on the same buffer,
  * such as during a yyrestart() or at EOF.
  */
-    static void yy_init_buffer  (YY_BUFFER_STATE  b, FILE * file )
+    static void yy_init_buffer  (YY_BUFFER_STATE  b, FILE * file , yyscan_t yyscanner)
 
 {
 	int oerrno = errno;
-    
-	yy_flush_buffer(b );
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	yy_flush_buffer(b ,yyscanner);
 
 	b->yy_input_file = file;
 	b->yy_fill_buffer = 1;
@@ -3369,9 +3391,10 @@ extern int isatty (int );
  * @param b the buffer state to be flushed, usually @c YY_CURRENT_BUFFER.
  * 
  */
-    void yy_flush_buffer (YY_BUFFER_STATE  b )
+    void yy_flush_buffer (YY_BUFFER_STATE  b , yyscan_t yyscanner)
 {
-    	if ( ! b )
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if ( ! b )
 		return;
 
 	b->yy_n_chars = 0;
@@ -3389,7 +3412,7 @@ extern int isatty (int );
 	b->yy_buffer_status = YY_BUFFER_NEW;
 
 	if ( b == YY_CURRENT_BUFFER )
-		yy_load_buffer_state( );
+		yy_load_buffer_state(yyscanner );
 }
 
 /** Pushes the new state onto the stack. The new state becomes
@@ -3398,95 +3421,98 @@ extern int isatty (int );
  *  @param new_buffer The new state.
  *  
  */
-void yypush_buffer_state (YY_BUFFER_STATE new_buffer )
+void yypush_buffer_state (YY_BUFFER_STATE new_buffer , yyscan_t yyscanner)
 {
-    	if (new_buffer == NULL)
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if (new_buffer == NULL)
 		return;
 
-	yyensure_buffer_stack();
+	yyensure_buffer_stack(yyscanner);
 
 	/* This block is copied from yy_switch_to_buffer. */
 	if ( YY_CURRENT_BUFFER )
 		{
 		/* Flush out information for old buffer. */
-		*(yy_c_buf_p) = (yy_hold_char);
-		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = (yy_c_buf_p);
-		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = (yy_n_chars);
+		*yyg->yy_c_buf_p = yyg->yy_hold_char;
+		YY_CURRENT_BUFFER_LVALUE->yy_buf_pos = yyg->yy_c_buf_p;
+		YY_CURRENT_BUFFER_LVALUE->yy_n_chars = yyg->yy_n_chars;
 		}
 
 	/* Only push if top exists. Otherwise, replace top. */
 	if (YY_CURRENT_BUFFER)
-		(yy_buffer_stack_top)++;
+		yyg->yy_buffer_stack_top++;
 	YY_CURRENT_BUFFER_LVALUE = new_buffer;
 
 	/* copied from yy_switch_to_buffer. */
-	yy_load_buffer_state( );
-	(yy_did_buffer_switch_on_eof) = 1;
+	yy_load_buffer_state(yyscanner );
+	yyg->yy_did_buffer_switch_on_eof = 1;
 }
 
 /** Removes and deletes the top of the stack, if present.
  *  The next element becomes the new top.
  *  
  */
-void yypop_buffer_state (void)
+void yypop_buffer_state (yyscan_t yyscanner)
 {
-    	if (!YY_CURRENT_BUFFER)
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+	if (!YY_CURRENT_BUFFER)
 		return;
 
-	yy_delete_buffer(YY_CURRENT_BUFFER );
+	yy_delete_buffer(YY_CURRENT_BUFFER ,yyscanner);
 	YY_CURRENT_BUFFER_LVALUE = NULL;
-	if ((yy_buffer_stack_top) > 0)
-		--(yy_buffer_stack_top);
+	if (yyg->yy_buffer_stack_top > 0)
+		--yyg->yy_buffer_stack_top;
 
 	if (YY_CURRENT_BUFFER) {
-		yy_load_buffer_state( );
-		(yy_did_buffer_switch_on_eof) = 1;
+		yy_load_buffer_state(yyscanner );
+		yyg->yy_did_buffer_switch_on_eof = 1;
 	}
 }
 
 /* Allocates the stack if it does not exist.
  *  Guarantees space for at least one push.
  */
-static void yyensure_buffer_stack (void)
+static void yyensure_buffer_stack (yyscan_t yyscanner)
 {
 	int num_to_alloc;
-    
-	if (!(yy_buffer_stack)) {
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+	if (!yyg->yy_buffer_stack) {
 
 		/* First allocation is just for 2 elements, since we don't know if this
 		 * scanner will even need a stack. We use 2 instead of 1 to avoid an
 		 * immediate realloc on the next call.
          */
 		num_to_alloc = 1;
-		(yy_buffer_stack) = (struct yy_buffer_state**)yyalloc
+		yyg->yy_buffer_stack = (struct yy_buffer_state**)yyalloc
 								(num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
+								, yyscanner);
+		if ( ! yyg->yy_buffer_stack )
 			YY_FATAL_ERROR( "out of dynamic memory in yyensure_buffer_stack()" );
 								  
-		memset((yy_buffer_stack), 0, num_to_alloc * sizeof(struct yy_buffer_state*));
+		memset(yyg->yy_buffer_stack, 0, num_to_alloc * sizeof(struct yy_buffer_state*));
 				
-		(yy_buffer_stack_max) = num_to_alloc;
-		(yy_buffer_stack_top) = 0;
+		yyg->yy_buffer_stack_max = num_to_alloc;
+		yyg->yy_buffer_stack_top = 0;
 		return;
 	}
 
-	if ((yy_buffer_stack_top) >= ((yy_buffer_stack_max)) - 1){
+	if (yyg->yy_buffer_stack_top >= (yyg->yy_buffer_stack_max) - 1){
 
 		/* Increase the buffer to prepare for a possible push. */
 		int grow_size = 8 /* arbitrary grow size */;
 
-		num_to_alloc = (yy_buffer_stack_max) + grow_size;
-		(yy_buffer_stack) = (struct yy_buffer_state**)yyrealloc
-								((yy_buffer_stack),
+		num_to_alloc = yyg->yy_buffer_stack_max + grow_size;
+		yyg->yy_buffer_stack = (struct yy_buffer_state**)yyrealloc
+								(yyg->yy_buffer_stack,
 								num_to_alloc * sizeof(struct yy_buffer_state*)
-								);
-		if ( ! (yy_buffer_stack) )
+								, yyscanner);
+		if ( ! yyg->yy_buffer_stack )
 			YY_FATAL_ERROR( "out of dynamic memory in yyensure_buffer_stack()" );
 
 		/* zero only the new slots.*/
-		memset((yy_buffer_stack) + (yy_buffer_stack_max), 0, grow_size * sizeof(struct yy_buffer_state*));
-		(yy_buffer_stack_max) = num_to_alloc;
+		memset(yyg->yy_buffer_stack + yyg->yy_buffer_stack_max, 0, grow_size * sizeof(struct yy_buffer_state*));
+		yyg->yy_buffer_stack_max = num_to_alloc;
 	}
 }
 
@@ -3496,7 +3522,7 @@ static void yyensure_buffer_stack (void)
  * 
  * @return the newly allocated buffer state object. 
  */
-YY_BUFFER_STATE yy_scan_buffer  (char * base, yy_size_t  size )
+YY_BUFFER_STATE yy_scan_buffer  (char * base, yy_size_t  size , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
     
@@ -3506,7 +3532,7 @@ YY_BUFFER_STATE yy_scan_buffer  (char * base, yy_size_t  size )
 		/* They forgot to leave room for the EOB's. */
 		return 0;
 
-	b = (YY_BUFFER_STATE) yyalloc(sizeof( struct yy_buffer_state )  );
+	b = (YY_BUFFER_STATE) yyalloc(sizeof( struct yy_buffer_state ) ,yyscanner );
 	if ( ! b )
 		YY_FATAL_ERROR( "out of dynamic memory in yy_scan_buffer()" );
 
@@ -3520,7 +3546,7 @@ YY_BUFFER_STATE yy_scan_buffer  (char * base, yy_size_t  size )
 	b->yy_fill_buffer = 0;
 	b->yy_buffer_status = YY_BUFFER_NEW;
 
-	yy_switch_to_buffer(b  );
+	yy_switch_to_buffer(b ,yyscanner );
 
 	return b;
 }
@@ -3533,10 +3559,10 @@ YY_BUFFER_STATE yy_scan_buffer  (char * base, yy_size_t  size )
  * @note If you want to scan bytes that may contain NUL values, then use
  *       yy_scan_bytes() instead.
  */
-YY_BUFFER_STATE yy_scan_string (yyconst char * yystr )
+YY_BUFFER_STATE yy_scan_string (yyconst char * yystr , yyscan_t yyscanner)
 {
     
-	return yy_scan_bytes(yystr,strlen(yystr) );
+	return yy_scan_bytes(yystr,strlen(yystr) ,yyscanner);
 }
 
 /** Setup the input buffer state to scan the given bytes. The next call to yylex() will
@@ -3546,7 +3572,7 @@ YY_BUFFER_STATE yy_scan_string (yyconst char * yystr )
  * 
  * @return the newly allocated buffer state object.
  */
-YY_BUFFER_STATE yy_scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
+YY_BUFFER_STATE yy_scan_bytes  (yyconst char * yybytes, int  _yybytes_len , yyscan_t yyscanner)
 {
 	YY_BUFFER_STATE b;
 	char *buf;
@@ -3555,7 +3581,7 @@ YY_BUFFER_STATE yy_scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
     
 	/* Get memory for full buffer, including space for trailing EOB's. */
 	n = _yybytes_len + 2;
-	buf = (char *) yyalloc(n  );
+	buf = (char *) yyalloc(n ,yyscanner );
 	if ( ! buf )
 		YY_FATAL_ERROR( "out of dynamic memory in yy_scan_bytes()" );
 
@@ -3564,7 +3590,7 @@ YY_BUFFER_STATE yy_scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
 
 	buf[_yybytes_len] = buf[_yybytes_len+1] = YY_END_OF_BUFFER_CHAR;
 
-	b = yy_scan_buffer(buf,n );
+	b = yy_scan_buffer(buf,n ,yyscanner);
 	if ( ! b )
 		YY_FATAL_ERROR( "bad buffer in yy_scan_bytes()" );
 
@@ -3580,7 +3606,7 @@ YY_BUFFER_STATE yy_scan_bytes  (yyconst char * yybytes, int  _yybytes_len )
 #define YY_EXIT_FAILURE 2
 #endif
 
-static void yy_fatal_error (yyconst char* msg )
+static void yy_fatal_error (yyconst char* msg , yyscan_t yyscanner)
 {
     	(void) fprintf( stderr, "%s\n", msg );
 	exit( YY_EXIT_FAILURE );
@@ -3595,106 +3621,253 @@ static void yy_fatal_error (yyconst char* msg )
 		/* Undo effects of setting up yytext. */ \
         int yyless_macro_arg = (n); \
         YY_LESS_LINENO(yyless_macro_arg);\
-		yytext[yyleng] = (yy_hold_char); \
-		(yy_c_buf_p) = yytext + yyless_macro_arg; \
-		(yy_hold_char) = *(yy_c_buf_p); \
-		*(yy_c_buf_p) = '\0'; \
+		yytext[yyleng] = yyg->yy_hold_char; \
+		yyg->yy_c_buf_p = yytext + yyless_macro_arg; \
+		yyg->yy_hold_char = *yyg->yy_c_buf_p; \
+		*yyg->yy_c_buf_p = '\0'; \
 		yyleng = yyless_macro_arg; \
 		} \
 	while ( 0 )
 
 /* Accessor  methods (get/set functions) to struct members. */
 
+/** Get the user-defined data for this scanner.
+ * @param yyscanner The scanner object.
+ */
+YY_EXTRA_TYPE yyget_extra  (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyextra;
+}
+
 /** Get the current line number.
- * 
+ * @param yyscanner The scanner object.
  */
-int yyget_lineno  (void)
+int yyget_lineno  (yyscan_t yyscanner)
 {
-        
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        if (! YY_CURRENT_BUFFER)
+            return 0;
+
     return yylineno;
 }
 
+/** Get the current column number.
+ * @param yyscanner The scanner object.
+ */
+int yyget_column  (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        if (! YY_CURRENT_BUFFER)
+            return 0;
+
+    return yycolumn;
+}
+
 /** Get the input stream.
- * 
+ * @param yyscanner The scanner object.
  */
-FILE *yyget_in  (void)
+FILE *yyget_in  (yyscan_t yyscanner)
 {
-        return yyin;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyin;
 }
 
 /** Get the output stream.
- * 
+ * @param yyscanner The scanner object.
  */
-FILE *yyget_out  (void)
+FILE *yyget_out  (yyscan_t yyscanner)
 {
-        return yyout;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyout;
 }
 
 /** Get the length of the current token.
- * 
+ * @param yyscanner The scanner object.
  */
-int yyget_leng  (void)
+int yyget_leng  (yyscan_t yyscanner)
 {
-        return yyleng;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yyleng;
 }
 
 /** Get the current token.
- * 
+ * @param yyscanner The scanner object.
  */
 
-char *yyget_text  (void)
+char *yyget_text  (yyscan_t yyscanner)
 {
-        return yytext;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yytext;
+}
+
+/** Set the user-defined data. This data is never touched by the scanner.
+ * @param user_defined The data to be associated with this scanner.
+ * @param yyscanner The scanner object.
+ */
+void yyset_extra (YY_EXTRA_TYPE  user_defined , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyextra = user_defined ;
 }
 
 /** Set the current line number.
  * @param line_number
- * 
+ * @param yyscanner The scanner object.
  */
-void yyset_lineno (int  line_number )
+void yyset_lineno (int  line_number , yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        /* lineno is only valid if an input buffer exists. */
+        if (! YY_CURRENT_BUFFER )
+           yy_fatal_error( "yyset_lineno called with no buffer" , yyscanner);
+
     yylineno = line_number;
 }
 
+/** Set the current column.
+ * @param line_number
+ * @param yyscanner The scanner object.
+ */
+void yyset_column (int  column_no , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
+        /* column is only valid if an input buffer exists. */
+        if (! YY_CURRENT_BUFFER )
+           yy_fatal_error( "yyset_column called with no buffer" , yyscanner);
+
+    yycolumn = column_no;
+}
+
 /** Set the input stream. This does not discard the current
  * input buffer.
  * @param in_str A readable stream.
- * 
+ * @param yyscanner The scanner object.
  * @see yy_switch_to_buffer
  */
-void yyset_in (FILE *  in_str )
+void yyset_in (FILE *  in_str , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyin = in_str ;
+}
+
+void yyset_out (FILE *  out_str , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yyout = out_str ;
+}
+
+int yyget_debug  (yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yy_flex_debug;
+}
+
+void yyset_debug (int  bdebug , yyscan_t yyscanner)
+{
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yy_flex_debug = bdebug ;
+}
+
+/* Accessor methods for yylval and yylloc */
+
+YYSTYPE * yyget_lval  (yyscan_t yyscanner)
 {
-        yyin = in_str ;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    return yylval;
 }
 
-void yyset_out (FILE *  out_str )
+void yyset_lval (YYSTYPE *  yylval_param , yyscan_t yyscanner)
 {
-        yyout = out_str ;
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    yylval = yylval_param;
 }
 
-int yyget_debug  (void)
+/* User-visible API */
+
+/* yylex_init is special because it creates the scanner itself, so it is
+ * the ONLY reentrant function that doesn't take the scanner as the last argument.
+ * That's why we explicitly handle the declaration, instead of using our macros.
+ */
+
+int yylex_init(yyscan_t* ptr_yy_globals)
+
 {
-        return yy_flex_debug;
+    if (ptr_yy_globals == NULL){
+        errno = EINVAL;
+        return 1;
+    }
+
+    *ptr_yy_globals = (yyscan_t) yyalloc ( sizeof( struct yyguts_t ), NULL );
+
+    if (*ptr_yy_globals == NULL){
+        errno = ENOMEM;
+        return 1;
+    }
+
+    /* By setting to 0xAA, we expose bugs in yy_init_globals. Leave at 0x00 for releases. */
+    memset(*ptr_yy_globals,0x00,sizeof(struct yyguts_t));
+
+    return yy_init_globals ( *ptr_yy_globals );
 }
 
-void yyset_debug (int  bdebug )
+/* yylex_init_extra has the same functionality as yylex_init, but follows the
+ * convention of taking the scanner as the last argument. Note however, that
+ * this is a *pointer* to a scanner, as it will be allocated by this call (and
+ * is the reason, too, why this function also must handle its own declaration).
+ * The user defined value in the first argument will be available to yyalloc in
+ * the yyextra field.
+ */
+
+int yylex_init_extra(YY_EXTRA_TYPE yy_user_defined,yyscan_t* ptr_yy_globals )
+
 {
-        yy_flex_debug = bdebug ;
+    struct yyguts_t dummy_yyguts;
+
+    yyset_extra (yy_user_defined, &dummy_yyguts);
+
+    if (ptr_yy_globals == NULL){
+        errno = EINVAL;
+        return 1;
+    }
+
+    *ptr_yy_globals = (yyscan_t) yyalloc ( sizeof( struct yyguts_t ), &dummy_yyguts );
+
+    if (*ptr_yy_globals == NULL){
+        errno = ENOMEM;
+        return 1;
+    }
+
+    /* By setting to 0xAA, we expose bugs in
+    yy_init_globals. Leave at 0x00 for releases. */
+    memset(*ptr_yy_globals,0x00,sizeof(struct yyguts_t));
+
+    yyset_extra (yy_user_defined, *ptr_yy_globals);
+
+    return yy_init_globals ( *ptr_yy_globals );
 }
 
-static int yy_init_globals (void)
+static int yy_init_globals (yyscan_t yyscanner)
 {
-        /* Initialization is the same as for the non-reentrant scanner.
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+    /* Initialization is the same as for the non-reentrant scanner.
      * This function is called from yylex_destroy(), so don't allocate here.
      */
 
-    (yy_buffer_stack) = 0;
-    (yy_buffer_stack_top) = 0;
-    (yy_buffer_stack_max) = 0;
-    (yy_c_buf_p) = (char *) 0;
-    (yy_init) = 0;
-    (yy_start) = 0;
+    yyg->yy_buffer_stack = 0;
+    yyg->yy_buffer_stack_top = 0;
+    yyg->yy_buffer_stack_max = 0;
+    yyg->yy_c_buf_p = (char *) 0;
+    yyg->yy_init = 0;
+    yyg->yy_start = 0;
+
+    yyg->yy_start_stack_ptr = 0;
+    yyg->yy_start_stack_depth = 0;
+    yyg->yy_start_stack =  NULL;
 
 /* Defined in main.c */
 #ifdef YY_STDINIT
@@ -3712,24 +3885,32 @@ static int yy_init_globals (void)
 }
 
 /* yylex_destroy is for both reentrant and non-reentrant scanners. */
-int yylex_destroy  (void)
+int yylex_destroy  (yyscan_t yyscanner)
 {
-    
+    struct yyguts_t * yyg = (struct yyguts_t*)yyscanner;
+
     /* Pop the buffer stack, destroying each element. */
 	while(YY_CURRENT_BUFFER){
-		yy_delete_buffer(YY_CURRENT_BUFFER  );
+		yy_delete_buffer(YY_CURRENT_BUFFER ,yyscanner );
 		YY_CURRENT_BUFFER_LVALUE = NULL;
-		yypop_buffer_state();
+		yypop_buffer_state(yyscanner);
 	}
 
 	/* Destroy the stack itself. */
-	yyfree((yy_buffer_stack) );
-	(yy_buffer_stack) = NULL;
+	yyfree(yyg->yy_buffer_stack ,yyscanner);
+	yyg->yy_buffer_stack = NULL;
+
+    /* Destroy the start condition stack. */
+        yyfree(yyg->yy_start_stack ,yyscanner );
+        yyg->yy_start_stack = NULL;
 
     /* Reset the globals. This is important in a non-reentrant scanner so the next time
      * yylex() is called, initialization will occur. */
-    yy_init_globals( );
+    yy_init_globals( yyscanner);
 
+    /* Destroy the main struct (reentrant only). */
+    yyfree ( yyscanner , yyscanner );
+    yyscanner = NULL;
     return 0;
 }
 
@@ -3738,7 +3919,7 @@ int yylex_destroy  (void)
  */
 
 #ifndef yytext_ptr
-static void yy_flex_strncpy (char* s1, yyconst char * s2, int n )
+static void yy_flex_strncpy (char* s1, yyconst char * s2, int n , yyscan_t yyscanner)
 {
 	register int i;
 	for ( i = 0; i < n; ++i )
@@ -3747,7 +3928,7 @@ static void yy_flex_strncpy (char* s1, yyconst char * s2, int n )
 #endif
 
 #ifdef YY_NEED_STRLEN
-static int yy_flex_strlen (yyconst char * s )
+static int yy_flex_strlen (yyconst char * s , yyscan_t yyscanner)
 {
 	register int n;
 	for ( n = 0; s[n]; ++n )
@@ -3757,12 +3938,12 @@ static int yy_flex_strlen (yyconst char * s )
 }
 #endif
 
-void *yyalloc (yy_size_t  size )
+void *yyalloc (yy_size_t  size , yyscan_t yyscanner)
 {
 	return (void *) malloc( size );
 }
 
-void *yyrealloc  (void * ptr, yy_size_t  size )
+void *yyrealloc  (void * ptr, yy_size_t  size , yyscan_t yyscanner)
 {
 	/* The cast to (char *) in the following accommodates both
 	 * implementations that use char* generic pointers, and those
@@ -3774,11 +3955,11 @@ void *yyrealloc  (void * ptr, yy_size_t  size )
 	return (void *) realloc( (char *) ptr, size );
 }
 
-void yyfree (void * ptr )
+void yyfree (void * ptr , yyscan_t yyscanner)
 {
 	free( (char *) ptr );	/* see yyrealloc() for (char *) cast */
 }
 
 #define YYTABLES_NAME "yytables"
 
-#line 345 "lex.l"
+#line 333 "lex.l"
@@ -23,60 +23,103 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <kmfl.h>
 #include "memman.h"
 
 // Memory Management
+//
+// All the memory used by a compilation is allocated from an arena: a list of large
+// chunks, each filled from the start by moving a pointer along it, and released as a
+// whole by mem_free_all() at the end of the compilation. mem_free() takes back the most
+// recent block in a chunk, and keeps other small blocks on a list for their size so
+// that they can be used again.
+//
+// Define MEMMAN_DEBUG to fill new blocks with 0xcd and released memory with 0xdd,
+// and to check that freed blocks belong to the arena
+
+typedef struct memchunk
+{
+    struct memchunk * mc_next;      // previous chunk
+    char * mc_free;                 // start of free space in the chunk
+    char * mc_end;                  // end of the chunk
+    char * mc_last;                 // most recent block in the chunk
+} MEMCHUNK;
+
 typedef struct memnod
 {
-    struct memnod   * mh_next;
-    struct memnod * mh_prev;
+    size_t mh_size;                 // size requested for the block
+    MEMCHUNK * mh_chunk;            // chunk the block is in
 } MEMHDR;
 
+#define MEM_ALIGN       sizeof(MEMHDR)
+#define MEM_ROUND(n)    (((n) + MEM_ALIGN - 1) & ~((size_t) MEM_ALIGN - 1))
+#define CHUNK_HDR_SIZE  MEM_ROUND(sizeof(MEMCHUNK))
+#define CHUNK_SIZE      (64 * 1024)
+#define SMALL_SIZES     32          // number of small block sizes kept for reuse
+#define BLOCK_SIZE(n)   (sizeof(MEMHDR) + MEM_ROUND((n) ? (n) : 1))
+#define SIZE_CLASS(n)   (MEM_ROUND((n) ? (n) : 1) / MEM_ALIGN - 1)
+
 #define CLIENT_TO_HDR(a) ((MEMHDR *) (((char *) (a)) - sizeof(MEMHDR)))
 #define HDR_TO_CLIENT(a) ((void *) (((char *) (a)) + sizeof(MEMHDR)))
 
-static MEMHDR * memlist= NULL;
+#ifdef MEMMAN_DEBUG
+#define POISON(p, c, n) memset((p), (c), (n))
+#else
+#define POISON(p, c, n)
+#endif
 
-static void mem_list_add(MEMHDR * p)
+// Arena of the compilation in progress on this thread
+static KMFL_THREAD MEMCHUNK * memlist= NULL;
+
+// Small blocks freed, by size, linked through their client area
+static KMFL_THREAD void * freelist[SMALL_SIZES];
+
+// Add a chunk to the arena, large enough for a block of the given size
+static MEMCHUNK * mem_chunk_add(size_t size)
 {
-    p->mh_next= memlist;
-    p->mh_prev= NULL;
+    MEMCHUNK * c;
+    size_t chunk_size= CHUNK_HDR_SIZE + size;
 
-    if (memlist != NULL)
-    {
-        memlist->mh_prev= p;
-    }
-    memlist= p;
+    if (chunk_size < CHUNK_SIZE)
+        chunk_size= CHUNK_SIZE;
 
-}
+    c= (MEMCHUNK *) malloc(chunk_size);
 
-static void mem_list_delete(MEMHDR * p)
-{
-    if (p->mh_next != NULL)
-        p->mh_next->mh_prev= p->mh_prev;
+    if (c == NULL)
+        return(NULL);
+
+    c->mc_free= (char *) c + CHUNK_HDR_SIZE;
+    c->mc_end= (char *) c + chunk_size;
+    c->mc_last= NULL;
+    POISON(c->mc_free, 0xdd, c->mc_end - c->mc_free);
 
-    if (p->mh_prev != NULL)
-        p->mh_prev->mh_next= p->mh_next;
+    // Large blocks get a chunk of their own, behind the current one
+    if (chunk_size > CHUNK_SIZE && memlist != NULL)
+    {
+        c->mc_next= memlist->mc_next;
+        memlist->mc_next= c;
+    }
     else
-        memlist= p->mh_next;
+    {
+        c->mc_next= memlist;
+        memlist= c;
+    }
+    return c;
 }
 
-static int PointerInList(MEMHDR * ptr)
+#ifdef MEMMAN_DEBUG
+static int PointerInArena(MEMHDR * ptr)
 {
-    MEMHDR * p;
-
-    p= memlist;
+    MEMCHUNK * c;
 
-    while (p != NULL)
+    for (c= memlist; c != NULL; c= c->mc_next)
     {
-        if (p == ptr)
+        if ((char *) ptr >= (char *) c + CHUNK_HDR_SIZE && (char *) ptr < c->mc_free)
             return 1;
-
-        p= p->mh_next;
     }
-
     return 0;
 }
+#endif
 
 void * mem_calloc(size_t n, size_t sz)
 {
@@ -89,37 +132,68 @@ void * mem_calloc(size_t n, size_t sz)
 
 void * mem_alloc(size_t size)
 {
+    MEMCHUNK * c;
     MEMHDR * p;
+    size_t n= BLOCK_SIZE(size);
+    size_t k= SIZE_CLASS(size);
 
-    p= malloc(sizeof(MEMHDR) + size);
+    // Use a block of the same size freed earlier if there is one
+    if (k < SMALL_SIZES && freelist[k] != NULL)
+    {
+        p= CLIENT_TO_HDR(freelist[k]);
+        freelist[k]= *(void **) freelist[k];
+        p->mh_size= size;
+        POISON(HDR_TO_CLIENT(p), 0xcd, size);
+        return HDR_TO_CLIENT(p);
+    }
 
-    if (p == NULL)
-        return(NULL);
+    c= memlist;
+
+    if (c == NULL || (size_t) (c->mc_end - c->mc_free) < n)
+    {
+        if ((c= mem_chunk_add(n)) == NULL)
+            return(NULL);
+    }
+
+    p= (MEMHDR *) c->mc_free;
+    p->mh_size= size;
+    p->mh_chunk= c;
+    c->mc_last= (char *) p;
+    c->mc_free += n;
+    POISON(HDR_TO_CLIENT(p), 0xcd, size);
 
-    mem_list_add(p);
     return HDR_TO_CLIENT(p);
 }
 
 void * mem_realloc(void * ptr, size_t size)
 {
-    MEMHDR *p;
+    MEMCHUNK * c;
+    MEMHDR * p;
+    void * q;
 
     if (ptr == NULL)
-        p= NULL;
-    else
-    {
-        p= CLIENT_TO_HDR(ptr);
+        return mem_alloc(size);
+
+    p= CLIENT_TO_HDR(ptr);
+    c= p->mh_chunk;
 
-        mem_list_delete(p);
+    // Grow or shrink the most recent block in place if there is room
+    if ((char *) p == c->mc_last
+        && (size_t) (c->mc_end - (char *) p) >= BLOCK_SIZE(size))
+    {
+        if (size > p->mh_size)
+            POISON((char *) ptr + p->mh_size, 0xcd, size - p->mh_size);
+        p->mh_size= size;
+        c->mc_free= (char *) p + BLOCK_SIZE(size);
+        return ptr;
     }
-    p= (MEMHDR *) realloc(p, sizeof(MEMHDR) + size);
 
-    if (p == NULL)
+    if ((q= mem_alloc(size)) == NULL)
         return(NULL);
 
-    mem_list_add(p);
-
-    return HDR_TO_CLIENT(p);
+    memcpy(q, ptr, (p->mh_size < size) ? p->mh_size : size);
+    mem_free(ptr);
+    return q;
 }
 
 char * mem_strdup(char * str)
@@ -136,27 +210,56 @@ char * mem_strdup(char * str)
 
 void mem_free(void * ptr)
 {
-    MEMHDR *p;
+    MEMCHUNK * c, ** pc;
+    MEMHDR * p;
+    size_t k;
 
     p= CLIENT_TO_HDR(ptr);
-    if (!PointerInList(p))
+#ifdef MEMMAN_DEBUG
+    if (!PointerInArena(p))
     {
         fprintf(stderr, "Error: freeing unallocated memory\n");
         return;
     }
+#endif
+    POISON(ptr, 0xdd, p->mh_size);
+
+    // Only the most recent block in a chunk can be taken back. Other small blocks
+    // are kept for reuse, the rest is released with the arena
+    c= p->mh_chunk;
+    if ((char *) p != c->mc_last)
+    {
+        if ((k= SIZE_CLASS(p->mh_size)) < SMALL_SIZES)
+        {
+            *(void **) ptr= freelist[k];
+            freelist[k]= ptr;
+        }
+        return;
+    }
+
+    c->mc_free= (char *) p;
+    c->mc_last= NULL;
 
-    mem_list_delete(p);
-    free(p);
+    // Release the chunk if it is now empty
+    if (c->mc_free == (char *) c + CHUNK_HDR_SIZE)
+    {
+        for (pc= &memlist; *pc != c; pc= &(*pc)->mc_next);
+        *pc= c->mc_next;
+        free(c);
+    }
 }
 
 void mem_free_all(void)
 {
-    MEMHDR *p;
+    MEMCHUNK *c;
+
+    memset(freelist, 0, sizeof(freelist));
 
     while (memlist != NULL)
     {
-        p = memlist;
-        mem_list_delete(memlist);
-        free(p);
+        c = memlist;
+        memlist= c->mc_next;
+        POISON(c, 0xdd, c->mc_end - (char *) c);
+        free(c);
     }
 }
@@ -19,80 +19,227 @@
  *
  */
 
+/*
+	UTF-8, UTF-16 and UTF-32 conversion
+
+	Notes:
+		The IConvert routines convert a whole buffer in one call, without tables
+		or any per-call setup, so they can be used on every keystroke. They follow
+		the iconv conventions used by the original implementation: the source and
+		target pointers are advanced past the text successfully converted, and the
+		return value is 0 on success, or (size_t)-1 with errno set to EILSEQ (illegal
+		sequence), EINVAL (incomplete sequence at the end of the source) or E2BIG
+		(target full).
+
+		UTF-16 and UTF-32 are in the native byte order of UTF16 and UTF32 units.
+		iconv is only needed for conversions from or to other code pages, through
+		UTFConvert(), and can be left out by defining KMFL_NO_ICONV.
+*/
+
+#include <stddef.h>
+#include <errno.h>
+
+#ifndef KMFL_NO_ICONV
 #include <iconv.h>
+#endif
+
 #include "kmflutfconv.h"
 
+#define UTF_OK			0
+#define UTF_ILLEGAL		EILSEQ
+#define UTF_INCOMPLETE	EINVAL
+#define UTF_FULL		E2BIG
 
-#define UTF8MODE "UTF-8"
-#define UTF16MODE "UTF-16LE"
-#define UTF32MODE "UTF-32LE"
+#define IS_SURROGATE(c)		(((c) & 0xfffff800) == 0xd800)
+#define MAX_CODEPOINT		0x10ffff
 
-size_t UTFConvert (
-		char * sourceCode, char * targetCode,
-		const void ** sourceStart, const void * sourceEnd, 
-		void ** targetStart, void * targetEnd) 
-{		
-	size_t result = 0;
-	char * source = *(char**)sourceStart;
-	char * target = *(char**)targetStart;
-	size_t inbytesleft = (char*)sourceEnd - *(char**)sourceStart;
-	size_t outbytesleft = (char*)targetEnd - *(char**)targetStart;
-	
-	iconv_t ic;
+// Decode one character from UTF-8
+static int decode_utf8(const UTF8 **sp, const UTF8 *se, UTF32 *cp)
+{
+	const UTF8 *s = *sp;
+	UTF32 c = *s, min;
+	int n, i;
 
-	
-	ic=iconv_open(targetCode, sourceCode);
-	
-	while (inbytesleft > 0 && result != (size_t) -1) {
-		result=iconv(ic, &source, &inbytesleft, &target, &outbytesleft);
+	if(c < 0x80)
+	{
+		*cp = c; *sp = s+1;
+		return UTF_OK;
 	}
-	*sourceStart = source;
-	*targetStart = target;
-	
-	iconv_close(ic);
-	
-	return result;
+	else if((c & 0xe0) == 0xc0) { n = 1; c &= 0x1f; min = 0x80; }
+	else if((c & 0xf0) == 0xe0) { n = 2; c &= 0x0f; min = 0x800; }
+	else if((c & 0xf8) == 0xf0) { n = 3; c &= 0x07; min = 0x10000; }
+	else return UTF_ILLEGAL;
+
+	for(i=1; i<=n; i++)
+	{
+		if(s+i >= se) return UTF_INCOMPLETE;
+		if((s[i] & 0xc0) != 0x80) return UTF_ILLEGAL;
+		c = (c << 6) | (s[i] & 0x3f);
+	}
+
+	// Reject overlong forms, surrogates and values beyond Unicode
+	if(c < min || c > MAX_CODEPOINT || IS_SURROGATE(c)) return UTF_ILLEGAL;
+
+	*cp = c; *sp = s+n+1;
+	return UTF_OK;
 }
 
-size_t IConvertUTF8toUTF16 (
-		const UTF8** sourceStart, const UTF8* sourceEnd, 
-		UTF16** targetStart, UTF16* targetEnd)
+// Encode one character as UTF-8
+static int encode_utf8(UTF32 c, UTF8 **tp, UTF8 *te)
 {
-	return UTFConvert(UTF8MODE, UTF16MODE, (const void**)sourceStart, (const void *)sourceEnd, (void**)targetStart, (void *)targetEnd);
+	UTF8 *t = *tp;
+
+	if(c < 0x80)
+	{
+		if(t+1 > te) return UTF_FULL;
+		*t++ = (UTF8)c;
+	}
+	else if(c < 0x800)
+	{
+		if(t+2 > te) return UTF_FULL;
+		*t++ = (UTF8)(0xc0 | (c >> 6));
+		*t++ = (UTF8)(0x80 | (c & 0x3f));
+	}
+	else if(c < 0x10000)
+	{
+		if(IS_SURROGATE(c)) return UTF_ILLEGAL;
+		if(t+3 > te) return UTF_FULL;
+		*t++ = (UTF8)(0xe0 | (c >> 12));
+		*t++ = (UTF8)(0x80 | ((c >> 6) & 0x3f));
+		*t++ = (UTF8)(0x80 | (c & 0x3f));
+	}
+	else if(c <= MAX_CODEPOINT)
+	{
+		if(t+4 > te) return UTF_FULL;
+		*t++ = (UTF8)(0xf0 | (c >> 18));
+		*t++ = (UTF8)(0x80 | ((c >> 12) & 0x3f));
+		*t++ = (UTF8)(0x80 | ((c >> 6) & 0x3f));
+		*t++ = (UTF8)(0x80 | (c & 0x3f));
+	}
+	else return UTF_ILLEGAL;
+
+	*tp = t;
+	return UTF_OK;
 }
 
-size_t IConvertUTF16toUTF8 (
-		const UTF16** sourceStart, const UTF16* sourceEnd, 
-		UTF8** targetStart, UTF8* targetEnd)
+// Decode one character from UTF-16
+static int decode_utf16(const UTF16 **sp, const UTF16 *se, UTF32 *cp)
 {
-	return UTFConvert(UTF16MODE, UTF8MODE, (const void**)sourceStart, (const void *)sourceEnd, (void**)targetStart, (void *)targetEnd);
+	const UTF16 *s = *sp;
+	UTF32 c = *s;
+
+	if(IS_SURROGATE(c))
+	{
+		if(c >= 0xdc00) return UTF_ILLEGAL;		// unpaired low surrogate
+		if(s+1 >= se) return UTF_INCOMPLETE;
+		if((s[1] & 0xfc00) != 0xdc00) return UTF_ILLEGAL;
+		c = 0x10000 + ((c - 0xd800) << 10) + (s[1] - 0xdc00);
+		*sp = s+2;
+	}
+	else *sp = s+1;
+
+	*cp = c;
+	return UTF_OK;
 }
-		
-		
-size_t IConvertUTF8toUTF32 (
-		const UTF8** sourceStart, const UTF8* sourceEnd, 
-		UTF32** targetStart, UTF32* targetEnd)
+
+// Encode one character as UTF-16
+static int encode_utf16(UTF32 c, UTF16 **tp, UTF16 *te)
 {
-	return UTFConvert(UTF8MODE, UTF32MODE, (const void**)sourceStart, (const void *)sourceEnd, (void**)targetStart, (void *)targetEnd);
+	UTF16 *t = *tp;
+
+	if(c < 0x10000)
+	{
+		if(IS_SURROGATE(c)) return UTF_ILLEGAL;
+		if(t+1 > te) return UTF_FULL;
+		*t++ = (UTF16)c;
+	}
+	else if(c <= MAX_CODEPOINT)
+	{
+		if(t+2 > te) return UTF_FULL;
+		c -= 0x10000;
+		*t++ = (UTF16)(0xd800 + (c >> 10));
+		*t++ = (UTF16)(0xdc00 + (c & 0x3ff));
+	}
+	else return UTF_ILLEGAL;
+
+	*tp = t;
+	return UTF_OK;
 }
 
-size_t IConvertUTF32toUTF8 (
-		const UTF32** sourceStart, const UTF32* sourceEnd, 
-		UTF8** targetStart, UTF8* targetEnd)
+// Decode one character from UTF-32 (just check that it is valid)
+static int decode_utf32(const UTF32 **sp, const UTF32 *se, UTF32 *cp)
 {
-	return UTFConvert(UTF32MODE, UTF8MODE, (const void**)sourceStart, (const void *)sourceEnd, (void**)targetStart, (void *)targetEnd);
+	UTF32 c = **sp;
+
+	if(c > MAX_CODEPOINT || IS_SURROGATE(c)) return UTF_ILLEGAL;
+	*cp = c; (*sp)++;
+	return UTF_OK;
 }
-		
-size_t IConvertUTF16toUTF32 (
-		const UTF16** sourceStart, const UTF16* sourceEnd, 
-		UTF32** targetStart, UTF32* targetEnd)
+
+// Encode one character as UTF-32
+static int encode_utf32(UTF32 c, UTF32 **tp, UTF32 *te)
 {
-	return UTFConvert(UTF16MODE, UTF32MODE, (const void**)sourceStart, (const void *)sourceEnd, (void**)targetStart, (void *)targetEnd);
+	if(*tp+1 > te) return UTF_FULL;
+	*(*tp)++ = c;
+	return UTF_OK;
 }
 
-size_t IConvertUTF32toUTF16 (
-		const UTF32** sourceStart, const UTF32* sourceEnd, 
-		UTF16** targetStart, UTF16* targetEnd)
+// Convert a buffer, stopping at the first error with the pointers left after the
+// last complete character that was converted
+#define UTF_CONVERTER(name, SRC, decode, DST, encode) \
+size_t name (const SRC** sourceStart, const SRC* sourceEnd, DST** targetStart, DST* targetEnd) \
+{ \
+	const SRC *s = *sourceStart, *s0; \
+	DST *t = *targetStart; \
+	UTF32 c; \
+	int err = UTF_OK; \
+	while(s < sourceEnd) \
+	{ \
+		s0 = s; \
+		if((err = decode(&s, sourceEnd, &c)) != UTF_OK) break; \
+		if((err = encode(c, &t, targetEnd)) != UTF_OK) { s = s0; break; } \
+	} \
+	*sourceStart = s; \
+	*targetStart = t; \
+	if(err == UTF_OK) return 0; \
+	errno = err; \
+	return (size_t)-1; \
+}
+
+UTF_CONVERTER(IConvertUTF8toUTF16, UTF8, decode_utf8, UTF16, encode_utf16)
+UTF_CONVERTER(IConvertUTF16toUTF8, UTF16, decode_utf16, UTF8, encode_utf8)
+UTF_CONVERTER(IConvertUTF8toUTF32, UTF8, decode_utf8, UTF32, encode_utf32)
+UTF_CONVERTER(IConvertUTF32toUTF8, UTF32, decode_utf32, UTF8, encode_utf8)
+UTF_CONVERTER(IConvertUTF16toUTF32, UTF16, decode_utf16, UTF32, encode_utf32)
+UTF_CONVERTER(IConvertUTF32toUTF16, UTF32, decode_utf32, UTF16, encode_utf16)
+
+#ifndef KMFL_NO_ICONV
+// Convert between any two code pages known to iconv (e.g. legacy 8-bit encodings)
+size_t UTFConvert (
+		char * sourceCode, char * targetCode,
+		const void ** sourceStart, const void * sourceEnd,
+		void ** targetStart, void * targetEnd)
 {
-	return UTFConvert(UTF32MODE, UTF16MODE, (const void**)sourceStart, (const void *)sourceEnd, (void**)targetStart, (void *)targetEnd);
+	size_t result = 0;
+	char * source = *(char**)sourceStart;
+	char * target = *(char**)targetStart;
+	size_t inbytesleft = (char*)sourceEnd - *(char**)sourceStart;
+	size_t outbytesleft = (char*)targetEnd - *(char**)targetStart;
+
+	iconv_t ic;
+
+	ic=iconv_open(targetCode, sourceCode);
+	if (ic == (iconv_t)-1)
+		return (size_t)-1;
+
+	while (inbytesleft > 0 && result != (size_t) -1) {
+		result=iconv(ic, &source, &inbytesleft, &target, &outbytesleft);
+	}
+	*sourceStart = source;
+	*targetStart = target;
+
+	iconv_close(ic);
+
+	return result;
 }
+#endif
@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton implementation for Bison's Yacc-like parsers in C
+/* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -36,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -43,135 +45,28 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.3"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
-
-/* Using locations.  */
-#define YYLSP_NEEDED 0
-
-
-
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     TOK_ANY = 258,
-     TOK_ANSI = 259,
-     TOK_AUTHOR = 260,
-     TOK_BEEP = 261,
-     TOK_BITMAP = 262,
-     TOK_BRKT = 263,
-     TOK_CALL = 264,
-     TOK_CAPSFREE = 265,
-     TOK_CAPSOFF = 266,
-     TOK_CAPSON = 267,
-     TOK_COMMA = 268,
-     TOK_CONTEXT = 269,
-     TOK_COPYRIGHT = 270,
-     TOK_CHAR = 271,
-     TOK_DEADKEY = 272,
-     TOK_DOLLAR = 273,
-     TOK_ERROR = 274,
-     TOK_ETHNOLOGUE = 275,
-     TOK_GROUP = 276,
-     TOK_GT = 277,
-     TOK_HOTKEY = 278,
-     TOK_INDEX = 279,
-     TOK_LANGUAGE = 280,
-     TOK_LAYOUT = 281,
-     TOK_MATCH = 282,
-     TOK_MESSAGE = 283,
-     TOK_MNEMONIC = 284,
-     TOK_NOMATCH = 285,
-     TOK_NAME = 286,
-     TOK_NOTANY = 287,
-     TOK_NUL = 288,
-     TOK_NUMBER = 289,
-     TOK_NL = 290,
-     TOK_OUTS = 291,
-     TOK_RAWKEY = 292,
-     TOK_PLUS = 293,
-     TOK_QM = 294,
-     TOK_RTN = 295,
-     TOK_SB = 296,
-     TOK_SHIFT = 297,
-     TOK_STORE = 298,
-     TOK_STOREINSTORE = 299,
-     TOK_SWITCH = 300,
-     TOK_UNICODE = 301,
-     TOK_USE = 302,
-     TOK_USINGKEYS = 303,
-     TOK_UTF = 304,
-     TOK_VERSION = 305,
-     TOK_XKEYSYM = 306
-   };
-#endif
-/* Tokens.  */
-#define TOK_ANY 258
-#define TOK_ANSI 259
-#define TOK_AUTHOR 260
-#define TOK_BEEP 261
-#define TOK_BITMAP 262
-#define TOK_BRKT 263
-#define TOK_CALL 264
-#define TOK_CAPSFREE 265
-#define TOK_CAPSOFF 266
-#define TOK_CAPSON 267
-#define TOK_COMMA 268
-#define TOK_CONTEXT 269
-#define TOK_COPYRIGHT 270
-#define TOK_CHAR 271
-#define TOK_DEADKEY 272
-#define TOK_DOLLAR 273
-#define TOK_ERROR 274
-#define TOK_ETHNOLOGUE 275
-#define TOK_GROUP 276
-#define TOK_GT 277
-#define TOK_HOTKEY 278
-#define TOK_INDEX 279
-#define TOK_LANGUAGE 280
-#define TOK_LAYOUT 281
-#define TOK_MATCH 282
-#define TOK_MESSAGE 283
-#define TOK_MNEMONIC 284
-#define TOK_NOMATCH 285
-#define TOK_NAME 286
-#define TOK_NOTANY 287
-#define TOK_NUL 288
-#define TOK_NUMBER 289
-#define TOK_NL 290
-#define TOK_OUTS 291
-#define TOK_RAWKEY 292
-#define TOK_PLUS 293
-#define TOK_QM 294
-#define TOK_RTN 295
-#define TOK_SB 296
-#define TOK_SHIFT 297
-#define TOK_STORE 298
-#define TOK_STOREINSTORE 299
-#define TOK_SWITCH 300
-#define TOK_UNICODE 301
-#define TOK_USE 302
-#define TOK_USINGKEYS 303
-#define TOK_UTF 304
-#define TOK_VERSION 305
-#define TOK_XKEYSYM 306
-
-
-
-
-/* Copy the first part of user declarations.  */
+#define YYPURE 2
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
 #line 1 "yacc.y"
 
 /* 
@@ -184,92 +79,201 @@
 
 #include "compiler.h"
 
-extern char *fname;			/* Current file name */
-extern int yylex();			/* Reference needed by yacc.c */
-
-int  lineno   = 1;			/* Current line number in file */
-int	 errcount = 0;			/* Count of errors */
+/* The line number and error count are kept in the compiler context (see compiler.h) */
 
-int	 n;						/* Temporary index value */
-GROUP *gp = NULL;			/* Temporary group pointer */
+KMFL_THREAD int	 n;					/* Temporary index value */
+KMFL_THREAD GROUP *gp = NULL;		/* Temporary group pointer */
 
 #define YYDEBUG 1			/* Allow compiler debugging (if yydebug true) */
+#define YYMAXDEPTH 1000000	/* Item lists are right recursive, so allow for long stores */
 
+#line 91 "yacc.c"
 
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 0
-#endif
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 25 "yacc.y"
+#include "yacc.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-	int simple;
-	ITEM number;
-	char *string;
-	ITEM *items;
-	RULE *rule;
-	GROUP *group;
-	}
-/* Line 187 of yacc.c.  */
-#line 230 "yacc.c"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
-# define YYSTYPE_IS_TRIVIAL 1
-#endif
-
-
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_TOK_ANY = 3,                    /* TOK_ANY  */
+  YYSYMBOL_TOK_ANSI = 4,                   /* TOK_ANSI  */
+  YYSYMBOL_TOK_AUTHOR = 5,                 /* TOK_AUTHOR  */
+  YYSYMBOL_TOK_BEEP = 6,                   /* TOK_BEEP  */
+  YYSYMBOL_TOK_BITMAP = 7,                 /* TOK_BITMAP  */
+  YYSYMBOL_TOK_BRKT = 8,                   /* TOK_BRKT  */
+  YYSYMBOL_TOK_CALL = 9,                   /* TOK_CALL  */
+  YYSYMBOL_TOK_CAPSFREE = 10,              /* TOK_CAPSFREE  */
+  YYSYMBOL_TOK_CAPSOFF = 11,               /* TOK_CAPSOFF  */
+  YYSYMBOL_TOK_CAPSON = 12,                /* TOK_CAPSON  */
+  YYSYMBOL_TOK_COMMA = 13,                 /* TOK_COMMA  */
+  YYSYMBOL_TOK_CONTEXT = 14,               /* TOK_CONTEXT  */
+  YYSYMBOL_TOK_COPYRIGHT = 15,             /* TOK_COPYRIGHT  */
+  YYSYMBOL_TOK_CHAR = 16,                  /* TOK_CHAR  */
+  YYSYMBOL_TOK_DEADKEY = 17,               /* TOK_DEADKEY  */
+  YYSYMBOL_TOK_DOLLAR = 18,                /* TOK_DOLLAR  */
+  YYSYMBOL_TOK_ERROR = 19,                 /* TOK_ERROR  */
+  YYSYMBOL_TOK_ETHNOLOGUE = 20,            /* TOK_ETHNOLOGUE  */
+  YYSYMBOL_TOK_GROUP = 21,                 /* TOK_GROUP  */
+  YYSYMBOL_TOK_GT = 22,                    /* TOK_GT  */
+  YYSYMBOL_TOK_HOTKEY = 23,                /* TOK_HOTKEY  */
+  YYSYMBOL_TOK_INDEX = 24,                 /* TOK_INDEX  */
+  YYSYMBOL_TOK_LANGUAGE = 25,              /* TOK_LANGUAGE  */
+  YYSYMBOL_TOK_LAYOUT = 26,                /* TOK_LAYOUT  */
+  YYSYMBOL_TOK_MATCH = 27,                 /* TOK_MATCH  */
+  YYSYMBOL_TOK_MESSAGE = 28,               /* TOK_MESSAGE  */
+  YYSYMBOL_TOK_MNEMONIC = 29,              /* TOK_MNEMONIC  */
+  YYSYMBOL_TOK_NOMATCH = 30,               /* TOK_NOMATCH  */
+  YYSYMBOL_TOK_NAME = 31,                  /* TOK_NAME  */
+  YYSYMBOL_TOK_NOTANY = 32,                /* TOK_NOTANY  */
+  YYSYMBOL_TOK_NUL = 33,                   /* TOK_NUL  */
+  YYSYMBOL_TOK_NUMBER = 34,                /* TOK_NUMBER  */
+  YYSYMBOL_TOK_NL = 35,                    /* TOK_NL  */
+  YYSYMBOL_TOK_OUTS = 36,                  /* TOK_OUTS  */
+  YYSYMBOL_TOK_RAWKEY = 37,                /* TOK_RAWKEY  */
+  YYSYMBOL_TOK_PLUS = 38,                  /* TOK_PLUS  */
+  YYSYMBOL_TOK_QM = 39,                    /* TOK_QM  */
+  YYSYMBOL_TOK_RTN = 40,                   /* TOK_RTN  */
+  YYSYMBOL_TOK_SB = 41,                    /* TOK_SB  */
+  YYSYMBOL_TOK_SHIFT = 42,                 /* TOK_SHIFT  */
+  YYSYMBOL_TOK_STORE = 43,                 /* TOK_STORE  */
+  YYSYMBOL_TOK_STOREINSTORE = 44,          /* TOK_STOREINSTORE  */
+  YYSYMBOL_TOK_SWITCH = 45,                /* TOK_SWITCH  */
+  YYSYMBOL_TOK_UNICODE = 46,               /* TOK_UNICODE  */
+  YYSYMBOL_TOK_USE = 47,                   /* TOK_USE  */
+  YYSYMBOL_TOK_USINGKEYS = 48,             /* TOK_USINGKEYS  */
+  YYSYMBOL_TOK_UTF = 49,                   /* TOK_UTF  */
+  YYSYMBOL_TOK_VERSION = 50,               /* TOK_VERSION  */
+  YYSYMBOL_TOK_XKEYSYM = 51,               /* TOK_XKEYSYM  */
+  YYSYMBOL_YYACCEPT = 52,                  /* $accept  */
+  YYSYMBOL_T_FILE = 53,                    /* T_FILE  */
+  YYSYMBOL_T_HEADER = 54,                  /* T_HEADER  */
+  YYSYMBOL_T_HEADLINE = 55,                /* T_HEADLINE  */
+  YYSYMBOL_T_GROUPS = 56,                  /* T_GROUPS  */
+  YYSYMBOL_T_GROUP = 57,                   /* T_GROUP  */
+  YYSYMBOL_T_GHEADER = 58,                 /* T_GHEADER  */
+  YYSYMBOL_T_RULES = 59,                   /* T_RULES  */
+  YYSYMBOL_T_RULELINE = 60,                /* T_RULELINE  */
+  YYSYMBOL_T_ITEMS = 61,                   /* T_ITEMS  */
+  YYSYMBOL_T_ITEM = 62,                    /* T_ITEM  */
+  YYSYMBOL_T_STRING = 63,                  /* T_STRING  */
+  YYSYMBOL_T_PARAMETER = 64,               /* T_PARAMETER  */
+  YYSYMBOL_T_KEYDEF = 65,                  /* T_KEYDEF  */
+  YYSYMBOL_T_KEYMODS = 66,                 /* T_KEYMODS  */
+  YYSYMBOL_T_BYTES = 67                    /* T_BYTES  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Copy the second part of user declarations.  */
 
 
-/* Line 216 of yacc.c.  */
-#line 243 "yacc.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
 typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef short int yytype_int8;
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -277,55 +281,106 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
-# if YYENABLE_NLS
+# if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int i)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (i)
-    int i;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return i;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
 #endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -342,11 +397,11 @@ YYID (i)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#     ifndef _STDLIB_H
-#      define _STDLIB_H 1
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
 #     endif
 #    endif
 #   endif
@@ -354,8 +409,8 @@ YYID (i)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -369,88 +424,89 @@ YYID (i)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
 #   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
 #  endif
-#  if (defined __cplusplus && ! defined _STDLIB_H \
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#   ifndef _STDLIB_H
-#    define _STDLIB_H 1
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
 #   endif
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss;
-  YYSTYPE yyvs;
-  };
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
-/* Copy COUNT objects from FROM to TO.  The source and destination do
-   not overlap.  */
-# ifndef YYCOPY
-#  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
-#  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
-#  endif
-# endif
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack)					\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack, Stack, yysize);				\
-	Stack = &yyptr->Stack;						\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  75
 /* YYLAST -- Last index in YYTABLE.  */
@@ -462,18 +518,23 @@ union yyalloc
 #define YYNNTS  16
 /* YYNRULES -- Number of rules.  */
 #define YYNRULES  79
-/* YYNRULES -- Number of states.  */
+/* YYNSTATES -- Number of states.  */
 #define YYNSTATES  160
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   306
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -509,160 +570,66 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint16 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     6,     8,    10,    13,    17,    21,    27,
-      31,    35,    39,    43,    47,    51,    55,    59,    63,    67,
-      70,    73,    76,    81,    87,    93,   101,   105,   109,   113,
-     117,   119,   121,   124,   126,   129,   133,   138,   140,   143,
-     148,   153,   155,   157,   159,   162,   165,   167,   171,   173,
-     176,   179,   182,   185,   187,   194,   199,   201,   203,   205,
-     210,   213,   215,   217,   220,   223,   226,   228,   232,   235,
-     239,   241,   244,   247,   249,   252,   254,   257,   259,   261
+       0,   115,   115,   121,   130,   131,   135,   139,   143,   147,
+     151,   155,   159,   163,   167,   171,   175,   179,   183,   187,
+     191,   195,   199,   203,   207,   211,   216,   220,   224,   228,
+     229,   233,   237,   244,   251,   262,   268,   276,   280,   287,
+     291,   295,   302,   306,   310,   314,   321,   325,   329,   333,
+     345,   357,   369,   373,   377,   389,   394,   398,   402,   406,
+     410,   414,   418,   422,   427,   432,   446,   453,   458,   465,
+     472,   477,   482,   486,   490,   494,   501,   505,   512,   516
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      53,     0,    -1,    54,    56,    -1,    56,    -1,    55,    -1,
-      55,    54,    -1,    31,    67,    35,    -1,    31,    63,    35,
-      -1,    23,    41,    65,    41,    35,    -1,    23,    63,    35,
-      -1,    50,    67,    35,    -1,    50,    63,    35,    -1,     7,
-      67,    35,    -1,     7,    63,    35,    -1,    15,    63,    35,
-      -1,    28,    63,    35,    -1,    25,    61,    35,    -1,    26,
-      63,    35,    -1,    26,    67,    35,    -1,    11,    35,    -1,
-      12,    35,    -1,    10,    35,    -1,    43,    64,    61,    35,
-      -1,     4,    22,    47,    64,    35,    -1,    46,    22,    47,
-      64,    35,    -1,     4,    22,    47,    64,    47,    64,    35,
-      -1,     5,    63,    35,    -1,    29,    63,    35,    -1,    20,
-      63,    35,    -1,    19,    67,    35,    -1,    35,    -1,    57,
-      -1,    57,    56,    -1,    58,    -1,    58,    59,    -1,    21,
-      64,    35,    -1,    21,    64,    48,    35,    -1,    60,    -1,
-      60,    59,    -1,    61,    22,    61,    35,    -1,    43,    64,
-      61,    35,    -1,    35,    -1,    62,    -1,    63,    -1,    62,
-      61,    -1,    63,    61,    -1,    34,    -1,    41,    65,    41,
-      -1,    38,    -1,     3,    64,    -1,    32,    64,    -1,    36,
-      64,    -1,    17,    64,    -1,    33,    -1,    24,     8,    67,
-      13,    67,     8,    -1,    24,     8,    67,     8,    -1,    40,
-      -1,     6,    -1,    14,    -1,    14,     8,    67,     8,    -1,
-      47,    64,    -1,    27,    -1,    30,    -1,     9,    64,    -1,
-      45,    64,    -1,    18,    67,    -1,    19,    -1,    39,    67,
-      39,    -1,    39,    39,    -1,     8,    67,     8,    -1,    63,
-      -1,    66,    63,    -1,    66,    37,    -1,    37,    -1,    66,
-      51,    -1,    51,    -1,    66,    42,    -1,    42,    -1,    16,
-      -1,    16,    67,    -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
-{
-       0,   102,   102,   108,   117,   118,   122,   126,   130,   134,
-     138,   142,   146,   150,   154,   158,   162,   166,   170,   174,
-     178,   182,   186,   190,   194,   198,   203,   207,   211,   215,
-     216,   220,   224,   231,   238,   249,   255,   263,   267,   274,
-     278,   282,   289,   293,   297,   301,   308,   312,   316,   320,
-     332,   344,   356,   360,   364,   376,   381,   385,   389,   393,
-     397,   401,   405,   409,   414,   419,   433,   440,   445,   452,
-     459,   464,   469,   473,   477,   481,   488,   492,   499,   503
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "TOK_ANY", "TOK_ANSI", "TOK_AUTHOR",
-  "TOK_BEEP", "TOK_BITMAP", "TOK_BRKT", "TOK_CALL", "TOK_CAPSFREE",
-  "TOK_CAPSOFF", "TOK_CAPSON", "TOK_COMMA", "TOK_CONTEXT", "TOK_COPYRIGHT",
-  "TOK_CHAR", "TOK_DEADKEY", "TOK_DOLLAR", "TOK_ERROR", "TOK_ETHNOLOGUE",
-  "TOK_GROUP", "TOK_GT", "TOK_HOTKEY", "TOK_INDEX", "TOK_LANGUAGE",
-  "TOK_LAYOUT", "TOK_MATCH", "TOK_MESSAGE", "TOK_MNEMONIC", "TOK_NOMATCH",
-  "TOK_NAME", "TOK_NOTANY", "TOK_NUL", "TOK_NUMBER", "TOK_NL", "TOK_OUTS",
-  "TOK_RAWKEY", "TOK_PLUS", "TOK_QM", "TOK_RTN", "TOK_SB", "TOK_SHIFT",
-  "TOK_STORE", "TOK_STOREINSTORE", "TOK_SWITCH", "TOK_UNICODE", "TOK_USE",
-  "TOK_USINGKEYS", "TOK_UTF", "TOK_VERSION", "TOK_XKEYSYM", "$accept",
-  "T_FILE", "T_HEADER", "T_HEADLINE", "T_GROUPS", "T_GROUP", "T_GHEADER",
-  "T_RULES", "T_RULELINE", "T_ITEMS", "T_ITEM", "T_STRING", "T_PARAMETER",
-  "T_KEYDEF", "T_KEYMODS", "T_BYTES", 0
+  "\"end of file\"", "error", "\"invalid token\"", "TOK_ANY", "TOK_ANSI",
+  "TOK_AUTHOR", "TOK_BEEP", "TOK_BITMAP", "TOK_BRKT", "TOK_CALL",
+  "TOK_CAPSFREE", "TOK_CAPSOFF", "TOK_CAPSON", "TOK_COMMA", "TOK_CONTEXT",
+  "TOK_COPYRIGHT", "TOK_CHAR", "TOK_DEADKEY", "TOK_DOLLAR", "TOK_ERROR",
+  "TOK_ETHNOLOGUE", "TOK_GROUP", "TOK_GT", "TOK_HOTKEY", "TOK_INDEX",
+  "TOK_LANGUAGE", "TOK_LAYOUT", "TOK_MATCH", "TOK_MESSAGE", "TOK_MNEMONIC",
+  "TOK_NOMATCH", "TOK_NAME", "TOK_NOTANY", "TOK_NUL", "TOK_NUMBER",
+  "TOK_NL", "TOK_OUTS", "TOK_RAWKEY", "TOK_PLUS", "TOK_QM", "TOK_RTN",
+  "TOK_SB", "TOK_SHIFT", "TOK_STORE", "TOK_STOREINSTORE", "TOK_SWITCH",
+  "TOK_UNICODE", "TOK_USE", "TOK_USINGKEYS", "TOK_UTF", "TOK_VERSION",
+  "TOK_XKEYSYM", "$accept", "T_FILE", "T_HEADER", "T_HEADLINE", "T_GROUPS",
+  "T_GROUP", "T_GHEADER", "T_RULES", "T_RULELINE", "T_ITEMS", "T_ITEM",
+  "T_STRING", "T_PARAMETER", "T_KEYDEF", "T_KEYMODS", "T_BYTES", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299,   300,   301,   302,   303,   304,
-     305,   306
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
-{
-       0,    52,    53,    53,    54,    54,    55,    55,    55,    55,
-      55,    55,    55,    55,    55,    55,    55,    55,    55,    55,
-      55,    55,    55,    55,    55,    55,    55,    55,    55,    55,
-      55,    56,    56,    57,    57,    58,    58,    59,    59,    60,
-      60,    60,    61,    61,    61,    61,    62,    62,    62,    62,
-      62,    62,    62,    62,    62,    62,    62,    62,    62,    62,
-      62,    62,    62,    62,    62,    62,    62,    63,    63,    64,
-      65,    65,    65,    65,    65,    65,    66,    66,    67,    67
-};
+#define YYPACT_NINF (-33)
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
-{
-       0,     2,     2,     1,     1,     2,     3,     3,     5,     3,
-       3,     3,     3,     3,     3,     3,     3,     3,     3,     2,
-       2,     2,     4,     5,     5,     7,     3,     3,     3,     3,
-       1,     1,     2,     1,     2,     3,     4,     1,     2,     4,
-       4,     1,     1,     1,     2,     2,     1,     3,     1,     2,
-       2,     2,     2,     1,     6,     4,     1,     1,     1,     4,
-       2,     1,     1,     2,     2,     2,     1,     3,     2,     3,
-       1,     2,     2,     1,     2,     1,     2,     1,     1,     2
-};
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-/* YYDEFACT[STATE-NAME] -- Default rule to reduce with in state
-   STATE-NUM when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
-{
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,    30,     0,     0,
-       0,     0,     0,     4,     3,    31,    33,     0,     0,     0,
-      78,     0,     0,    21,    19,    20,     0,     0,     0,     0,
-       0,     0,     0,     0,    57,     0,    58,     0,     0,    66,
-       0,    61,    62,     0,    53,    46,     0,    48,    56,     0,
-       0,     0,     0,    42,    43,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     1,     2,     5,    32,    41,
-       0,    34,    37,     0,     0,    68,     0,    26,    79,    13,
-      12,    14,    29,    28,     0,    35,     0,    73,    77,    75,
-      70,     0,     0,     9,    49,    63,     0,    52,    65,     0,
-      50,    51,     0,    64,    60,    16,    44,    45,    17,    18,
-      15,    27,     7,     6,     0,     0,    11,    10,     0,    38,
-       0,     0,    67,    69,    36,     0,    72,    76,    74,    71,
-       0,     0,    47,    22,     0,     0,     0,    23,     0,     8,
-      59,    55,     0,    24,    40,    39,     0,     0,    25,    54
-};
+#define YYTABLE_NINF (-1)
 
-/* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] =
-{
-      -1,    21,    22,    23,    24,    25,    26,    81,    82,    83,
-      63,    64,    40,   101,   102,    32
-};
+#define yytable_value_is_error(Yyn) \
+  0
 
 /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
    STATE-NUM.  */
-#define YYPACT_NINF -33
 static const yytype_int16 yypact[] =
 {
      117,   -16,   -22,   -12,   -28,   -21,     2,   -22,    25,   -22,
@@ -683,6 +650,29 @@ static const yytype_int16 yypact[] =
      -33,   -33,    25,   -33,   -33,   -33,    65,    81,   -33,   -33
 };
 
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    30,     0,     0,
+       0,     0,     0,     4,     3,    31,    33,     0,     0,     0,
+      78,     0,     0,    21,    19,    20,     0,     0,     0,     0,
+       0,     0,     0,     0,    57,     0,    58,     0,     0,    66,
+       0,    61,    62,     0,    53,    46,     0,    48,    56,     0,
+       0,     0,     0,    42,    43,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     1,     2,     5,    32,    41,
+       0,    34,    37,     0,     0,    68,     0,    26,    79,    13,
+      12,    14,    29,    28,     0,    35,     0,    73,    77,    75,
+      70,     0,     0,     9,    49,    63,     0,    52,    65,     0,
+      50,    51,     0,    64,    60,    16,    44,    45,    17,    18,
+      15,    27,     7,     6,     0,     0,    11,    10,     0,    38,
+       0,     0,    67,    69,    36,     0,    72,    76,    74,    71,
+       0,     0,    47,    22,     0,     0,     0,    23,     0,     8,
+      59,    55,     0,    24,    40,    39,     0,     0,    25,    54
+};
+
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
@@ -690,11 +680,16 @@ static const yytype_int8 yypgoto[] =
      -33,    55,   -17,    56,   -33,    -8
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If zero, do what YYDEFACT says.
-   If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,    21,    22,    23,    24,    25,    26,    81,    82,    83,
+      63,    64,    40,   101,   102,    32
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
       37,    71,    62,   147,    30,    66,    27,    33,    70,    30,
@@ -759,9 +754,9 @@ static const yytype_int16 yycheck[] =
       -1,    -1,    45,    -1,    47
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     4,     5,     7,    10,    11,    12,    15,    19,    20,
       21,    23,    25,    26,    28,    29,    31,    35,    43,    46,
@@ -781,95 +776,67 @@ static const yytype_uint8 yystos[] =
        8,     8,    13,    35,    35,    35,    64,    67,    35,     8
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
-
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
-
-
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    52,    53,    53,    54,    54,    55,    55,    55,    55,
+      55,    55,    55,    55,    55,    55,    55,    55,    55,    55,
+      55,    55,    55,    55,    55,    55,    55,    55,    55,    55,
+      55,    56,    56,    57,    57,    58,    58,    59,    59,    60,
+      60,    60,    61,    61,    61,    61,    62,    62,    62,    62,
+      62,    62,    62,    62,    62,    62,    62,    62,    62,    62,
+      62,    62,    62,    62,    62,    62,    62,    63,    63,    64,
+      65,    65,    65,    65,    65,    65,    66,    66,    67,    67
+};
 
-#define YYFAIL		goto yyerrlab
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     2,     1,     1,     2,     3,     3,     5,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     2,
+       2,     2,     4,     5,     5,     7,     3,     3,     3,     3,
+       1,     1,     2,     1,     2,     3,     4,     1,     2,     4,
+       4,     1,     1,     1,     2,     2,     1,     3,     1,     2,
+       2,     2,     2,     1,     6,     4,     1,     1,     1,     4,
+       2,     1,     1,     2,     2,     2,     1,     3,     2,     3,
+       1,     2,     2,     1,     2,     1,     2,     1,     1,     2
+};
 
-#define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      yytoken = YYTRANSLATE (yychar);				\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
-   If N is 0, then set CURRENT to the empty location which ends
-   the previous symbol: RHS[0] (always defined).  */
-
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
-#ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
+enum { YYENOMEM = -2 };
 
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
-   This macro was not mandated originally: define only if we know
-   we won't break user code: when these are the locations we know.  */
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
-#ifndef YY_LOCATION_PRINT
-# if YYLTYPE_IS_TRIVIAL
-#  define YY_LOCATION_PRINT(File, Loc)			\
-     fprintf (File, "%d.%d-%d.%d",			\
-	      (Loc).first_line, (Loc).first_column,	\
-	      (Loc).last_line,  (Loc).last_column)
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
 
+#define YYRECOVERING()  (!!yyerrstatus)
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (scanner, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -879,80 +846,59 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, scanner); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, yyscan_t scanner)
 {
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (scanner);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
-static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, yyscan_t scanner)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, scanner);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -960,80 +906,68 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_stack_print (yytype_int16 *bottom, yytype_int16 *top)
-#else
-static void
-yy_stack_print (bottom, top)
-    yytype_int16 *bottom;
-    yytype_int16 *top;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
-  for (; bottom <= top; ++bottom)
-    YYFPRINTF (stderr, " %d", *bottom);
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, yyscan_t scanner)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
-      fprintf (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
-      fprintf (stderr, "\n");
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], scanner);
+      YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, scanner); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -1048,277 +982,32 @@ int yydebug;
 # define YYMAXDEPTH 10000
 #endif
 
-
 
-#if YYERROR_VERBOSE
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into YYRESULT an error message about the unexpected token
-   YYCHAR while in state YYSTATE.  Return the number of bytes copied,
-   including the terminating null byte.  If YYRESULT is null, do not
-   copy anything; just return the number of bytes that would be
-   copied.  As a special case, return 0 if an ordinary "syntax error"
-   message will do.  Return YYSIZE_MAXIMUM if overflow occurs during
-   size calculation.  */
-static YYSIZE_T
-yysyntax_error (char *yyresult, int yystate, int yychar)
-{
-  int yyn = yypact[yystate];
-
-  if (! (YYPACT_NINF < yyn && yyn <= YYLAST))
-    return 0;
-  else
-    {
-      int yytype = YYTRANSLATE (yychar);
-      YYSIZE_T yysize0 = yytnamerr (0, yytname[yytype]);
-      YYSIZE_T yysize = yysize0;
-      YYSIZE_T yysize1;
-      int yysize_overflow = 0;
-      enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-      char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-      int yyx;
-
-# if 0
-      /* This is so xgettext sees the translatable formats that are
-	 constructed on the fly.  */
-      YY_("syntax error, unexpected %s");
-      YY_("syntax error, unexpected %s, expecting %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s");
-# endif
-      char *yyfmt;
-      char const *yyf;
-      static char const yyunexpected[] = "syntax error, unexpected %s";
-      static char const yyexpecting[] = ", expecting %s";
-      static char const yyor[] = " or %s";
-      char yyformat[sizeof yyunexpected
-		    + sizeof yyexpecting - 1
-		    + ((YYERROR_VERBOSE_ARGS_MAXIMUM - 2)
-		       * (sizeof yyor - 1))];
-      char const *yyprefix = yyexpecting;
-
-      /* Start YYX at -YYN if negative to avoid negative indexes in
-	 YYCHECK.  */
-      int yyxbegin = yyn < 0 ? -yyn : 0;
-
-      /* Stay within bounds of both yycheck and yytname.  */
-      int yychecklim = YYLAST - yyn + 1;
-      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-      int yycount = 1;
-
-      yyarg[0] = yytname[yytype];
-      yyfmt = yystpcpy (yyformat, yyunexpected);
-
-      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-	if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR)
-	  {
-	    if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-	      {
-		yycount = 1;
-		yysize = yysize0;
-		yyformat[sizeof yyunexpected - 1] = '\0';
-		break;
-	      }
-	    yyarg[yycount++] = yytname[yyx];
-	    yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-	    yysize_overflow |= (yysize1 < yysize);
-	    yysize = yysize1;
-	    yyfmt = yystpcpy (yyfmt, yyprefix);
-	    yyprefix = yyor;
-	  }
-
-      yyf = YY_(yyformat);
-      yysize1 = yysize + yystrlen (yyf);
-      yysize_overflow |= (yysize1 < yysize);
-      yysize = yysize1;
-
-      if (yysize_overflow)
-	return YYSIZE_MAXIMUM;
-
-      if (yyresult)
-	{
-	  /* Avoid sprintf, as that infringes on the user's name space.
-	     Don't have undefined behavior even if the translation
-	     produced a string with the wrong number of "%s"s.  */
-	  char *yyp = yyresult;
-	  int yyi = 0;
-	  while ((*yyp = *yyf) != '\0')
-	    {
-	      if (*yyp == '%' && yyf[1] == 's' && yyi < yycount)
-		{
-		  yyp += yytnamerr (yyp, yyarg[yyi++]);
-		  yyf += 2;
-		}
-	      else
-		{
-		  yyp++;
-		  yyf++;
-		}
-	    }
-	}
-      return yysize;
-    }
-}
-#endif /* YYERROR_VERBOSE */
-
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
-static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, yyscan_t scanner)
 {
-  YYUSE (yyvaluep);
-
+  YY_USE (yyvaluep);
+  YY_USE (scanner);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
-
-  switch (yytype)
-    {
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
-
-
-/* Prevent warnings from -Wmissing-prototypes.  */
-
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
 
 
 
-/* The look-ahead symbol.  */
-int yychar;
-
-/* The semantic value of the look-ahead symbol.  */
-YYSTYPE yylval;
-
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 
@@ -1326,200 +1015,193 @@ int yynerrs;
 | yyparse.  |
 `----------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 int
-yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
+yyparse (yyscan_t scanner)
 {
-  
-  int yystate;
-  int yyn;
-  int yyresult;
-  /* Number of tokens to shift before error messages enabled.  */
-  int yyerrstatus;
-  /* Look-ahead token as an internal (translated) token number.  */
-  int yytoken = 0;
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+/* Lookahead token kind.  */
+int yychar;
 
-  /* Three stacks and their tools:
-     `yyss': related to states,
-     `yyvs': related to semantic values,
-     `yyls': related to locations.
 
-     Refer to the stacks thru separate pointers, to allow yyoverflow
-     to reallocate them elsewhere.  */
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
-  /* The state stack.  */
-  yytype_int16 yyssa[YYINITDEPTH];
-  yytype_int16 *yyss = yyssa;
-  yytype_int16 *yyssp;
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
 
-  /* The semantic value stack.  */
-  YYSTYPE yyvsa[YYINITDEPTH];
-  YYSTYPE *yyvs = yyvsa;
-  YYSTYPE *yyvsp;
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
 
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
 
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-  YYSIZE_T yystacksize = YYINITDEPTH;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
 
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
-  yychar = YYEMPTY;		/* Cause a token to be read.  */
-
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
-
-  yyssp = yyss;
-  yyvsp = yyvs;
+  yychar = YYEMPTY; /* Cause a token to be read.  */
 
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss);
-	YYSTACK_RELOCATE (yyvs);
-
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
-     look-ahead token if we need one and don't already have one.  */
+     lookahead token if we need one and don't already have one.  */
 
-  /* First try to decide what to do without reference to look-ahead token.  */
+  /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yyn == YYPACT_NINF)
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
-  /* Not known => get a look-ahead token if don't already have one.  */
+  /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid look-ahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex (&yylval, scanner);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1534,30 +1216,26 @@ yybackup:
   yyn = yytable[yyn];
   if (yyn <= 0)
     {
-      if (yyn == 0 || yyn == YYTABLE_NINF)
-	goto yyerrlab;
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
       yyn = -yyn;
       goto yyreduce;
     }
 
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
   /* Count tokens shifted since error; after three, turn off error
      status.  */
   if (yyerrstatus)
     yyerrstatus--;
 
-  /* Shift the look-ahead token.  */
+  /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token unless it is eof.  */
-  if (yychar != YYEOF)
-    yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1572,14 +1250,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1592,473 +1270,532 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 103 "yacc.y"
-    {
-		kbp->groups = (yyvsp[(2) - (2)].group);
-		kbp->ngroups = count_groups((yyvsp[(2) - (2)].group));
-		kbp->nstores = count_stores(kbp->stores);
+  case 2: /* T_FILE: T_HEADER T_GROUPS  */
+#line 116 "yacc.y"
+        {
+		kmflcomp_ctx->keyboard.groups = (yyvsp[0].group);
+		kmflcomp_ctx->keyboard.ngroups = count_groups((yyvsp[0].group));
+		kmflcomp_ctx->keyboard.nstores = count_stores(kmflcomp_ctx->keyboard.stores);
 	}
+#line 1281 "yacc.c"
     break;
 
-  case 3:
-#line 109 "yacc.y"
-    {
-		kbp->groups = (yyvsp[(1) - (1)].group);
-		kbp->ngroups = count_groups((yyvsp[(1) - (1)].group));
-		kbp->nstores = count_stores(kbp->stores);
+  case 3: /* T_FILE: T_GROUPS  */
+#line 122 "yacc.y"
+        {
+		kmflcomp_ctx->keyboard.groups = (yyvsp[0].group);
+		kmflcomp_ctx->keyboard.ngroups = count_groups((yyvsp[0].group));
+		kmflcomp_ctx->keyboard.nstores = count_stores(kmflcomp_ctx->keyboard.stores);
 	}
+#line 1291 "yacc.c"
     break;
 
-  case 6:
-#line 123 "yacc.y"
-    {
-		new_store_from_string("&name",(yyvsp[(2) - (3)].string),lineno);
+  case 6: /* T_HEADLINE: TOK_NAME T_BYTES TOK_NL  */
+#line 136 "yacc.y"
+        {
+		new_store_from_string("&name",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1299 "yacc.c"
     break;
 
-  case 7:
-#line 127 "yacc.y"
-    {
-		new_store_from_string("&name",(yyvsp[(2) - (3)].string),lineno);
+  case 7: /* T_HEADLINE: TOK_NAME T_STRING TOK_NL  */
+#line 140 "yacc.y"
+        {
+		new_store_from_string("&name",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1307 "yacc.c"
     break;
 
-  case 8:
-#line 131 "yacc.y"
-    {
-		new_store("&hotkey",new_list((yyvsp[(3) - (5)].number)),lineno);
+  case 8: /* T_HEADLINE: TOK_HOTKEY TOK_SB T_KEYDEF TOK_SB TOK_NL  */
+#line 144 "yacc.y"
+        {
+		new_store("&hotkey",list_items(new_list((yyvsp[-2].number))),kmflcomp_ctx->lineno);
 	}
+#line 1315 "yacc.c"
     break;
 
-  case 9:
-#line 135 "yacc.y"
-    {
-		new_store_from_string("&hotkey",(yyvsp[(2) - (3)].string),lineno);
+  case 9: /* T_HEADLINE: TOK_HOTKEY T_STRING TOK_NL  */
+#line 148 "yacc.y"
+        {
+		new_store_from_string("&hotkey",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1323 "yacc.c"
     break;
 
-  case 10:
-#line 139 "yacc.y"
-    {
-		new_store_from_string("&version",(yyvsp[(2) - (3)].string),lineno);
+  case 10: /* T_HEADLINE: TOK_VERSION T_BYTES TOK_NL  */
+#line 152 "yacc.y"
+        {
+		new_store_from_string("&version",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1331 "yacc.c"
     break;
 
-  case 11:
-#line 143 "yacc.y"
-    {
-		new_store_from_string("&version",(yyvsp[(2) - (3)].string),lineno);
+  case 11: /* T_HEADLINE: TOK_VERSION T_STRING TOK_NL  */
+#line 156 "yacc.y"
+        {
+		new_store_from_string("&version",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1339 "yacc.c"
     break;
 
-  case 12:
-#line 147 "yacc.y"
-    { 
-		new_store_from_string("&bitmap",(yyvsp[(2) - (3)].string),lineno);
+  case 12: /* T_HEADLINE: TOK_BITMAP T_BYTES TOK_NL  */
+#line 160 "yacc.y"
+        { 
+		new_store_from_string("&bitmap",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1347 "yacc.c"
     break;
 
-  case 13:
-#line 151 "yacc.y"
-    { 
-		new_store_from_string("&bitmap",(yyvsp[(2) - (3)].string),lineno);
+  case 13: /* T_HEADLINE: TOK_BITMAP T_STRING TOK_NL  */
+#line 164 "yacc.y"
+        { 
+		new_store_from_string("&bitmap",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1355 "yacc.c"
     break;
 
-  case 14:
-#line 155 "yacc.y"
-    { 
-		new_store_from_string("&copyright",(yyvsp[(2) - (3)].string),lineno);	
+  case 14: /* T_HEADLINE: TOK_COPYRIGHT T_STRING TOK_NL  */
+#line 168 "yacc.y"
+        { 
+		new_store_from_string("&copyright",(yyvsp[-1].string),kmflcomp_ctx->lineno);	
 	}
+#line 1363 "yacc.c"
     break;
 
-  case 15:
-#line 159 "yacc.y"
-    { 
-		new_store_from_string("&message",(yyvsp[(2) - (3)].string),lineno);
+  case 15: /* T_HEADLINE: TOK_MESSAGE T_STRING TOK_NL  */
+#line 172 "yacc.y"
+        { 
+		new_store_from_string("&message",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1371 "yacc.c"
     break;
 
-  case 16:
-#line 163 "yacc.y"
-    { 
-		new_store_from_string("&language",(yyvsp[(2) - (3)].items),lineno);
+  case 16: /* T_HEADLINE: TOK_LANGUAGE T_ITEMS TOK_NL  */
+#line 176 "yacc.y"
+        { 
+		new_store_from_string("&language",(char *)list_items((yyvsp[-1].items)),kmflcomp_ctx->lineno);
 	}
+#line 1379 "yacc.c"
     break;
 
-  case 17:
-#line 167 "yacc.y"
-    { 
-		new_store_from_string("&layout",(yyvsp[(2) - (3)].string),lineno);
+  case 17: /* T_HEADLINE: TOK_LAYOUT T_STRING TOK_NL  */
+#line 180 "yacc.y"
+        { 
+		new_store_from_string("&layout",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1387 "yacc.c"
     break;
 
-  case 18:
-#line 171 "yacc.y"
-    { 
-		new_store_from_string("&layout",(yyvsp[(2) - (3)].string),lineno);
+  case 18: /* T_HEADLINE: TOK_LAYOUT T_BYTES TOK_NL  */
+#line 184 "yacc.y"
+        { 
+		new_store_from_string("&layout",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1395 "yacc.c"
     break;
 
-  case 19:
-#line 175 "yacc.y"
-    { 
-		new_store_from_string("&capsalwaysoff","1",lineno);
+  case 19: /* T_HEADLINE: TOK_CAPSOFF TOK_NL  */
+#line 188 "yacc.y"
+        { 
+		new_store_from_string("&capsalwaysoff","1",kmflcomp_ctx->lineno);
 	}
+#line 1403 "yacc.c"
     break;
 
-  case 20:
-#line 179 "yacc.y"
-    { 
-		new_store_from_string("&capsononly","1",lineno);
+  case 20: /* T_HEADLINE: TOK_CAPSON TOK_NL  */
+#line 192 "yacc.y"
+        { 
+		new_store_from_string("&capsononly","1",kmflcomp_ctx->lineno);
 	}
+#line 1411 "yacc.c"
     break;
 
-  case 21:
-#line 183 "yacc.y"
-    { 
-		new_store_from_string("&shiftfreescaps","1",lineno);
+  case 21: /* T_HEADLINE: TOK_CAPSFREE TOK_NL  */
+#line 196 "yacc.y"
+        { 
+		new_store_from_string("&shiftfreescaps","1",kmflcomp_ctx->lineno);
 	}
+#line 1419 "yacc.c"
     break;
 
-  case 22:
-#line 187 "yacc.y"
-    {
-		new_store((yyvsp[(2) - (4)].string),(yyvsp[(3) - (4)].items),lineno);
+  case 22: /* T_HEADLINE: TOK_STORE T_PARAMETER T_ITEMS TOK_NL  */
+#line 200 "yacc.y"
+        {
+		new_store((yyvsp[-2].string),list_items((yyvsp[-1].items)),kmflcomp_ctx->lineno);
 	}
+#line 1427 "yacc.c"
     break;
 
-  case 23:
-#line 191 "yacc.y"
-    {
-		set_start_group((yyvsp[(4) - (5)].string),KF_ANSI, lineno);
+  case 23: /* T_HEADLINE: TOK_ANSI TOK_GT TOK_USE T_PARAMETER TOK_NL  */
+#line 204 "yacc.y"
+        {
+		set_start_group((yyvsp[-1].string),KF_ANSI, kmflcomp_ctx->lineno);
 	}
+#line 1435 "yacc.c"
     break;
 
-  case 24:
-#line 195 "yacc.y"
-    {
-		set_start_group((yyvsp[(4) - (5)].string),KF_UNICODE, lineno);
+  case 24: /* T_HEADLINE: TOK_UNICODE TOK_GT TOK_USE T_PARAMETER TOK_NL  */
+#line 208 "yacc.y"
+        {
+		set_start_group((yyvsp[-1].string),KF_UNICODE, kmflcomp_ctx->lineno);
 	}
+#line 1443 "yacc.c"
     break;
 
-  case 25:
-#line 199 "yacc.y"
-    {
-		kmflcomp_error(lineno,"alternate starting groups not supported");
+  case 25: /* T_HEADLINE: TOK_ANSI TOK_GT TOK_USE T_PARAMETER TOK_USE T_PARAMETER TOK_NL  */
+#line 212 "yacc.y"
+        {
+		kmflcomp_error(kmflcomp_ctx->lineno,"alternate starting groups not supported");
 		fail(11,"obsolete syntax");
 	}
+#line 1452 "yacc.c"
     break;
 
-  case 26:
-#line 204 "yacc.y"
-    { 
-		new_store_from_string("&author",(yyvsp[(2) - (3)].string),lineno);
+  case 26: /* T_HEADLINE: TOK_AUTHOR T_STRING TOK_NL  */
+#line 217 "yacc.y"
+        { 
+		new_store_from_string("&author",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1460 "yacc.c"
     break;
 
-  case 27:
-#line 208 "yacc.y"
-    { 
-		new_store_from_string("&mnemoniclayout",(yyvsp[(2) - (3)].string),lineno);
+  case 27: /* T_HEADLINE: TOK_MNEMONIC T_STRING TOK_NL  */
+#line 221 "yacc.y"
+        { 
+		new_store_from_string("&mnemoniclayout",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1468 "yacc.c"
     break;
 
-  case 28:
-#line 212 "yacc.y"
-    { 
-		new_store_from_string("&ethnologuecode",(yyvsp[(2) - (3)].string),lineno);
+  case 28: /* T_HEADLINE: TOK_ETHNOLOGUE T_STRING TOK_NL  */
+#line 225 "yacc.y"
+        { 
+		new_store_from_string("&ethnologuecode",(yyvsp[-1].string),kmflcomp_ctx->lineno);
 	}
+#line 1476 "yacc.c"
     break;
 
-  case 31:
-#line 221 "yacc.y"
-    {
-		(yyval.group) = kbp->groups;
+  case 31: /* T_GROUPS: T_GROUP  */
+#line 234 "yacc.y"
+        {
+		(yyval.group) = kmflcomp_ctx->keyboard.groups;
 	}
+#line 1484 "yacc.c"
     break;
 
-  case 32:
-#line 225 "yacc.y"
-    {
-		(yyval.group) = kbp->groups;
+  case 32: /* T_GROUPS: T_GROUP T_GROUPS  */
+#line 238 "yacc.y"
+        {
+		(yyval.group) = kmflcomp_ctx->keyboard.groups;
 	}
+#line 1492 "yacc.c"
     break;
 
-  case 33:
-#line 232 "yacc.y"
-    {
-		(yyval.group) = (yyvsp[(1) - (1)].group);
+  case 33: /* T_GROUP: T_GHEADER  */
+#line 245 "yacc.y"
+        {
+		(yyval.group) = (yyvsp[0].group);
 		((yyval.group))->rules = NULL;
 		((yyval.group))->nrules = 0;
-		kmflcomp_warn(0,"group(%s) is empty!",((yyvsp[(1) - (1)].group))->name);
+		kmflcomp_warn(0,"group(%s) is empty!",((yyvsp[0].group))->name);
 	}
+#line 1503 "yacc.c"
     break;
 
-  case 34:
-#line 239 "yacc.y"
-    {
-		(yyval.group) = (yyvsp[(1) - (2)].group);
-		((yyval.group))->rules = (yyvsp[(2) - (2)].rule);
-		((yyval.group))->nrules = count_rules((yyvsp[(2) - (2)].rule));
+  case 34: /* T_GROUP: T_GHEADER T_RULES  */
+#line 252 "yacc.y"
+        {
+		(yyval.group) = (yyvsp[-1].group);
+		((yyval.group))->rules = (yyvsp[0].rule);
+		((yyval.group))->nrules = count_rules((yyvsp[0].rule));
 		if(((yyval.group))->nrules == 0) 
-			kmflcomp_warn(0,"group(%s) is empty!",((yyvsp[(1) - (2)].group))->name); 
+			kmflcomp_warn(0,"group(%s) is empty!",((yyvsp[-1].group))->name); 
 	}
+#line 1515 "yacc.c"
     break;
 
-  case 35:
-#line 250 "yacc.y"
-    {
-		(yyval.group) = gp = new_group((yyvsp[(2) - (3)].string), lineno);
-		if(gp) gp->flags = 0;
+  case 35: /* T_GHEADER: TOK_GROUP T_PARAMETER TOK_NL  */
+#line 263 "yacc.y"
+        {
+		(yyval.group) = gp = new_group((yyvsp[-1].string), kmflcomp_ctx->lineno);
+		if(gp) { gp->flags = 0; gp->line = kmflcomp_ctx->lineno; }
 	}
+#line 1524 "yacc.c"
     break;
 
-  case 36:
-#line 256 "yacc.y"
-    {
-		(yyval.group) = gp = new_group((yyvsp[(2) - (4)].string), lineno);
-		if(gp) gp->flags = GF_USEKEYS;
+  case 36: /* T_GHEADER: TOK_GROUP T_PARAMETER TOK_USINGKEYS TOK_NL  */
+#line 269 "yacc.y"
+        {
+		(yyval.group) = gp = new_group((yyvsp[-2].string), kmflcomp_ctx->lineno);
+		if(gp) { gp->flags = GF_USEKEYS; gp->line = kmflcomp_ctx->lineno; }
 	}
+#line 1533 "yacc.c"
     break;
 
-  case 37:
-#line 264 "yacc.y"
-    {
-		(yyval.rule) = (yyvsp[(1) - (1)].rule);
+  case 37: /* T_RULES: T_RULELINE  */
+#line 277 "yacc.y"
+        {
+		(yyval.rule) = (yyvsp[0].rule);
 	}
+#line 1541 "yacc.c"
     break;
 
-  case 38:
-#line 268 "yacc.y"
-    {
-		(yyval.rule) = add_rule((yyvsp[(1) - (2)].rule), (yyvsp[(2) - (2)].rule));
+  case 38: /* T_RULES: T_RULELINE T_RULES  */
+#line 281 "yacc.y"
+        {
+		(yyval.rule) = add_rule((yyvsp[-1].rule), (yyvsp[0].rule));
 	}
+#line 1549 "yacc.c"
     break;
 
-  case 39:
-#line 275 "yacc.y"
-    {
-		(yyval.rule) = new_rule(gp, (yyvsp[(1) - (4)].items), (yyvsp[(3) - (4)].items), lineno);
+  case 39: /* T_RULELINE: T_ITEMS TOK_GT T_ITEMS TOK_NL  */
+#line 288 "yacc.y"
+        {
+		(yyval.rule) = new_rule(gp, list_items((yyvsp[-3].items)), list_items((yyvsp[-1].items)), kmflcomp_ctx->lineno);
 	}
+#line 1557 "yacc.c"
     break;
 
-  case 40:
-#line 279 "yacc.y"
-    {
-		new_store((yyvsp[(2) - (4)].string),(yyvsp[(3) - (4)].items),lineno); (yyval.rule) = NULL;
+  case 40: /* T_RULELINE: TOK_STORE T_PARAMETER T_ITEMS TOK_NL  */
+#line 292 "yacc.y"
+        {
+		new_store((yyvsp[-2].string),list_items((yyvsp[-1].items)),kmflcomp_ctx->lineno); (yyval.rule) = NULL;
 	}
+#line 1565 "yacc.c"
     break;
 
-  case 41:
-#line 283 "yacc.y"
-    {
+  case 41: /* T_RULELINE: TOK_NL  */
+#line 296 "yacc.y"
+        {
 		(yyval.rule) = NULL;
 	}
+#line 1573 "yacc.c"
     break;
 
-  case 42:
-#line 290 "yacc.y"
-    {
-		(yyval.items) = new_list((yyvsp[(1) - (1)].number));
+  case 42: /* T_ITEMS: T_ITEM  */
+#line 303 "yacc.y"
+        {
+		(yyval.items) = new_list((yyvsp[0].number));
 	}
+#line 1581 "yacc.c"
     break;
 
-  case 43:
-#line 294 "yacc.y"
-    {
-		(yyval.items) = items_from_string((yyvsp[(1) - (1)].string),lineno);
+  case 43: /* T_ITEMS: T_STRING  */
+#line 307 "yacc.y"
+        {
+		(yyval.items) = add_lists(NULL,items_from_string((yyvsp[0].string),kmflcomp_ctx->lineno));
 	}
+#line 1589 "yacc.c"
     break;
 
-  case 44:
-#line 298 "yacc.y"
-    {
-		(yyval.items) = add_item_to_list((yyvsp[(2) - (2)].items),(yyvsp[(1) - (2)].number));
+  case 44: /* T_ITEMS: T_ITEM T_ITEMS  */
+#line 311 "yacc.y"
+        {
+		(yyval.items) = add_item_to_list((yyvsp[0].items),(yyvsp[-1].number));
 	}
+#line 1597 "yacc.c"
     break;
 
-  case 45:
-#line 302 "yacc.y"
-    {
-		(yyval.items) = add_lists((yyvsp[(2) - (2)].items),items_from_string((yyvsp[(1) - (2)].string),lineno));
+  case 45: /* T_ITEMS: T_STRING T_ITEMS  */
+#line 315 "yacc.y"
+        {
+		(yyval.items) = add_lists((yyvsp[0].items),items_from_string((yyvsp[-1].string),kmflcomp_ctx->lineno));
 	}
+#line 1605 "yacc.c"
     break;
 
-  case 46:
-#line 309 "yacc.y"
-    {
-		(yyval.number) = MAKE_ITEM(ITEM_CHAR,(yyvsp[(1) - (1)].number));
+  case 46: /* T_ITEM: TOK_NUMBER  */
+#line 322 "yacc.y"
+        {
+		(yyval.number) = MAKE_ITEM(ITEM_CHAR,(yyvsp[0].number));
 	}
+#line 1613 "yacc.c"
     break;
 
-  case 47:
-#line 313 "yacc.y"
-    {
-		(yyval.number) = MAKE_ITEM(ITEM_KEYSYM,(yyvsp[(2) - (3)].number));
+  case 47: /* T_ITEM: TOK_SB T_KEYDEF TOK_SB  */
+#line 326 "yacc.y"
+        {
+		(yyval.number) = MAKE_ITEM(ITEM_KEYSYM,(yyvsp[-1].number));
 	}
+#line 1621 "yacc.c"
     break;
 
-  case 48:
-#line 317 "yacc.y"
-    {
+  case 48: /* T_ITEM: TOK_PLUS  */
+#line 330 "yacc.y"
+        {
 		(yyval.number) = MAKE_ITEM(ITEM_PLUS,0);	/* include in item list - remove later when testing validity */
 	}
+#line 1629 "yacc.c"
     break;
 
-  case 49:
-#line 321 "yacc.y"
-    {
-		if((n=store_number((yyvsp[(2) - (2)].string),lineno)) != UNDEFINED)
+  case 49: /* T_ITEM: TOK_ANY T_PARAMETER  */
+#line 334 "yacc.y"
+        {
+		if((n=store_number((yyvsp[0].string),kmflcomp_ctx->lineno)) != UNDEFINED)
 		{
 			(yyval.number) = MAKE_ITEM(ITEM_ANY,n);
 		}
 		else
 		{
-			kmflcomp_warn(lineno,"store (%s) is undefined!",(yyvsp[(2) - (2)].string));
+			kmflcomp_warn(kmflcomp_ctx->lineno,"store (%s) is undefined!",(yyvsp[0].string));
 			(yyval.number) = 0;
 		}
 	}
+#line 1645 "yacc.c"
     break;
 
-  case 50:
-#line 333 "yacc.y"
-    {
-		if((n=store_number((yyvsp[(2) - (2)].string),lineno)) != UNDEFINED)
+  case 50: /* T_ITEM: TOK_NOTANY T_PARAMETER  */
+#line 346 "yacc.y"
+        {
+		if((n=store_number((yyvsp[0].string),kmflcomp_ctx->lineno)) != UNDEFINED)
 		{
 			(yyval.number) = MAKE_ITEM(ITEM_NOTANY,n);
 		}
 		else
 		{
-			kmflcomp_warn(lineno,"store (%s) is undefined!",(yyvsp[(2) - (2)].string));
+			kmflcomp_warn(kmflcomp_ctx->lineno,"store (%s) is undefined!",(yyvsp[0].string));
 			(yyval.number) = 0;
 		}
 	}
+#line 1661 "yacc.c"
     break;
 
-  case 51:
-#line 345 "yacc.y"
-    {
-		if((n=store_number((yyvsp[(2) - (2)].string),lineno)) != UNDEFINED)
+  case 51: /* T_ITEM: TOK_OUTS T_PARAMETER  */
+#line 358 "yacc.y"
+        {
+		if((n=store_number((yyvsp[0].string),kmflcomp_ctx->lineno)) != UNDEFINED)
 		{
 			(yyval.number) = MAKE_ITEM(ITEM_OUTS,n);
 		}
 		else
 		{
-			kmflcomp_warn(lineno,"store (%s) is undefined!",(yyvsp[(2) - (2)].string));
+			kmflcomp_warn(kmflcomp_ctx->lineno,"store (%s) is undefined!",(yyvsp[0].string));
 			(yyval.number) = 0;
 		}
 	}
+#line 1677 "yacc.c"
     break;
 
-  case 52:
-#line 357 "yacc.y"
-    {
-		(yyval.number) = MAKE_ITEM(ITEM_DEADKEY,deadkey_number((yyvsp[(2) - (2)].string), lineno));
+  case 52: /* T_ITEM: TOK_DEADKEY T_PARAMETER  */
+#line 370 "yacc.y"
+        {
+		(yyval.number) = MAKE_ITEM(ITEM_DEADKEY,deadkey_number((yyvsp[0].string), kmflcomp_ctx->lineno));
 	}
+#line 1685 "yacc.c"
     break;
 
-  case 53:
-#line 361 "yacc.y"
-    {
+  case 53: /* T_ITEM: TOK_NUL  */
+#line 374 "yacc.y"
+        {
 		(yyval.number) = MAKE_ITEM(ITEM_NUL,0);
 	}
+#line 1693 "yacc.c"
     break;
 
-  case 54:
-#line 365 "yacc.y"
-    {
-		if((n=store_number((yyvsp[(3) - (6)].string),lineno)) != UNDEFINED)
+  case 54: /* T_ITEM: TOK_INDEX TOK_BRKT T_BYTES TOK_COMMA T_BYTES TOK_BRKT  */
+#line 378 "yacc.y"
+        {
+		if((n=store_number((yyvsp[-3].string),kmflcomp_ctx->lineno)) != UNDEFINED)
 		{
-			(yyval.number) = MAKE_PARAMETER_ITEM(ITEM_INDEX,atoi((yyvsp[(5) - (6)].string)),n);
+			(yyval.number) = MAKE_PARAMETER_ITEM(ITEM_INDEX,atoi((yyvsp[-1].string)),n);
 		}
 		else
 		{
-			kmflcomp_warn(lineno,"store (%s) is undefined!",(yyvsp[(3) - (6)].string));
+			kmflcomp_warn(kmflcomp_ctx->lineno,"store (%s) is undefined!",(yyvsp[-3].string));
 			(yyval.number) = 0;
 		}
 	}
+#line 1709 "yacc.c"
     break;
 
-  case 55:
-#line 377 "yacc.y"
-    {
-		kmflcomp_warn(lineno,"index(%s) must have TWO parameters!",(yyvsp[(3) - (4)].string));
+  case 55: /* T_ITEM: TOK_INDEX TOK_BRKT T_BYTES TOK_BRKT  */
+#line 390 "yacc.y"
+        {
+		kmflcomp_warn(kmflcomp_ctx->lineno,"index(%s) must have TWO parameters!",(yyvsp[-1].string));
 		(yyval.number) = 0;
 	}
+#line 1718 "yacc.c"
     break;
 
-  case 56:
-#line 382 "yacc.y"
-    {
+  case 56: /* T_ITEM: TOK_RTN  */
+#line 395 "yacc.y"
+        {
 		(yyval.number) = MAKE_ITEM(ITEM_RETURN,0);
 	}
+#line 1726 "yacc.c"
     break;
 
-  case 57:
-#line 386 "yacc.y"
-    {
+  case 57: /* T_ITEM: TOK_BEEP  */
+#line 399 "yacc.y"
+        {
 		(yyval.number) = MAKE_ITEM(ITEM_BEEP,0);
 	}
+#line 1734 "yacc.c"
     break;
 
-  case 58:
-#line 390 "yacc.y"
-    {
+  case 58: /* T_ITEM: TOK_CONTEXT  */
+#line 403 "yacc.y"
+        {
 		(yyval.number) = MAKE_ITEM(ITEM_CONTEXT,0);
 	}
+#line 1742 "yacc.c"
     break;
 
-  case 59:
-#line 394 "yacc.y"
-    {
-		(yyval.number) = MAKE_ITEM(ITEM_CONTEXT,atoi((yyvsp[(3) - (4)].string)));
+  case 59: /* T_ITEM: TOK_CONTEXT TOK_BRKT T_BYTES TOK_BRKT  */
+#line 407 "yacc.y"
+        {
+		(yyval.number) = MAKE_ITEM(ITEM_CONTEXT,atoi((yyvsp[-1].string)));
 	}
+#line 1750 "yacc.c"
     break;
 
-  case 60:
-#line 398 "yacc.y"
-    {
-		(yyval.number) = MAKE_ITEM(ITEM_USE,group_number((yyvsp[(2) - (2)].string), lineno));
+  case 60: /* T_ITEM: TOK_USE T_PARAMETER  */
+#line 411 "yacc.y"
+        {
+		(yyval.number) = MAKE_ITEM(ITEM_USE,group_number((yyvsp[0].string), kmflcomp_ctx->lineno));
 	}
+#line 1758 "yacc.c"
     break;
 
-  case 61:
-#line 402 "yacc.y"
-    {
+  case 61: /* T_ITEM: TOK_MATCH  */
+#line 415 "yacc.y"
+        {
 		(yyval.number) = MAKE_ITEM(ITEM_MATCH,0);
 	}
+#line 1766 "yacc.c"
     break;
 
-  case 62:
-#line 406 "yacc.y"
-    {
+  case 62: /* T_ITEM: TOK_NOMATCH  */
+#line 419 "yacc.y"
+        {
 		(yyval.number) = MAKE_ITEM(ITEM_NOMATCH,0);
 	}
+#line 1774 "yacc.c"
     break;
 
-  case 63:
-#line 410 "yacc.y"
-    {
-		kmflcomp_error(lineno,"call keyword not implemented");
+  case 63: /* T_ITEM: TOK_CALL T_PARAMETER  */
+#line 423 "yacc.y"
+        {
+		kmflcomp_error(kmflcomp_ctx->lineno,"call keyword not implemented");
 		fail(12,"unsupported keyword");
 	}
+#line 1783 "yacc.c"
     break;
 
-  case 64:
-#line 415 "yacc.y"
-    {
-		kmflcomp_error(lineno,"switch keyword not implemented");
+  case 64: /* T_ITEM: TOK_SWITCH T_PARAMETER  */
+#line 428 "yacc.y"
+        {
+		kmflcomp_error(kmflcomp_ctx->lineno,"switch keyword not implemented");
 		fail(11,"obsolete syntax");
 	}
+#line 1792 "yacc.c"
     break;
 
-  case 65:
-#line 420 "yacc.y"
-    {
+  case 65: /* T_ITEM: TOK_DOLLAR T_BYTES  */
+#line 433 "yacc.y"
+        {
 		STORE *sp;		/* check for named constants */
-		sp = find_store((yyvsp[(2) - (2)].string));
+		sp = find_store((yyvsp[0].string));
 		if(sp)
 		{
 			(yyval.number) = *sp->items;
@@ -2066,205 +1803,195 @@ yyreduce:
 		else
 		{
 			(yyval.number) = 0;
-			kmflcomp_error(lineno,"undefined constant");
+			kmflcomp_error(kmflcomp_ctx->lineno,"undefined constant");
 		}
 	}
+#line 1810 "yacc.c"
     break;
 
-  case 66:
-#line 434 "yacc.y"
-    {
-		kmflcomp_error(lineno,"illegal or unrecognized item in rule or store");
+  case 66: /* T_ITEM: TOK_ERROR  */
+#line 447 "yacc.y"
+        {
+		kmflcomp_error(kmflcomp_ctx->lineno,"illegal or unrecognized item in rule or store");
 	}
+#line 1818 "yacc.c"
     break;
 
-  case 67:
-#line 441 "yacc.y"
-    { 	
-		(yyval.string) = (yyvsp[(2) - (3)].string);
+  case 67: /* T_STRING: TOK_QM T_BYTES TOK_QM  */
+#line 454 "yacc.y"
+        { 	
+		(yyval.string) = (yyvsp[-1].string);
 	}
+#line 1826 "yacc.c"
     break;
 
-  case 68:
-#line 446 "yacc.y"
-    {
+  case 68: /* T_STRING: TOK_QM TOK_QM  */
+#line 459 "yacc.y"
+        {
 		(yyval.string) = new_string(0); /* allow for empty strings */
 	}
+#line 1834 "yacc.c"
     break;
 
-  case 69:
-#line 453 "yacc.y"
-    {
-		(yyval.string) = (yyvsp[(2) - (3)].string);
+  case 69: /* T_PARAMETER: TOK_BRKT T_BYTES TOK_BRKT  */
+#line 466 "yacc.y"
+        {
+		(yyval.string) = (yyvsp[-1].string);
 	}
+#line 1842 "yacc.c"
     break;
 
-  case 70:
-#line 460 "yacc.y"
-    {	
-		(yyval.number) = make_keysym(lineno, 0,string_to_keysym((yyvsp[(1) - (1)].string),lineno));
+  case 70: /* T_KEYDEF: T_STRING  */
+#line 473 "yacc.y"
+        {	
+		(yyval.number) = make_keysym(kmflcomp_ctx->lineno, 0,string_to_keysym((yyvsp[0].string),kmflcomp_ctx->lineno));
 	}
+#line 1850 "yacc.c"
     break;
 
-  case 71:
-#line 465 "yacc.y"
-    {	
-		(yyval.number) = make_keysym(lineno, 0,string_to_keysym((yyvsp[(2) - (2)].string),lineno));
+  case 71: /* T_KEYDEF: T_KEYMODS T_STRING  */
+#line 478 "yacc.y"
+        {	
+		(yyval.number) = make_keysym(kmflcomp_ctx->lineno, 0,string_to_keysym((yyvsp[0].string),kmflcomp_ctx->lineno));
 	}
+#line 1858 "yacc.c"
     break;
 
-  case 72:
-#line 470 "yacc.y"
-    {
-		(yyval.number) = make_keysym(lineno, (yyvsp[(1) - (2)].number),(yyvsp[(2) - (2)].number));
+  case 72: /* T_KEYDEF: T_KEYMODS TOK_RAWKEY  */
+#line 483 "yacc.y"
+        {
+		(yyval.number) = make_keysym(kmflcomp_ctx->lineno, (yyvsp[-1].number),(yyvsp[0].number));
 	}
+#line 1866 "yacc.c"
     break;
 
-  case 73:
-#line 474 "yacc.y"
-    {
-		(yyval.number) = make_keysym(lineno, 0,(yyvsp[(1) - (1)].number));
+  case 73: /* T_KEYDEF: TOK_RAWKEY  */
+#line 487 "yacc.y"
+        {
+		(yyval.number) = make_keysym(kmflcomp_ctx->lineno, 0,(yyvsp[0].number));
 	}
+#line 1874 "yacc.c"
     break;
 
-  case 74:
-#line 478 "yacc.y"
-    {
-		(yyval.number) = make_xkeysym(lineno, (yyvsp[(1) - (2)].number), (yyvsp[(2) - (2)].number));
+  case 74: /* T_KEYDEF: T_KEYMODS TOK_XKEYSYM  */
+#line 491 "yacc.y"
+        {
+		(yyval.number) = make_xkeysym(kmflcomp_ctx->lineno, (yyvsp[-1].number), (yyvsp[0].number));
 	}
+#line 1882 "yacc.c"
     break;
 
-  case 75:
-#line 482 "yacc.y"
-    {
-		(yyval.number) = make_xkeysym(lineno, 0, (yyvsp[(1) - (1)].number));
+  case 75: /* T_KEYDEF: TOK_XKEYSYM  */
+#line 495 "yacc.y"
+        {
+		(yyval.number) = make_xkeysym(kmflcomp_ctx->lineno, 0, (yyvsp[0].number));
 	}
+#line 1890 "yacc.c"
     break;
 
-  case 76:
-#line 489 "yacc.y"
-    {
-		(yyval.number) = (yyvsp[(1) - (2)].number) | (yyvsp[(2) - (2)].number);
+  case 76: /* T_KEYMODS: T_KEYMODS TOK_SHIFT  */
+#line 502 "yacc.y"
+        {
+		(yyval.number) = (yyvsp[-1].number) | (yyvsp[0].number);
 	}
+#line 1898 "yacc.c"
     break;
 
-  case 77:
-#line 493 "yacc.y"
-    {
-		(yyval.number) = (yyvsp[(1) - (1)].number);
+  case 77: /* T_KEYMODS: TOK_SHIFT  */
+#line 506 "yacc.y"
+        {
+		(yyval.number) = (yyvsp[0].number);
 	}
+#line 1906 "yacc.c"
     break;
 
-  case 78:
-#line 500 "yacc.y"
-    {	
-		(yyval.string) = new_string((yyvsp[(1) - (1)].number));
+  case 78: /* T_BYTES: TOK_CHAR  */
+#line 513 "yacc.y"
+        {	
+		(yyval.string) = new_string((yyvsp[0].number));
 	}
+#line 1914 "yacc.c"
     break;
 
-  case 79:
-#line 504 "yacc.y"
-    {
-		(yyval.string) = add_char((yyvsp[(2) - (2)].string),(yyvsp[(1) - (2)].number));
+  case 79: /* T_BYTES: TOK_CHAR T_BYTES  */
+#line 517 "yacc.y"
+        {
+		(yyval.string) = add_char((yyvsp[0].string),(yyvsp[-1].number));
 	}
+#line 1922 "yacc.c"
     break;
 
 
-/* Line 1267 of yacc.c.  */
-#line 2175 "yacc.c"
+#line 1926 "yacc.c"
+
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (YY_("syntax error"));
-#else
-      {
-	YYSIZE_T yysize = yysyntax_error (0, yystate, yychar);
-	if (yymsg_alloc < yysize && yymsg_alloc < YYSTACK_ALLOC_MAXIMUM)
-	  {
-	    YYSIZE_T yyalloc = 2 * yysize;
-	    if (! (yysize <= yyalloc && yyalloc <= YYSTACK_ALLOC_MAXIMUM))
-	      yyalloc = YYSTACK_ALLOC_MAXIMUM;
-	    if (yymsg != yymsgbuf)
-	      YYSTACK_FREE (yymsg);
-	    yymsg = (char *) YYSTACK_ALLOC (yyalloc);
-	    if (yymsg)
-	      yymsg_alloc = yyalloc;
-	    else
-	      {
-		yymsg = yymsgbuf;
-		yymsg_alloc = sizeof yymsgbuf;
-	      }
-	  }
-
-	if (0 < yysize && yysize <= yymsg_alloc)
-	  {
-	    (void) yysyntax_error (yymsg, yystate, yychar);
-	    yyerror (yymsg);
-	  }
-	else
-	  {
-	    yyerror (YY_("syntax error"));
-	    if (yysize != 0)
-	      goto yyexhaustedlab;
-	  }
-      }
-#endif
+      yyerror (scanner, YY_("syntax error"));
     }
 
-
-
   if (yyerrstatus == 3)
     {
-      /* If just tried and failed to reuse look-ahead token after an
-	 error, discard it.  */
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, scanner);
+          yychar = YYEMPTY;
+        }
     }
 
-  /* Else will try to reuse look-ahead token after shifting the error
+  /* Else will try to reuse lookahead token after shifting the error
      token.  */
   goto yyerrlab1;
 
@@ -2273,14 +2000,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -2293,42 +2019,42 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
-      if (yyn != YYPACT_NINF)
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, scanner);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2339,60 +2065,66 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#ifndef yyoverflow
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (scanner, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
-  if (yychar != YYEOF && yychar != YYEMPTY)
-     yydestruct ("Cleanup: discarding lookahead",
-		 yytoken, &yylval);
-  /* Do not reclaim the symbols of the rule which action triggered
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, scanner);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, scanner);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
 
+  return yyresult;
+}
 
-#line 510 "yacc.y"
+#line 523 "yacc.y"
 
 
-void yyerror(char *str)
+void yyerror(yyscan_t scanner, const char *str)
 {
     fflush (stdout); (void) fflush (stderr);
-    fprintf (stderr, "Error: %s (line %d)\n", str, lineno);
-    fflush (stderr); errcount++;
+    fprintf (stderr, "Error: %s (line %d)\n", str, kmflcomp_ctx->lineno);
+    fflush (stderr); kmflcomp_ctx->nerrors++;
+    if(kmflcomp_ctx->message[0] == 0)
+        snprintf(kmflcomp_ctx->message, sizeof(kmflcomp_ctx->message), "%.480s (line %d)", str, kmflcomp_ctx->lineno);
 }
 
 #ifdef _WIN32
@@ -2401,4 +2133,3 @@ int yywrap(void)
 	return 1;
 }
 #endif
-
@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
+/* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,135 +31,124 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     TOK_ANY = 258,
-     TOK_ANSI = 259,
-     TOK_AUTHOR = 260,
-     TOK_BEEP = 261,
-     TOK_BITMAP = 262,
-     TOK_BRKT = 263,
-     TOK_CALL = 264,
-     TOK_CAPSFREE = 265,
-     TOK_CAPSOFF = 266,
-     TOK_CAPSON = 267,
-     TOK_COMMA = 268,
-     TOK_CONTEXT = 269,
-     TOK_COPYRIGHT = 270,
-     TOK_CHAR = 271,
-     TOK_DEADKEY = 272,
-     TOK_DOLLAR = 273,
-     TOK_ERROR = 274,
-     TOK_ETHNOLOGUE = 275,
-     TOK_GROUP = 276,
-     TOK_GT = 277,
-     TOK_HOTKEY = 278,
-     TOK_INDEX = 279,
-     TOK_LANGUAGE = 280,
-     TOK_LAYOUT = 281,
-     TOK_MATCH = 282,
-     TOK_MESSAGE = 283,
-     TOK_MNEMONIC = 284,
-     TOK_NOMATCH = 285,
-     TOK_NAME = 286,
-     TOK_NOTANY = 287,
-     TOK_NUL = 288,
-     TOK_NUMBER = 289,
-     TOK_NL = 290,
-     TOK_OUTS = 291,
-     TOK_RAWKEY = 292,
-     TOK_PLUS = 293,
-     TOK_QM = 294,
-     TOK_RTN = 295,
-     TOK_SB = 296,
-     TOK_SHIFT = 297,
-     TOK_STORE = 298,
-     TOK_STOREINSTORE = 299,
-     TOK_SWITCH = 300,
-     TOK_UNICODE = 301,
-     TOK_USE = 302,
-     TOK_USINGKEYS = 303,
-     TOK_UTF = 304,
-     TOK_VERSION = 305,
-     TOK_XKEYSYM = 306
-   };
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_YACC_H_INCLUDED
+# define YY_YY_YACC_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
 #endif
-/* Tokens.  */
-#define TOK_ANY 258
-#define TOK_ANSI 259
-#define TOK_AUTHOR 260
-#define TOK_BEEP 261
-#define TOK_BITMAP 262
-#define TOK_BRKT 263
-#define TOK_CALL 264
-#define TOK_CAPSFREE 265
-#define TOK_CAPSOFF 266
-#define TOK_CAPSON 267
-#define TOK_COMMA 268
-#define TOK_CONTEXT 269
-#define TOK_COPYRIGHT 270
-#define TOK_CHAR 271
-#define TOK_DEADKEY 272
-#define TOK_DOLLAR 273
-#define TOK_ERROR 274
-#define TOK_ETHNOLOGUE 275
-#define TOK_GROUP 276
-#define TOK_GT 277
-#define TOK_HOTKEY 278
-#define TOK_INDEX 279
-#define TOK_LANGUAGE 280
-#define TOK_LAYOUT 281
-#define TOK_MATCH 282
-#define TOK_MESSAGE 283
-#define TOK_MNEMONIC 284
-#define TOK_NOMATCH 285
-#define TOK_NAME 286
-#define TOK_NOTANY 287
-#define TOK_NUL 288
-#define TOK_NUMBER 289
-#define TOK_NL 290
-#define TOK_OUTS 291
-#define TOK_RAWKEY 292
-#define TOK_PLUS 293
-#define TOK_QM 294
-#define TOK_RTN 295
-#define TOK_SB 296
-#define TOK_SHIFT 297
-#define TOK_STORE 298
-#define TOK_STOREINSTORE 299
-#define TOK_SWITCH 300
-#define TOK_UNICODE 301
-#define TOK_USE 302
-#define TOK_USINGKEYS 303
-#define TOK_UTF 304
-#define TOK_VERSION 305
-#define TOK_XKEYSYM 306
+#if YYDEBUG
+extern int yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 25 "yacc.y"
 
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void *yyscan_t;
+#endif
 
+#line 56 "yacc.h"
 
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    TOK_ANY = 258,                 /* TOK_ANY  */
+    TOK_ANSI = 259,                /* TOK_ANSI  */
+    TOK_AUTHOR = 260,              /* TOK_AUTHOR  */
+    TOK_BEEP = 261,                /* TOK_BEEP  */
+    TOK_BITMAP = 262,              /* TOK_BITMAP  */
+    TOK_BRKT = 263,                /* TOK_BRKT  */
+    TOK_CALL = 264,                /* TOK_CALL  */
+    TOK_CAPSFREE = 265,            /* TOK_CAPSFREE  */
+    TOK_CAPSOFF = 266,             /* TOK_CAPSOFF  */
+    TOK_CAPSON = 267,              /* TOK_CAPSON  */
+    TOK_COMMA = 268,               /* TOK_COMMA  */
+    TOK_CONTEXT = 269,             /* TOK_CONTEXT  */
+    TOK_COPYRIGHT = 270,           /* TOK_COPYRIGHT  */
+    TOK_CHAR = 271,                /* TOK_CHAR  */
+    TOK_DEADKEY = 272,             /* TOK_DEADKEY  */
+    TOK_DOLLAR = 273,              /* TOK_DOLLAR  */
+    TOK_ERROR = 274,               /* TOK_ERROR  */
+    TOK_ETHNOLOGUE = 275,          /* TOK_ETHNOLOGUE  */
+    TOK_GROUP = 276,               /* TOK_GROUP  */
+    TOK_GT = 277,                  /* TOK_GT  */
+    TOK_HOTKEY = 278,              /* TOK_HOTKEY  */
+    TOK_INDEX = 279,               /* TOK_INDEX  */
+    TOK_LANGUAGE = 280,            /* TOK_LANGUAGE  */
+    TOK_LAYOUT = 281,              /* TOK_LAYOUT  */
+    TOK_MATCH = 282,               /* TOK_MATCH  */
+    TOK_MESSAGE = 283,             /* TOK_MESSAGE  */
+    TOK_MNEMONIC = 284,            /* TOK_MNEMONIC  */
+    TOK_NOMATCH = 285,             /* TOK_NOMATCH  */
+    TOK_NAME = 286,                /* TOK_NAME  */
+    TOK_NOTANY = 287,              /* TOK_NOTANY  */
+    TOK_NUL = 288,                 /* TOK_NUL  */
+    TOK_NUMBER = 289,              /* TOK_NUMBER  */
+    TOK_NL = 290,                  /* TOK_NL  */
+    TOK_OUTS = 291,                /* TOK_OUTS  */
+    TOK_RAWKEY = 292,              /* TOK_RAWKEY  */
+    TOK_PLUS = 293,                /* TOK_PLUS  */
+    TOK_QM = 294,                  /* TOK_QM  */
+    TOK_RTN = 295,                 /* TOK_RTN  */
+    TOK_SB = 296,                  /* TOK_SB  */
+    TOK_SHIFT = 297,               /* TOK_SHIFT  */
+    TOK_STORE = 298,               /* TOK_STORE  */
+    TOK_STOREINSTORE = 299,        /* TOK_STOREINSTORE  */
+    TOK_SWITCH = 300,              /* TOK_SWITCH  */
+    TOK_UNICODE = 301,             /* TOK_UNICODE  */
+    TOK_USE = 302,                 /* TOK_USE  */
+    TOK_USINGKEYS = 303,           /* TOK_USINGKEYS  */
+    TOK_UTF = 304,                 /* TOK_UTF  */
+    TOK_VERSION = 305,             /* TOK_VERSION  */
+    TOK_XKEYSYM = 306              /* TOK_XKEYSYM  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
 
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 25 "yacc.y"
+union YYSTYPE
 {
+#line 38 "yacc.y"
+
 	int simple;
 	ITEM number;
 	char *string;
-	ITEM *items;
+	ITEMVEC *items;
 	RULE *rule;
 	GROUP *group;
-	}
-/* Line 1489 of yacc.c.  */
-#line 160 "yacc.h"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
+	
+
+#line 134 "yacc.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
-extern YYSTYPE yylval;
 
+
+
+int yyparse (yyscan_t scanner);
+
+/* "%code provides" blocks.  */
+#line 32 "yacc.y"
+
+int yylex(YYSTYPE *yylval_param, yyscan_t yyscanner);
+void yyerror(yyscan_t scanner, const char *str);
+
+#line 153 "yacc.h"
+
+#endif /* !YY_YY_YACC_H_INCLUDED  */
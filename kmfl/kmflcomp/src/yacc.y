@@ -9,24 +9,37 @@
 
 #include "compiler.h"
 
-extern char *fname;			/* Current file name */
-extern int yylex();			/* Reference needed by yacc.c */
+/* The line number and error count are kept in the compiler context (see compiler.h) */
 
-int  lineno   = 1;			/* Current line number in file */
-int	 errcount = 0;			/* Count of errors */
-
-int	 n;						/* Temporary index value */
-GROUP *gp = NULL;			/* Temporary group pointer */
+KMFL_THREAD int	 n;					/* Temporary index value */
+KMFL_THREAD GROUP *gp = NULL;		/* Temporary group pointer */
 
 #define YYDEBUG 1			/* Allow compiler debugging (if yydebug true) */
+#define YYMAXDEPTH 1000000	/* Item lists are right recursive, so allow for long stores */
 %}
 
+/* The parser is reentrant, and reads its tokens from a reentrant scanner (see lex.l) */
+%define api.pure full
+%param {yyscan_t scanner}
+
+%code requires {
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void *yyscan_t;
+#endif
+}
+
+%code provides {
+int yylex(YYSTYPE *yylval_param, yyscan_t yyscanner);
+void yyerror(yyscan_t scanner, const char *str);
+}
+
 %union
 	{
 	int simple;
 	ITEM number;
 	char *string;
-	ITEM *items;
+	ITEMVEC *items;
 	RULE *rule;
 	GROUP *group;
 	}
@@ -101,15 +114,15 @@ GROUP *gp = NULL;			/* Temporary group pointer */
 T_FILE :
 	T_HEADER T_GROUPS
 	{
-		kbp->groups = $2;
-		kbp->ngroups = count_groups($2);
-		kbp->nstores = count_stores(kbp->stores);
+		kmflcomp_ctx->keyboard.groups = $2;
+		kmflcomp_ctx->keyboard.ngroups = count_groups($2);
+		kmflcomp_ctx->keyboard.nstores = count_stores(kmflcomp_ctx->keyboard.stores);
 	}
 	| T_GROUPS
 	{
-		kbp->groups = $1;
-		kbp->ngroups = count_groups($1);
-		kbp->nstores = count_stores(kbp->stores);
+		kmflcomp_ctx->keyboard.groups = $1;
+		kmflcomp_ctx->keyboard.ngroups = count_groups($1);
+		kmflcomp_ctx->keyboard.nstores = count_stores(kmflcomp_ctx->keyboard.stores);
 	}
 	;
 
@@ -121,96 +134,96 @@ T_HEADER :
 T_HEADLINE :
 	TOK_NAME T_BYTES TOK_NL
 	{
-		new_store_from_string("&name",$2,lineno);
+		new_store_from_string("&name",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_NAME T_STRING TOK_NL
 	{
-		new_store_from_string("&name",$2,lineno);
+		new_store_from_string("&name",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_HOTKEY TOK_SB T_KEYDEF TOK_SB TOK_NL
 	{
-		new_store("&hotkey",new_list($3),lineno);
+		new_store("&hotkey",list_items(new_list($3)),kmflcomp_ctx->lineno);
 	}
 	| TOK_HOTKEY T_STRING TOK_NL
 	{
-		new_store_from_string("&hotkey",$2,lineno);
+		new_store_from_string("&hotkey",$2,kmflcomp_ctx->lineno);
 	}	
 	| TOK_VERSION T_BYTES TOK_NL
 	{
-		new_store_from_string("&version",$2,lineno);
+		new_store_from_string("&version",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_VERSION T_STRING TOK_NL
 	{
-		new_store_from_string("&version",$2,lineno);
+		new_store_from_string("&version",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_BITMAP T_BYTES TOK_NL
 	{ 
-		new_store_from_string("&bitmap",$2,lineno);
+		new_store_from_string("&bitmap",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_BITMAP T_STRING TOK_NL
 	{ 
-		new_store_from_string("&bitmap",$2,lineno);
+		new_store_from_string("&bitmap",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_COPYRIGHT T_STRING TOK_NL
 	{ 
-		new_store_from_string("&copyright",$2,lineno);	
+		new_store_from_string("&copyright",$2,kmflcomp_ctx->lineno);	
 	}
 	| TOK_MESSAGE T_STRING TOK_NL
 	{ 
-		new_store_from_string("&message",$2,lineno);
+		new_store_from_string("&message",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_LANGUAGE T_ITEMS TOK_NL
 	{ 
-		new_store_from_string("&language",$2,lineno);
+		new_store_from_string("&language",(char *)list_items($2),kmflcomp_ctx->lineno);
 	}
 	| TOK_LAYOUT T_STRING TOK_NL
 	{ 
-		new_store_from_string("&layout",$2,lineno);
+		new_store_from_string("&layout",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_LAYOUT T_BYTES TOK_NL
 	{ 
-		new_store_from_string("&layout",$2,lineno);
+		new_store_from_string("&layout",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_CAPSOFF TOK_NL
 	{ 
-		new_store_from_string("&capsalwaysoff","1",lineno);
+		new_store_from_string("&capsalwaysoff","1",kmflcomp_ctx->lineno);
 	}
 	| TOK_CAPSON TOK_NL
 	{ 
-		new_store_from_string("&capsononly","1",lineno);
+		new_store_from_string("&capsononly","1",kmflcomp_ctx->lineno);
 	}
 	| TOK_CAPSFREE TOK_NL
 	{ 
-		new_store_from_string("&shiftfreescaps","1",lineno);
+		new_store_from_string("&shiftfreescaps","1",kmflcomp_ctx->lineno);
 	}
 	| TOK_STORE T_PARAMETER T_ITEMS TOK_NL
 	{
-		new_store($2,$3,lineno);
+		new_store($2,list_items($3),kmflcomp_ctx->lineno);
 	}
 	| TOK_ANSI TOK_GT TOK_USE T_PARAMETER TOK_NL
 	{
-		set_start_group($4,KF_ANSI, lineno);
+		set_start_group($4,KF_ANSI, kmflcomp_ctx->lineno);
 	}
 	| TOK_UNICODE TOK_GT TOK_USE T_PARAMETER TOK_NL
 	{
-		set_start_group($4,KF_UNICODE, lineno);
+		set_start_group($4,KF_UNICODE, kmflcomp_ctx->lineno);
 	}
 	| TOK_ANSI TOK_GT TOK_USE T_PARAMETER TOK_USE T_PARAMETER TOK_NL
 	{
-		kmflcomp_error(lineno,"alternate starting groups not supported");
+		kmflcomp_error(kmflcomp_ctx->lineno,"alternate starting groups not supported");
 		fail(11,"obsolete syntax");
 	}
 	| TOK_AUTHOR T_STRING TOK_NL
 	{ 
-		new_store_from_string("&author",$2,lineno);
+		new_store_from_string("&author",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_MNEMONIC T_STRING TOK_NL
 	{ 
-		new_store_from_string("&mnemoniclayout",$2,lineno);
+		new_store_from_string("&mnemoniclayout",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_ETHNOLOGUE T_STRING TOK_NL
 	{ 
-		new_store_from_string("&ethnologuecode",$2,lineno);
+		new_store_from_string("&ethnologuecode",$2,kmflcomp_ctx->lineno);
 	}
 	| TOK_ERROR T_BYTES TOK_NL
 	| TOK_NL
@@ -219,11 +232,11 @@ T_HEADLINE :
 T_GROUPS :
 	T_GROUP					
 	{
-		$$ = kbp->groups;
+		$$ = kmflcomp_ctx->keyboard.groups;
 	}
 	| T_GROUP T_GROUPS		
 	{
-		$$ = kbp->groups;
+		$$ = kmflcomp_ctx->keyboard.groups;
 	}
 	;
 
@@ -248,14 +261,14 @@ T_GROUP :
 T_GHEADER :
 	TOK_GROUP T_PARAMETER TOK_NL
 	{
-		$$ = gp = new_group($2, lineno);
-		if(gp) gp->flags = 0;
+		$$ = gp = new_group($2, kmflcomp_ctx->lineno);
+		if(gp) { gp->flags = 0; gp->line = kmflcomp_ctx->lineno; }
 	}
 	|
 	TOK_GROUP T_PARAMETER TOK_USINGKEYS TOK_NL
 	{
-		$$ = gp = new_group($2, lineno);
-		if(gp) gp->flags = GF_USEKEYS;
+		$$ = gp = new_group($2, kmflcomp_ctx->lineno);
+		if(gp) { gp->flags = GF_USEKEYS; gp->line = kmflcomp_ctx->lineno; }
 	}
 	;
 
@@ -273,11 +286,11 @@ T_RULES :
 T_RULELINE :
 	T_ITEMS TOK_GT T_ITEMS TOK_NL
 	{
-		$$ = new_rule(gp, $1, $3, lineno);
+		$$ = new_rule(gp, list_items($1), list_items($3), kmflcomp_ctx->lineno);
 	}
 	| TOK_STORE T_PARAMETER T_ITEMS TOK_NL
 	{
-		new_store($2,$3,lineno); $$ = NULL;
+		new_store($2,list_items($3),kmflcomp_ctx->lineno); $$ = NULL;
 	}
 	| TOK_NL
 	{
@@ -292,7 +305,7 @@ T_ITEMS :
 	}
 	| T_STRING
 	{
-		$$ = items_from_string($1,lineno);
+		$$ = add_lists(NULL,items_from_string($1,kmflcomp_ctx->lineno));
 	}
 	| T_ITEM T_ITEMS
 	{
@@ -300,7 +313,7 @@ T_ITEMS :
 	}
 	| T_STRING T_ITEMS
 	{
-		$$ = add_lists($2,items_from_string($1,lineno));
+		$$ = add_lists($2,items_from_string($1,kmflcomp_ctx->lineno));
 	}
 	;
 
@@ -319,43 +332,43 @@ T_ITEM :
 	}
 	| TOK_ANY T_PARAMETER 
 	{
-		if((n=store_number($2,lineno)) != UNDEFINED)
+		if((n=store_number($2,kmflcomp_ctx->lineno)) != UNDEFINED)
 		{
 			$$ = MAKE_ITEM(ITEM_ANY,n);
 		}
 		else
 		{
-			kmflcomp_warn(lineno,"store (%s) is undefined!",$2);
+			kmflcomp_warn(kmflcomp_ctx->lineno,"store (%s) is undefined!",$2);
 			$$ = 0;
 		}
 	}
 	| TOK_NOTANY T_PARAMETER 
 	{
-		if((n=store_number($2,lineno)) != UNDEFINED)
+		if((n=store_number($2,kmflcomp_ctx->lineno)) != UNDEFINED)
 		{
 			$$ = MAKE_ITEM(ITEM_NOTANY,n);
 		}
 		else
 		{
-			kmflcomp_warn(lineno,"store (%s) is undefined!",$2);
+			kmflcomp_warn(kmflcomp_ctx->lineno,"store (%s) is undefined!",$2);
 			$$ = 0;
 		}
 	}
 	| TOK_OUTS T_PARAMETER 
 	{
-		if((n=store_number($2,lineno)) != UNDEFINED)
+		if((n=store_number($2,kmflcomp_ctx->lineno)) != UNDEFINED)
 		{
 			$$ = MAKE_ITEM(ITEM_OUTS,n);
 		}
 		else
 		{
-			kmflcomp_warn(lineno,"store (%s) is undefined!",$2);
+			kmflcomp_warn(kmflcomp_ctx->lineno,"store (%s) is undefined!",$2);
 			$$ = 0;
 		}
 	}
 	| TOK_DEADKEY T_PARAMETER 
 	{
-		$$ = MAKE_ITEM(ITEM_DEADKEY,deadkey_number($2, lineno));
+		$$ = MAKE_ITEM(ITEM_DEADKEY,deadkey_number($2, kmflcomp_ctx->lineno));
 	}
 	| TOK_NUL
 	{
@@ -363,19 +376,19 @@ T_ITEM :
 	}
 	| TOK_INDEX TOK_BRKT T_BYTES TOK_COMMA T_BYTES TOK_BRKT
 	{
-		if((n=store_number($3,lineno)) != UNDEFINED)
+		if((n=store_number($3,kmflcomp_ctx->lineno)) != UNDEFINED)
 		{
 			$$ = MAKE_PARAMETER_ITEM(ITEM_INDEX,atoi($5),n);
 		}
 		else
 		{
-			kmflcomp_warn(lineno,"store (%s) is undefined!",$3);
+			kmflcomp_warn(kmflcomp_ctx->lineno,"store (%s) is undefined!",$3);
 			$$ = 0;
 		}
 	}
 	| TOK_INDEX TOK_BRKT T_BYTES TOK_BRKT
 	{
-		kmflcomp_warn(lineno,"index(%s) must have TWO parameters!",$3);
+		kmflcomp_warn(kmflcomp_ctx->lineno,"index(%s) must have TWO parameters!",$3);
 		$$ = 0;
 	}
 	| TOK_RTN
@@ -396,7 +409,7 @@ T_ITEM :
 	}
 	| TOK_USE T_PARAMETER 
 	{
-		$$ = MAKE_ITEM(ITEM_USE,group_number($2, lineno));
+		$$ = MAKE_ITEM(ITEM_USE,group_number($2, kmflcomp_ctx->lineno));
 	}
 	| TOK_MATCH
 	{
@@ -408,12 +421,12 @@ T_ITEM :
 	}
 	| TOK_CALL T_PARAMETER
 	{
-		kmflcomp_error(lineno,"call keyword not implemented");
+		kmflcomp_error(kmflcomp_ctx->lineno,"call keyword not implemented");
 		fail(12,"unsupported keyword");
 	}
 	| TOK_SWITCH T_PARAMETER
 	{
-		kmflcomp_error(lineno,"switch keyword not implemented");
+		kmflcomp_error(kmflcomp_ctx->lineno,"switch keyword not implemented");
 		fail(11,"obsolete syntax");
 	}
 	| TOK_DOLLAR T_BYTES
@@ -427,12 +440,12 @@ T_ITEM :
 		else
 		{
 			$$ = 0;
-			kmflcomp_error(lineno,"undefined constant");
+			kmflcomp_error(kmflcomp_ctx->lineno,"undefined constant");
 		}
 	}
 	| TOK_ERROR
 	{
-		kmflcomp_error(lineno,"illegal or unrecognized item in rule or store");
+		kmflcomp_error(kmflcomp_ctx->lineno,"illegal or unrecognized item in rule or store");
 	}
 	;
 
@@ -458,29 +471,29 @@ T_PARAMETER:
 T_KEYDEF : 
 	T_STRING 
 	{	
-		$$ = make_keysym(lineno, 0,string_to_keysym($1,lineno));
+		$$ = make_keysym(kmflcomp_ctx->lineno, 0,string_to_keysym($1,kmflcomp_ctx->lineno));
 	}
 	|
 	T_KEYMODS T_STRING 
 	{	
-		$$ = make_keysym(lineno, 0,string_to_keysym($2,lineno));
+		$$ = make_keysym(kmflcomp_ctx->lineno, 0,string_to_keysym($2,kmflcomp_ctx->lineno));
 	}
 	|
 	T_KEYMODS TOK_RAWKEY 
 	{
-		$$ = make_keysym(lineno, $1,$2);
+		$$ = make_keysym(kmflcomp_ctx->lineno, $1,$2);
 	}
 	| TOK_RAWKEY 
 	{
-		$$ = make_keysym(lineno, 0,$1);
+		$$ = make_keysym(kmflcomp_ctx->lineno, 0,$1);
 	}
 	| T_KEYMODS TOK_XKEYSYM
 	{
-		$$ = make_xkeysym(lineno, $1, $2);
+		$$ = make_xkeysym(kmflcomp_ctx->lineno, $1, $2);
 	}
 	| TOK_XKEYSYM
 	{
-		$$ = make_xkeysym(lineno, 0, $1);
+		$$ = make_xkeysym(kmflcomp_ctx->lineno, 0, $1);
 	}
 	;
 
@@ -509,11 +522,13 @@ T_BYTES :
 	
 %%
 
-void yyerror(char *str)
+void yyerror(yyscan_t scanner, const char *str)
 {
     fflush (stdout); (void) fflush (stderr);
-    fprintf (stderr, "Error: %s (line %d)\n", str, lineno);
-    fflush (stderr); errcount++;
+    fprintf (stderr, "Error: %s (line %d)\n", str, kmflcomp_ctx->lineno);
+    fflush (stderr); kmflcomp_ctx->nerrors++;
+    if(kmflcomp_ctx->message[0] == 0)
+        snprintf(kmflcomp_ctx->message, sizeof(kmflcomp_ctx->message), "%.480s (line %d)", str, kmflcomp_ctx->lineno);
 }
 
 #ifdef _WIN32
@@ -23,6 +23,8 @@
 
 #ifndef LIBKMFL_H
 
+#include <stdio.h>
+
 #ifdef _WIN32
 #define KMFL_EXPORT __declspec(dllexport)
 #else
@@ -32,16 +34,136 @@
 #ifdef	__cplusplus
 extern "C" {
 #endif
+
+// Locations of the tables of a compiled keyboard
+typedef struct _kmfltables {
+	XSTORE *stores;
+	XGROUP *groups;
+	XRULE *rules;
+	ITEM *strings;
+	UINT nrules;			// number of rules in all groups
+	UINT nstrings;			// number of items in the string table
+	UINT *dispatch;			// XS_DISPATCH section (or NULL)
+	UINT ndispatch;			// size of the XS_DISPATCH section in UINTs
+	UINT *store_index;		// XS_STOREINDEX section (or NULL)
+	UINT nstore_index;		// size of the XS_STOREINDEX section in UINTs
+	UINT *lines;			// XS_LINES section (or NULL)
+} KMFLTABLES;
+
+// A keystroke for kmfl_interpret_batch()
+typedef struct _kmflkey {
+	UINT key;
+	UINT state;
+} KMFLKEY;
+
+// Operations of the edit script made by kmfl_interpret_batch()
+enum {KMFL_EDIT_ERASE=1, KMFL_EDIT_INSERT, KMFL_EDIT_BEEP, KMFL_EDIT_FORWARD};
+
+typedef struct _kmfledit {
+	UINT op;				// KMFL_EDIT_ERASE, _INSERT, _BEEP or _FORWARD
+	UINT count;				// number of characters erased or inserted
+	UINT offset;			// characters inserted: offset of their UTF-8 form in the script
+	UINT length;			// characters inserted: length of their UTF-8 form in bytes
+	UINT key;				// keystroke passed back to the application
+	UINT state;				// shift state of the keystroke passed back
+} KMFLEDIT;
+
+// Results of kmfl_interpret_batch(). Zero it before it is first used, and release it
+// with kmfl_free_batch()
+typedef struct _kmflbatch {
+	KMFLEDIT *edits;		// edit script
+	UINT nedits;			// number of operations in the edit script
+	char *script;			// characters inserted by the edit script (UTF-8)
+	char *text;				// text left by the batch (UTF-8, null terminated)
+	UINT textlen;			// length of the text in bytes
+	UINT nerased;			// characters erased from the text before the batch
+	int failed;				// set if memory ran out
+	UINT maxedits;			// work areas: edits allocated,
+	ITEM *chars;			//   characters inserted by the edit script,
+	UINT nchars, maxchars;
+	ITEM *output;			//   characters of the text left by the batch,
+	UINT noutput, maxoutput;
+	UINT scriptsize;		//   and bytes allocated for the script and the text
+	UINT textsize;
+} KMFLBATCH;
+
+// Counts and times (in nanoseconds) for one rule of a keyboard being profiled
+typedef struct _kmflrulestats {
+	unsigned long attempts;	// times the rule was compared with the history
+	unsigned long matches;	// times it matched
+	double match_time;		// time spent comparing it
+	double process_time;	// time spent processing its output, including groups it uses
+} KMFLRULESTATS;
+
+// Counts and times for one group of a keyboard being profiled
+typedef struct _kmflgroupstats {
+	unsigned long calls;	// times the group was processed
+	unsigned long handled;	// times one of its rules (or match or nomatch) produced output
+	double time;			// time spent in the group, including groups it uses
+} KMFLGROUPSTATS;
+
+// Profile of the rules used by an instance, started by kmfl_start_profile(). It is
+// cleared when the instance moves to another keyboard or to reloaded tables
+typedef struct _kmflprofile {
+	char kbd_name[NAMELEN+1];	// name of the keyboard profiled
+	UINT ngroups;
+	UINT nrules;
+	KMFLGROUPSTATS *groups;	// counts for each group
+	KMFLRULESTATS *rules;	// counts for each rule (numbered as in the compiled keyboard)
+	UINT *group_lines;		// source line of each group (0 if the keyboard has no XS_LINES)
+	UINT *rule_lines;		// source line of each rule
+	UINT *rule_groups;		// group of each rule
+	unsigned long keystrokes;	// keystrokes interpreted
+	double time;			// time spent in kmfl_interpret()
+	unsigned long callbacks;	// calls to the output functions of the application
+	double callback_time;	// time spent in them
+} KMFLPROFILE;
+
 KMFL_EXPORT
 int kmfl_interpret(KMSI *p_kmsi, UINT key, UINT state);
+int kmfl_interpret_keystroke(KMSI *p_kmsi, UINT key, UINT state);
+
+KMFL_EXPORT
+int kmfl_interpret_batch(KMSI *p_kmsi, const KMFLKEY *keys, UINT nkeys, KMFLBATCH *batch);
+
+KMFL_EXPORT
+void kmfl_free_batch(KMFLBATCH *batch);
+
+KMFL_EXPORT
+long kmfl_transliterate_file(KMSI *p_kmsi, FILE *in, FILE *out, unsigned long *p_nread);
+
+KMFL_EXPORT
+int kmfl_start_profile(KMSI *p_kmsi);
+KMFL_EXPORT
+void kmfl_stop_profile(KMSI *p_kmsi);
+KMFL_EXPORT
+int kmfl_write_profile(KMSI *p_kmsi, FILE *fp);
+
+void kmfl_reset_profile(KMSI *p_kmsi, KMFLTABLES *tables);
+double kmfl_profile_clock(void);
+int kmfl_profile_keystroke(KMSI *p_kmsi, UINT key, UINT state);
+int kmfl_profile_group(KMSI *p_kmsi, XGROUP *gp);
+int kmfl_profile_match_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys);
+int kmfl_profile_process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys);
+void kmfl_profile_callback(KMSI *p_kmsi, double t);
+
+void kmfl_batch_insert(KMFLBATCH *batch, const ITEM *items, UINT nitems);
+void kmfl_batch_erase(KMFLBATCH *batch);
+void kmfl_batch_event(KMFLBATCH *batch, UINT op, UINT key, UINT state);
 KMFL_EXPORT
 int kmfl_load_keyboard(const char *file);
 KMFL_EXPORT
 int kmfl_check_keyboard(const char *file);
+KMFL_EXPORT
+int kmfl_load_keyboard_from_buffer(void *keyboard_buffer, unsigned long size, int owned);
+KMFL_EXPORT
+int kmfl_check_keyboard_buffer(const void *keyboard_buffer, unsigned long size);
 KMFL_EXPORT
 int kmfl_reload_keyboard(int keyboard_number);
 KMFL_EXPORT
 int kmfl_reload_all_keyboards(void);
+KMFL_EXPORT
+int kmfl_reload_keyboard_in_background(int keyboard_number);
 KMFL_EXPORT
 int kmfl_unload_keyboard(int keyboard_number);
 KMFL_EXPORT
@@ -58,6 +180,8 @@ KMFL_EXPORT
 int kmfl_attach_keyboard(KMSI *p_kmsi, int keyboard_number);
 KMFL_EXPORT
 int kmfl_detach_keyboard(KMSI *p_kmsi);
+void kmfl_update_keyboard(KMSI *p_kmsi);
+KMFLTABLES *kmfl_instance_tables(KMSI *p_kmsi);
 
 KMFL_EXPORT
 int kmfl_keyboard_number(char *name);
@@ -68,7 +192,41 @@ const char *kmfl_icon_file(int keyboard_number);
 
 int kmfl_get_header(KMSI *p_kmsi,int hdrID,char *buf,int buflen);
 
-void DBGMSG(int debug,const char *fmt,...);
+KMFL_EXPORT
+int kmfl_keyboard_tables(XKEYBOARD *p_kbd, unsigned long size, KMFLTABLES *tables);
+int kmfl_check_checksums(XKEYBOARD *p_kbd);
+XDISPATCH *kmfl_map_dispatch(XKEYBOARD *p_kbd, KMFLTABLES *tables);
+XSTOREINDEX *kmfl_map_store_index(XKEYBOARD *p_kbd, KMFLTABLES *tables);
+unsigned long kmfl_add_index_sections(XKEYBOARD **pp_kbd, unsigned long size);
+
+XDISPATCH *kmfl_make_dispatch(XKEYBOARD *p_kbd, KMFLTABLES *tables);
+void kmfl_free_dispatch(XDISPATCH *p_dispatch);
+int kmfl_make_trie(XDISPATCH *dp, XGROUP *gp, XRULE *rules, XSTORE *stores, ITEM *strings);
+XSTOREINDEX *kmfl_make_store_index(XKEYBOARD *p_kbd, KMFLTABLES *tables);
+void kmfl_free_store_index(XSTOREINDEX *p_index);
+int kmfl_find_in_store(XSTOREINDEX *p_index, ITEM item, int ignore_type);
+XKEYBOARD *kmfl_load_cached_keyboard(const char *filename, char *cache_key, size_t *p_map_size, unsigned long *p_size);
+void kmfl_save_cached_keyboard(const char *filename, const char *cache_key, XKEYBOARD *p_kbd, unsigned long size);
+
+// Debug message levels, tested against kmfl_debug
+#define KMFL_DEBUG_GENERAL	1		// loading keyboards, instances and other events
+#define KMFL_DEBUG_TRACE	2		// each rule and keystroke processed
+
+// Levels of debug messages compiled in. Others cost nothing, and the ones compiled in
+// cost a test of kmfl_debug unless they are enabled
+#ifndef KMFL_DEBUG_MASK
+#define KMFL_DEBUG_MASK		KMFL_DEBUG_GENERAL
+#endif
+
+#define KMFL_DEBUG_LOG		"/tmp/libkmfldebug.log"
+
+#define DBGMSG(debug, ...) \
+	do { if(((debug) & KMFL_DEBUG_MASK) != 0 && ((debug) & kmfl_debug) != 0) \
+		kmfl_debug_message((debug), __VA_ARGS__); } while(0)
+
+void kmfl_debug_message(int debug, const char *fmt, ...);
+KMFL_EXPORT
+int kmfl_dump_debug_log(FILE *fp);
 void *ERRMSG(const char *fmt,...);
 KMFL_EXPORT
 void clear_history(KMSI *p_kmsi);
@@ -76,6 +234,14 @@ KMFL_EXPORT
 int deadkey_in_history(KMSI *p_kmsi);
 KMFL_EXPORT
 void set_history(KMSI *p_kmsi, ITEM * items, UINT nitems);
+KMFL_EXPORT
+ITEM kmfl_history_item(KMSI *p_kmsi, UINT n);
+KMFL_EXPORT
+UINT kmfl_history_length(KMSI *p_kmsi);
+
+// History item n of an instance (0 is the keystroke, 1 the most recent character)
+#define HISTORY_MASK	(HISTORY_SIZE-1)
+#define HISTORY_ITEM(p_kmsi,n)	((p_kmsi)->history_buffer[((p_kmsi)->history_start+(n)) & HISTORY_MASK])
 
 extern int kmfl_debug;
 
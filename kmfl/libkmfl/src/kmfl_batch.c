@@ -0,0 +1,480 @@
+/* kmfl_batch.c
+ * Copyright (C) 2026 ThanLwinSoft.org
+ *
+ * This file is part of the KMFL library.
+ *
+ * The KMFL library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * The KMFL library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with the KMFL library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ *
+ */
+
+/*
+
+	Keystroke interpreter for keyboard mapping for Linux project
+
+	Batch interpretation
+
+	Notes:
+		kmfl_interpret_batch() interprets a sequence of keystrokes in one call. While
+		it runs, the interpreter records what it would have done with output_string(),
+		erase_char(), output_beep() and forward_keyevent() in an edit script, instead
+		of calling them for each keystroke.
+
+		Insertions and erasures are merged as they are recorded, so an erasure removes
+		the last character inserted if it is still at the end of the script. Beeps and
+		keystrokes passed back to the application (including those the keyboard does
+		not handle) are kept in order, as the application may change its text when it
+		handles a keystroke.
+
+		The characters are converted to UTF-8 once, at the end of the batch, along
+		with the text left by the whole batch: the characters inserted, less those
+		erased again.
+
+		kmfl_transliterate_file() types a UTF-8 file with a keyboard, one block at a
+		time. Latin-1 characters are typed as themselves, and control characters as
+		the keysyms of the matching keys (Return, Tab, etc.), which the keyboard passes
+		back to be output as they are. Other characters cannot be typed, so they are
+		output as they are and end the history, as for keys that an application
+		handles itself. The output is held back by 2*MAX_HISTORY characters before
+		it is written, as the next keystrokes can still erase them (rules only erase
+		characters in the history), so memory use does not depend on the size of
+		the file.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kmfl/kmfl.h>
+#include <kmfl/kmflutfconv.h>
+#include "libkmfl.h"
+
+// Characters that can be converted to UTF-8, as in process_output_queue()
+#define VALID_CHAR(c)	((c) <= 0x10ffff && ((c) & 0xfffff800) != 0xd800)
+
+// Number of bytes in the UTF-8 form of a valid character
+#define UTF8_LENGTH(c)	((c) < 0x80 ? 1 : (c) < 0x800 ? 2 : (c) < 0x10000 ? 3 : 4)
+
+// Bytes of input typed in each batch by kmfl_transliterate_file()
+#define TRANSLIT_BLOCK	65536
+
+// Characters of output held back in case the next keystrokes erase them
+#define TRANSLIT_KEEP	(2*MAX_HISTORY)
+
+// Output of kmfl_transliterate_file() that has not been written yet
+typedef struct _kmfltext {
+	char *buf;				// UTF-8 text
+	UINT len;				// length of the text in bytes
+	UINT size;				// bytes allocated
+	UINT nchars;			// number of characters in the text
+} KMFLTEXT;
+
+// Make room for more items in one of the arrays of a batch
+static int grow_array(KMFLBATCH *batch, void **array, UINT *size, UINT needed, size_t itemsize)
+{
+	void *p;
+	UINT n;
+
+	if(needed <= *size) return 1;
+	if(batch->failed) return 0;
+
+	for(n=*size ? *size : 64; n<needed; n*=2);
+
+	if((p=realloc(*array, n*itemsize)) == NULL)
+	{
+		ERRMSG("Out of memory in kmfl_interpret_batch()\n");
+		batch->failed = 1;
+		return 0;
+	}
+	*array = p;
+	*size = n;
+	return 1;
+}
+
+// Add an operation to the edit script
+static KMFLEDIT *add_edit(KMFLBATCH *batch, UINT op)
+{
+	KMFLEDIT *ep;
+
+	if(!grow_array(batch, (void **)&batch->edits, &batch->maxedits, batch->nedits+1, sizeof(KMFLEDIT)))
+		return NULL;
+
+	ep = batch->edits+batch->nedits++;
+	memset(ep, 0, sizeof(KMFLEDIT));
+	ep->op = op;
+	return ep;
+}
+
+// Record the characters output for a keystroke
+void kmfl_batch_insert(KMFLBATCH *batch, const ITEM *items, UINT nitems)
+{
+	KMFLEDIT *ep;
+	UINT n;
+
+	if(nitems == 0) return;
+
+	// The output for a keystroke is dropped if any of it cannot be converted
+	for(n=0; n<nitems; n++)
+	{
+		if(!VALID_CHAR(items[n]))
+		{
+			ERRMSG("Exceeded maximum length of output allowed from any one key event.\n");
+			return;
+		}
+	}
+
+	if(!grow_array(batch, (void **)&batch->chars, &batch->maxchars, batch->nchars+nitems, sizeof(ITEM))
+		|| !grow_array(batch, (void **)&batch->output, &batch->maxoutput, batch->noutput+nitems, sizeof(ITEM)))
+		return;
+
+	if(batch->nedits > 0 && batch->edits[batch->nedits-1].op == KMFL_EDIT_INSERT)
+		ep = batch->edits+batch->nedits-1;
+	else if((ep=add_edit(batch, KMFL_EDIT_INSERT)) == NULL)
+		return;
+
+	memcpy(batch->chars+batch->nchars, items, nitems*sizeof(ITEM));
+	memcpy(batch->output+batch->noutput, items, nitems*sizeof(ITEM));
+	batch->nchars += nitems;
+	batch->noutput += nitems;
+	ep->count += nitems;
+}
+
+// Record the erasure of a character
+void kmfl_batch_erase(KMFLBATCH *batch)
+{
+	KMFLEDIT *ep;
+
+	if(batch->noutput > 0)
+		batch->noutput--;
+	else
+		batch->nerased++;
+
+	// Take the character back if it was the last one inserted
+	if(batch->nedits > 0 && (ep=batch->edits+batch->nedits-1)->op == KMFL_EDIT_INSERT)
+	{
+		batch->nchars--;
+		if(--ep->count == 0) batch->nedits--;
+		return;
+	}
+
+	if(batch->nedits > 0 && (ep=batch->edits+batch->nedits-1)->op == KMFL_EDIT_ERASE)
+		ep->count++;
+	else if((ep=add_edit(batch, KMFL_EDIT_ERASE)) != NULL)
+		ep->count = 1;
+}
+
+// Record a beep, or a keystroke passed back to the application
+void kmfl_batch_event(KMFLBATCH *batch, UINT op, UINT key, UINT state)
+{
+	KMFLEDIT *ep;
+
+	if((ep=add_edit(batch, op)) != NULL)
+	{
+		ep->key = key;
+		ep->state = state;
+	}
+}
+
+// Convert characters to a null terminated UTF-8 string, returning its length
+static UINT utf8_string(KMFLBATCH *batch, char **pp, UINT *size, const ITEM *items, UINT nitems)
+{
+	const UTF32 *pin;
+	UTF8 *pout;
+
+	if(!grow_array(batch, (void **)pp, size, 4*nitems+1, sizeof(char)))
+		return 0;
+
+	pin = (const UTF32 *)items;
+	pout = (UTF8 *)*pp;
+	IConvertUTF32toUTF8(&pin, pin+nitems, &pout, (UTF8 *)*pp+4*nitems);
+	*pout = 0;
+	return (UINT)(pout-(UTF8 *)*pp);
+}
+
+// Interpret a sequence of keystrokes, making an edit script and the text left by them
+// instead of calling the output routines. The results are the same as calling
+// kmfl_interpret() for each keystroke in turn. The batch must be zeroed before it is
+// first used, and can be used again for other batches. Returns the number of
+// keystrokes handled by the keyboard, or -1 on error
+int kmfl_interpret_batch(KMSI *p_kmsi, const KMFLKEY *keys, UINT nkeys, KMFLBATCH *batch)
+{
+	KMFLEDIT *ep;
+	const ITEM *pc;
+	UINT n, k, offset;
+	int nhandled=0;
+
+	if(p_kmsi == NULL || batch == NULL || (keys == NULL && nkeys > 0)) return -1;
+
+	batch->nedits = batch->nchars = batch->noutput = batch->nerased = 0;
+	batch->failed = 0;
+
+	p_kmsi->batch = batch;
+	for(n=0; n<nkeys; n++)
+	{
+		if(kmfl_interpret(p_kmsi, keys[n].key, keys[n].state))
+			nhandled++;
+		else
+			kmfl_batch_event(batch, KMFL_EDIT_FORWARD, keys[n].key, keys[n].state);
+	}
+	p_kmsi->batch = NULL;
+
+	// Convert the characters inserted by the script, and the text left by the batch
+	utf8_string(batch, &batch->script, &batch->scriptsize, batch->chars, batch->nchars);
+	batch->textlen = utf8_string(batch, &batch->text, &batch->textsize, batch->output, batch->noutput);
+
+	if(batch->failed) return -1;
+
+	// Find the characters of each insertion in the script
+	for(n=0, ep=batch->edits, pc=batch->chars, offset=0; n<batch->nedits; n++, ep++)
+	{
+		if(ep->op != KMFL_EDIT_INSERT) continue;
+
+		ep->offset = offset;
+		for(k=0; k<ep->count; k++, pc++)
+			offset += UTF8_LENGTH(*pc);
+		ep->length = offset-ep->offset;
+	}
+
+	return nhandled;
+}
+
+// Free the memory used by a batch
+void kmfl_free_batch(KMFLBATCH *batch)
+{
+	if(batch == NULL) return;
+
+	free(batch->edits);
+	free(batch->chars);
+	free(batch->output);
+	free(batch->script);
+	free(batch->text);
+	memset(batch, 0, sizeof(KMFLBATCH));
+}
+
+// Add UTF-8 characters to the output not yet written
+static int put_text(KMFLTEXT *tp, const char *p, UINT len, UINT nchars)
+{
+	char *buf;
+	UINT n;
+
+	if(tp->len+len > tp->size)
+	{
+		for(n=tp->size ? tp->size : 4096; n<tp->len+len; n*=2);
+		if((buf=(char *)realloc(tp->buf, n)) == NULL)
+		{
+			ERRMSG("Out of memory in kmfl_transliterate_file()\n");
+			return 0;
+		}
+		tp->buf = buf;
+		tp->size = n;
+	}
+	memcpy(tp->buf+tp->len, p, len);
+	tp->len += len;
+	tp->nchars += nchars;
+	return 1;
+}
+
+// Add a character to the output not yet written
+static int put_char(KMFLTEXT *tp, ITEM c)
+{
+	UTF32 utfin[1];
+	UTF8 utfout[4], *pout=utfout;
+	const UTF32 *pin=utfin;
+
+	utfin[0] = c;
+	if(IConvertUTF32toUTF8(&pin, utfin+1, &pout, utfout+4) == (size_t)-1)
+		return 1;		// not a character: output nothing
+	return put_text(tp, (char *)utfout, (UINT)(pout-utfout), 1);
+}
+
+// Erase the last character of the output not yet written (if there is one)
+static void erase_text(KMFLTEXT *tp)
+{
+	if(tp->nchars == 0) return;
+
+	while(tp->len > 0 && (tp->buf[--tp->len] & 0xc0) == 0x80);
+	tp->nchars--;
+}
+
+// Write the output, except for the last characters (keep of them)
+static int write_text(KMFLTEXT *tp, FILE *out, UINT keep, unsigned long *p_nwritten)
+{
+	UINT len, n;
+
+	if(tp->nchars <= keep) return 1;
+
+	// Find the start of the characters to be kept
+	for(len=tp->len, n=0; n<keep; n++)
+	{
+		while(len > 0 && (tp->buf[--len] & 0xc0) == 0x80);
+	}
+
+	if(len > 0 && fwrite(tp->buf, 1, len, out) != len) return 0;
+	*p_nwritten += len;
+
+	memmove(tp->buf, tp->buf+len, tp->len-len);
+	tp->len -= len;
+	tp->nchars = keep;
+	return 1;
+}
+
+// The character output by a keystroke passed back by the keyboard (or 0 if none)
+static ITEM forwarded_char(UINT key)
+{
+	if(key < 0x100) return key;
+	if(key >= 0xff00 && key < 0xff20) return key & 0x1f;	// Return, Tab, Escape, etc.
+	return 0;
+}
+
+// Decode UTF-8 input into keystrokes, returning the number of bytes decoded. A character
+// cut off at the end of the input is left for the next block, unless this is the last one.
+// Decoding stops after a character that cannot be typed, which is returned in p_char
+static size_t input_keys(const unsigned char *p, size_t len, int last, KMFLKEY *keys, UINT *p_nkeys, ITEM *p_char)
+{
+	size_t i, n, k;
+	UINT c, nkeys=0;
+
+	*p_char = 0;
+	for(i=0; i<len; i+=n, nkeys++)
+	{
+		c = p[i];
+		if(c < 0x80) n = 1;
+		else if((c & 0xe0) == 0xc0) { n = 2; c &= 0x1f; }
+		else if((c & 0xf0) == 0xe0) { n = 3; c &= 0x0f; }
+		else if((c & 0xf8) == 0xf0) { n = 4; c &= 0x07; }
+		else { n = 1; c = 0xfffd; }
+
+		if(n > 1)
+		{
+			if(i+n > len && !last) break;
+			for(k=1; k<n && i+k<len && (p[i+k] & 0xc0) == 0x80; k++)
+				c = (c << 6) | (p[i+k] & 0x3f);
+			if(k < n) { n = k; c = 0xfffd; }
+		}
+
+		if(c >= 0x100)
+		{
+			*p_char = c;
+			i += n;
+			break;
+		}
+
+		// Latin-1 characters are typed as themselves, control characters as the keys
+		// that X gives the same code (BackSpace, Tab, Linefeed, Return, Escape, etc.)
+		keys[nkeys].key = (c < 0x20) ? (0xff00 | c) : c;
+		keys[nkeys].state = 0;
+	}
+
+	*p_nkeys = nkeys;
+	return i;
+}
+
+// Type the UTF-8 text read from a file with the keyboard attached to an instance, and
+// write the text that it makes. Returns the number of bytes written, or -1 on error.
+// The number of bytes read is returned in p_nread if it is not NULL
+long kmfl_transliterate_file(KMSI *p_kmsi, FILE *in, FILE *out, unsigned long *p_nread)
+{
+	KMFLBATCH batch;
+	KMFLTEXT text;
+	KMFLEDIT *ep;
+	KMFLKEY *keys;
+	unsigned char *block;
+	unsigned long nread=0, nwritten=0;
+	size_t pos=0, len=0, n;
+	UINT nkeys, e, k;
+	ITEM c, pass;
+	int last=0, ok=1;
+
+	if(p_kmsi == NULL || in == NULL || out == NULL) return -1;
+
+	memset(&batch, 0, sizeof(batch));
+	memset(&text, 0, sizeof(text));
+	block = (unsigned char *)malloc(TRANSLIT_BLOCK);
+	keys = (KMFLKEY *)malloc(TRANSLIT_BLOCK*sizeof(KMFLKEY));
+	if(block == NULL || keys == NULL)
+	{
+		ERRMSG("Out of memory in kmfl_transliterate_file()\n");
+		ok = 0;
+	}
+
+	while(ok && (!last || pos < len))
+	{
+		// Refill the block once it has been typed, after any character cut off at its end
+		if(!last && (pos == len || len-pos < 4))
+		{
+			memmove(block, block+pos, len-pos);
+			len -= pos;
+			pos = 0;
+			n = fread(block+len, 1, TRANSLIT_BLOCK-len, in);
+			nread += n;
+			len += n;
+			if(n == 0) last = 1;
+		}
+
+		pos += input_keys(block+pos, len-pos, last, keys, &nkeys, &pass);
+
+		if(kmfl_interpret_batch(p_kmsi, keys, nkeys, &batch) < 0)
+		{
+			ok = 0;
+			break;
+		}
+
+		// Apply the edit script to the output not yet written
+		for(e=0, ep=batch.edits; ok && e<batch.nedits; e++, ep++)
+		{
+			switch(ep->op)
+			{
+			case KMFL_EDIT_INSERT:
+				ok = put_text(&text, batch.script+ep->offset, ep->length, ep->count);
+				break;
+			case KMFL_EDIT_ERASE:
+				for(k=0; k<ep->count; k++) erase_text(&text);
+				break;
+			case KMFL_EDIT_FORWARD:
+				if(ep->key == 0xff08)
+					erase_text(&text);
+				else if((c=forwarded_char(ep->key)) != 0)
+					ok = put_char(&text, c);
+				break;
+			}
+		}
+
+		// Output a character that cannot be typed as an application would
+		if(ok && pass != 0)
+		{
+			ok = put_char(&text, pass);
+			clear_history(p_kmsi);
+		}
+
+		if(ok && !write_text(&text, out, (last && pos == len) ? 0 : TRANSLIT_KEEP, &nwritten))
+		{
+			ERRMSG("Failed to write the transliterated text\n");
+			ok = 0;
+		}
+	}
+
+	if(ferror(in))
+	{
+		ERRMSG("Failed to read the text to be transliterated\n");
+		ok = 0;
+	}
+
+	kmfl_free_batch(&batch);
+	free(text.buf);
+	free(keys);
+	free(block);
+
+	if(p_nread) *p_nread = nread;
+	return ok ? (long)nwritten : -1;
+}
@@ -0,0 +1,362 @@
+/* kmfl_cache.c
+ * Copyright (C) 2026 ThanLwinSoft.org
+ *
+ * This file is part of the KMFL library.
+ *
+ * The KMFL library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * The KMFL library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with the KMFL library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ *
+ */
+
+/*
+
+	Keystroke interpreter for keyboard mapping for Linux project
+
+	Compiled keyboard cache
+
+	Notes:
+		Compiling a .kmn source takes far longer than mapping a compiled keyboard,
+		so the keyboards compiled by kmfl_load_keyboard_from_file() are saved in a
+		cache directory ($KMFL_CACHE_DIR, else $XDG_CACHE_HOME/kmfl, else
+		~/.cache/kmfl). Setting KMFL_NO_CACHE disables the cache. Cached keyboards
+		also hold the rule dispatch index and store lookup tables built by the
+		interpreter (see kmfl_sections.c).
+
+		Cache files are named after a 64 bit FNV-1a hash of everything the compiled
+		keyboard depends on: the compiler version, the version of the layout of the
+		index sections (XS_INDEX_VERSION), the X display (used to shift keysyms),
+		the source file name (the default keyboard name) and the source text. A
+		changed source, compiler or index layout therefore simply uses another entry.
+
+		The only other input is the BITMAP store, which the compiler replaces by
+		the name of the bitmap file it finds next to the source. For keyboards
+		with a bitmap, each cache file ends with a list of dependencies (the size
+		and modification time of the source directory and of the bitmap file), and
+		the entry is only used while they are unchanged. The list is followed by a
+		CACHETRAILER, which is also written for keyboards without dependencies.
+
+		Entries are written to a temporary file (made by mkstemp) which is then
+		renamed, so that a process loading the same keyboard never sees a partial
+		file.
+*/
+
+#ifndef _WIN32
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <setjmp.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include <kmfl/kmfl.h>
+#include <kmfl/kmflcomp.h>
+#include <kmfl/kmflutfconv.h>
+#include "libkmfl.h"
+
+#define CACHE_ID		"KMFLDEPS"
+#define FNV_OFFSET		0xcbf29ce484222325ULL
+#define FNV_PRIME		0x100000001b3ULL
+#define MAX_DEPENDS		(2*PATH_MAX+128)
+
+// End of a cache file, after the keyboard and its dependency list
+typedef struct _cachetrailer {
+	unsigned int kbd_size;		// size of the compiled keyboard
+	unsigned int dep_size;		// size of the dependency list
+	char id[8];					// CACHE_ID
+} CACHETRAILER;
+
+// Add a block of bytes to a hash
+static unsigned long long hash_bytes(unsigned long long h, const void *p, size_t n)
+{
+	const unsigned char *s=(const unsigned char *)p;
+
+	while(n--)
+	{
+		h ^= *s++;
+		h *= FNV_PRIME;
+	}
+	return h;
+}
+
+// Add a string, including its terminating null, to a hash
+static unsigned long long hash_string(unsigned long long h, const char *s)
+{
+	return hash_bytes(h, s ? s : "", s ? strlen(s)+1 : 1);
+}
+
+// Find the cache directory, creating it if necessary. Returns 0 on success
+static int cache_directory(char *dir, size_t len)
+{
+	const char *p;
+
+	if(getenv("KMFL_NO_CACHE") != NULL) return -1;
+
+	if((p=getenv("KMFL_CACHE_DIR")) != NULL && *p)
+	{
+		if(strlen(p) >= len) return -1;
+		strcpy(dir, p);
+	}
+	else if((p=getenv("XDG_CACHE_HOME")) != NULL && *p)
+	{
+		if(strlen(p)+6 >= len) return -1;
+		sprintf(dir, "%s/kmfl", p);
+	}
+	else if((p=getenv("HOME")) != NULL && *p)
+	{
+		if(strlen(p)+13 >= len) return -1;
+		sprintf(dir, "%s/.cache", p);
+		mkdir(dir, 0700);
+		strcat(dir, "/kmfl");
+	}
+	else return -1;
+
+	if(mkdir(dir, 0700) != 0 && errno != EEXIST) return -1;
+	return 0;
+}
+
+// Make the name of the cache file for a key
+static int cache_file_name(const char *cache_key, char *path, size_t len)
+{
+	char dir[PATH_MAX];
+
+	if(cache_directory(dir, sizeof(dir)) != 0) return -1;
+	if(strlen(dir)+strlen(cache_key)+7 >= len) return -1;
+	sprintf(path, "%s/%s.kmfl", dir, cache_key);
+	return 0;
+}
+
+// Hash the source file and everything else the compiled keyboard depends on
+static int make_cache_key(const char *filename, char *cache_key)
+{
+	unsigned long long h=FNV_OFFSET;
+	char buf[4096];
+	const char *p;
+	size_t n;
+	FILE *fp;
+
+	if((fp=fopen(filename,"rb")) == NULL) return -1;
+
+	h = hash_string(h, compiler_version());
+	h = hash_string(h, XS_INDEX_VERSION);
+	h = hash_string(h, getenv("DISPLAY"));
+	p = strrchr(filename, '/');
+	h = hash_string(h, p ? p+1 : filename);
+
+	while((n=fread(buf, 1, sizeof(buf), fp)) > 0)
+		h = hash_bytes(h, buf, n);
+
+	if(ferror(fp))
+	{
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+
+	sprintf(cache_key, "%016llx", h);
+	return 0;
+}
+
+// Get the name of the bitmap file of a compiled keyboard, checking that the
+// keyboard is large enough to hold it. Returns the length of the name
+static size_t bitmap_name(XKEYBOARD *p_kbd, size_t size, char *name, size_t len)
+{
+	KMFLTABLES tables;
+	XSTORE *sp;
+	UTF32 *p32;
+	UTF8 *p8;
+
+	*name = 0;
+	if(p_kbd->nstores <= SS_BITMAP) return 0;
+	if(kmfl_keyboard_tables(p_kbd, size, &tables) != 0) return 0;
+
+	sp = tables.stores+SS_BITMAP;
+	if(sp->len == 0 || sp->items > tables.nstrings || sp->len > tables.nstrings-sp->items) return 0;
+
+	p32 = tables.strings+sp->items;
+	p8 = (UTF8 *)name;
+	IConvertUTF32toUTF8((const UTF32 **)&p32, p32+sp->len, &p8, (UTF8 *)(name+len-1));
+	*p8 = 0;
+	return strlen(name);
+}
+
+// Add the size and modification time of a file to a dependency list
+static void add_dependency(char *deps, const char *path)
+{
+	struct stat fstat;
+	char *p=deps+strlen(deps);
+
+	if(stat(path, &fstat) == 0)
+		sprintf(p, "%lld %lld %ld %s\n", (long long)fstat.st_size,
+			(long long)fstat.st_mtim.tv_sec, (long)fstat.st_mtim.tv_nsec, path);
+	else
+		sprintf(p, "-1 0 0 %s\n", path);
+}
+
+// List the files other than the source which the compiled keyboard depends on.
+// Returns the length of the list, or -1 if it cannot be made
+static int make_dependencies(const char *filename, XKEYBOARD *p_kbd, size_t size, char *deps)
+{
+	char dir[PATH_MAX], path[PATH_MAX], name[256];
+	const char *p;
+
+	*deps = 0;
+
+	// Only the bitmap file is looked for by the compiler
+	if(bitmap_name(p_kbd, size, name, sizeof(name)) == 0) return 0;
+
+	// The bitmap is found in the same directory as the source
+	if((p=strrchr(filename, '/')) != NULL)
+	{
+		if((size_t)(p-filename) >= sizeof(path)) return -1;
+		strncpy(path, filename, p-filename);
+		path[p-filename] = 0;
+		if(*path == 0) strcpy(path, "/");
+	}
+	else strcpy(path, ".");
+
+	if(realpath(path, dir) == NULL) return -1;
+	if(strlen(dir)+strlen(name)+2 >= sizeof(path)) return -1;
+	strcpy(path, dir);
+	strcat(path, "/");
+	strcat(path, name);
+
+	// Adding or renaming files in the directory may change which bitmap is found
+	add_dependency(deps, dir);
+	add_dependency(deps, path);
+	return (int)strlen(deps);
+}
+
+// Map a cached compiled keyboard for a source file, if there is a valid one. The key of the
+// cache entry is returned in cache_key (or an empty string if the cache cannot be used), 
+// and the size of the keyboard in *p_size
+XKEYBOARD *kmfl_load_cached_keyboard(const char *filename, char *cache_key, size_t *p_map_size, unsigned long *p_size)
+{
+	char path[PATH_MAX], deps[MAX_DEPENDS];
+	struct stat fileinfo;
+	CACHETRAILER trailer;
+	KMFLTABLES tables;
+	XKEYBOARD *p_kbd;
+	size_t filelen;
+	int fd, ndeps;
+
+	*cache_key = 0;
+	*p_map_size = 0;
+
+	if(make_cache_key(filename, cache_key) != 0)
+	{
+		*cache_key = 0;
+		return NULL;
+	}
+	if(cache_file_name(cache_key, path, sizeof(path)) != 0)
+	{
+		*cache_key = 0;
+		return NULL;
+	}
+
+	if((fd=open(path,O_RDONLY)) < 0)
+		return NULL;
+
+	if(fstat(fd, &fileinfo) != 0 || (size_t)fileinfo.st_size < sizeof(XKEYBOARD)+sizeof(CACHETRAILER))
+	{
+		close(fd);
+		return NULL;
+	}
+	filelen = fileinfo.st_size;
+
+	p_kbd = (XKEYBOARD *)mmap(NULL, filelen, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(p_kbd == (XKEYBOARD *)MAP_FAILED)
+		return NULL;
+
+	// Check the trailer, and that the dependencies have not changed
+	memcpy(&trailer, (char *)p_kbd+filelen-sizeof(CACHETRAILER), sizeof(CACHETRAILER));
+	if(memcmp(trailer.id, CACHE_ID, sizeof(trailer.id)) != 0
+		|| (size_t)trailer.kbd_size+trailer.dep_size+sizeof(CACHETRAILER) != filelen
+		|| trailer.dep_size >= sizeof(deps)
+		|| (ndeps=make_dependencies(filename, p_kbd, trailer.kbd_size, deps)) < 0
+		|| (UINT)ndeps != trailer.dep_size
+		|| memcmp(deps, (char *)p_kbd+trailer.kbd_size, ndeps) != 0)
+	{
+		DBGMSG(1,"Cached keyboard %s is out of date\n",path);
+		munmap((void *)p_kbd, filelen);
+		return NULL;
+	}
+
+	// A damaged entry would fail to load every time, so remove it and compile the source
+	if(memcmp(p_kbd->id,"KMFL",4) != 0
+		|| kmfl_keyboard_tables(p_kbd, trailer.kbd_size, &tables) != 0
+		|| kmfl_check_checksums(p_kbd) != 0)
+	{
+		DBGMSG(1,"Cached keyboard %s is corrupt\n",path);
+		munmap((void *)p_kbd, filelen);
+		unlink(path);
+		return NULL;
+	}
+
+	DBGMSG(1,"Using cached keyboard %s for %s\n",path,filename);
+	*p_map_size = filelen;
+	*p_size = trailer.kbd_size;
+	return p_kbd;
+}
+
+// Save a compiled keyboard in the cache
+void kmfl_save_cached_keyboard(const char *filename, const char *cache_key, XKEYBOARD *p_kbd, unsigned long size)
+{
+	char path[PATH_MAX], tmpname[PATH_MAX+32], deps[MAX_DEPENDS];
+	CACHETRAILER trailer;
+	FILE *fp;
+	int fd, ndeps, ok;
+
+	if(*cache_key == 0 || size < sizeof(XKEYBOARD)) return;
+	if(cache_file_name(cache_key, path, sizeof(path)) != 0) return;
+	if((ndeps=make_dependencies(filename, p_kbd, size, deps)) < 0) return;
+
+	trailer.kbd_size = (unsigned int)size;
+	trailer.dep_size = (unsigned int)ndeps;
+	memcpy(trailer.id, CACHE_ID, sizeof(trailer.id));
+
+	// Write to a temporary file, then replace the cache entry with it. Each writer
+	// has a file of its own, as the same keyboard may be compiled on several threads
+	sprintf(tmpname, "%s.XXXXXX", path);
+	if((fd=mkstemp(tmpname)) < 0) return;
+	if((fp=fdopen(fd,"wb")) == NULL)
+	{
+		close(fd);
+		remove(tmpname);
+		return;
+	}
+
+	ok = (fwrite(p_kbd, 1, size, fp) == size)
+		&& (fwrite(deps, 1, ndeps, fp) == (size_t)ndeps)
+		&& (fwrite(&trailer, 1, sizeof(trailer), fp) == sizeof(trailer));
+	if(fclose(fp) != 0) ok = 0;
+
+	if(!ok || rename(tmpname, path) != 0)
+	{
+		DBGMSG(1,"Unable to save cached keyboard %s\n",path);
+		remove(tmpname);
+		return;
+	}
+
+	DBGMSG(1,"Saved cached keyboard %s for %s\n",path,filename);
+}
+
+#endif
@@ -0,0 +1,186 @@
+/* kmfl_dispatch.c
+ * Copyright (C) 2026 ThanLwinSoft.org
+ *
+ * This file is part of the KMFL library.
+ *
+ * The KMFL library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * The KMFL library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with the KMFL library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ *
+ */
+
+/*
+
+	Keystroke interpreter for keyboard mapping for Linux project
+
+	Rule dispatch index
+
+	Notes:
+		Each rule of a group can only match if the last item of its input rule
+		matches the keystroke (for groups using keys) or the most recent character
+		in the history (for other groups). The index maps the low 16 bits of that
+		item to the list of rules that could possibly match it, so that process_group()
+		only needs to call match_rule() for those candidates.
+
+		Rules ending in a character, deadkey or keysym are placed in the bucket of
+		that item. Rules ending in any() are placed in the bucket of every item in
+		the store. All other rules (notany(), context, nul, index) are placed in the
+		wildcard list, which is merged with the bucket when the group is processed.
+		Both lists keep the sorted order of the rules, so the first matching
+		candidate is always the same rule that a linear scan would have found.
+
+		Groups that can be matched by an automaton (see kmfl_trie.c) also get one,
+		which process_group() uses in preference to the lists.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kmfl/kmfl.h>
+#include "libkmfl.h"
+
+#define MAX_DISPATCH_BUCKETS	1024
+
+// Add a rule to a bucket (skipping duplicates from any() stores), or just count it
+static void add_to_bucket(UINT *count, UINT *last, UINT *list, UINT *fill, UINT bucket, UINT nrule)
+{
+	if(last[bucket] == nrule+1) return;
+	last[bucket] = nrule+1;
+	if(list)
+		list[fill[bucket]++] = nrule;
+	else
+		count[bucket]++;
+}
+
+// Assign each rule of a group to its buckets, or to the wildcard list
+static UINT index_group_rules(XDISPATCH *dp, XGROUP *gp, XRULE *rules, XSTORE *stores, ITEM *strings,
+	UINT *count, UINT *last, UINT *fill)
+{
+	XRULE *rp;
+	XSTORE *sp;
+	ITEM *pr, *ps;
+	UINT n, k, nwild=0, mask=dp->nbuckets-1;
+
+	memset(last, 0, dp->nbuckets*sizeof(UINT));
+
+	for(n=0, rp=rules+gp->rule1; n<gp->nrules; n++, rp++)
+	{
+		pr = (rp->ilen > 0) ? strings+rp->lhs+rp->ilen-1 : NULL;
+
+		switch(pr ? ITEM_TYPE(*pr) : ITEM_NUL)
+		{
+		case ITEM_CHAR:
+		case ITEM_KEYSYM:
+		case ITEM_DEADKEY:
+			add_to_bucket(count, last, dp->rules, fill, (*pr) & mask, n);
+			break;
+
+		case ITEM_ANY:		// no bucket at all if the store is empty, as the rule cannot match
+			sp = stores+((*pr) & 0xffff);
+			for(k=0, ps=strings+sp->items; k<sp->len; k++, ps++)
+				add_to_bucket(count, last, dp->rules, fill, (*ps) & mask, n);
+			break;
+
+		default:
+			if(dp->wild) dp->wild[nwild] = n;
+			nwild++;
+			break;
+		}
+	}
+	return nwild;
+}
+
+// Build the dispatch index for every group of a loaded keyboard
+XDISPATCH *kmfl_make_dispatch(XKEYBOARD *p_kbd, KMFLTABLES *tables)
+{
+	XDISPATCH *p_dispatch, *dp;
+	XSTORE *stores=tables->stores;
+	XGROUP *groups=tables->groups, *gp;
+	XRULE *rules=tables->rules;
+	ITEM *strings=tables->strings;
+	UINT *count, *last, *fill, *p;
+	UINT n, b, ntotal, nbuckets;
+
+	if((p_dispatch=(XDISPATCH *)calloc(p_kbd->ngroups+1, sizeof(XDISPATCH))) == NULL)
+		return NULL;
+
+	count = (UINT *)malloc(MAX_DISPATCH_BUCKETS*sizeof(UINT));
+	last = (UINT *)malloc(MAX_DISPATCH_BUCKETS*sizeof(UINT));
+	fill = (UINT *)malloc(MAX_DISPATCH_BUCKETS*sizeof(UINT));
+	if(!count || !last || !fill)
+		goto fail;
+
+	for(n=0, gp=groups, dp=p_dispatch; n<p_kbd->ngroups; n++, gp++, dp++)
+	{
+		// Use about one bucket per rule
+		for(nbuckets=8; nbuckets<gp->nrules && nbuckets<MAX_DISPATCH_BUCKETS; nbuckets <<= 1);
+		dp->nbuckets = nbuckets;
+
+		// First pass: count the entries in each bucket and the wildcards
+		memset(count, 0, nbuckets*sizeof(UINT));
+		dp->nwild = index_group_rules(dp, gp, rules, stores, strings, count, last, fill);
+
+		for(b=ntotal=0; b<nbuckets; b++) ntotal += count[b];
+
+		// Allocate the bucket offsets, bucket lists and wildcard list as one block
+		if((p=(UINT *)malloc((nbuckets+1+ntotal+dp->nwild+1)*sizeof(UINT))) == NULL)
+			goto fail;
+		dp->buckets = p;
+		dp->rules = p+nbuckets+1;
+		dp->wild = dp->rules+ntotal;
+
+		for(b=0, dp->buckets[0]=0; b<nbuckets; b++)
+		{
+			dp->buckets[b+1] = dp->buckets[b]+count[b];
+			fill[b] = dp->buckets[b];
+		}
+
+		// Second pass: fill the lists
+		index_group_rules(dp, gp, rules, stores, strings, count, last, fill);
+
+		// Use the matching automaton instead of the lists if the group allows it
+		if(kmfl_make_trie(dp, gp, rules, stores, strings))
+			DBGMSG(1,"Matching automaton built for group %d\n",n);
+	}
+
+	free(count); free(last); free(fill);
+	DBGMSG(1,"Rule dispatch index built for %s\n",p_kbd->name);
+	return p_dispatch;
+
+fail:
+	if(count) free(count);
+	if(last) free(last);
+	if(fill) free(fill);
+	kmfl_free_dispatch(p_dispatch);
+	DBGMSG(1,"Unable to build rule dispatch index for %s\n",p_kbd->name);
+	return NULL;
+}
+
+// Release the dispatch index of a keyboard
+void kmfl_free_dispatch(XDISPATCH *p_dispatch)
+{
+	XDISPATCH *dp;
+
+	if(p_dispatch == NULL) return;
+
+	// The array is terminated by an entry with no buckets. The tables of an index read from
+	// an XS_DISPATCH section are part of the keyboard
+	for(dp=p_dispatch; dp->nbuckets > 0; dp++)
+	{
+		if(dp->mapped) continue;
+		if(dp->buckets) free(dp->buckets);
+		if(dp->trie) free(dp->trie);
+	}
+	free(p_dispatch);
+}
@@ -64,13 +64,31 @@
 // Macro to return a string from the string table
 #define ITEMSTRING(x)		(strings+(x))
 
+// Macros to process groups and rules, counting them if the instance is being profiled
+#define PROCESS_GROUP(p_kmsi,gp) \
+	((p_kmsi)->profile ? kmfl_profile_group(p_kmsi,gp) : process_group(p_kmsi,gp))
+#define MATCH_RULE(p_kmsi,rp,any_index,usekeys) ((p_kmsi)->profile \
+	? kmfl_profile_match_rule(p_kmsi,rp,any_index,usekeys) : match_rule(p_kmsi,rp,any_index,usekeys))
+#define PROCESS_RULE(p_kmsi,rp,any_index,usekeys) ((p_kmsi)->profile \
+	? kmfl_profile_process_rule(p_kmsi,rp,any_index,usekeys) : process_rule(p_kmsi,rp,any_index,usekeys))
+
+// Macro to call an output function of the application, timing it if the instance is
+// being profiled
+#define CALL_OUTPUT(p_kmsi,call) \
+	do { if((p_kmsi)->profile == NULL) call; \
+		else { double t_=kmfl_profile_clock(); call; kmfl_profile_callback(p_kmsi,t_); } } while(0)
+
 int process_group(KMSI *p_kmsi, XGROUP *gp);
 int match_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys);
+int match_item(KMSI *p_kmsi, ITEM item, ITEM h, int last);
+void search_trie(KMSI *p_kmsi, XDISPATCH *dp, UINT node, UINT depth, UINT nhistory, int usekeys, UINT *best);
 int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys);
 UINT modified_state(UINT state);
 UINT compare_state(ITEM rule_key, ITEM keystroke);
 
 void erase_char_int(KMSI *p_kmsi);
+void output_beep_int(KMSI *p_kmsi);
+void forward_keyevent_int(KMSI *p_kmsi, UINT key, UINT state);
 void queue_item_for_output(KMSI *p_kmsi, ITEM item);
 void process_output_queue(KMSI *p_kmsi);
 void output_item(void *connection, ITEM x);
@@ -80,6 +98,7 @@ void clear_history(KMSI *p_kmsi);
 
 ITEM *store_content(KMSI *p_kmsi, UINT nstore);
 UINT store_length(KMSI *p_kmsi, UINT nstore);
+int find_in_store(KMSI *p_kmsi, UINT nstore, ITEM item, int ignore_type);
 
 // External routines
 void output_string(void *connection, char *p);
@@ -91,13 +110,6 @@ void erase_char(void *connection);
 
 int kmfl_interpret(KMSI *p_kmsi, UINT key, UINT state) 
 {
-	XKEYBOARD *p_kbd;
-	XGROUP *p_group1;
-	ITEM keysym;
-	int matched;
-
-	p_kmsi->noutput_queue=0;
-	
 	// Test first for modifier key keystrokes and do nothing
 	switch(key) 
 	{
@@ -117,6 +129,24 @@ int kmfl_interpret(KMSI *p_kmsi, UINT key, UINT state)
 
 	if(p_kmsi == NULL || p_kmsi->keyboard == NULL) return 0;
 
+	// Move to the new tables of a keyboard that has been reloaded
+	kmfl_update_keyboard(p_kmsi);
+
+	if(p_kmsi->profile != NULL)
+		return kmfl_profile_keystroke(p_kmsi, key, state);
+	return kmfl_interpret_keystroke(p_kmsi, key, state);
+}
+
+// Interpret a keystroke (other than a modifier key) with the keyboard attached to an instance
+int kmfl_interpret_keystroke(KMSI *p_kmsi, UINT key, UINT state) 
+{
+	XKEYBOARD *p_kbd;
+	XGROUP *p_group1;
+	ITEM keysym;
+	int matched;
+
+	p_kmsi->noutput_queue=0;
+
 	// Pack the state bits into a single byte
 	state = modified_state(state);
 
@@ -124,13 +154,13 @@ int kmfl_interpret(KMSI *p_kmsi, UINT key, UINT state)
 	p_kbd = p_kmsi->keyboard;
 	p_group1 = p_kmsi->groups+p_kbd->group1;
 
-	// Place the current keystroke at the start of the history array
+	// Place the current keystroke at the start of the history
 	keysym = (key & 0xffff) | (state<<16);	
 	keysym = MAKE_ITEM(ITEM_KEYSYM,keysym);
-	p_kmsi->history[0] = keysym;
+	HISTORY_ITEM(p_kmsi,0) = keysym;
 
 	// Pass control to the first group for processing, and return if key was matched
-	if((matched=process_group(p_kmsi, p_group1)) > 0) 
+	if((matched=PROCESS_GROUP(p_kmsi, p_group1)) > 0) 
 	{
 		process_output_queue(p_kmsi);
 		return 1;
@@ -140,8 +170,8 @@ int kmfl_interpret(KMSI *p_kmsi, UINT key, UINT state)
 	if ((state & KS_SHIFT) != 0) 
 	{
 		keysym &= ~((unsigned long)KS_SHIFT<<16);
-		p_kmsi->history[0] = keysym;
-		if((matched=process_group(p_kmsi, p_group1)) > 0) 
+		HISTORY_ITEM(p_kmsi,0) = keysym;
+		if((matched=PROCESS_GROUP(p_kmsi, p_group1)) > 0) 
 		{
 			process_output_queue(p_kmsi);
 			return 1;
@@ -174,7 +204,7 @@ int kmfl_interpret(KMSI *p_kmsi, UINT key, UINT state)
 		return 0;
 	case 0xff1b:		// escape - add to history, let app handle key
 		add_to_history(p_kmsi,(ITEM)0x1b);
-		forward_keyevent(p_kmsi->connection, key, state);
+		forward_keyevent_int(p_kmsi, key, state);
 		return 1;
 	default:
 		clear_history(p_kmsi);
@@ -185,8 +215,9 @@ int kmfl_interpret(KMSI *p_kmsi, UINT key, UINT state)
 // Process a keystroke with a given group of rules
 int process_group(KMSI *p_kmsi, XGROUP *gp) 
 {
-	UINT nrules, n, nhistory;
+	UINT n, nhistory, ib, nb, iw, nw, *pb, *pw, b;
 	XRULE *rp, trule;
+	XDISPATCH *dp;
 	ITEM any_index[MAX_HISTORY+2];
 	int matched, result=0, usekeys, enable_global_matching;
 
@@ -194,22 +225,62 @@ int process_group(KMSI *p_kmsi, XGROUP *gp)
 	usekeys = ((gp->flags & GF_USEKEYS) != 0);
 	nhistory = p_kmsi->nhistory;
 	if(usekeys) nhistory++;
-	p_kmsi->history[nhistory+1-usekeys] = 0;
+	HISTORY_ITEM(p_kmsi,nhistory+1-usekeys) = 0;
+
+	dp = (p_kmsi->dispatch != NULL) ? p_kmsi->dispatch+(gp-p_kmsi->groups) : NULL;
+
+	// Find the first matching rule with the group's matching automaton if it has one
+	if(dp != NULL && dp->trie != NULL)
+	{
+		n = TRIE_NO_RULE;
+		search_trie(p_kmsi,dp,0,0,nhistory,usekeys,&n);
+		if(n != TRIE_NO_RULE)
+		{
+			// Match the rule again to get the offsets of any() items for index()
+			rp = p_kmsi->rules+gp->rule1+n;
+			MATCH_RULE(p_kmsi,rp,any_index,usekeys);
+			result = PROCESS_RULE(p_kmsi,rp,any_index,usekeys);
+		}
+		pb = pw = NULL;
+		nb = nw = 0;
+	}
 
-	nrules = gp->nrules;
+	// Otherwise select the candidate rules for the keystroke (or last character) from the 
+	// dispatch index, or fall back to trying every rule of the group if there is no index
+	else if(dp != NULL)
+	{
+		b = HISTORY_ITEM(p_kmsi,1-usekeys) & (dp->nbuckets-1);
+		pb = dp->rules+dp->buckets[b];
+		nb = dp->buckets[b+1]-dp->buckets[b];
+		pw = dp->wild;
+		nw = dp->nwild;
+	}
+	else
+	{
+		pb = pw = NULL;
+		nb = gp->nrules;
+		nw = 0;
+	}
 
-	// Match rules until either a match is found or all rules have been tried
-	for(n=0,rp=p_kmsi->rules+gp->rule1; n<nrules; n++,rp++) 
+	// Match rules until either a match is found or all candidates have been tried,
+	// merging bucketed and wildcard rules so that they are tried in sorted order
+	for(ib=iw=0; ib<nb || iw<nw; ) 
 	{
+		if(iw == nw || (ib < nb && pb[ib] < pw[iw]))
+			n = pb ? pb[ib++] : ib++;
+		else
+			n = pw[iw++];
+		rp = p_kmsi->rules+gp->rule1+n;
+
 		// Check rule length before matching
 		if((rp->ilen > nhistory+1) || ((rp->ilen == nhistory+1)
 			&& (ITEM_TYPE(*(p_kmsi->strings+rp->lhs)) != ITEM_NUL))) continue;
 
 		// Compare the current rule with the history
-		if((matched=match_rule(p_kmsi,rp,any_index,usekeys)))
+		if((matched=MATCH_RULE(p_kmsi,rp,any_index,usekeys)))
 		{			
 			// Then determine the output for this rule
-			result = process_rule(p_kmsi,rp,any_index,usekeys);
+			result = PROCESS_RULE(p_kmsi,rp,any_index,usekeys);
 			break;
 		}
 	}
@@ -217,7 +288,7 @@ int process_group(KMSI *p_kmsi, XGROUP *gp)
 	// Determine if we need to consider processing match or nomatch rules
 	if((gp->flags & GF_USEKEYS) != 0)
 	{
-		enable_global_matching = ((*p_kmsi->history & 0xff00) != 0xff00);
+		enable_global_matching = ((HISTORY_ITEM(p_kmsi,0) & 0xff00) != 0xff00);
 	}
 	else
 	{
@@ -248,50 +319,44 @@ int process_group(KMSI *p_kmsi, XGROUP *gp)
 int match_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys) 
 {
 	
-	UINT k, m, n, nmax, rulelen, nhistory, index;
-	ITEM *pr, *ph, *ps, mask;
+	UINT k, m, rulelen, nhistory, index, ih;
+	ITEM *pr, *ps, h;
+	int found;
 
 	rulelen = rp->ilen;
 	pr = p_kmsi->strings+rp->lhs;
-	ph = p_kmsi->history+rulelen - (usekeys ? 1 : 0);
+	ih = rulelen - (usekeys ? 1 : 0);	// history item compared with the first rule item
 	nhistory = p_kmsi->nhistory + (usekeys ? 1 : 0);	
 	
-	for(m=0; m<rp->ilen; pr++,ph--,m++) 
+	for(m=0; m<rp->ilen; pr++,ih--,m++) 
 	{
 		unsigned char item_type;
 		item_type=ITEM_TYPE(*pr);
+		h = HISTORY_ITEM(p_kmsi,ih);
 		switch(item_type) 
 		{
 		case ITEM_CHAR:
-			if(*pr != *ph) return 0;
+			if(*pr != h) return 0;
 			break;				// matched - continue matching string
 
 		case ITEM_KEYSYM:
-			if((*pr & 0xffff) != (*ph & 0xffff)) return 0;
-			if(compare_state(*pr,*ph)) return 0;
+			if((*pr & 0xffff) != (h & 0xffff)) return 0;
+			if(compare_state(*pr,h)) return 0;
 			break;				// matched - continue matching string
 
 		case ITEM_DEADKEY:	
-			if(*pr != *ph) return 0;
+			if(*pr != h) return 0;
 			break;				// matched - continue matching string
 
 		case ITEM_ANY:	// will need to allow for matching keysyms in any()
 		case ITEM_NOTANY: 
-			ps = store_content(p_kmsi,STORE_NUMBER(*pr));
-			nmax = store_length(p_kmsi,STORE_NUMBER(*pr));
-			if(m == rp->ilen-1) mask = 0xffffff; else mask = 0xffffffff;
-			for(n=0; n<nmax; ps++,n++) 
-			{
-				if(((*ps) & mask) == ((*ph) & mask)) // ignore keysym id
-				{
-					any_index[m] = n;	// save offset for use with index
-					break;
-				}
-			}
+			found = find_in_store(p_kmsi,STORE_NUMBER(*pr),h,m == rp->ilen-1); // ignore keysym id
+			if(found != UNDEFINED) 
+				any_index[m] = found;	// save offset for use with index
 			if (item_type == ITEM_ANY) {
-				if(n == nmax) return 0;		// no match
+				if(found == UNDEFINED) return 0;		// no match
 			} else {
-				if(n != nmax) return 0;		// no match
+				if(found != UNDEFINED) return 0;		// no match
 			}
 			break;				// matched - continue matching string
 
@@ -312,7 +377,7 @@ int match_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 			k = CONTEXT_CHAR(*pr);
 			if(k == m+1) break;				// wild-card match of input
 			if((k == 0) || (k > rulelen)	// arg cannot be 0 (on LHS of rule)
-				|| (*ph != *(ph+m+1-k))) return 0;		// no match 			
+				|| (h != HISTORY_ITEM(p_kmsi,ih+m+1-k))) return 0;		// no match 			
 			break;				// matched - continue matching string
 
 		case ITEM_NUL:			// nhistory (+ key) must be equal to the rule length
@@ -338,6 +403,88 @@ int match_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 	return 1;	// Return 1 if history matches rule
 }
 
+// Compare a history item with a rule item (other than context, index or nul)
+int match_item(KMSI *p_kmsi, ITEM item, ITEM h, int last)
+{
+	switch(ITEM_TYPE(item))
+	{
+	case ITEM_KEYSYM:
+		return ((item & 0xffff) == (h & 0xffff)) && !compare_state(item,h);
+	case ITEM_ANY:			// the item type is ignored for the last item of a rule
+		return find_in_store(p_kmsi,STORE_NUMBER(item),h,last) != UNDEFINED;
+	case ITEM_NOTANY:
+		return find_in_store(p_kmsi,STORE_NUMBER(item),h,last) == UNDEFINED;
+	default:
+		return item == h;
+	}
+}
+
+// Search a group's matching automaton for the first rule matching the history, starting 
+// from a given node (reached after matching depth items). The best rule found so far is
+// updated in *best, and branches that can only lead to later rules are not searched
+void search_trie(KMSI *p_kmsi, XDISPATCH *dp, UINT node, UINT depth, UINT nhistory, int usekeys, UINT *best)
+{
+	XTRIENODE *np=dp->trie+node;
+	XTRIEEDGE *ep;
+	UINT lo, hi, mid, n, nk;
+	ITEM h, key;
+
+	if(np->best >= *best) return;
+	if(np->rule < *best) *best = np->rule;
+
+	// Stop at the end of the history (including the keystroke for groups using keys)
+	if(depth >= nhistory || (np->nedges == 0 && np->nany == 0)) return;
+
+	h = HISTORY_ITEM(p_kmsi,depth+1-usekeys);
+	ep = dp->edges+np->edge1;
+
+	// Characters and deadkeys must match exactly, so at most one of them can be followed
+	for(lo=0, hi=np->nliteral; lo<hi; )
+	{
+		mid = (lo+hi)/2;
+		if(ep[mid].item < h) lo = mid+1; else hi = mid;
+	}
+	if(lo < np->nliteral && ep[lo].item == h)
+		search_trie(p_kmsi,dp,ep[lo].node,depth+1,nhistory,usekeys,best);
+
+	// Keysyms are only compared if they have the same key as the history item
+	nk = np->nliteral+np->nkeysym;
+	for(lo=np->nliteral, hi=nk; lo<hi; )
+	{
+		mid = (lo+hi)/2;
+		if((ep[mid].item & 0xffff) < (h & 0xffff)) lo = mid+1; else hi = mid;
+	}
+	for(n=lo; n<nk && (ep[n].item & 0xffff) == (h & 0xffff); n++)
+	{
+		if(dp->trie[ep[n].node].best >= *best) break;
+		if(!compare_state(ep[n].item,h))
+			search_trie(p_kmsi,dp,ep[n].node,depth+1,nhistory,usekeys,best);
+	}
+
+	// any() entries are sorted by store item (ignoring the item type for the last item)
+	key = (depth == 0) ? (h & 0xffffff) : h;
+	ep = dp->anys+np->any1;
+	for(lo=0, hi=np->nany; lo<hi; )
+	{
+		mid = (lo+hi)/2;
+		if(ep[mid].item < key) lo = mid+1; else hi = mid;
+	}
+	for(n=lo; n<np->nany && ep[n].item == key; n++)
+	{
+		if(dp->trie[ep[n].node].best >= *best) break;
+		search_trie(p_kmsi,dp,ep[n].node,depth+1,nhistory,usekeys,best);
+	}
+
+	// Then try the other items, in order of the first rule they lead to
+	ep = dp->edges+np->edge1;
+	for(n=nk; n<np->nedges; n++)
+	{
+		if(dp->trie[ep[n].node].best >= *best) break;
+		if(match_item(p_kmsi,ep[n].item,h,depth == 0))
+			search_trie(p_kmsi,dp,ep[n].node,depth+1,nhistory,usekeys,best);
+	}
+}
+
 // Process a matched rule, return codes are:
 //		1	rule processed
 //		2	rule processed, return encountered (in rule or in subgroup rule)
@@ -346,23 +493,23 @@ int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 {
 	XGROUP *gp;
 	UINT i, k, m, n, nout, itp, index;
-	ITEM *p, *pr, *ps, output[MAX_OUTPUT+1], history[MAX_HISTORY], *it;
-	int erase, result, retCode=1, nhistory;
+	ITEM *p, *pr, *ps, output[MAX_OUTPUT+1], context[MAX_HISTORY+2], *it;
+	int erase, result, retCode=1;
 
-	DBGMSG(1, "DAR - libkmfl - process_rule\n");
+	DBGMSG(KMFL_DEBUG_TRACE, "DAR - libkmfl - process_rule\n");
 	pr = p_kmsi->strings+rp->rhs;	// Pointer to start of output rule
 
-	// Make a temporary copy of the history before any modifications are made
-	nhistory = p_kmsi->nhistory;
-	for(i=0; (int)i<nhistory+1; i++)
+	// Make a temporary copy of the matched context (the only part of the history that 
+	// can be output by context()) before any modifications are made
+	for(i=1; i+usekeys<=rp->ilen; i++)
 	{
-		history[i] = p_kmsi->history[i];
+		context[i] = HISTORY_ITEM(p_kmsi,i);
 	}
 
 	// Must erase the number of characters matched,
 	// excluding the keystroke, and deadkeys, and nul, match or nomatch items  
 	erase = rp->ilen - (usekeys ? 1 : 0);
-	for(p=p_kmsi->strings+rp->lhs; erase>0 && p_kmsi->history>0; erase--,p++) 
+	for(p=p_kmsi->strings+rp->lhs; erase>0; erase--,p++) 
 	{
 		itp = ITEM_TYPE(*p);
 		switch(itp)
@@ -372,11 +519,9 @@ int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 		case ITEM_NOMATCH:
 			break;
 		default:
-			if(ITEM_TYPE(p_kmsi->history[1]) != ITEM_DEADKEY) 
+			if(ITEM_TYPE(HISTORY_ITEM(p_kmsi,1)) != ITEM_DEADKEY) 
 				erase_char_int(p_kmsi);	
-			for(i=1; i<p_kmsi->nhistory; i++) 
-				p_kmsi->history[i] = p_kmsi->history[i+1];
-			p_kmsi->nhistory--;
+			delete_from_history(p_kmsi,1);
 			break;
 		}
 	}
@@ -401,8 +546,8 @@ int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 				it=ps + index;
 				if (ITEM_TYPE(*it) == ITEM_BEEP)
 				{
-	                        	DBGMSG(1, "DAR -libkmfl - *** index beep*** \n");
-        	                	output_beep(p_kmsi->connection);
+	                        	DBGMSG(KMFL_DEBUG_TRACE, "DAR -libkmfl - *** index beep*** \n");
+        	                	output_beep_int(p_kmsi);
 				} else {
 					*p++ = *it;
 				}
@@ -427,12 +572,12 @@ int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 			{
 				for(i=rp->ilen; i>(UINT)usekeys; i--)
 				{
-					*p++ = history[i-usekeys]; // was [i-1], corrected 2004/04/23
+					*p++ = context[i-usekeys]; // was [i-1], corrected 2004/04/23
 				}
 			}
 			else if(k <= rp->ilen-usekeys)
 			{
-				*p++ = history[rp->ilen-k+1-usekeys];
+				*p++ = context[rp->ilen-k+1-usekeys];
 			}
 			else return -1;	// this should be prevented by the compiler
 			break;
@@ -445,15 +590,15 @@ int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 			break;
 
 		case ITEM_BEEP:		// output an audible signal
-			DBGMSG(1, "DAR -libkmfl - ***beep*** \n");
-			output_beep(p_kmsi->connection);
+			DBGMSG(KMFL_DEBUG_TRACE, "DAR -libkmfl - ***beep*** \n");
+			output_beep_int(p_kmsi);
 			break;
 
 		case ITEM_USE:		// process another rule group then return here
 			if(retCode == 2) break;	// do not process subgroup rules if return encountered
 			
 			gp = p_kmsi->groups+GROUP_NUMBER(*pr);
-			if((result=process_group(p_kmsi,gp)) < 0) 
+			if((result=PROCESS_GROUP(p_kmsi,gp)) < 0) 
 			{
 				return -1;	// error processing subgroup rules
 			}
@@ -496,8 +641,8 @@ int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 					UINT key, state;
 					key = (*p) & 0xFFFF;
 					state = ((*p) >> 16) & 0xFF;
-					DBGMSG(1, "DAR - libkmfl - ITEM_KEYSYM key:%x, state: %x\n", key, state);
-                    forward_keyevent(p_kmsi->connection, key, state);
+					DBGMSG(KMFL_DEBUG_TRACE, "DAR - libkmfl - ITEM_KEYSYM key:%x, state: %x\n", key, state);
+                    forward_keyevent_int(p_kmsi, key, state);
                     clear_history(p_kmsi);
                 } 
                 else
@@ -518,12 +663,11 @@ int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
 // Check to see if there are deadkeys in the current history
 int deadkey_in_history(KMSI *p_kmsi)
 {
-	ITEM * pitem =p_kmsi->history+1;
 	UINT nitems= p_kmsi->nhistory;
 	UINT iitem;
 
-	for (iitem=0; iitem < nitems; iitem++, pitem++) {
-		if(ITEM_TYPE(*pitem) == ITEM_DEADKEY) {
+	for (iitem=1; iitem <= nitems; iitem++) {
+		if(ITEM_TYPE(HISTORY_ITEM(p_kmsi,iitem)) == ITEM_DEADKEY) {
 			return 1; 
 		}
 	}
@@ -534,46 +678,60 @@ int deadkey_in_history(KMSI *p_kmsi)
 // Sets the history to the surrounding context 
 void set_history(KMSI *p_kmsi, ITEM * items, UINT nitems)
 {
+	UINT n;
 
 	if (nitems > MAX_HISTORY)
 		nitems = MAX_HISTORY;
 
-	memcpy(p_kmsi->history+1, items, nitems * sizeof(ITEM));
+	for(n=0; n<nitems; n++)
+		HISTORY_ITEM(p_kmsi,n+1) = items[n];
 	p_kmsi->nhistory=nitems;
 }
 
-// Add a character item (or deadkey) to the start of the history stack (to item 1)
-void add_to_history(KMSI *p_kmsi,ITEM item) 
+// Return a history item (0 is the current keystroke, 1 the most recent character or 
+// deadkey), or 0 if the history is not that long
+ITEM kmfl_history_item(KMSI *p_kmsi, UINT n)
 {
-	ITEM *ip,*ip0=p_kmsi->history+1;
-	UINT n=p_kmsi->nhistory;
+	if(n > p_kmsi->nhistory) return 0;
+	return HISTORY_ITEM(p_kmsi,n);
+}
 
-	if(n >= MAX_HISTORY) n = MAX_HISTORY-1;
-	p_kmsi->nhistory = n+1;
+// Return the number of valid history items (excluding the keystroke)
+UINT kmfl_history_length(KMSI *p_kmsi)
+{
+	return p_kmsi->nhistory;
+}
 
-	for(ip=ip0+n-1; n>0; n--,ip--) *(ip+1) = *ip;
+// Add a character item (or deadkey) to the start of the history stack (to item 1).
+// The history is a circular buffer, so this just moves the start back by one item,
+// keeping the keystroke (item 0) in front of it. The oldest item is dropped once the
+// history holds MAX_HISTORY items.
+void add_to_history(KMSI *p_kmsi,ITEM item) 
+{
+	ITEM key=HISTORY_ITEM(p_kmsi,0);
 
-	*ip0 = item;
+	HISTORY_ITEM(p_kmsi,0) = item;
+	p_kmsi->history_start = (p_kmsi->history_start-1) & HISTORY_MASK;
+	HISTORY_ITEM(p_kmsi,0) = key;
 
+	if(p_kmsi->nhistory < MAX_HISTORY) p_kmsi->nhistory++;
+	else p_kmsi->nhistory = MAX_HISTORY;
 }
 
 // Delete items (or deadkeys) from the start of the history stack (from item 1)
 void delete_from_history(KMSI *p_kmsi,UINT nitems) 
 {
-	UINT nleft;
+	ITEM key=HISTORY_ITEM(p_kmsi,0);
 
 	if(p_kmsi->nhistory > MAX_HISTORY) 
 		p_kmsi->nhistory = MAX_HISTORY;
 
 	if(nitems > p_kmsi->nhistory) 
 		nitems = p_kmsi->nhistory;
-	nleft = p_kmsi->nhistory - nitems;
-	if(nleft > 0 && nitems > 0)
-	{
-		memmove(p_kmsi->history+1,p_kmsi->history+nitems+1,nleft*sizeof(ITEM));
-	}
-	p_kmsi->nhistory = nleft;
-//	*(p_kmsi->history+1+nleft) = 0; 
+
+	p_kmsi->history_start = (p_kmsi->history_start+nitems) & HISTORY_MASK;
+	HISTORY_ITEM(p_kmsi,0) = key;
+	p_kmsi->nhistory -= nitems;
 }
 
 // Clear history
@@ -601,38 +759,53 @@ void queue_item_for_output(KMSI *p_kmsi, ITEM item)
 
 void process_output_queue(KMSI *p_kmsi)
 {
-	int i;
-	
-	UTF32 utfin[2]={0};
-	UTF32 *pin;
-	UTF8 utfout[MAX_OUTPUT*4+1]={0};
+	const UTF32 *pin;
+	UTF8 utfout[MAX_OUTPUT*4+1];
 	UTF8 *pout;
 	size_t result;
 	
+	// Record the output in the edit script when interpreting a batch of keystrokes
+	if (p_kmsi->batch != NULL) {
+		kmfl_batch_insert(p_kmsi->batch, p_kmsi->output_queue, p_kmsi->noutput_queue);
+		return;
+	}
+
+	// Convert the whole queue in one call
+	pin = (const UTF32 *)p_kmsi->output_queue;
 	pout = &utfout[0];
-	for (i=0; i < p_kmsi->noutput_queue; i++) {
-#if 0
-		output_item(p_kmsi->connection, p_kmsi->output_queue[i]);
-#else
-		pin = &utfin[0]; 
-		utfin[0] = p_kmsi->output_queue[i]; 
-		result = IConvertUTF32toUTF8((const UTF32 **)&pin,utfin+1,&pout,utfout+MAX_OUTPUT*4);
-		if (result == (size_t)-1) {
-			ERRMSG("Exceeded maximum length of output allowed from any one key event.\n");
-			return;
-		}
+	result = IConvertUTF32toUTF8(&pin,pin+p_kmsi->noutput_queue,&pout,utfout+MAX_OUTPUT*4);
+	if (result == (size_t)-1) {
+		ERRMSG("Exceeded maximum length of output allowed from any one key event.\n");
+		return;
 	}
 	*pout = 0;
-	output_string(p_kmsi->connection, (char *)utfout);
-#endif
+	CALL_OUTPUT(p_kmsi, output_string(p_kmsi->connection, (char *)utfout));
 }
 
 void erase_char_int(KMSI *p_kmsi)
 {
 	if (p_kmsi->noutput_queue > 0)
 		(p_kmsi->noutput_queue)--;
+	else if (p_kmsi->batch != NULL)
+		kmfl_batch_erase(p_kmsi->batch);
 	else
-		erase_char(p_kmsi->connection);
+		CALL_OUTPUT(p_kmsi, erase_char(p_kmsi->connection));
+}
+
+void output_beep_int(KMSI *p_kmsi)
+{
+	if (p_kmsi->batch != NULL)
+		kmfl_batch_event(p_kmsi->batch, KMFL_EDIT_BEEP, 0, 0);
+	else
+		CALL_OUTPUT(p_kmsi, output_beep(p_kmsi->connection));
+}
+
+void forward_keyevent_int(KMSI *p_kmsi, UINT key, UINT state)
+{
+	if (p_kmsi->batch != NULL)
+		kmfl_batch_event(p_kmsi->batch, KMFL_EDIT_FORWARD, key, state);
+	else
+		CALL_OUTPUT(p_kmsi, forward_keyevent(p_kmsi->connection, key, state));
 }
 
 // Because some apps cannot handle a mixture of erases and commits when processing
@@ -673,6 +846,28 @@ UINT store_length(KMSI *p_kmsi, UINT nstore)
 	return(sp->len);
 }
 
+// Return the index of the first item of a store matching an item (optionally ignoring
+// the item type), or UNDEFINED if there is none
+int find_in_store(KMSI *p_kmsi, UINT nstore, ITEM item, int ignore_type)
+{
+	XSTOREINDEX *sx;
+	ITEM *ps, mask;
+	UINT n, nmax;
+
+	// Look up the item in the store's hash tables if it has them
+	if(p_kmsi->store_index != NULL && (sx=p_kmsi->store_index+nstore)->mask != 0)
+		return kmfl_find_in_store(sx,item,ignore_type);
+
+	ps = store_content(p_kmsi,nstore);
+	nmax = store_length(p_kmsi,nstore);
+	if(ignore_type) mask = 0xffffff; else mask = 0xffffffff;
+	for(n=0; n<nmax; ps++,n++) 
+	{
+		if(((*ps) & mask) == (item & mask)) return (int)n;
+	}
+	return UNDEFINED;
+}
+
 // Translate the state integer received from scim_kmfl_server
 UINT modified_state(UINT state)
 {
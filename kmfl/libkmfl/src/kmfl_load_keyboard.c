@@ -26,6 +26,21 @@
 		Version 1.000, January 2004, John Durdin, Tavultesoft
 	
 	Keyboard and loading and instance management
+
+	Notes:
+		Instances can be created, used and deleted on different threads at the same
+		time. The list of instances and the table of installed keyboards are only
+		changed while holding keyboard_lock, and an instance only reads the tables
+		of its keyboard, so each thread can interpret keystrokes with its own
+		instances without any locking.
+
+		Each loaded keyboard is counted by the table of installed keyboards and by
+		the instances attached to it. Reloading a keyboard loads the new tables
+		first, then replaces the old ones in the table of installed keyboards.
+		Each instance moves to the new tables when it next interprets a keystroke
+		(unless another thread holds the lock at that moment, in which case it
+		goes on with the tables it has, rather than wait), and the old tables are
+		released when the last instance has moved on.
 */
 
 #include <stdio.h>
@@ -38,6 +53,9 @@
 
 #ifndef _WIN32
 	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <pthread.h>
 #endif
 
 #include <kmfl/kmfl.h>
@@ -45,55 +63,226 @@
 #include <kmfl/kmflutfconv.h>
 #include "libkmfl.h"
 
+// Map size recorded for a keyboard in a buffer that still belongs to the caller
+#define BORROWED_KEYBOARD	((size_t)-1)
+
+// A loaded keyboard with the indexes of its rules and stores, shared by the instances
+// using it
+struct _kmflkeyboard {
+	XKEYBOARD *keyboard;			// the compiled keyboard
+	size_t map_size;				// size of the mapped keyboard file (0 if allocated)
+	KMFLTABLES tables;				// locations of the tables of the keyboard
+	XDISPATCH *dispatch;			// rule dispatch index of each group
+	XSTOREINDEX *store_index;		// lookup tables of each store
+	char *filename;					// file the keyboard was loaded from (NULL if none)
+	UINT refs;						// references from the installed keyboards and instances
+};
+
+typedef struct _kmflkeyboard KMFLKEYBOARD;
+
+// An installed keyboard. Its number is never given to another keyboard, even after it
+// has been unloaded
+struct _kmflinstalled {
+	int number;						// keyboard number
+	KMFLKEYBOARD *loaded;			// current tables (replaced when the keyboard is reloaded)
+	char name[NAMELEN+1];			// name of the keyboard, which outlives the tables
+	KMSI *instances;				// instances using the keyboard
+	struct _kmflinstalled *next_name;	// next keyboard with a name in the same hash bucket
+	struct _kmflinstalled *next;		// link to next installed keyboard
+	struct _kmflinstalled *last;		// link to previous installed keyboard
+};
+
+typedef struct _kmflinstalled KMFLINSTALLED;
+
 // Globally loaded keyboards and instances
-XKEYBOARD *p_installed_kbd[MAX_KEYBOARDS]={NULL};
-char * keyboard_filename[MAX_KEYBOARDS];
+static KMFLINSTALLED **p_installed=NULL;	// installed keyboards by number (NULL once unloaded)
+static UINT n_numbers=0;					// number of keyboard numbers given out
+static UINT max_numbers=0;					// size of p_installed
+static KMFLINSTALLED **p_names=NULL;		// hash table of installed keyboards by name
+static UINT name_mask=0;					// number of buckets in p_names less one
+static KMFLINSTALLED *p_first_installed=NULL;
 
 KMSI *p_first_instance={NULL};
+KMSI *p_last_instance=NULL;						// end of the list of instances
 unsigned int n_keyboards=0;
 
+// Deleted instances, kept to be used again. Each instance is allocated together with
+// its history buffer, so making an instance from this list needs no allocation
+static KMSI *p_free_instances=NULL;
+
+// Lock held while changing the instance list, the installed keyboards or their
+// reference counts
+#ifndef _WIN32
+static pthread_mutex_t keyboard_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_KEYBOARDS()	pthread_mutex_lock(&keyboard_lock)
+#define TRYLOCK_KEYBOARDS()	(pthread_mutex_trylock(&keyboard_lock) == 0)
+#define UNLOCK_KEYBOARDS()	pthread_mutex_unlock(&keyboard_lock)
+#else
+#define LOCK_KEYBOARDS()
+#define TRYLOCK_KEYBOARDS()	1
+#define UNLOCK_KEYBOARDS()
+#endif
+
+// The current tables of an installed keyboard are also read without the lock, by
+// kmfl_update_keyboard()
+#ifdef __GNUC__
+#define LOAD_CURRENT(ip)		__atomic_load_n(&(ip)->loaded, __ATOMIC_ACQUIRE)
+#define STORE_CURRENT(ip,kp)	__atomic_store_n(&(ip)->loaded, (kp), __ATOMIC_RELEASE)
+#else
+#define LOAD_CURRENT(ip)		((ip)->loaded)
+#define STORE_CURRENT(ip,kp)	((ip)->loaded = (kp))
+#endif
+
+static int attach_keyboard(KMSI *p_kmsi, int keyboard_number);
+static void use_keyboard(KMSI *p_kmsi, KMFLKEYBOARD *kp);
+
+// Remove an instance from the list of instances using its keyboard, with keyboard_lock held
+static void unlink_keyboard_instance(KMSI *p_kmsi)
+{
+	KMSI *p1, *p2;
+
+	if(p_kmsi->installed == NULL) return;
+
+	p1 = p_kmsi->kbd_last; p2 = p_kmsi->kbd_next;
+	if(p1) p1->kbd_next = p2; else p_kmsi->installed->instances = p2;
+	if(p2) p2->kbd_last = p1;
+	p_kmsi->installed = NULL;
+	p_kmsi->keyboard_number = -1;
+}
+
+// Find an installed keyboard from its number, with keyboard_lock held
+static KMFLINSTALLED *installed_keyboard(int keyboard_number)
+{
+	if(keyboard_number < 0 || (UINT)keyboard_number >= n_numbers) return NULL;
+	return p_installed[keyboard_number];
+}
+
+// Hash a keyboard name (FNV-1a)
+static UINT name_hash(const char *name)
+{
+	UINT h=2166136261u;
+
+	for(; *name; name++)
+		h = (h ^ (unsigned char)*name) * 16777619u;
+	return h;
+}
+
+// Add an installed keyboard to the hash table of names, with keyboard_lock held
+static void add_name(KMFLINSTALLED **names, UINT mask, KMFLINSTALLED *ip)
+{
+	UINT bucket=name_hash(ip->name) & mask;
+
+	ip->next_name = names[bucket];
+	names[bucket] = ip;
+}
+
+// Remove an installed keyboard from the hash table of names, with keyboard_lock held
+static void remove_name(KMFLINSTALLED *ip)
+{
+	KMFLINSTALLED **pp=p_names+(name_hash(ip->name) & name_mask);
+
+	for(; *pp != ip; pp=&(*pp)->next_name);
+	*pp = ip->next_name;
+}
+
+// Make room for one more installed keyboard, keeping the hash table of names at least
+// twice as large as the number of keyboards. Called with keyboard_lock held. Returns 0
+// on success
+static int grow_registry(void)
+{
+	KMFLINSTALLED **pp, *ip;
+	UINT size;
+
+	if(n_numbers == max_numbers)
+	{
+		size = max_numbers ? 2*max_numbers : 16;
+		if((pp=(KMFLINSTALLED **)realloc(p_installed, size*sizeof(KMFLINSTALLED *))) == NULL)
+			return -1;
+		p_installed = pp;
+		max_numbers = size;
+	}
+
+	if(2*(n_keyboards+1) > name_mask+1)
+	{
+		size = p_names ? 2*(name_mask+1) : 32;
+		if((pp=(KMFLINSTALLED **)calloc(size, sizeof(KMFLINSTALLED *))) == NULL)
+			return -1;
+		for(ip=p_first_installed; ip; ip=ip->next)
+			add_name(pp, size-1, ip);
+		if(p_names) free(p_names);
+		p_names = pp;
+		name_mask = size-1;
+	}
+	return 0;
+}
+
+// Make a list of the numbers of the installed keyboards. Returns the number of keyboards
+// in the list (which must be freed), or 0 if there are none
+static UINT installed_numbers(int **p_numbers)
+{
+	KMFLINSTALLED *ip;
+	UINT n=0;
+
+	LOCK_KEYBOARDS();
+	if(n_keyboards > 0 && (*p_numbers=(int *)malloc(n_keyboards*sizeof(int))) != NULL)
+	{
+		for(ip=p_first_installed; ip; ip=ip->next)
+			(*p_numbers)[n++] = ip->number;
+	}
+	UNLOCK_KEYBOARDS();
+	return n;
+}
+
 // Create a new keyboard mapping server instance
 KMSI *kmfl_make_keyboard_instance(void *connection)
 {
-	KMSI *p_kmsi, *p;
+	KMSI *p_kmsi;
+
+	// Use a deleted instance if there is one
+	LOCK_KEYBOARDS();
+	if((p_kmsi=p_free_instances) != NULL)
+		p_free_instances = p_kmsi->next;
+	UNLOCK_KEYBOARDS();
+
+	if(p_kmsi == NULL)
+		p_kmsi = (KMSI *)malloc(sizeof(KMSI)+HISTORY_SIZE*sizeof(ITEM));
 
-	if((p_kmsi=(KMSI *)malloc(sizeof(KMSI))))
+	if(p_kmsi == NULL)
 	{
-		p_kmsi->history = (ITEM *)malloc((MAX_HISTORY+2)*sizeof(ITEM));
-		if(p_kmsi->history) 
-		{ 
-			p_kmsi->connection = connection;
-			*p_kmsi->kbd_name = 0;
-			p_kmsi->keyboard = NULL;
-			p_kmsi->groups = NULL;	
-			p_kmsi->rules = NULL;
-			p_kmsi->stores = NULL;
-			p_kmsi->strings = NULL;
-			p_kmsi->nhistory = 0;
-
-			// Link to other keyboard instances
-			if(p_first_instance == NULL)
-			{
-				p_first_instance = p_kmsi;
-				p_kmsi->last = NULL;
-			}
-			else
-			{
-				for(p=p_first_instance; p->next!=NULL; p=p->next);
-				p->next = p_kmsi;
-				p_kmsi->last = p;
-			}
-			p_kmsi->next = NULL;
-			DBGMSG(1,"Keyboard instance created\n");				
-			return p_kmsi;
-		}
-		else
-		{
-			free(p_kmsi); 
-		}
+		DBGMSG(1,"Unable to create keyboard instance!\n");
+		return NULL; 
 	}
-	DBGMSG(1,"Unable to create keyboard instance!\n");
-	return NULL; 
+
+	p_kmsi->history_buffer = (ITEM *)(p_kmsi+1);
+	p_kmsi->connection = connection;
+	*p_kmsi->kbd_name = 0;
+	p_kmsi->keyboard_number = -1;
+	p_kmsi->keyboard = NULL;
+	p_kmsi->groups = NULL;	
+	p_kmsi->rules = NULL;
+	p_kmsi->stores = NULL;
+	p_kmsi->strings = NULL;
+	p_kmsi->dispatch = NULL;
+	p_kmsi->store_index = NULL;
+	p_kmsi->batch = NULL;
+	p_kmsi->profile = NULL;
+	p_kmsi->loaded = NULL;
+	p_kmsi->installed = NULL;
+	p_kmsi->history_start = 0;
+	p_kmsi->nhistory = 0;
+	p_kmsi->kbd_next = NULL;
+	p_kmsi->kbd_last = NULL;
+
+	// Link to the end of the other keyboard instances
+	LOCK_KEYBOARDS();
+	p_kmsi->next = NULL;
+	p_kmsi->last = p_last_instance;
+	if(p_last_instance) p_last_instance->next = p_kmsi; else p_first_instance = p_kmsi;
+	p_last_instance = p_kmsi;
+	UNLOCK_KEYBOARDS();
+
+	DBGMSG(1,"Keyboard instance created\n");				
+	return p_kmsi;
 }
 	
 // Delete a keyboard mapping server instance
@@ -101,66 +290,99 @@ int kmfl_delete_keyboard_instance(KMSI *p_kmsi)
 {
 	KMSI *p1, *p2;
 
+	kmfl_stop_profile(p_kmsi);
+
+	LOCK_KEYBOARDS();
+
 	// Remove this instance from chain of linked instances
 	p1 = p_kmsi->last; p2 = p_kmsi->next;
 	if(p1) p1->next = p2; else p_first_instance = p2;
-	if(p2) p2->last = p1;
+	if(p2) p2->last = p1; else p_last_instance = p1;
+	unlink_keyboard_instance(p_kmsi);
+	use_keyboard(p_kmsi, NULL);
+
+	// Keep it to be used again
+	p_kmsi->next = p_free_instances;
+	p_free_instances = p_kmsi;
 
-	// Free allocated memory
-	if(p_kmsi->history) free(p_kmsi->history);
-	free(p_kmsi);
+	UNLOCK_KEYBOARDS();
 	
 	DBGMSG(1,"Keyboard instance deleted\n");
 	return 0;
 }
 
-// Delete all server instances
+// Delete all server instances, and release the memory of all deleted instances
 int kmfl_delete_all_keyboard_instances(void)
 {
 	KMSI *p, *p1;
-	for(p=p_first_instance; p!=NULL; p=p1)
+
+	for(;;)
 	{
-		p1 = p->next;
+		LOCK_KEYBOARDS();
+		p = p_first_instance;
+		UNLOCK_KEYBOARDS();
+		if(p == NULL) break;
 		kmfl_delete_keyboard_instance(p);
 	}
 
+	LOCK_KEYBOARDS();
+	p = p_free_instances;
+	p_free_instances = NULL;
+	UNLOCK_KEYBOARDS();
+
+	for(; p!=NULL; p=p1)
+	{
+		p1 = p->next;
+		free(p);
+	}
+
 	return 0;
 }
 
 // Attach a keyboard to a server instance
 int kmfl_attach_keyboard(KMSI *p_kmsi, int keyboard_number)
 {
+	int result;
+
+	LOCK_KEYBOARDS();
+	result = attach_keyboard(p_kmsi, keyboard_number);
+	UNLOCK_KEYBOARDS();
+	return result;
+}
+
+// Attach a keyboard to a server instance, with keyboard_lock held
+static int attach_keyboard(KMSI *p_kmsi, int keyboard_number)
+{
+	KMFLINSTALLED *ip;
 	XKEYBOARD *p_kbd=NULL;
-	XGROUP *gp;
-	unsigned int n, nrules;
 	
-	if (p_installed_kbd[keyboard_number] == NULL) {
+	if ((ip=installed_keyboard(keyboard_number)) == NULL) {
 		DBGMSG(1,"Invalid keyboard number\n");
 		return -1;
 	}
 
-	p_kbd=p_installed_kbd[keyboard_number];
-	p_kmsi->keyboard = p_kbd;
-	p_kmsi->keyboard_number = keyboard_number;
-
-	// Fill group, rule, store and string pointers
-	p_kmsi->stores = (XSTORE *)(p_kbd+1);
-	p_kmsi->groups = (XGROUP *)(p_kmsi->stores+p_kbd->nstores);
-	p_kmsi->rules = (XRULE *)(p_kmsi->groups+p_kbd->ngroups);
+	p_kbd=ip->loaded->keyboard;
 
-	for(n=nrules=0,gp=p_kmsi->groups; n<p_kbd->ngroups; n++, gp++)
+	// Move the instance to the list of instances using this keyboard
+	if(p_kmsi->installed != ip)
 	{
-		nrules += gp->nrules;
+		unlink_keyboard_instance(p_kmsi);
+		p_kmsi->installed = ip;
+		p_kmsi->keyboard_number = keyboard_number;
+		p_kmsi->kbd_last = NULL;
+		p_kmsi->kbd_next = ip->instances;
+		if(p_kmsi->kbd_next) p_kmsi->kbd_next->kbd_last = p_kmsi;
+		ip->instances = p_kmsi;
 	}
 
-	p_kmsi->strings = (ITEM *)(p_kmsi->rules+nrules);
+	use_keyboard(p_kmsi, ip->loaded);
 
 	// Initialize history unless keyboard hasn't changed
 	if(strcmp(p_kbd->name,p_kmsi->kbd_name) != 0)
 	{
 		strncpy(p_kmsi->kbd_name,p_kbd->name, NAMELEN);
 		p_kmsi->kbd_name[NAMELEN]=0;
-		*p_kmsi->history = 0;
+		HISTORY_ITEM(p_kmsi,0) = 0;
 		p_kmsi->nhistory = 0;
 	}
 	
@@ -175,78 +397,216 @@ int kmfl_detach_keyboard(KMSI *p_kmsi)
 		DBGMSG(1,"Keyboard %s detached\n",p_kmsi->kbd_name);
 	
 	*p_kmsi->kbd_name = 0;
-	p_kmsi->keyboard = NULL;
-	p_kmsi->groups = NULL;
-	p_kmsi->rules = NULL;
-	p_kmsi->stores = NULL;
-	p_kmsi->strings = NULL;
+	LOCK_KEYBOARDS();
+	use_keyboard(p_kmsi, NULL);
+	UNLOCK_KEYBOARDS();
 	return 0;
 }
 
-XKEYBOARD * kmfl_load_keyboard_from_file(const char *filename)
+// Move an instance to the tables of its keyboard, if it has been reloaded since the
+// instance was attached. This never waits for the lock: if another thread holds it, 
+// the instance goes on with the tables it has until its next keystroke
+void kmfl_update_keyboard(KMSI *p_kmsi)
+{
+	KMFLKEYBOARD *kp;
+
+	// An attached instance always belongs to an installed keyboard
+	if(p_kmsi->loaded == NULL) return;
+	kp = LOAD_CURRENT(p_kmsi->installed);
+	if(kp == p_kmsi->loaded || !TRYLOCK_KEYBOARDS()) return;
+
+	kp = p_kmsi->installed->loaded;
+	if(kp != p_kmsi->loaded && p_kmsi->loaded != NULL)
+	{
+		// Keep the history, even if the name of the keyboard has changed
+		use_keyboard(p_kmsi, kp);
+		strncpy(p_kmsi->kbd_name,kp->keyboard->name, NAMELEN);
+		p_kmsi->kbd_name[NAMELEN]=0;
+		DBGMSG(1,"Keyboard %s updated\n",p_kmsi->kbd_name);
+	}
+	UNLOCK_KEYBOARDS();
+}
+
+// Release the memory holding a loaded keyboard (mapped or allocated)
+static void free_keyboard(XKEYBOARD *p_kbd, size_t map_size)
+{
+	if(map_size == BORROWED_KEYBOARD) return;
+#ifndef _WIN32
+	if(map_size > 0)
+	{
+		munmap((void *)p_kbd, map_size);
+		return;
+	}
+#endif
+	free(p_kbd);
+}
+
+// Release a reference to a loaded keyboard, freeing it with the last one. Called with
+// keyboard_lock held
+static void release_keyboard(KMFLKEYBOARD *kp)
+{
+	if(kp == NULL || --kp->refs > 0) return;
+
+	DBGMSG(1,"Keyboard %s released\n",kp->keyboard->name);
+	kmfl_free_dispatch(kp->dispatch);
+	kmfl_free_store_index(kp->store_index);
+	free_keyboard(kp->keyboard, kp->map_size);
+	if(kp->filename) free(kp->filename);
+	free(kp);
+}
+
+// Point an instance at the tables of a loaded keyboard (or at none), with keyboard_lock held
+static void use_keyboard(KMSI *p_kmsi, KMFLKEYBOARD *kp)
+{
+	if(kp) kp->refs++;
+	release_keyboard(p_kmsi->loaded);
+	p_kmsi->loaded = kp;
+
+	// Fill group, rule, store and string pointers (found when the keyboard was loaded)
+	p_kmsi->keyboard = kp ? kp->keyboard : NULL;
+	p_kmsi->stores = kp ? kp->tables.stores : NULL;
+	p_kmsi->groups = kp ? kp->tables.groups : NULL;
+	p_kmsi->rules = kp ? kp->tables.rules : NULL;
+	p_kmsi->strings = kp ? kp->tables.strings : NULL;
+	p_kmsi->dispatch = kp ? kp->dispatch : NULL;
+	p_kmsi->store_index = kp ? kp->store_index : NULL;
+
+	// A profile only counts the rules of one set of tables
+	if(p_kmsi->profile) kmfl_reset_profile(p_kmsi, kp ? &kp->tables : NULL);
+}
+
+// The tables of the keyboard an instance is using (or NULL if it is detached)
+KMFLTABLES *kmfl_instance_tables(KMSI *p_kmsi)
+{
+	return p_kmsi->loaded ? &p_kmsi->loaded->tables : NULL;
+}
+
+// Use the rule dispatch index held in a keyboard, or build it if there is none
+static XDISPATCH *keyboard_dispatch(XKEYBOARD *p_kbd, KMFLTABLES *tables)
+{
+	XDISPATCH *p_dispatch=kmfl_map_dispatch(p_kbd, tables);
+
+	return p_dispatch ? p_dispatch : kmfl_make_dispatch(p_kbd, tables);
+}
+
+// Use the store lookup tables held in a keyboard, or build them if there are none
+static XSTOREINDEX *keyboard_store_index(XKEYBOARD *p_kbd, KMFLTABLES *tables)
+{
+	XSTOREINDEX *p_index=kmfl_map_store_index(p_kbd, tables);
+
+	return p_index ? p_index : kmfl_make_store_index(p_kbd, tables);
+}
+
+// Load a keyboard, compiling it first if it is a source file (unless there is a cached
+// copy of the compiled keyboard). Compiled keyboard files are mapped read-only where 
+// possible (so that all processes using a keyboard share the same pages), and 
+// *p_map_size is set to the size of the mapping (or 0 if the keyboard was loaded into 
+// allocated memory). The locations of the tables of the keyboard are returned in *tables
+XKEYBOARD * kmfl_load_keyboard_from_file(const char *filename, size_t *p_map_size, KMFLTABLES *tables)
 {
 	XKEYBOARD *p_kbd = NULL;
-	FILE *fp;
 	char version_string[6]={0};
 	unsigned int filelen, kbver=0;
 	struct stat fstat;
 	const char * extension;
-    int errcode;
+	KMFLCOMP_CONTEXT *ctx;
+	unsigned long size;
+#ifndef _WIN32
+	char cache_key[20];
+	int fd;
+#else
+	FILE *fp;
+#endif
 
 	DBGMSG(1,"DAR: kmfl_load_keyboard_from_file %s\n",filename);
 
+	*p_map_size = 0;
+
     extension = strrchr(filename, '.');
     
     if (extension && (strcmp(extension, ".kmn") == 0))
     {
         
-     	errcode = setjmp(fatal_error_buf);
-    	
-        if (errcode == 0)
+#ifndef _WIN32
+        // Use the cached compiled keyboard if the source has not changed
+        p_kbd = kmfl_load_cached_keyboard(filename, cache_key, p_map_size, &size);
+        if (p_kbd == NULL)
+#endif
         {
-            compile_keyboard_to_buffer(filename, (void *) &p_kbd);
+            // Compile in a context of its own, so that keyboards can be loaded on
+            // several threads at once
+            if ((ctx = kmflcomp_create_context()) == NULL)
+                return NULL;
+            size = compile_keyboard_to_buffer_r(ctx, filename, (void *) &p_kbd);
+            kmflcomp_delete_context(ctx);
             if (!p_kbd)
                 return NULL;
-    		memcpy(version_string,p_kbd->version,3); // Copy to ensure terminated
-    		kbver = (unsigned)atoi(version_string);
-        } 
-        else
-        {
-            return NULL;
-        } 
+#ifndef _WIN32
+            // Cache the keyboard with its dispatch index and store lookup tables
+            if (*cache_key)
+            {
+                size = kmfl_add_index_sections(&p_kbd, size);
+                kmfl_save_cached_keyboard(filename, cache_key, p_kbd, size);
+            }
+#endif
+        }
+		memcpy(version_string,p_kbd->version,3); // Copy to ensure terminated
+		kbver = (unsigned)atoi(version_string);
     } 
     else
     {    
     	// Get the file size
     	if(stat(filename,&fstat) != 0) 
     	   return NULL;
-    	filelen = fstat.st_size;
+    	size = filelen = fstat.st_size;
+    	if(filelen < sizeof(XKEYBOARD))
+    		return NULL;
 
+#ifndef _WIN32
+    	// Map the file into memory
+    	if((fd=open(filename,O_RDONLY)) < 0)
+    		return NULL;
+    	p_kbd = (XKEYBOARD *)mmap(NULL, filelen, PROT_READ, MAP_SHARED, fd, 0);
+    	close(fd);
+    	if(p_kbd == (XKEYBOARD *)MAP_FAILED)
+    	{
+    		DBGMSG(1,"Unable to map %s\n",filename);
+    		return NULL;
+    	}
+    	*p_map_size = filelen;
+#else
     	// Allocate memory for the installed keyboard
     	if((p_kbd=(XKEYBOARD *)malloc(filelen)) == NULL) 
 			return NULL;
 
     	// Open the file
-    	if((fp=fopen(filename,"rb")) != NULL) 
+    	if((fp=fopen(filename,"rb")) == NULL) 
     	{
-    		if (fread(p_kbd, 1, filelen, fp) != filelen)
-    		{
-	    		fclose(fp);
-	    		return NULL;
-	    	}
-    		fclose(fp);
-    		memcpy(version_string,p_kbd->version,3); // Copy to ensure terminated
-    		kbver = (unsigned)atoi(version_string);
+    		free(p_kbd);
+    		return NULL;
     	}
+    	if (fread(p_kbd, 1, filelen, fp) != filelen)
+    	{
+	    	fclose(fp);
+	    	free(p_kbd);
+	    	return NULL;
+	    }
+    	fclose(fp);
+#endif
+    	memcpy(version_string,p_kbd->version,3); // Copy to ensure terminated
+    	kbver = (unsigned)atoi(version_string);
     }
-	// Check the loaded file is valid and has the correct version
+	// Check the loaded file is valid and has the correct version, then find its tables
 	if((memcmp(p_kbd->id,"KMFL",4) != 0) 
-		|| (p_kbd->version[3] != *FILE_VERSION)
+		|| (p_kbd->version[3] != *FILE_VERSION && p_kbd->version[3] != *FILE_VERSION_1)
 		|| (kbver < (unsigned)atoi(BASE_VERSION))
-		|| (kbver > (unsigned)atoi(LAST_VERSION)))
+		|| (kbver > (unsigned)atoi(LAST_VERSION))
+		|| (kmfl_keyboard_tables(p_kbd, size, tables) != 0)
+		|| (kmfl_check_checksums(p_kbd) != 0))
 	{
-		DBGMSG(1, "Invalid version\n");
-		free(p_kbd); 
+		DBGMSG(1, "Invalid version or corrupt keyboard\n");
+		free_keyboard(p_kbd, *p_map_size);
+		*p_map_size = 0;
 		return NULL;
 	}
 
@@ -255,53 +615,184 @@ XKEYBOARD * kmfl_load_keyboard_from_file(const char *filename)
 	return p_kbd;
 }
 
-// Load the keyboard table into memory and assign it to an empty keyboard slot
-int kmfl_load_keyboard(const char *file) 
+// Make a loaded keyboard, with the indexes of its rules and stores and one reference.
+// Returns NULL if there is not enough memory (the keyboard itself is not released)
+static KMFLKEYBOARD *new_keyboard(XKEYBOARD *p_kbd, size_t map_size, KMFLTABLES *tables, const char *file)
 {
-	XKEYBOARD *p_kbd;
+	KMFLKEYBOARD *kp;
+
+	if((kp=(KMFLKEYBOARD *)malloc(sizeof(KMFLKEYBOARD))) == NULL)
+		return NULL;
+
+	kp->filename = NULL;
+	if(file && (kp->filename=strdup(file)) == NULL)
+	{
+		free(kp);
+		return NULL;
+	}
+	kp->keyboard = p_kbd;
+	kp->map_size = map_size;
+	kp->tables = *tables;
+	kp->dispatch = keyboard_dispatch(p_kbd, tables);
+	kp->store_index = keyboard_store_index(p_kbd, tables);
+	kp->refs = 1;
+	return kp;
+}
+
+// Install a keyboard with the indexes of its rules and stores, giving it a new number.
+// Returns the keyboard number, or -1 if there is not enough memory (the keyboard itself 
+// is not released)
+static int install_keyboard(XKEYBOARD *p_kbd, size_t map_size, KMFLTABLES *tables, const char *file)
+{
+	KMFLKEYBOARD *kp;
+	KMFLINSTALLED *ip;
 	int keyboard_number;
-	
-	// Check number of installed keyboards
-	if(n_keyboards >= MAX_KEYBOARDS) return -1;
-	
-	// initialize the installed keyboards array
-	if(n_keyboards == 0)
-		memset(p_installed_kbd, 0, sizeof(XKEYBOARD *) * MAX_KEYBOARDS);
-	
-	p_kbd = kmfl_load_keyboard_from_file(file);
 
-	if (p_kbd == NULL)
+	// Index the keyboard before taking the lock, so other threads can go on
+	// creating and deleting instances meanwhile
+	if((kp=new_keyboard(p_kbd, map_size, tables, file)) == NULL)
+		return -1;
+	if((ip=(KMFLINSTALLED *)calloc(1, sizeof(KMFLINSTALLED))) == NULL)
+	{
+		kp->map_size = BORROWED_KEYBOARD;	// leave the keyboard itself to the caller
+		release_keyboard(kp);
 		return -1;
+	}
 
-	// Find an empty slot
-	for (keyboard_number=0;keyboard_number < MAX_KEYBOARDS; keyboard_number++)
-		if (p_installed_kbd[keyboard_number] == NULL)
-			break;
-		
-	// Sanity check
-	if (keyboard_number == MAX_KEYBOARDS) {
-		DBGMSG(1, "Could not find an empty keyboard slot even though there was supposed to be one\n");
-		free(p_kbd);
+	LOCK_KEYBOARDS();
+
+	if (grow_registry() != 0) {
+		UNLOCK_KEYBOARDS();
+		DBGMSG(1, "Could not make room for another keyboard\n");
+		free(ip);
+		kp->map_size = BORROWED_KEYBOARD;
+		release_keyboard(kp);
 		return -1;
 	}
 	
-	// Copy pointer and increment number of installed keyboards
-	p_installed_kbd[keyboard_number] = p_kbd;
-	keyboard_filename[keyboard_number]=strdup(file);
+	// Give the keyboard the next number, and add it to the list and the names
+	keyboard_number = ip->number = n_numbers;
+	ip->loaded = kp;
+	memcpy(ip->name, p_kbd->name, NAMELEN);	// calloc has terminated it
+	p_installed[n_numbers++] = ip;
+	add_name(p_names, name_mask, ip);
+	ip->next = p_first_installed;
+	if(ip->next) ip->next->last = ip;
+	p_first_installed = ip;
 	
 	n_keyboards++;
+	UNLOCK_KEYBOARDS();
 	DBGMSG(1,"Keyboard %s loaded\n",p_kbd->name);
 
 	return keyboard_number;	
 }
 
+// Load the keyboard table into memory and install it
+int kmfl_load_keyboard(const char *file) 
+{
+	XKEYBOARD *p_kbd;
+	KMFLTABLES tables;
+	int keyboard_number;
+	size_t map_size;
+	
+	p_kbd = kmfl_load_keyboard_from_file(file, &map_size, &tables);
+
+	if (p_kbd == NULL)
+		return -1;
+
+	keyboard_number = install_keyboard(p_kbd, map_size, &tables, file);
+	if (keyboard_number < 0)
+		free_keyboard(p_kbd, map_size);
+
+	return keyboard_number;	
+}
+
+// Assign a compiled keyboard held in memory (by compile_keyboard_to_buffer(), for 
+// example) to a new keyboard number. If owned is non-zero, the buffer must have been
+// allocated with malloc(), and is freed when the keyboard is unloaded; otherwise it 
+// must be kept until then. If the keyboard cannot be loaded, the buffer still belongs 
+// to the caller. A keyboard loaded this way cannot be reloaded
+int kmfl_load_keyboard_from_buffer(void *keyboard_buffer, unsigned long size, int owned)
+{
+	XKEYBOARD *p_kbd=(XKEYBOARD *)keyboard_buffer;
+	KMFLTABLES tables;
+	
+	if(kmfl_check_keyboard_buffer(keyboard_buffer, size) != 0
+		|| kmfl_keyboard_tables(p_kbd, size, &tables) != 0)
+	{
+		DBGMSG(1, "Invalid version or corrupt keyboard\n");
+		return -1;
+	}
+
+	return install_keyboard(p_kbd, owned ? 0 : BORROWED_KEYBOARD, &tables, NULL);
+}
+
+// Check the identifier and version in a keyboard header
+static int check_keyboard_header(const XKEYBOARD *p_kbd)
+{
+	char version_string[6]={0};
+	unsigned int kbver=0;
+
+	memcpy(version_string,p_kbd->version,3);	// Copy to ensure terminated
+	kbver = (unsigned)atoi(version_string);
+
+	if(memcmp(p_kbd->id,"KMFL",4) != 0) 
+		return -2;
+	if(p_kbd->version[3] != *FILE_VERSION && p_kbd->version[3] != *FILE_VERSION_1) 
+		return -2;
+	if(kbver < (unsigned)atoi(BASE_VERSION)) 
+		return -3;
+	if(kbver > (unsigned)atoi(LAST_VERSION)) 
+		return -4;
+	return 0;
+}
+
+// Check that a compiled keyboard held in memory is valid. Returns the same values as
+// kmfl_check_keyboard()
+int kmfl_check_keyboard_buffer(const void *keyboard_buffer, unsigned long size)
+{
+	XKEYBOARD *p_kbd=(XKEYBOARD *)keyboard_buffer;
+	KMFLTABLES tables;
+	int result;
+
+	if(p_kbd == NULL || size < sizeof(XKEYBOARD))
+		return -1;
+	if((result=check_keyboard_header(p_kbd)) != 0)
+		return result;
+	if(kmfl_keyboard_tables(p_kbd, size, &tables) != 0 || kmfl_check_checksums(p_kbd) != 0)
+		return -2;
+	return 0;
+}
+
+// Check the section directory and checksums of a version 2 keyboard file
+static int check_keyboard_sections(FILE *fp)
+{
+	XKEYBOARD *p_kbd;
+	KMFLTABLES tables;
+	long filelen;
+	int result=-1;
+
+	if(fseek(fp, 0, SEEK_END) != 0 || (filelen=ftell(fp)) < (long)sizeof(XKEYBOARD))
+		return -1;
+	rewind(fp);
+
+	if((p_kbd=(XKEYBOARD *)malloc(filelen)) == NULL)
+		return -1;
+	if(fread(p_kbd, 1, filelen, fp) == (size_t)filelen
+		&& kmfl_keyboard_tables(p_kbd, filelen, &tables) == 0
+		&& kmfl_check_checksums(p_kbd) == 0)
+		result = 0;
+
+	free(p_kbd);
+	return result;
+}
+
 // Check that a keyboard file is valid
 int kmfl_check_keyboard(const char *file) 
 {
 	XKEYBOARD xkb;
 	FILE *fp;
-	char version_string[6]={0};
-	unsigned int kbver=0;
+	int result;
 
 	// Open the file
 	if((fp=fopen(file,"rb")) == NULL) 
@@ -313,99 +804,155 @@ int kmfl_check_keyboard(const char *file)
 		return(-1);
 	}
 	
-	fclose(fp);
-	
-	memcpy(version_string,xkb.version,3);	// Copy to ensure terminated
-	kbver = (unsigned)atoi(version_string);
-
 	// Check the loaded file is valid and has the correct version
-	if(memcmp(xkb.id,"KMFL",4) != 0) 
-		return(-2);
-	if(xkb.version[3] != *FILE_VERSION) 
-		return(-2);
-	if(kbver < (unsigned)atoi(BASE_VERSION)) 
-		return(-3);
-	if(kbver > (unsigned)atoi(LAST_VERSION)) 
-		return(-4);
+	if((result=check_keyboard_header(&xkb)) == 0
+		&& xkb.version[3] == *FILE_VERSION && check_keyboard_sections(fp) != 0)
+		result = -2;
 	
-	return 0;	// file appears to be valid
+	fclose(fp);
+	return result;
 }
 
-// Reload a keyboard from a file
+// Reload a keyboard from its file. Instances using the keyboard go on with the old
+// tables while the file is loaded, and move to the new ones at their next keystroke
 int kmfl_reload_keyboard(int keyboard_number)
 {
-	KMSI *p;
-	XKEYBOARD *p_kbd;
+	KMFLKEYBOARD *kp=NULL, *newkp=NULL;
+	KMFLINSTALLED *ip;
 	XKEYBOARD *p_newkbd;
+	KMFLTABLES tables;
+	size_t map_size;
+	int result=-1;
 	
-	p_kbd =p_installed_kbd[keyboard_number];
-
-	if (p_kbd == NULL) 
-		return -1;
-	
-	// Detach any instances of this keyboard
-	for(p=p_first_instance; p; p=p->next)
+	// Hold on to the keyboard while its file is loaded
+	LOCK_KEYBOARDS();
+	if((ip=installed_keyboard(keyboard_number)) != NULL)
 	{
-		if(p->keyboard_number == keyboard_number) 
-			kmfl_detach_keyboard(p);
+		kp = ip->loaded;
+		kp->refs++;
 	}
+	UNLOCK_KEYBOARDS();
 
-	p_newkbd=kmfl_load_keyboard_from_file(keyboard_filename[keyboard_number]);
-
-	if (p_newkbd == NULL)
+	if (kp == NULL) 
 		return -1;
 	
-	p_installed_kbd[keyboard_number]=p_newkbd;
+	// Keyboards loaded from a buffer have no file to reload
+	if (kp->filename != NULL
+		&& (p_newkbd=kmfl_load_keyboard_from_file(kp->filename, &map_size, &tables)) != NULL)
+	{
+		if ((newkp=new_keyboard(p_newkbd, map_size, &tables, kp->filename)) == NULL)
+			free_keyboard(p_newkbd, map_size);
+	}
 
-	free(p_kbd);
+	LOCK_KEYBOARDS();
 
-	// reattach this keyboard to instances using this keyboard
-	for(p=p_first_instance; p; p=p->next)
+	// Replace the keyboard, unless it has been unloaded or replaced meanwhile. Numbers
+	// are not reused, so the keyboard is still installed if its number is
+	if (newkp != NULL && (ip=installed_keyboard(keyboard_number)) != NULL && ip->loaded == kp)
 	{
-		if(p->keyboard_number == keyboard_number) 
-			kmfl_attach_keyboard(p, keyboard_number);
+		// The name may have changed. It is only written if it has, as callers of
+		// kmfl_keyboard_name() may be reading it
+		STORE_CURRENT(ip, newkp);
+		if(strncmp(ip->name, newkp->keyboard->name, NAMELEN) != 0)
+		{
+			remove_name(ip);
+			memcpy(ip->name, newkp->keyboard->name, NAMELEN);
+			add_name(p_names, name_mask, ip);
+		}
+		release_keyboard(kp);
+		DBGMSG(1,"Keyboard %s reloaded\n",newkp->keyboard->name);
+		result = 0;
 	}
+	else
+		release_keyboard(newkp);
+
+	release_keyboard(kp);
+	UNLOCK_KEYBOARDS();
 	
-	return 0;	
+	return result;	
 }
 
 // Reload all keyboards
 int kmfl_reload_all_keyboards(void)
 {
-	int n;
+	int *numbers;
+	UINT n, count;
 
-	for(n=0; n < MAX_KEYBOARDS; n++) 
-	{
-		if(p_installed_kbd[n] != NULL)
-			kmfl_reload_keyboard(n);
-	}
+	if((count=installed_numbers(&numbers)) == 0)
+		return 0;
+	for(n=0; n < count; n++) 
+		kmfl_reload_keyboard(numbers[n]);
+	free(numbers);
 	return 0;
 }
 
+#ifndef _WIN32
+static void *reload_thread(void *arg)
+{
+	int keyboard_number=(int)(size_t)arg;
+
+	if(keyboard_number < 0)
+		kmfl_reload_all_keyboards();
+	else
+		kmfl_reload_keyboard(keyboard_number);
+	return NULL;
+}
+#endif
+
+// Reload a keyboard (or all keyboards if keyboard_number is -1) on a thread of its own,
+// so that the caller does not wait for the keyboard to be compiled. Returns 0 if the
+// reload was started (or done, where threads are not used)
+int kmfl_reload_keyboard_in_background(int keyboard_number)
+{
+#ifndef _WIN32
+	pthread_t thread;
+	pthread_attr_t attr;
+	int result;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	result = pthread_create(&thread, &attr, reload_thread, (void *)(size_t)keyboard_number);
+	pthread_attr_destroy(&attr);
+	if(result == 0)
+		return 0;
+#endif
+	if(keyboard_number < 0)
+		return kmfl_reload_all_keyboards();
+	return kmfl_reload_keyboard(keyboard_number);
+}
+
 // Unload a keyboard that has been installed
 int kmfl_unload_keyboard(int keyboard_number) 
 {
-	KMSI *p;
-	XKEYBOARD *p_kbd=p_installed_kbd[keyboard_number];
+	KMFLINSTALLED *ip;
 	
-	if (p_kbd == NULL) 
+	LOCK_KEYBOARDS();
+	ip=installed_keyboard(keyboard_number);
+	if (ip == NULL) 
+	{
+		UNLOCK_KEYBOARDS();
 		return -1;
+	}
 	
-	// Enumerate instances and ensure that no instances are using this keyboard
-	for(p=p_first_instance; p; p=p->next)
+	// Ensure that no instances are using this keyboard
+	if (ip->instances != NULL)
 	{
-		if(p->keyboard_number == keyboard_number) return 1;
+		UNLOCK_KEYBOARDS();
+		return 1;
 	}
-
 		
-	// Remove keyboard from list and free memory
-	DBGMSG(1,"Keyboard %s unloaded\n",p_kbd->name);
-	free(keyboard_filename[keyboard_number]);
-	free(p_kbd);
-	
-	p_installed_kbd[keyboard_number]=NULL;
+	// Remove keyboard from the registry, and free its memory unless it is still being 
+	// reloaded. Its number is not given to another keyboard
+	DBGMSG(1,"Keyboard %s unloaded\n",ip->loaded->keyboard->name);
+	p_installed[keyboard_number] = NULL;
+	remove_name(ip);
+	if(ip->last) ip->last->next = ip->next; else p_first_installed = ip->next;
+	if(ip->next) ip->next->last = ip->last;
+	release_keyboard(ip->loaded);
+	free(ip);
 	
 	n_keyboards--;
+	UNLOCK_KEYBOARDS();
 	
 	return 0;
 }
@@ -413,66 +960,67 @@ int kmfl_unload_keyboard(int keyboard_number)
 // Unload all keyboards from memory
 int kmfl_unload_all_keyboards(void)
 {
-	int n;
+	int *numbers;
+	UINT n, count;
 
-	for(n=0; n < MAX_KEYBOARDS; n++) 
-	{
-		if(p_installed_kbd[n] != NULL)
-			kmfl_unload_keyboard(n);
-	}
-	n_keyboards = 0;
+	if((count=installed_numbers(&numbers)) == 0)
+		return 0;
+	for(n=0; n < count; n++) 
+		kmfl_unload_keyboard(numbers[n]);
+	free(numbers);
 	return 0;
 }
 
 // Get the number of an installed keyboard from the name
 int kmfl_keyboard_number(char *name)
 {
-	unsigned int n;
+	KMFLINSTALLED *ip;
+	int n=UNDEFINED;
 
-	for(n=0; n<MAX_KEYBOARDS; n++)
+	LOCK_KEYBOARDS();
+	if(p_names != NULL)
 	{
-		if(p_installed_kbd[n] != NULL && 
-		   strcmp(p_installed_kbd[n]->name,name) == 0) 
-			return n;
+		// Keyboards may share a name: take the first one installed
+		for(ip=p_names[name_hash(name) & name_mask]; ip; ip=ip->next_name)
+		{
+			if(strcmp(ip->name,name) == 0 && (n == UNDEFINED || ip->number < n)) 
+				n = ip->number;
+		}
 	}
-	return UNDEFINED;
+	UNLOCK_KEYBOARDS();
+	return n;
 }
 
-// Get the name of an installed keyboard from the number
+// Get the name of an installed keyboard from the number. The name belongs to the
+// installed keyboard, so it stays valid when the keyboard is reloaded, until it is unloaded
 const char *kmfl_keyboard_name(int keyboard_number)
 {
-	if(p_installed_kbd[keyboard_number] != NULL)
-		return p_installed_kbd[keyboard_number]->name;
-	else
-		return NULL;
+	KMFLINSTALLED *ip;
+	const char *name=NULL;
+
+	LOCK_KEYBOARDS();
+	if((ip=installed_keyboard(keyboard_number)) != NULL)
+		name = ip->name;
+	UNLOCK_KEYBOARDS();
+	return name;
 }
 
 const char *kmfl_icon_file(int keyboard_number)
 {
-	XKEYBOARD *p_kbd;
+	KMFLINSTALLED *ip;
 	XSTORE *stores;
-	XGROUP *groups, *gp;
-	XRULE *rules;
 	ITEM * strings;
 	UTF32 *p32;
 	UTF8 *p8;
-	unsigned int n, nrules;
 	static char icon_name[256];
 
 	*icon_name = 0;
 
-	if((p_kbd=p_installed_kbd[keyboard_number]) != NULL) 
+	LOCK_KEYBOARDS();
+	if((ip=installed_keyboard(keyboard_number)) != NULL) 
 	{
-		stores = (XSTORE *)(p_kbd+1);
-		groups = (XGROUP *)(stores+p_kbd->nstores);
-		rules = (XRULE *)(groups+p_kbd->ngroups);
-
-		for(n=nrules=0,gp=groups; n<p_kbd->ngroups; n++, gp++)
-		{
-			nrules += gp->nrules;
-		}
-
-		strings = (ITEM *)(rules+nrules);
+		stores = ip->loaded->tables.stores;
+		strings = ip->loaded->tables.strings;
 
 		if(stores[SS_BITMAP].len >= 0) 
 		{
@@ -482,5 +1030,6 @@ const char *kmfl_icon_file(int keyboard_number)
 			*p8 = 0;
 		}
 	}
+	UNLOCK_KEYBOARDS();
 	return icon_name;
 }
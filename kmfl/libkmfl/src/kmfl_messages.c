@@ -31,24 +31,246 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+#endif
+#include <kmfl/kmfl.h>
+#include "libkmfl.h"
 
 int kmfl_debug=0;
 
-void DBGMSG(int debug,const char *fmt,...) 
+// Debug messages are formatted into a ring buffer, and written to the log file by a 
+// background thread (or by kmfl_dump_debug_log()), so that logging them does not wait 
+// for the file. The thread is woken early when the buffer is half full; if it still falls 
+// LOG_ENTRIES messages behind, new messages are lost until it catches up
+#define LOG_ENTRIES		1024	// a power of 2
+#define LOG_LENGTH		248		// longest message kept (longer ones are cut short)
+#define LOG_INTERVAL	100		// milliseconds between writes by the background thread
+
+typedef struct _kmfllogentry {
+	UINT seq;					// message number + 1 when complete, or 0 while being written
+	char text[LOG_LENGTH];
+} KMFLLOGENTRY;
+
+static KMFLLOGENTRY log_entries[LOG_ENTRIES];
+static UINT log_next=0;			// number of the next message
+static UINT log_written=0;		// number of the next message to be written out
+static UINT log_lost=0;			// number of messages lost since the last write
+
+#ifdef __GNUC__
+#define CLAIM_MESSAGE(n)	__atomic_compare_exchange_n(&log_next, &(n), (n)+1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define LOAD_SEQ(lp)		__atomic_load_n(&(lp)->seq, __ATOMIC_ACQUIRE)
+#define STORE_SEQ(lp,n)		__atomic_store_n(&(lp)->seq, (n), __ATOMIC_RELEASE)
+#define READ_FENCE()		__atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define LOAD_NEXT()			__atomic_load_n(&log_next, __ATOMIC_ACQUIRE)
+#define LOAD_WRITTEN()		__atomic_load_n(&log_written, __ATOMIC_ACQUIRE)
+#define STORE_WRITTEN(n)	__atomic_store_n(&log_written, (n), __ATOMIC_RELEASE)
+#define COUNT_LOST()		__atomic_fetch_add(&log_lost, 1, __ATOMIC_RELAXED)
+#define LOAD_LOST()			__atomic_load_n(&log_lost, __ATOMIC_RELAXED)
+#define TAKE_LOST(v)		((v) = __atomic_exchange_n(&log_lost, 0, __ATOMIC_RELAXED))
+#else
+#define CLAIM_MESSAGE(n)	(log_next = (n)+1, 1)
+#define LOAD_SEQ(lp)		((lp)->seq)
+#define STORE_SEQ(lp,n)		((lp)->seq = (n))
+#define READ_FENCE()
+#define LOAD_NEXT()			(log_next)
+#define LOAD_WRITTEN()		(log_written)
+#define STORE_WRITTEN(n)	(log_written = (n))
+#define COUNT_LOST()		(log_lost++)
+#define LOAD_LOST()			(log_lost)
+#define TAKE_LOST(v)		((v) = log_lost, log_lost = 0, (v))
+#endif
+
+#ifndef _WIN32
+static pthread_mutex_t log_lock=PTHREAD_MUTEX_INITIALIZER;	// held while writing out
+static pthread_cond_t log_wake=PTHREAD_COND_INITIALIZER;
+static pthread_t log_thread;
+static int log_thread_state=0;	// 0: not started, 1: running, 2: stopping
+
+static void start_log_thread(void);
+#endif
+
+// Record a debug message. Called through DBGMSG(), once the debug level is known to
+// be enabled
+void kmfl_debug_message(int debug, const char *fmt, ...) 
 {
-	FILE * debugfile;
+	KMFLLOGENTRY *lp;
 	va_list args;
+	UINT n;
 	
-	if((debug<0) || ((kmfl_debug&debug)!=0))
+	// Claim the next entry. It is only free once the message LOG_ENTRIES before it has 
+	// been written out: until then the message is lost
+	n = LOAD_NEXT();
+	do
 	{
-		debugfile=fopen("/tmp/libkmfldebug.log", "a");
-		fprintf(debugfile,"debug: ");
-		va_start(args,fmt);
-		vfprintf(debugfile,fmt,args);
-		va_end(args);
-		fclose(debugfile);
+		if(n - LOAD_WRITTEN() >= LOG_ENTRIES)
+		{
+			COUNT_LOST();
+#ifndef _WIN32
+			pthread_cond_signal(&log_wake);
+#endif
+			return;
+		}
+	} while(!CLAIM_MESSAGE(n));
+	lp = log_entries + (n & (LOG_ENTRIES-1));
+
+	STORE_SEQ(lp, 0);
+	va_start(args,fmt);
+	vsnprintf(lp->text, LOG_LENGTH, fmt, args);
+	va_end(args);
+	STORE_SEQ(lp, n+1);
+
+#ifdef _WIN32
+	kmfl_dump_debug_log(NULL);		// no background thread: write it out now
+#else
+	start_log_thread();
+
+	// Wake the background thread rather than let the buffer fill up
+	if((n & (LOG_ENTRIES/2-1)) == 0 && n - LOAD_WRITTEN() >= LOG_ENTRIES/2)
+		pthread_cond_signal(&log_wake);
+#endif
+}
+
+// Write the debug messages recorded since the last call to a file. Returns the number
+// of messages written
+static UINT write_log(FILE *fp)
+{
+	KMFLLOGENTRY *lp;
+	char text[LOG_LENGTH];
+	UINT n, lost, next, count=0;
+
+	// Messages were lost because the buffer was full, so they follow those in it
+	TAKE_LOST(lost);
+	next = LOAD_NEXT();
+
+	for(n=log_written; n != next; n++)
+	{
+		lp = log_entries + (n & (LOG_ENTRIES-1));
+
+		// Stop at a message still being written. Entries are not reused before they are
+		// written out, but the sequence is checked again after the copy in case one was
+		if(LOAD_SEQ(lp) != n+1) 
+			break;
+		memcpy(text, lp->text, LOG_LENGTH);
+		text[LOG_LENGTH-1] = 0;
+		READ_FENCE();
+		if(LOAD_SEQ(lp) != n+1) 
+			break;
+
+		fprintf(fp,"debug: %s",text);
+		count++;
 	}
+	STORE_WRITTEN(n);
+
+	if(lost > 0)
+		fprintf(fp,"debug: (%u messages lost)\n", (unsigned)lost);
+	return count;
+}
+
+// Write out the debug messages that have not been written yet (to the debug log if fp
+// is NULL). Returns the number of messages written
+int kmfl_dump_debug_log(FILE *fp)
+{
+	FILE *debugfile=fp;
+	UINT count=0;
+
+#ifndef _WIN32
+	pthread_mutex_lock(&log_lock);
+#endif
+	if(log_written != LOAD_NEXT() || LOAD_LOST() != 0)
+	{
+		if(debugfile != NULL || (debugfile=fopen(KMFL_DEBUG_LOG, "a")) != NULL)
+		{
+			count = write_log(debugfile);
+			if(fp == NULL) 
+				fclose(debugfile);
+			else
+				fflush(fp);
+		}
+	}
+#ifndef _WIN32
+	pthread_mutex_unlock(&log_lock);
+#endif
+	return (int)count;
+}
+
+#ifndef _WIN32
+// Background thread writing the debug messages to the debug log
+static void *log_thread_main(void *arg)
+{
+	struct timeval now;
+	struct timespec wake;
+	int stopping=0;
+
+	while(!stopping)
+	{
+		gettimeofday(&now, NULL);
+		wake.tv_sec = now.tv_sec + (now.tv_usec + LOG_INTERVAL*1000) / 1000000;
+		wake.tv_nsec = ((now.tv_usec + LOG_INTERVAL*1000) % 1000000) * 1000;
+
+		pthread_mutex_lock(&log_lock);
+		if(log_thread_state == 1)
+			pthread_cond_timedwait(&log_wake, &log_lock, &wake);
+		stopping = (log_thread_state != 1);
+		pthread_mutex_unlock(&log_lock);
+
+		kmfl_dump_debug_log(NULL);
+	}
+	return NULL;
+}
+
+// Start the background thread on the first message
+static void start_log_thread(void)
+{
+	static int started=0;
+
+#ifdef __GNUC__
+	if(__atomic_load_n(&started, __ATOMIC_ACQUIRE))
+		return;
+#else
+	if(started)
+		return;
+#endif
+
+	pthread_mutex_lock(&log_lock);
+	if(!started && log_thread_state == 0 
+		&& pthread_create(&log_thread, NULL, log_thread_main, NULL) == 0)
+		log_thread_state = 1;
+#ifdef __GNUC__
+	__atomic_store_n(&started, 1, __ATOMIC_RELEASE);
+#else
+	started = 1;
+#endif
+	pthread_mutex_unlock(&log_lock);
+}
+#endif
+
+#ifdef __GNUC__
+// Stop the background thread and write out the last messages when the library is 
+// unloaded or the program exits
+static void __attribute__((destructor)) stop_log_thread(void)
+{
+#ifndef _WIN32
+	int running;
+
+	pthread_mutex_lock(&log_lock);
+	running = (log_thread_state == 1);
+	if(running)
+	{
+		log_thread_state = 2;
+		pthread_cond_signal(&log_wake);
+	}
+	pthread_mutex_unlock(&log_lock);
+
+	if(running)
+		pthread_join(log_thread, NULL);
+#endif
+	kmfl_dump_debug_log(NULL);
 }
+#endif
 
 void *ERRMSG(const char *fmt,...) 
 {
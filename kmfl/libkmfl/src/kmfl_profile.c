@@ -0,0 +1,256 @@
+/* kmfl_profile.c
+ * Copyright (C) 2026 ThanLwinSoft.org
+ *
+ * This file is part of the KMFL library.
+ *
+ * The KMFL library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * The KMFL library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with the KMFL library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ *
+ */
+
+/*
+
+	Keystroke interpreter for keyboard mapping for Linux project
+
+	Rule profiles
+
+	Notes:
+		kmfl_start_profile() makes kmfl_interpret() count, for an instance, how
+		often each rule is compared with the history and how often it matches, how
+		often each group is processed, and how long all of this takes, including the
+		time spent in the output functions of the application. An instance that is
+		not profiled only pays for a test of its profile pointer at each step.
+
+		Groups with a matching automaton find their rule without comparing the
+		others, so for them only the rule found is counted as an attempt; the trie
+		field of the group is 1 for these groups. The time spent processing a rule
+		or a group includes the groups it uses.
+
+		kmfl_write_profile() writes the counts as lines of tab-separated fields,
+		with the source line of each group and rule taken from the XS_LINES section
+		of the keyboard (0 if the keyboard was compiled without one):
+
+			profile		keyboard name
+			keystrokes	count	time
+			callbacks	count	time
+			group		number	line	calls	handled	time	trie
+			rule		number	group	line	attempts	matches	match time	process time
+
+		Times are in nanoseconds. Several profiles of the same keyboard can be added
+		together by adding up the lines with the same numbers.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <kmfl/kmfl.h>
+#include "libkmfl.h"
+
+int process_group(KMSI *p_kmsi, XGROUP *gp);
+int match_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys);
+int process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys);
+
+// Read a monotonic clock, in nanoseconds
+double kmfl_profile_clock(void)
+{
+#ifdef _WIN32
+	static double ns_per_tick=0;
+	LARGE_INTEGER n;
+
+	if(ns_per_tick == 0)
+	{
+		QueryPerformanceFrequency(&n);
+		ns_per_tick = 1e9/(double)n.QuadPart;
+	}
+	QueryPerformanceCounter(&n);
+	return (double)n.QuadPart*ns_per_tick;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1e9+ts.tv_nsec;
+#endif
+}
+
+// Clear the profile of an instance, and size it for a set of tables (or for none). The
+// profile is stopped if there is not enough memory
+void kmfl_reset_profile(KMSI *p_kmsi, KMFLTABLES *tables)
+{
+	KMFLPROFILE *pp=p_kmsi->profile;
+	XGROUP *gp;
+	UINT ngroups, nrules, n, r;
+	size_t size;
+
+	ngroups = (tables && p_kmsi->keyboard) ? p_kmsi->keyboard->ngroups : 0;
+	nrules = tables ? tables->nrules : 0;
+
+	if(pp->groups) free(pp->groups);
+	memset(pp, 0, sizeof(KMFLPROFILE));
+
+	// The counts, source lines and groups of the rules are held in one block
+	size = ngroups*sizeof(KMFLGROUPSTATS)+nrules*sizeof(KMFLRULESTATS)
+		+(ngroups+2*nrules)*sizeof(UINT);
+	if(size > 0 && (pp->groups=(KMFLGROUPSTATS *)calloc(size, 1)) == NULL)
+	{
+		ERRMSG("Out of memory for the profile of %s\n", p_kmsi->kbd_name);
+		kmfl_stop_profile(p_kmsi);
+		return;
+	}
+	if(size == 0) return;
+
+	pp->ngroups = ngroups;
+	pp->nrules = nrules;
+	pp->rules = (KMFLRULESTATS *)(pp->groups+ngroups);
+	pp->group_lines = (UINT *)(pp->rules+nrules);
+	pp->rule_lines = pp->group_lines+ngroups;
+	pp->rule_groups = pp->rule_lines+nrules;
+	strcpy(pp->kbd_name, p_kmsi->keyboard->name);
+
+	for(n=0, gp=tables->groups; n<ngroups; n++, gp++)
+	{
+		for(r=gp->rule1; r<gp->rule1+gp->nrules && r<nrules; r++)
+			pp->rule_groups[r] = n;
+	}
+
+	if(tables->lines)
+		memcpy(pp->group_lines, tables->lines, (ngroups+nrules)*sizeof(UINT));
+}
+
+// Start profiling the rules used by an instance (or clear its profile if it is already
+// being profiled). Returns 0 on success, or -1 if there is not enough memory
+int kmfl_start_profile(KMSI *p_kmsi)
+{
+	if(p_kmsi == NULL) return -1;
+
+	if(p_kmsi->profile == NULL
+		&& (p_kmsi->profile=(KMFLPROFILE *)calloc(1, sizeof(KMFLPROFILE))) == NULL)
+		return -1;
+
+	kmfl_reset_profile(p_kmsi, kmfl_instance_tables(p_kmsi));
+	return p_kmsi->profile ? 0 : -1;
+}
+
+// Stop profiling an instance, and release its profile
+void kmfl_stop_profile(KMSI *p_kmsi)
+{
+	KMFLPROFILE *pp=p_kmsi->profile;
+
+	if(pp == NULL) return;
+
+	p_kmsi->profile = NULL;
+	if(pp->groups) free(pp->groups);
+	free(pp);
+}
+
+// Write the profile of an instance to a file. Returns 0 on success, or -1 if the
+// instance is not being profiled or the file could not be written
+int kmfl_write_profile(KMSI *p_kmsi, FILE *fp)
+{
+	KMFLPROFILE *pp=p_kmsi ? p_kmsi->profile : NULL;
+	KMFLGROUPSTATS *gs;
+	KMFLRULESTATS *rs;
+	UINT n;
+
+	if(pp == NULL || fp == NULL) return -1;
+
+	fprintf(fp, "profile\t%s\n", pp->kbd_name);
+	fprintf(fp, "keystrokes\t%lu\t%.0f\n", pp->keystrokes, pp->time);
+	fprintf(fp, "callbacks\t%lu\t%.0f\n", pp->callbacks, pp->callback_time);
+
+	for(n=0, gs=pp->groups; n<pp->ngroups; n++, gs++)
+	{
+		fprintf(fp, "group\t%u\t%u\t%lu\t%lu\t%.0f\t%d\n", (unsigned)n,
+			(unsigned)pp->group_lines[n], gs->calls, gs->handled, gs->time,
+			(p_kmsi->dispatch != NULL && p_kmsi->dispatch[n].trie != NULL));
+	}
+
+	for(n=0, rs=pp->rules; n<pp->nrules; n++, rs++)
+	{
+		fprintf(fp, "rule\t%u\t%u\t%u\t%lu\t%lu\t%.0f\t%.0f\n", (unsigned)n,
+			(unsigned)pp->rule_groups[n], (unsigned)pp->rule_lines[n],
+			rs->attempts, rs->matches, rs->match_time, rs->process_time);
+	}
+
+	return ferror(fp) ? -1 : 0;
+}
+
+// Interpret a keystroke for an instance being profiled
+int kmfl_profile_keystroke(KMSI *p_kmsi, UINT key, UINT state)
+{
+	KMFLPROFILE *pp=p_kmsi->profile;
+	double t=kmfl_profile_clock();
+	int result;
+
+	result = kmfl_interpret_keystroke(p_kmsi, key, state);
+
+	pp->keystrokes++;
+	pp->time += kmfl_profile_clock()-t;
+	return result;
+}
+
+// Process a group of rules for an instance being profiled
+int kmfl_profile_group(KMSI *p_kmsi, XGROUP *gp)
+{
+	KMFLGROUPSTATS *gs=p_kmsi->profile->groups+(gp-p_kmsi->groups);
+	double t=kmfl_profile_clock();
+	int result;
+
+	result = process_group(p_kmsi, gp);
+
+	gs->calls++;
+	if(result > 0) gs->handled++;
+	gs->time += kmfl_profile_clock()-t;
+	return result;
+}
+
+// Compare a rule of the keyboard with the history for an instance being profiled
+int kmfl_profile_match_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
+{
+	KMFLRULESTATS *rs=p_kmsi->profile->rules+(rp-p_kmsi->rules);
+	double t=kmfl_profile_clock();
+	int matched;
+
+	matched = match_rule(p_kmsi, rp, any_index, usekeys);
+
+	rs->attempts++;
+	if(matched) rs->matches++;
+	rs->match_time += kmfl_profile_clock()-t;
+	return matched;
+}
+
+// Process a matched rule of the keyboard for an instance being profiled
+int kmfl_profile_process_rule(KMSI *p_kmsi, XRULE *rp, ITEM *any_index, int usekeys)
+{
+	KMFLRULESTATS *rs=p_kmsi->profile->rules+(rp-p_kmsi->rules);
+	double t=kmfl_profile_clock();
+	int result;
+
+	result = process_rule(p_kmsi, rp, any_index, usekeys);
+
+	rs->process_time += kmfl_profile_clock()-t;
+	return result;
+}
+
+// Count a call to an output function of the application, which started at time t
+void kmfl_profile_callback(KMSI *p_kmsi, double t)
+{
+	p_kmsi->profile->callbacks++;
+	p_kmsi->profile->callback_time += kmfl_profile_clock()-t;
+}
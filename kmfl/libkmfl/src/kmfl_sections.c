@@ -0,0 +1,523 @@
+/* kmfl_sections.c
+ * Copyright (C) 2026 ThanLwinSoft.org
+ *
+ * This file is part of the KMFL library.
+ *
+ * The KMFL library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * The KMFL library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with the KMFL library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ *
+ */
+
+/*
+
+	Keystroke interpreter for keyboard mapping for Linux project
+
+	Sections of compiled keyboards
+
+	Notes:
+		A version 2 compiled keyboard lists its tables in a section directory
+		(see kmfl.h), so they are found once when the keyboard is loaded and the
+		loader can check that each of them lies inside the file and has not been
+		corrupted. Version 1 keyboards are still accepted: their tables simply
+		follow one another after the header.
+
+		The rule dispatch index and store lookup tables are built by the
+		interpreter, not by the compiler, so keyboards written by kmflcomp only
+		have the four sections holding the stores, groups, rules and strings,
+		and an XS_LINES section giving the source line of each group and rule
+		for profiles (older keyboards do not have it).
+		Keyboards saved in the compiled keyboard cache also get XS_DISPATCH and
+		XS_STOREINDEX sections, which are used in place of the tables built by
+		kmfl_make_dispatch() and kmfl_make_store_index() once they have been
+		checked, so that loading a cached keyboard builds nothing.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <kmfl/kmfl.h>
+#include <kmfl/kmflcomp.h>
+#include "libkmfl.h"
+
+#define REC_SIZE(t)		(sizeof(t)/sizeof(UINT))	// size of a record in UINTs
+#define MAX_SECTIONS	16
+
+// Is this a version 2 keyboard?
+static int has_directory(XKEYBOARD *p_kbd)
+{
+	return p_kbd->version[3] == *FILE_VERSION;
+}
+
+// Locate the tables of a version 1 keyboard, which follow the header in turn
+static int find_tables_v1(XKEYBOARD *p_kbd, unsigned long size, KMFLTABLES *tables)
+{
+	XGROUP *gp;
+	unsigned long offset, nrules;
+	UINT n;
+
+	offset = sizeof(XKEYBOARD);
+	if(p_kbd->nstores > (size-offset)/sizeof(XSTORE)) return -1;
+	offset += p_kbd->nstores*sizeof(XSTORE);
+	if(p_kbd->ngroups > (size-offset)/sizeof(XGROUP)) return -1;
+	offset += p_kbd->ngroups*sizeof(XGROUP);
+
+	tables->stores = (XSTORE *)(p_kbd+1);
+	tables->groups = (XGROUP *)(tables->stores+p_kbd->nstores);
+
+	for(n=0, nrules=0, gp=tables->groups; n<p_kbd->ngroups; n++, gp++)
+	{
+		nrules += gp->nrules;
+		if(nrules > (size-offset)/sizeof(XRULE)) return -1;
+	}
+	offset += nrules*sizeof(XRULE);
+
+	tables->rules = (XRULE *)(tables->groups+p_kbd->ngroups);
+	tables->nrules = nrules;
+	tables->strings = (ITEM *)(tables->rules+nrules);
+	tables->nstrings = (size-offset)/sizeof(ITEM);
+	return 0;
+}
+
+// Locate the tables of a compiled keyboard of size bytes, checking that they lie within it.
+// Returns 0 if they were all found, or -1 if the keyboard is not valid
+int kmfl_keyboard_tables(XKEYBOARD *p_kbd, unsigned long size, KMFLTABLES *tables)
+{
+	XDIRECTORY *xdp;
+	XSECTION *xs;
+	XGROUP *gp;
+	unsigned long start, nrules;
+	UINT n, found=0;
+	char *base=(char *)p_kbd;
+
+	memset(tables, 0, sizeof(KMFLTABLES));
+
+	if(size < sizeof(XKEYBOARD)) return -1;
+	if(!has_directory(p_kbd)) return find_tables_v1(p_kbd, size, tables);
+
+	// Check the directory
+	if(size < sizeof(XKEYBOARD)+sizeof(XDIRECTORY)) return -1;
+	xdp = (XDIRECTORY *)(p_kbd+1);
+	if(xdp->size > size) return -1;
+	start = sizeof(XKEYBOARD)+sizeof(XDIRECTORY);
+	if(xdp->size < start || xdp->nsections > (xdp->size-start)/sizeof(XSECTION)) return -1;
+	start += xdp->nsections*sizeof(XSECTION);
+
+	// Check that each section is aligned and lies after the directory
+	for(n=0, xs=(XSECTION *)(xdp+1); n<xdp->nsections; n++, xs++)
+	{
+		if(xs->offset % XS_ALIGN != 0 || xs->offset < start || xs->offset > xdp->size
+			|| xs->size > xdp->size-xs->offset || xs->size % sizeof(UINT) != 0)
+			return -1;
+
+		switch(xs->id)
+		{
+		case XS_STORES:
+			if(xs->size != p_kbd->nstores*sizeof(XSTORE)) return -1;
+			tables->stores = (XSTORE *)(base+xs->offset);
+			break;
+		case XS_GROUPS:
+			if(xs->size != p_kbd->ngroups*sizeof(XGROUP)) return -1;
+			tables->groups = (XGROUP *)(base+xs->offset);
+			break;
+		case XS_RULES:
+			if(xs->size != xdp->nrules*sizeof(XRULE)) return -1;
+			tables->rules = (XRULE *)(base+xs->offset);
+			break;
+		case XS_STRINGS:
+			tables->strings = (ITEM *)(base+xs->offset);
+			tables->nstrings = xs->size/sizeof(ITEM);
+			break;
+		case XS_DISPATCH:
+			tables->dispatch = (UINT *)(base+xs->offset);
+			tables->ndispatch = xs->size/sizeof(UINT);
+			break;
+		case XS_STOREINDEX:
+			tables->store_index = (UINT *)(base+xs->offset);
+			tables->nstore_index = xs->size/sizeof(UINT);
+			break;
+		case XS_LINES:
+			if(xs->size != (p_kbd->ngroups+xdp->nrules)*sizeof(UINT)) return -1;
+			tables->lines = (UINT *)(base+xs->offset);
+			break;
+		default:			// ignore sections added by later versions
+			continue;
+		}
+		found |= 1 << xs->id;
+	}
+
+	// The tables are required, and the groups must account for all the rules
+	if((found & 0x1e) != 0x1e) return -1;
+
+	for(n=0, nrules=0, gp=tables->groups; n<p_kbd->ngroups; n++, gp++)
+		nrules += gp->nrules;
+	if(nrules != xdp->nrules) return -1;
+
+	tables->nrules = xdp->nrules;
+	return 0;
+}
+
+// Check the checksums of a version 2 keyboard whose tables have been located.
+// Returns 0 if they are correct (or if the keyboard has none)
+int kmfl_check_checksums(XKEYBOARD *p_kbd)
+{
+	XDIRECTORY *xdp;
+	XSECTION *xs;
+	UINT n, sum;
+
+	if(!has_directory(p_kbd)) return 0;
+
+	xdp = (XDIRECTORY *)(p_kbd+1);
+	xs = (XSECTION *)(xdp+1);
+	sum = kmfl_checksum(XS_CHECKSUM_INIT, p_kbd, sizeof(XKEYBOARD));
+	if(kmfl_checksum(sum, xs, xdp->nsections*sizeof(XSECTION)) != xdp->checksum)
+		return -1;
+
+	for(n=0; n<xdp->nsections; n++, xs++)
+	{
+		if(kmfl_checksum(XS_CHECKSUM_INIT, (char *)p_kbd+xs->offset, xs->size) != xs->checksum)
+			return -1;
+	}
+	return 0;
+}
+
+// Is a rule number valid for a group?
+static int valid_rule(UINT nrule, XGROUP *gp)
+{
+	return nrule < gp->nrules;
+}
+
+// Check the matching automaton of a group read from an XS_DISPATCH section
+static int valid_trie(XDISPATCH *dp, XGROUP *gp)
+{
+	XTRIENODE *np;
+	UINT n;
+
+	for(n=0, np=dp->trie; n<dp->nnodes; n++, np++)
+	{
+		if((np->rule != TRIE_NO_RULE && !valid_rule(np->rule, gp))
+			|| (np->best != TRIE_NO_RULE && !valid_rule(np->best, gp))
+			|| np->edge1 > dp->nedges || np->nedges > dp->nedges-np->edge1
+			|| np->nliteral > np->nedges || np->nkeysym > np->nedges-np->nliteral
+			|| np->any1 > dp->nanys || np->nany > dp->nanys-np->any1)
+			return 0;
+	}
+	for(n=0; n<dp->nedges; n++)
+	{
+		if(dp->edges[n].node >= dp->nnodes) return 0;
+	}
+	for(n=0; n<dp->nanys; n++)
+	{
+		if(dp->anys[n].node >= dp->nnodes) return 0;
+	}
+	return 1;
+}
+
+// Use the rule dispatch index held in the XS_DISPATCH section of a keyboard, after checking
+// it. Returns NULL if there is no such section, or if it is not valid
+XDISPATCH *kmfl_map_dispatch(XKEYBOARD *p_kbd, KMFLTABLES *tables)
+{
+	XDISPATCH *p_dispatch, *dp;
+	XDISPATCHREC *rec;
+	XGROUP *gp;
+	UINT *base=tables->dispatch;
+	unsigned long need, navail=tables->ndispatch;
+	UINT n, k;
+
+	if(base == NULL || p_kbd->ngroups > navail/REC_SIZE(XDISPATCHREC)) return NULL;
+
+	if((p_dispatch=(XDISPATCH *)calloc(p_kbd->ngroups+1, sizeof(XDISPATCH))) == NULL)
+		return NULL;
+
+	for(n=0, rec=(XDISPATCHREC *)base, gp=tables->groups, dp=p_dispatch; n<p_kbd->ngroups; n++, rec++, gp++, dp++)
+	{
+		// Check the sizes of the tables (each is no larger than the section)
+		if(rec->nbuckets == 0 || (rec->nbuckets & (rec->nbuckets-1)) != 0
+			|| rec->nbuckets >= navail || rec->nlisted > navail || rec->nwild > navail
+			|| rec->nnodes > navail || rec->nedges > navail || rec->nanys > navail
+			|| rec->tables > navail)
+			goto fail;
+
+		need = (unsigned long)rec->nbuckets+1+rec->nlisted+rec->nwild+rec->nnodes*REC_SIZE(XTRIENODE)
+			+ ((unsigned long)rec->nedges+rec->nanys)*REC_SIZE(XTRIEEDGE);
+		if(need > navail-rec->tables) goto fail;
+
+		dp->nbuckets = rec->nbuckets;
+		dp->nwild = rec->nwild;
+		dp->buckets = base+rec->tables;
+		dp->rules = dp->buckets+dp->nbuckets+1;
+		dp->wild = dp->rules+rec->nlisted;
+		dp->mapped = 1;
+
+		// Check the rule lists
+		if(dp->buckets[0] != 0 || dp->buckets[dp->nbuckets] != rec->nlisted) goto fail;
+		for(k=0; k<dp->nbuckets; k++)
+		{
+			if(dp->buckets[k] > dp->buckets[k+1]) goto fail;
+		}
+		for(k=0; k<rec->nlisted; k++)
+		{
+			if(!valid_rule(dp->rules[k], gp)) goto fail;
+		}
+		for(k=0; k<dp->nwild; k++)
+		{
+			if(!valid_rule(dp->wild[k], gp)) goto fail;
+		}
+
+		if(rec->nnodes > 0)
+		{
+			dp->nnodes = rec->nnodes;
+			dp->nedges = rec->nedges;
+			dp->nanys = rec->nanys;
+			dp->trie = (XTRIENODE *)(dp->wild+dp->nwild);
+			dp->edges = (XTRIEEDGE *)(dp->trie+dp->nnodes);
+			dp->anys = dp->edges+dp->nedges;
+			if(!valid_trie(dp, gp)) goto fail;
+		}
+	}
+
+	DBGMSG(1,"Using precomputed rule dispatch index for %s\n",p_kbd->name);
+	return p_dispatch;
+
+fail:
+	free(p_dispatch);
+	DBGMSG(1,"Invalid rule dispatch section in %s\n",p_kbd->name);
+	return NULL;
+}
+
+// Use the store lookup tables held in the XS_STOREINDEX section of a keyboard, after
+// checking them. Returns NULL if there is no such section, or if it is not valid
+XSTOREINDEX *kmfl_map_store_index(XKEYBOARD *p_kbd, KMFLTABLES *tables)
+{
+	XSTOREINDEX *p_index, *sx;
+	XSTOREINDEXREC *rec;
+	XSTORE *sp;
+	UINT *base=tables->store_index;
+	unsigned long navail=tables->nstore_index;
+	UINT n, k;
+
+	if(base == NULL || p_kbd->nstores == 0 || p_kbd->nstores > navail/REC_SIZE(XSTOREINDEXREC))
+		return NULL;
+
+	if((p_index=(XSTOREINDEX *)calloc(p_kbd->nstores, sizeof(XSTOREINDEX))) == NULL)
+		return NULL;
+
+	for(n=0, rec=(XSTOREINDEXREC *)base, sp=tables->stores, sx=p_index; n<p_kbd->nstores; n++, rec++, sp++, sx++)
+	{
+		if(rec->mask == 0) continue;
+
+		// Each table has mask+1 slots (a power of 2) of two UINTs
+		if(rec->mask >= navail/4 || (rec->mask & (rec->mask+1)) != 0
+			|| rec->slots > navail || 4*((unsigned long)rec->mask+1) > navail-rec->slots)
+			goto fail;
+
+		sx->mask = rec->mask;
+		sx->items = base+rec->slots;
+		sx->chars = sx->items+2*(sx->mask+1);
+
+		// The slots must give the index of an item of the store
+		for(k=0; k<=sx->mask; k++)
+		{
+			if(sx->items[2*k+1] > sp->len || sx->chars[2*k+1] > sp->len) goto fail;
+		}
+	}
+
+	DBGMSG(1,"Using precomputed store lookup tables for %s\n",p_kbd->name);
+	return p_index;
+
+fail:
+	free(p_index);
+	DBGMSG(1,"Invalid store lookup section in %s\n",p_kbd->name);
+	return NULL;
+}
+
+// Size of the XS_DISPATCH section for a dispatch index, in UINTs
+static unsigned long dispatch_size(XDISPATCH *p_dispatch, UINT ngroups)
+{
+	XDISPATCH *dp;
+	unsigned long size;
+	UINT n;
+
+	size = ngroups*REC_SIZE(XDISPATCHREC);
+	for(n=0, dp=p_dispatch; n<ngroups; n++, dp++)
+	{
+		size += dp->nbuckets+1+dp->buckets[dp->nbuckets]+dp->nwild;
+		if(dp->trie)
+			size += dp->nnodes*REC_SIZE(XTRIENODE)+(dp->nedges+dp->nanys)*REC_SIZE(XTRIEEDGE);
+	}
+	return size;
+}
+
+// Write the XS_DISPATCH section for a dispatch index
+static void write_dispatch(UINT *base, XDISPATCH *p_dispatch, UINT ngroups)
+{
+	XDISPATCH *dp;
+	XDISPATCHREC *rec;
+	UINT *p;
+	UINT n;
+
+	p = base+ngroups*REC_SIZE(XDISPATCHREC);
+	for(n=0, dp=p_dispatch, rec=(XDISPATCHREC *)base; n<ngroups; n++, dp++, rec++)
+	{
+		rec->nbuckets = dp->nbuckets;
+		rec->nwild = dp->nwild;
+		rec->nlisted = dp->buckets[dp->nbuckets];
+		rec->tables = p-base;
+
+		memcpy(p, dp->buckets, (dp->nbuckets+1)*sizeof(UINT));
+		p += dp->nbuckets+1;
+		memcpy(p, dp->rules, rec->nlisted*sizeof(UINT));
+		p += rec->nlisted;
+		memcpy(p, dp->wild, dp->nwild*sizeof(UINT));
+		p += dp->nwild;
+
+		if(dp->trie)
+		{
+			rec->nnodes = dp->nnodes;
+			rec->nedges = dp->nedges;
+			rec->nanys = dp->nanys;
+			memcpy(p, dp->trie, dp->nnodes*sizeof(XTRIENODE));
+			p += dp->nnodes*REC_SIZE(XTRIENODE);
+			memcpy(p, dp->edges, dp->nedges*sizeof(XTRIEEDGE));
+			p += dp->nedges*REC_SIZE(XTRIEEDGE);
+			memcpy(p, dp->anys, dp->nanys*sizeof(XTRIEEDGE));
+			p += dp->nanys*REC_SIZE(XTRIEEDGE);
+		}
+	}
+}
+
+// Size of the XS_STOREINDEX section for a set of store lookup tables, in UINTs
+static unsigned long store_index_size(XSTOREINDEX *p_index, UINT nstores)
+{
+	XSTOREINDEX *sx;
+	unsigned long size;
+	UINT n;
+
+	size = nstores*REC_SIZE(XSTOREINDEXREC);
+	for(n=0, sx=p_index; n<nstores; n++, sx++)
+	{
+		if(sx->mask != 0) size += 4*(sx->mask+1);
+	}
+	return size;
+}
+
+// Write the XS_STOREINDEX section for a set of store lookup tables
+static void write_store_index(UINT *base, XSTOREINDEX *p_index, UINT nstores)
+{
+	XSTOREINDEX *sx;
+	XSTOREINDEXREC *rec;
+	UINT *p;
+	UINT n;
+
+	p = base+nstores*REC_SIZE(XSTOREINDEXREC);
+	for(n=0, sx=p_index, rec=(XSTOREINDEXREC *)base; n<nstores; n++, sx++, rec++)
+	{
+		rec->mask = sx->mask;
+		if(sx->mask == 0) continue;
+
+		rec->slots = p-base;
+		memcpy(p, sx->items, 2*(sx->mask+1)*sizeof(UINT));
+		p += 2*(sx->mask+1);
+		memcpy(p, sx->chars, 2*(sx->mask+1)*sizeof(UINT));
+		p += 2*(sx->mask+1);
+	}
+}
+
+// Add the rule dispatch index and store lookup tables to an allocated version 2 keyboard of
+// size bytes, as XS_DISPATCH and XS_STOREINDEX sections. The keyboard is replaced by a
+// larger copy, and its new size is returned (or the old size if nothing was added)
+unsigned long kmfl_add_index_sections(XKEYBOARD **pp_kbd, unsigned long size)
+{
+	XKEYBOARD *p_kbd=*pp_kbd, *p_new;
+	XDIRECTORY *xdp, *xdp_new;
+	XSECTION xs[MAX_SECTIONS], *xsp;
+	OFFSET oldoffset[MAX_SECTIONS];
+	XDISPATCH *p_dispatch=NULL;
+	XSTOREINDEX *p_index=NULL;
+	KMFLTABLES tables;
+	unsigned long offset, newsize;
+	UINT n, ns, nold, sum;
+
+	if(!has_directory(p_kbd) || kmfl_keyboard_tables(p_kbd, size, &tables) != 0
+		|| tables.dispatch != NULL || tables.store_index != NULL)
+		return size;
+
+	xdp = (XDIRECTORY *)(p_kbd+1);
+	if(xdp->nsections > MAX_SECTIONS-2) return size;
+
+	p_dispatch = kmfl_make_dispatch(p_kbd, &tables);
+	p_index = kmfl_make_store_index(p_kbd, &tables);
+
+	// List the existing sections and the new ones
+	nold = xdp->nsections;
+	memcpy(xs, xdp+1, nold*sizeof(XSECTION));
+	ns = nold;
+	if(p_dispatch)
+	{
+		xs[ns].id = XS_DISPATCH;
+		xs[ns++].size = dispatch_size(p_dispatch, p_kbd->ngroups)*sizeof(UINT);
+	}
+	if(p_index)
+	{
+		xs[ns].id = XS_STOREINDEX;
+		xs[ns++].size = store_index_size(p_index, p_kbd->nstores)*sizeof(UINT);
+	}
+
+	// Lay out the sections after the larger directory
+	offset = XS_ALIGNED(sizeof(XKEYBOARD)+sizeof(XDIRECTORY)+ns*sizeof(XSECTION));
+	for(n=0, xsp=xs; n<ns; n++, xsp++)
+	{
+		oldoffset[n] = xsp->offset;
+		xsp->offset = offset;
+		offset = XS_ALIGNED(offset+xsp->size);
+	}
+	newsize = xs[ns-1].offset+xs[ns-1].size;
+
+	if(ns == nold || (p_new=(XKEYBOARD *)calloc(newsize, 1)) == NULL)
+	{
+		kmfl_free_dispatch(p_dispatch);
+		kmfl_free_store_index(p_index);
+		return size;
+	}
+
+	// Copy the header and the existing sections, then write the new ones
+	memcpy(p_new, p_kbd, sizeof(XKEYBOARD));
+	for(n=0, xsp=xs; n<ns; n++, xsp++)
+	{
+		if(n < nold)
+			memcpy((char *)p_new+xsp->offset, (char *)p_kbd+oldoffset[n], xsp->size);
+		else if(xsp->id == XS_DISPATCH)
+			write_dispatch((UINT *)((char *)p_new+xsp->offset), p_dispatch, p_kbd->ngroups);
+		else
+			write_store_index((UINT *)((char *)p_new+xsp->offset), p_index, p_kbd->nstores);
+
+		xsp->checksum = kmfl_checksum(XS_CHECKSUM_INIT, (char *)p_new+xsp->offset, xsp->size);
+	}
+
+	xdp_new = (XDIRECTORY *)(p_new+1);
+	xdp_new->size = newsize;
+	xdp_new->nsections = ns;
+	xdp_new->nrules = xdp->nrules;
+	memcpy(xdp_new+1, xs, ns*sizeof(XSECTION));
+	sum = kmfl_checksum(XS_CHECKSUM_INIT, p_new, sizeof(XKEYBOARD));
+	xdp_new->checksum = kmfl_checksum(sum, xs, ns*sizeof(XSECTION));
+
+	kmfl_free_dispatch(p_dispatch);
+	kmfl_free_store_index(p_index);
+	free(p_kbd);
+
+	*pp_kbd = p_new;
+	return newsize;
+}
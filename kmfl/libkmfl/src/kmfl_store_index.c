@@ -0,0 +1,160 @@
+/* kmfl_store_index.c
+ * Copyright (C) 2026 ThanLwinSoft.org
+ *
+ * This file is part of the KMFL library.
+ *
+ * The KMFL library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * The KMFL library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with the KMFL library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ *
+ */
+
+/*
+
+	Keystroke interpreter for keyboard mapping for Linux project
+
+	Store lookup tables
+
+	Notes:
+		match_rule() needs the index of the first item of a store that matches
+		a history item for any() and notany(). The last item of a rule is compared
+		without its item type (so that a keysym matches a character), the other
+		items are compared in full.
+
+		For every store used by any() or notany(), two open-addressed hash tables
+		are built when the keyboard is loaded, one keyed by the full item and one
+		by the item without its type. Each slot holds the key and the index of the
+		first matching item plus one (zero for an empty slot). The tables are at
+		most half full, so a lookup takes one or two probes on average.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kmfl/kmfl.h>
+#include "libkmfl.h"
+
+#define STORE_HASH(x,mask)	((((x)*0x9e3779b1UL) >> 13) & (mask))
+#define TYPE_MASK			0xffffff
+
+// Add an item to a hash table, unless an earlier item has the same key
+static void insert_item(UINT *slots, UINT mask, UINT key, UINT index)
+{
+	UINT h;
+
+	for(h=STORE_HASH(key,mask); slots[2*h+1] != 0; h=(h+1) & mask)
+	{
+		if(slots[2*h] == key) return;
+	}
+	slots[2*h] = key;
+	slots[2*h+1] = index+1;
+}
+
+// Size of the tables for a store (a power of 2, at least twice the store length)
+static UINT table_size(UINT len)
+{
+	UINT n;
+	for(n=4; n<2*len; n <<= 1);
+	return n;
+}
+
+// Build lookup tables for the stores referenced by any() or notany() in a loaded keyboard
+XSTOREINDEX *kmfl_make_store_index(XKEYBOARD *p_kbd, KMFLTABLES *tables)
+{
+	XSTOREINDEX *p_index, *sx;
+	XSTORE *stores=tables->stores, *sp;
+	XRULE *rules=tables->rules, *rp;
+	ITEM *strings=tables->strings, *pr, *ps;
+	UINT *slots;
+	UINT n, k, nrules=tables->nrules, nslots, nstore;
+	char *used;
+
+	// Find the stores that are used by any() or notany()
+	if((used=(char *)calloc(p_kbd->nstores+1, 1)) == NULL)
+		return NULL;
+
+	for(n=0, rp=rules; n<nrules; n++, rp++)
+	{
+		for(k=0, pr=strings+rp->lhs; k<rp->ilen; k++, pr++)
+		{
+			if((ITEM_TYPE(*pr) == ITEM_ANY || ITEM_TYPE(*pr) == ITEM_NOTANY)
+				&& (nstore=(*pr) & 0xffff) < p_kbd->nstores)
+				used[nstore] = 1;
+		}
+	}
+
+	for(n=nslots=0, sp=stores; n<p_kbd->nstores; n++, sp++)
+	{
+		if(used[n] && sp->len > 0) nslots += 2*table_size(sp->len);
+	}
+
+	// Allocate the index and all its tables as a single block
+	p_index = (XSTOREINDEX *)calloc(1, p_kbd->nstores*sizeof(XSTOREINDEX)+2*nslots*sizeof(UINT));
+	if(p_index == NULL)
+	{
+		free(used);
+		DBGMSG(1,"Unable to build store lookup tables for %s\n",p_kbd->name);
+		return NULL;
+	}
+
+	slots = (UINT *)(p_index+p_kbd->nstores);
+	for(n=0, sp=stores, sx=p_index; n<p_kbd->nstores; n++, sp++, sx++)
+	{
+		if(!used[n] || sp->len == 0) continue;
+
+		nslots = table_size(sp->len);
+		sx->mask = nslots-1;
+		sx->items = slots; slots += 2*nslots;
+		sx->chars = slots; slots += 2*nslots;
+
+		for(k=0, ps=strings+sp->items; k<sp->len; k++, ps++)
+		{
+			insert_item(sx->items, sx->mask, *ps, k);
+			insert_item(sx->chars, sx->mask, (*ps) & TYPE_MASK, k);
+		}
+	}
+
+	free(used);
+	DBGMSG(1,"Store lookup tables built for %s\n",p_kbd->name);
+	return p_index;
+}
+
+// Release the store lookup tables of a keyboard
+void kmfl_free_store_index(XSTOREINDEX *p_index)
+{
+	if(p_index) free(p_index);
+}
+
+// Return the index of the first store item matching an item (optionally ignoring the
+// item type), or UNDEFINED if there is no match
+int kmfl_find_in_store(XSTOREINDEX *sx, ITEM item, int ignore_type)
+{
+	UINT *slots, h;
+
+	if(ignore_type)
+	{
+		slots = sx->chars;
+		item &= TYPE_MASK;
+	}
+	else
+	{
+		slots = sx->items;
+	}
+
+	for(h=STORE_HASH(item,sx->mask); slots[2*h+1] != 0; h=(h+1) & sx->mask)
+	{
+		if(slots[2*h] == item) return (int)slots[2*h+1]-1;
+	}
+	return UNDEFINED;
+}
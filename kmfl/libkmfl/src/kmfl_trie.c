@@ -0,0 +1,299 @@
+/* kmfl_trie.c
+ * Copyright (C) 2026 ThanLwinSoft.org
+ *
+ * This file is part of the KMFL library.
+ *
+ * The KMFL library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * The KMFL library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with the KMFL library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ *
+ */
+
+/*
+
+	Keystroke interpreter for keyboard mapping for Linux project
+
+	Rule matching automaton
+
+	Notes:
+		match_rule() compares a rule with the history from right to left, one
+		rule at a time. For groups whose rules only contain characters, keysyms,
+		deadkeys, any() and notany(), the input rules are merged into a trie of
+		reversed item sequences instead, so that rules sharing the same ending
+		share the same comparisons.
+
+		Each node records the first rule (in the order established by sort_rules()
+		in the compiler) that ends there, and the first rule ending anywhere below
+		it. The interpreter walks the trie along the history, skipping any branch
+		that cannot lead to an earlier rule than the best one found so far, so the
+		rule found is always the one that a linear scan would have matched.
+
+		Character and deadkey edges must match exactly and are sorted by item, so
+		only one of them can be followed from a node (found by binary search).
+		Keysym edges are sorted by key, so only those with the same key as the
+		history item need their shift states compared. any() edges are expanded
+		into one entry per store item, sorted by item (without its type for the
+		last item of a rule, as in match_rule()), so they can be found by binary
+		search as well. The other edges (notany()) are tried in turn, in order of
+		the first rule they lead to.
+
+		Groups using context(), index(), nul or other items on the left hand side
+		of their rules are not converted, and are matched one rule at a time.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kmfl/kmfl.h>
+#include "libkmfl.h"
+
+// Node of the trie while it is being built
+typedef struct _tnode {
+	ITEM item;				// item on the edge leading to this node
+	UINT rule;				// first rule ending at this node
+	UINT best;				// first rule ending at or below this node
+	UINT child;				// first child (0 if none)
+	UINT sibling;			// next sibling (0 if none)
+} TNODE;
+
+// Edge of the trie while it is being sorted
+typedef struct _tedge {
+	ITEM item;
+	UINT node;
+	UINT best;
+	int kind;
+} TEDGE;
+
+// Kinds of edges, in the order they are stored
+#define EDGE_LITERAL	0
+#define EDGE_KEYSYM		1
+#define EDGE_OTHER		2
+
+// Can this item be matched by the automaton?
+static int trie_item(ITEM item)
+{
+	switch(ITEM_TYPE(item))
+	{
+	case ITEM_CHAR:
+	case ITEM_KEYSYM:
+	case ITEM_DEADKEY:
+	case ITEM_ANY:
+	case ITEM_NOTANY:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+// Sort literal edges first (by item), then keysym edges (by key), then the others,
+// with edges of the same key or kind sorted by the first rule they lead to
+static int compare_edges(const void *arg1, const void *arg2)
+{
+	const TEDGE *e1=(const TEDGE *)arg1, *e2=(const TEDGE *)arg2;
+
+	if(e1->kind != e2->kind) return (e1->kind < e2->kind) ? -1 : 1;
+	if(e1->kind == EDGE_LITERAL)
+	{
+		if(e1->item < e2->item) return -1;
+		if(e1->item > e2->item) return 1;
+		return 0;
+	}
+	if(e1->kind == EDGE_KEYSYM)
+	{
+		if((e1->item & 0xffff) < (e2->item & 0xffff)) return -1;
+		if((e1->item & 0xffff) > (e2->item & 0xffff)) return 1;
+	}
+	if(e1->best < e2->best) return -1;
+	if(e1->best > e2->best) return 1;
+	return 0;
+}
+
+// Sort any() entries by item, then by the first rule they lead to
+static int compare_any(const void *arg1, const void *arg2)
+{
+	const TEDGE *e1=(const TEDGE *)arg1, *e2=(const TEDGE *)arg2;
+
+	if(e1->item < e2->item) return -1;
+	if(e1->item > e2->item) return 1;
+	if(e1->best < e2->best) return -1;
+	if(e1->best > e2->best) return 1;
+	return 0;
+}
+
+// Build the matching automaton for a group, if all its rules can be matched by it.
+// Returns 1 if the automaton was built, 0 otherwise
+int kmfl_make_trie(XDISPATCH *dp, XGROUP *gp, XRULE *rules, XSTORE *stores, ITEM *strings)
+{
+	TNODE *tn=NULL;
+	TEDGE *te=NULL;
+	XRULE *rp;
+	XSTORE *sp;
+	XTRIENODE *np;
+	ITEM *pr, *ps, mask;
+	UINT n, k, m, d, i, node, nnodes, nedges, nanys, nwork;
+
+	dp->trie = NULL;
+	dp->edges = NULL;
+	dp->anys = NULL;
+
+	if(gp->nrules == 0) return 0;
+
+	// Check that the rules only contain items that the automaton can match
+	for(n=0, nnodes=1, rp=rules+gp->rule1; n<gp->nrules; n++, rp++)
+	{
+		for(k=0, pr=strings+rp->lhs; k<rp->ilen; k++, pr++)
+		{
+			if(!trie_item(*pr)) return 0;
+		}
+		nnodes += rp->ilen;
+	}
+
+	// Allocate the nodes for the worst case (no shared items). Node 0 is the root
+	if((tn=(TNODE *)calloc(nnodes, sizeof(TNODE))) == NULL)
+		return 0;
+
+	tn[0].rule = tn[0].best = TRIE_NO_RULE;
+	nnodes = 1;
+
+	// Insert the reversed input rules in sorted order, so the first rule to reach
+	// or end at a node is always the best one for it
+	for(n=0, rp=rules+gp->rule1; n<gp->nrules; n++, rp++)
+	{
+		if(tn[0].best == TRIE_NO_RULE) tn[0].best = n;
+
+		for(d=0, node=0, pr=strings+rp->lhs+rp->ilen-1; d<rp->ilen; d++, pr--)
+		{
+			for(k=tn[node].child; k && tn[k].item != *pr; k=tn[k].sibling);
+
+			if(k == 0)
+			{
+				k = nnodes++;
+				tn[k].item = *pr;
+				tn[k].rule = TRIE_NO_RULE;
+				tn[k].best = n;
+				tn[k].sibling = tn[node].child;
+				tn[node].child = k;
+			}
+			node = k;
+		}
+		if(tn[node].rule == TRIE_NO_RULE) tn[node].rule = n;
+	}
+
+	// Count the edges, and the entries needed for the items of any() stores
+	for(k=1, nedges=nanys=0; k<nnodes; k++)
+	{
+		if(ITEM_TYPE(tn[k].item) == ITEM_ANY)
+			nanys += stores[tn[k].item & 0xffff].len;
+		else
+			nedges++;
+	}
+
+	// Allocate the automaton and a work area for sorting edges
+	nwork = (nedges > nanys) ? nedges : nanys;
+	np = (XTRIENODE *)malloc(nnodes*sizeof(XTRIENODE)+(nedges+nanys)*sizeof(XTRIEEDGE));
+	te = (TEDGE *)malloc((nwork+1)*sizeof(TEDGE));
+	if(np == NULL || te == NULL)
+	{
+		if(np) free(np);
+		if(te) free(te);
+		free(tn);
+		return 0;
+	}
+
+	dp->trie = np;
+	dp->edges = (XTRIEEDGE *)(np+nnodes);
+	dp->anys = dp->edges+nedges;
+	dp->nnodes = nnodes;
+	dp->nedges = nedges;
+	dp->nanys = nanys;
+
+	// Store the edges of each node as contiguous sorted lists
+	for(node=0, nedges=nanys=0; node<nnodes; node++, np++)
+	{
+		np->rule = tn[node].rule;
+		np->best = tn[node].best;
+		np->edge1 = nedges;
+		np->nliteral = 0;
+		np->nkeysym = 0;
+		np->any1 = nanys;
+		np->nany = 0;
+
+		// Expand any() edges first, ignoring the item type for the last item of a rule
+		mask = (node == 0) ? 0xffffff : 0xffffffff;
+		for(m=0, k=tn[node].child; k; k=tn[k].sibling)
+		{
+			if(ITEM_TYPE(tn[k].item) != ITEM_ANY) continue;
+
+			sp = stores+(tn[k].item & 0xffff);
+			for(i=0, ps=strings+sp->items; i<sp->len; i++, ps++, m++)
+			{
+				te[m].item = (*ps) & mask;
+				te[m].node = k;
+				te[m].best = tn[k].best;
+				te[m].kind = EDGE_LITERAL;
+			}
+		}
+
+		qsort(te, m, sizeof(TEDGE), compare_any);
+
+		// Store them, skipping repeated store items
+		for(k=0; k<m; k++)
+		{
+			if(k > 0 && te[k].item == te[k-1].item && te[k].node == te[k-1].node) continue;
+			dp->anys[nanys].item = te[k].item;
+			dp->anys[nanys].node = te[k].node;
+			nanys++;
+			np->nany++;
+		}
+
+		// Then sort and store the other edges
+		for(m=0, k=tn[node].child; k; k=tn[k].sibling)
+		{
+			if(ITEM_TYPE(tn[k].item) == ITEM_ANY) continue;
+
+			te[m].item = tn[k].item;
+			te[m].node = k;
+			te[m].best = tn[k].best;
+			switch(ITEM_TYPE(tn[k].item))
+			{
+			case ITEM_CHAR:
+			case ITEM_DEADKEY:
+				te[m].kind = EDGE_LITERAL;
+				np->nliteral++;
+				break;
+			case ITEM_KEYSYM:
+				te[m].kind = EDGE_KEYSYM;
+				np->nkeysym++;
+				break;
+			default:
+				te[m].kind = EDGE_OTHER;
+				break;
+			}
+			m++;
+		}
+		np->nedges = m;
+
+		qsort(te, m, sizeof(TEDGE), compare_edges);
+
+		for(k=0; k<m; k++, nedges++)
+		{
+			dp->edges[nedges].item = te[k].item;
+			dp->edges[nedges].node = te[k].node;
+		}
+	}
+
+	free(te);
+	free(tn);
+	return 1;
+}
@@ -744,6 +744,7 @@ XKEYBOARD *
 load_kmfl_file(const String & file)
 {
     XKEYBOARD *keyboard = 0;
+    KMFLTABLES tables;
     unsigned int filelen, kbver = 0;
     char version_string[6] = { 0 };
     struct stat fstat;
@@ -798,9 +799,10 @@ load_kmfl_file(const String & file)
 	    }
 	    // Check the loaded file is valid and has the correct version
 	    if ((memcmp(keyboard->id, "KMFL", 4) != 0)
-		|| (keyboard->version[3] != *FILE_VERSION)
+		|| (keyboard->version[3] != *FILE_VERSION && keyboard->version[3] != *FILE_VERSION_1)
 		|| (kbver < (unsigned) atoi(BASE_VERSION))
-		|| (kbver > (unsigned) atoi(LAST_VERSION))) {
+		|| (kbver > (unsigned) atoi(LAST_VERSION))
+		|| (kmfl_keyboard_tables(keyboard, filelen, &tables) != 0)) {
 		free(keyboard);
 		return NULL;
 	    }
@@ -812,26 +814,18 @@ load_kmfl_file(const String & file)
 static String
 get_static_store(XKEYBOARD * p_kbd, int hdrID)
 {
+    KMFLTABLES tables;
     XSTORE *stores;
-    XGROUP *groups, *gp;
-    XRULE *rules;
     ITEM *strings;
     UTF32 *p32;
     UTF8 *p8;
-    unsigned int n, nrules;
     static char static_store[256];
     *static_store = 0;
 
-    if (p_kbd != NULL) {
-	stores = (XSTORE *) (p_kbd + 1);
-	groups = (XGROUP *) (stores + p_kbd->nstores);
-	rules = (XRULE *) (groups + p_kbd->ngroups);
-
-	for (n = nrules = 0, gp = groups; n < p_kbd->ngroups; n++, gp++) {
-	    nrules += gp->nrules;
-	}
-
-	strings = (ITEM *) (rules + nrules);
+    // The keyboard was checked when it was loaded, so its size need not be known here
+    if (p_kbd != NULL && kmfl_keyboard_tables(p_kbd, (unsigned long) -1, &tables) == 0) {
+	stores = tables.stores;
+	strings = tables.strings;
 
 	if (stores[SS_BITMAP].len >= 0) {
 	    p32 = strings + stores[hdrID].items;
@@ -133,7 +133,7 @@ extern "C" {
     void scim_module_init(void) 
     {
 #ifdef DEBUGGING
-        kmfl_debug = 1;
+        kmfl_debug = KMFL_DEBUG_GENERAL | KMFL_DEBUG_TRACE;
 #endif
         DBGMSG(1, "DAR/JD: kmfl - Kmfl Module init!!!\n");
     } 
@@ -453,13 +453,13 @@ bool KmflInstance::process_key_event(const KeyEvent & key)
 
     if (key.code == SCIM_KEY_Sys_Req && (key.mask & SCIM_KEY_ControlMask) && (key.mask & SCIM_KEY_AltMask)){
         DBGMSG(1, "DAR: kmfl -Reloading all keyboards\n");
-        kmfl_reload_all_keyboards();
+        kmfl_reload_keyboard_in_background(-1);
         return true;
     }
 
     if (key.code == SCIM_KEY_Print && (key.mask & SCIM_KEY_ControlMask)) {
         DBGMSG(1, "DAR: kmfl -Reloading keyboard %s\n", p_kmsi->kbd_name);
-        kmfl_reload_keyboard(p_kmsi->keyboard_number);
+        kmfl_reload_keyboard_in_background(p_kmsi->keyboard_number);
         return true;
     }
 
@@ -0,0 +1,149 @@
+/***************************************************************************
+ *   Copyright (C) 2026 ThanLwinSoft.org                                   *
+ *   devel@thanlwinsoft.org                                                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// Measures the time taken to compile keyboards, and the peak memory used.
+// With -g, a keyboard with the given number of rules is generated and compiled
+// as well, to show how compile time grows with the size of the keyboard
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <kmfl/kmfl.h>
+#include <kmfl/kmflcomp.h>
+
+static double now_ms()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return 1000.0 * tv.tv_sec + tv.tv_usec / 1000.0;
+}
+
+// Write a keyboard with one store and the given number of rules
+static bool generate_keyboard(const char * kmnFile, int nrules)
+{
+    FILE * fp = fopen(kmnFile, "w");
+    if (fp == NULL) return false;
+
+    fprintf(fp, "NAME \"Generated\"\nVERSION 5.0\n\nbegin Unicode > use(Main)\n\n");
+    fprintf(fp, "store(keys) \"abcdefghijklmnopqrstuvwxyz\"\n");
+    fprintf(fp, "store(outs) \"ABCDEFGHIJKLMNOPQRSTUVWXYZ\"\n\n");
+    fprintf(fp, "group(Main) using keys\n\n");
+    fprintf(fp, "+ any(keys) > index(outs, 1)\n");
+    for (int i = 0; i < nrules; i++)
+    {
+        fprintf(fp, "U+%04X U+%04X + '%c' > U+%04X U+%04X\n", 0x4e00 + i / 26,
+            0x3400 + i % 1024, 'a' + i % 26, 0xac00 + i % 11000, 0x1000 + i % 32);
+    }
+    fclose(fp);
+    return true;
+}
+
+// Compile the keyboard repeat times, returning the mean time per compilation
+static double time_compiles(const char * kmnFile, int repeat, unsigned long *size)
+{
+    KMFLCOMP_CONTEXT * ctx = kmflcomp_create_context();
+    double startTime = now_ms();
+    for (int i = 0; i < repeat; i++)
+    {
+        void * keyboard_buffer;
+        *size = compile_keyboard_to_buffer_r(ctx, kmnFile, &keyboard_buffer);
+        if (*size == 0)
+        {
+            std::cerr << "Failed to compile " << kmnFile << std::endl;
+            exit(2);
+        }
+        free(keyboard_buffer);
+    }
+    double ms = (now_ms() - startTime) / repeat;
+    kmflcomp_delete_context(ctx);
+    return ms;
+}
+
+int main(int argc, char *argv[])
+{
+    int repeat = 10, nrules = 0, opt;
+
+    while ((opt = getopt(argc, argv, "g:n:")) != EOF)
+    {
+        switch (opt)
+        {
+        case 'g':
+            nrules = atoi(optarg);
+            break;
+        case 'n':
+            repeat = atoi(optarg);
+            break;
+        default:
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (optind > argc || (optind == argc && nrules <= 0))
+    {
+        std::cerr << argv[0] << " [-n repeat] [-g rules] [file.kmn...]" << std::endl;
+        std::cerr << "Reports the time to compile each keyboard and the peak memory used." << std::endl;
+        std::cerr << "-g also compiles a generated keyboard with the given number of rules" << std::endl;
+        return 1;
+    }
+    if (repeat < 1) repeat = 1;
+
+    std::vector<std::string> files(argv + optind, argv + argc);
+    char generated[] = "/tmp/kmflbenchXXXXXX.kmn";
+    if (nrules > 0)
+    {
+        int fd = mkstemps(generated, 4);
+        if (fd < 0 || !generate_keyboard(generated, nrules))
+        {
+            std::cerr << "Failed to generate a keyboard" << std::endl;
+            return 3;
+        }
+        close(fd);
+        files.push_back(generated);
+    }
+
+    // Keep the compiler messages out of the results
+    if (freopen("/dev/null", "w", stderr) == NULL) return 3;
+
+    double total = 0;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        unsigned long size;
+        double ms = time_compiles(files[i].c_str(), repeat, &size);
+        printf("%-40s %8lu bytes %10.3f ms\n", files[i].c_str(), size, ms);
+        total += ms;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("total %.3f ms per round, peak RSS %ld kB\n", total, usage.ru_maxrss);
+
+    if (nrules > 0) unlink(generated);
+    return 0;
+}
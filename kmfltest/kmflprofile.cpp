@@ -0,0 +1,385 @@
+/***************************************************************************
+ *   Copyright (C) 2026 ThanLwinSoft.org                                   *
+ *   devel@thanlwinsoft.org                                                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// Reports the rules of a keyboard that are used most, from profiles written by
+// kmfl_write_profile(), or by typing text files with the keyboard. Profiles of the
+// same keyboard are added together
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <getopt.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <kmfl/kmfl.h>
+#include <kmfl/kmflcomp.h>
+#include <kmfl/libkmfl.h>
+
+extern "C" {
+
+    // Not used: kmfl_transliterate_file() records the output of the keyboard itself
+    void output_string(void *contrack, char *ptr) {}
+    void output_char(void *contrack, unsigned char byte) {}
+    void forward_keyevent(void *contrack, unsigned int key, unsigned int state) {}
+    void output_beep(void *contrack) {}
+    void erase_char(void *contrack) {}
+
+    void log_message(const char *fmt, va_list args)
+    {
+        char buffer[1024];
+        vsnprintf(buffer, 1024, fmt, args);
+        std::cerr << buffer << std::endl;
+    }
+}                                /* extern "c" */
+
+struct RuleCounts
+{
+    unsigned number;
+    unsigned group;
+    unsigned line;
+    double attempts;
+    double matches;
+    double matchTime;
+    double processTime;
+};
+
+struct GroupCounts
+{
+    unsigned line;
+    bool trie;          // rules found by the matching automaton (only the rule found is counted)
+    double calls;
+    double handled;
+    double time;
+};
+
+struct Profile
+{
+    std::string keyboard;
+    double keystrokes;
+    double time;
+    double callbacks;
+    double callbackTime;
+    std::vector<GroupCounts> groups;
+    std::vector<RuleCounts> rules;
+};
+
+enum SortOrder { SORT_TIME, SORT_ATTEMPTS, SORT_MATCHES };
+
+static SortOrder sortOrder = SORT_TIME;
+
+// Add the profile read from a file to the totals. Returns false if it is not a profile
+static bool read_profile(FILE * fp, const char * name, Profile & total)
+{
+    char line[1024], field[NAMELEN + 1];
+    unsigned n, group, srcline, trie;
+    double a, b, c, d;
+    int nfields;
+    bool found = false;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (sscanf(line, "profile\t%64[^\n]", field) == 1)
+        {
+            if (!total.keyboard.empty() && total.keyboard != field)
+                std::cerr << "Warning: " << name << " is a profile of " << field
+                    << ", not of " << total.keyboard << std::endl;
+            total.keyboard = field;
+            found = true;
+        }
+        else if (sscanf(line, "keystrokes\t%lf\t%lf", &a, &b) == 2)
+        {
+            total.keystrokes += a;
+            total.time += b;
+        }
+        else if (sscanf(line, "callbacks\t%lf\t%lf", &a, &b) == 2)
+        {
+            total.callbacks += a;
+            total.callbackTime += b;
+        }
+        else if ((nfields = sscanf(line, "group\t%u\t%u\t%lf\t%lf\t%lf\t%u", &n, &srcline,
+            &a, &b, &c, &trie)) >= 5)
+        {
+            if (n >= total.groups.size())
+                total.groups.resize(n + 1, GroupCounts());
+            GroupCounts & g = total.groups[n];
+            g.line = srcline;
+            if (nfields == 6 && trie) g.trie = true;
+            g.calls += a;
+            g.handled += b;
+            g.time += c;
+        }
+        else if (sscanf(line, "rule\t%u\t%u\t%u\t%lf\t%lf\t%lf\t%lf", &n, &group, &srcline,
+            &a, &b, &c, &d) == 7)
+        {
+            if (n >= total.rules.size())
+                total.rules.resize(n + 1, RuleCounts());
+            RuleCounts & r = total.rules[n];
+            r.number = n;
+            r.group = group;
+            r.line = srcline;
+            r.attempts += a;
+            r.matches += b;
+            r.matchTime += c;
+            r.processTime += d;
+        }
+    }
+    return found;
+}
+
+// Profile the keyboard by typing the text files with it
+static bool profile_keyboard(const char * keyboardFile, char ** inputs, int ninputs,
+    const char * outfile, Profile & total)
+{
+    int keyboard = kmfl_load_keyboard(keyboardFile);
+    if (keyboard < 0)
+    {
+        std::cerr << "Failed to load " << keyboardFile << std::endl;
+        return false;
+    }
+
+    KMSI * kmsi = kmfl_make_keyboard_instance(NULL);
+    if (kmsi == NULL || kmfl_attach_keyboard(kmsi, keyboard) || kmfl_start_profile(kmsi))
+    {
+        std::cerr << "Failed to profile " << keyboardFile << std::endl;
+        return false;
+    }
+
+    FILE * out = fopen("/dev/null", "wb");
+    bool ok = (out != NULL);
+    for (int i = 0; ok && i < ninputs; i++)
+    {
+        FILE * in = fopen(inputs[i], "rb");
+        if (in == NULL)
+        {
+            std::cerr << "Failed to open " << inputs[i] << std::endl;
+            ok = false;
+            break;
+        }
+        // Each file starts with an empty context
+        clear_history(kmsi);
+        if (kmfl_transliterate_file(kmsi, in, out, NULL) < 0)
+        {
+            std::cerr << "Failed to type " << inputs[i] << std::endl;
+            ok = false;
+        }
+        fclose(in);
+    }
+    if (out) fclose(out);
+
+    // Write the profile, then read it back like any other
+    FILE * fp = outfile ? fopen(outfile, "w+") : tmpfile();
+    if (ok && (fp == NULL || kmfl_write_profile(kmsi, fp)))
+    {
+        std::cerr << "Failed to write the profile" << std::endl;
+        ok = false;
+    }
+    if (ok)
+    {
+        rewind(fp);
+        read_profile(fp, keyboardFile, total);
+    }
+    if (fp) fclose(fp);
+
+    kmfl_stop_profile(kmsi);
+    kmfl_detach_keyboard(kmsi);
+    kmfl_delete_keyboard_instance(kmsi);
+    kmfl_unload_keyboard(keyboard);
+    return ok;
+}
+
+static bool hotter(const RuleCounts & r1, const RuleCounts & r2)
+{
+    double k1, k2;
+    switch (sortOrder)
+    {
+    case SORT_ATTEMPTS:
+        k1 = r1.attempts; k2 = r2.attempts;
+        break;
+    case SORT_MATCHES:
+        k1 = r1.matches; k2 = r2.matches;
+        break;
+    default:
+        k1 = r1.matchTime + r1.processTime; k2 = r2.matchTime + r2.processTime;
+        break;
+    }
+    if (k1 != k2) return k1 > k2;
+    return r1.number < r2.number;
+}
+
+// Read the lines of the keyboard source, to show the hot rules
+static std::vector<std::string> read_source(const char * sourceFile)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(sourceFile);
+    std::string line;
+
+    if (!in)
+        std::cerr << "Failed to open " << sourceFile << std::endl;
+    while (std::getline(in, line))
+    {
+        size_t start = line.find_first_not_of(" \t");
+        size_t end = line.find_last_not_of(" \t\r");
+        lines.push_back(start == std::string::npos ? std::string() : line.substr(start, end - start + 1));
+    }
+    return lines;
+}
+
+static void report(Profile & total, size_t count, const std::vector<std::string> & source)
+{
+    printf("Keyboard: %s\n", total.keyboard.c_str());
+    printf("Keystrokes: %.0f in %.3f ms (%.2f us each)\n", total.keystrokes, total.time / 1e6,
+        (total.keystrokes > 0) ? total.time / total.keystrokes / 1000.0 : 0.0);
+    printf("Output functions: %.0f calls in %.3f ms (%.1f%% of the time)\n",
+        total.callbacks, total.callbackTime / 1e6,
+        (total.time > 0) ? 100.0 * total.callbackTime / total.time : 0.0);
+
+    bool anyTrie = false;
+    printf("\n%6s %6s %10s %10s %12s %5s\n", "group", "line", "calls", "handled", "time (ms)", "trie");
+    for (size_t n = 0; n < total.groups.size(); n++)
+    {
+        const GroupCounts & g = total.groups[n];
+        printf("%6u %6u %10.0f %10.0f %12.3f %5s\n", (unsigned)n, g.line, g.calls, g.handled,
+            g.time / 1e6, g.trie ? "yes" : "no");
+        if (g.trie) anyTrie = true;
+    }
+
+    std::vector<RuleCounts> rules;
+    for (size_t n = 0; n < total.rules.size(); n++)
+    {
+        if (total.rules[n].attempts > 0)
+            rules.push_back(total.rules[n]);
+    }
+    std::sort(rules.begin(), rules.end(), hotter);
+    if (count > 0 && rules.size() > count)
+        rules.resize(count);
+
+    printf("\n%6s %6s %6s %10s %10s %6s %10s %10s\n", "rule", "line", "group", "attempts",
+        "matches", "hit %", "match ms", "output ms");
+    for (size_t n = 0; n < rules.size(); n++)
+    {
+        const RuleCounts & r = rules[n];
+        printf("%6u %6u %6u %10.0f %10.0f %6.1f %10.3f %10.3f", r.number, r.line, r.group,
+            r.attempts, r.matches, 100.0 * r.matches / r.attempts, r.matchTime / 1e6,
+            r.processTime / 1e6);
+        if (r.line > 0 && r.line <= source.size())
+            printf("  %s", source[r.line - 1].substr(0, 60).c_str());
+        printf("\n");
+    }
+    if (anyTrie)
+        printf("\nThe rules of groups that use a trie are only counted when they are found\n");
+}
+
+static void usage(const char * program)
+{
+    std::cerr << program << " [options] profile..." << std::endl;
+    std::cerr << "Reports the rules used most in profiles written by kmfl_write_profile()" << std::endl;
+    std::cerr << program << " [options] [-o profile] -k file.kmn|file.kmfl input..." << std::endl;
+    std::cerr << "Types the UTF-8 text of each input with the keyboard, and reports the rules" << std::endl;
+    std::cerr << "used most (saving the profile if -o is given)" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  -n count   number of rules listed (default 20, 0 for all)" << std::endl;
+    std::cerr << "  -s order   sort rules by time (default), attempts or matches" << std::endl;
+    std::cerr << "  -S file    keyboard source, to show the rules listed" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    const char * keyboardFile = NULL;
+    const char * outfile = NULL;
+    const char * sourceFile = NULL;
+    size_t count = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "k:o:n:s:S:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'k':
+            keyboardFile = optarg;
+            break;
+        case 'o':
+            outfile = optarg;
+            break;
+        case 'n':
+            count = (size_t)atoi(optarg);
+            break;
+        case 's':
+            if (strcmp(optarg, "time") == 0)
+                sortOrder = SORT_TIME;
+            else if (strcmp(optarg, "attempts") == 0)
+                sortOrder = SORT_ATTEMPTS;
+            else if (strcmp(optarg, "matches") == 0)
+                sortOrder = SORT_MATCHES;
+            else
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'S':
+            sourceFile = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind >= argc || (outfile != NULL && keyboardFile == NULL))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Profile total = Profile();
+    if (keyboardFile != NULL)
+    {
+        if (!profile_keyboard(keyboardFile, argv + optind, argc - optind, outfile, total))
+            return 2;
+    }
+    else
+    {
+        for (int i = optind; i < argc; i++)
+        {
+            FILE * fp = fopen(argv[i], "r");
+            if (fp == NULL || !read_profile(fp, argv[i], total))
+            {
+                std::cerr << "Failed to read the profile " << argv[i] << std::endl;
+                if (fp) fclose(fp);
+                return 2;
+            }
+            fclose(fp);
+        }
+    }
+
+    std::vector<std::string> source;
+    if (sourceFile != NULL)
+        source = read_source(sourceFile);
+
+    report(total, count, source);
+    return 0;
+}
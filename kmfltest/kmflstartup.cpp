@@ -0,0 +1,126 @@
+/***************************************************************************
+ *   Copyright (C) 2026 ThanLwinSoft.org                                   *
+ *   devel@thanlwinsoft.org                                                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// Measures the time taken to load a .kmn keyboard without the compiled keyboard
+// cache, on a cold start (compiling and saving to the cache) and on warm starts
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <sys/time.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <kmfl/kmfl.h>
+#include <kmfl/kmflcomp.h>
+#include <kmfl/libkmfl.h>
+
+extern "C" {
+
+    void output_string(void *contrack, char *ptr) {}
+    void output_char(void *contrack, unsigned char byte) {}
+    void forward_keyevent(void *contrack, unsigned int key, unsigned int state) {}
+    void output_beep(void *contrack) {}
+    void erase_char(void *contrack) {}
+
+    void log_message(const char *fmt, va_list args)
+    {
+        char buffer[1024];
+        vsnprintf(buffer, 1024, fmt, args);
+        std::cerr << buffer << std::endl;
+    }
+}                                /* extern "c" */
+
+static double now_ms()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return 1000.0 * tv.tv_sec + tv.tv_usec / 1000.0;
+}
+
+// Load and unload the keyboard repeat times, returning the mean time per load
+static double time_loads(const char * kmnFile, int repeat)
+{
+    double startTime = now_ms();
+    for (int i = 0; i < repeat; i++)
+    {
+        int keyboard = kmfl_load_keyboard(kmnFile);
+        if (keyboard < 0)
+        {
+            std::cerr << "Failed to load " << kmnFile << std::endl;
+            exit(2);
+        }
+        kmfl_unload_keyboard(keyboard);
+    }
+    return (now_ms() - startTime) / repeat;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << argv[0] << " file.kmn [repeat]" << std::endl;
+        std::cerr << "Reports the time to load a keyboard source without the cache," << std::endl;
+        std::cerr << "on a cold start (empty cache) and on warm starts" << std::endl;
+        return 1;
+    }
+    int repeat = (argc > 2) ? atoi(argv[2]) : 10;
+    if (repeat < 1) repeat = 1;
+
+    // Use an empty cache directory, removed at the end
+    char cacheDir[] = "/tmp/kmflcacheXXXXXX";
+    if (mkdtemp(cacheDir) == NULL)
+    {
+        std::cerr << "Failed to create a cache directory" << std::endl;
+        return 3;
+    }
+    setenv("KMFL_CACHE_DIR", cacheDir, 1);
+
+    setenv("KMFL_NO_CACHE", "1", 1);
+    double uncached = time_loads(argv[1], repeat);
+    unsetenv("KMFL_NO_CACHE");
+    double cold = time_loads(argv[1], 1);
+    double warm = time_loads(argv[1], repeat);
+
+    fprintf(stderr, "uncached: %.3f ms per load\n", uncached);
+    fprintf(stderr, "cold:     %.3f ms (compile and save)\n", cold);
+    fprintf(stderr, "warm:     %.3f ms per load (%.1f times faster)\n", warm,
+        (warm > 0) ? uncached / warm : 0.0);
+
+    DIR * dir = opendir(cacheDir);
+    if (dir)
+    {
+        struct dirent * entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            if (entry->d_name[0] == '.') continue;
+            std::string path = std::string(cacheDir) + "/" + entry->d_name;
+            unlink(path.c_str());
+        }
+        closedir(dir);
+    }
+    rmdir(cacheDir);
+    return 0;
+}
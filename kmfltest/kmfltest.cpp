@@ -21,10 +21,13 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <setjmp.h>
+#include <time.h>
 
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <utility>
 #include <assert.h>
 #include <kmfl/kmfl.h>
 #include <kmfl/kmflcomp.h>
@@ -97,12 +100,15 @@ int main(int argc, char *argv[])
 {
     if (argc < 3)
     {
-        std::cerr << argv[0] << " file.kmn testData.txt" << std::endl;
+        std::cerr << argv[0] << " file.kmn testData.txt [repeat]" << std::endl;
         std::cerr << "Test data file should have the format:" << std::endl;
         std::cerr << "Odd lines: ascii typed" << std::endl;
         std::cerr << "Even lines: expected utf8 output" << std::endl;
+        std::cerr << "If repeat is given, the test data is typed repeat times" << std::endl;
+        std::cerr << "and the time per keystroke is reported" << std::endl;
         return 1;
     }
+    int repeat = (argc > 3) ? atoi(argv[3]) : 0;
     void * keyboard_buffer;
     unsigned long keyboard_buffer_size;
     char * kmflFile = argv[1];
@@ -118,16 +124,24 @@ int main(int argc, char *argv[])
     }
     write_keyboard(kmflFile, keyboard_buffer, (int)keyboard_buffer_size);
     printf("wrote %s\n", kmflFile);
-    free(keyboard_buffer);
     std::string utf8Out;
-    if (kmfl_load_keyboard(kmflFile))
+    // Use the compiled keyboard directly, rather than compiling it again
+    if (kmfl_load_keyboard_from_buffer(keyboard_buffer, keyboard_buffer_size, 1))
     {
         std::cerr << "Failed to load " << kmflFile << std::endl;
+        free(keyboard_buffer);
         return 2;
     }
     KMSI * kmsi = kmfl_make_keyboard_instance(&utf8Out);
     if (kmfl_attach_keyboard(kmsi, 0))
         std::cerr << ("Failed to attach keyboard") << std::endl;
+
+    // A second instance checks that kmfl_interpret_batch() gives the same text
+    KMSI * batchKmsi = kmfl_make_keyboard_instance(NULL);
+    if (kmfl_attach_keyboard(batchKmsi, 0))
+        std::cerr << ("Failed to attach keyboard") << std::endl;
+    KMFLBATCH batch = KMFLBATCH();
+    std::vector<KMFLKEY> keys;
     int errorCount = 0;
     try
     {
@@ -139,43 +153,79 @@ int main(int argc, char *argv[])
             std::cerr << "Failed to open " << argv[2] << std::endl;
             return 4;
         }
-        // loop over each line
-        size_t lineNum = 1;
-
+        // read pairs of typed and expected lines
+        std::vector<std::pair<std::string, std::string> > testLines;
         while (fileInput.good())
         {
             std::string utf8Line;
             std::getline(fileInput, utf8Line);
             if (!utf8Line.length()) continue;
-            for (size_t i = 0; i < utf8Line.length(); i++)
-            {
-                kmfl_interpret(kmsi, (UINT)utf8Line[i], 0);
-            }
-
             std::string expectedResult;
             std::getline(fileInput, expectedResult);
-            if (expectedResult != utf8Out)
-            {
-                std::cout << "Error at line: " << lineNum << "[" << utf8Line.c_str()
-                    << "] expected:" << expectedResult.c_str() << " got:" 
-                    << utf8Out.c_str() << std::endl;
-                ++errorCount;
-            }
-            else
+            testLines.push_back(std::make_pair(utf8Line, expectedResult));
+        }
+        fileInput.close();
+
+        // loop over each line, checking the output on the first pass only
+        unsigned long keystrokes = 0;
+        clock_t startTime = clock();
+        for (int pass = 0; pass == 0 || pass < repeat; pass++)
+        {
+            size_t lineNum = 1;
+            for (size_t j = 0; j < testLines.size(); j++)
             {
-                //std::cout << "Line: " << lineNum << " Correct" << std::endl;
+                const std::string & utf8Line = testLines[j].first;
+                for (size_t i = 0; i < utf8Line.length(); i++)
+                {
+                    kmfl_interpret(kmsi, (UINT)utf8Line[i], 0);
+                }
+                keystrokes += utf8Line.length();
+
+                if (pass == 0 && testLines[j].second != utf8Out)
+                {
+                    std::cout << "Error at line: " << lineNum << "[" << utf8Line.c_str()
+                        << "] expected:" << testLines[j].second.c_str() << " got:" 
+                        << utf8Out.c_str() << std::endl;
+                    ++errorCount;
+                }
+                if (pass == 0)
+                {
+                    keys.resize(utf8Line.length());
+                    for (size_t i = 0; i < utf8Line.length(); i++)
+                    {
+                        keys[i].key = (UINT)utf8Line[i];
+                        keys[i].state = 0;
+                    }
+                    if (kmfl_interpret_batch(batchKmsi, keys.empty() ? NULL : &keys[0],
+                        (UINT)keys.size(), &batch) < 0 || utf8Out != batch.text)
+                    {
+                        std::cout << "Batch error at line: " << lineNum << "[" << utf8Line.c_str()
+                            << "] expected:" << utf8Out.c_str() << " got:"
+                            << (batch.text ? batch.text : "") << std::endl;
+                        ++errorCount;
+                    }
+                    clear_history(batchKmsi);
+                }
+                lineNum+= 2;
+                clear_history(kmsi);
+                utf8Out.erase(0, utf8Out.length());
             }
-            lineNum+= 2;
-            clear_history(kmsi);
-            utf8Out.erase(0, utf8Out.length());
         }
-        fileInput.close();
+        if (repeat > 0 && keystrokes > 0)
+        {
+            double msecs = 1000.0 * (double)(clock() - startTime) / CLOCKS_PER_SEC;
+            fprintf(stderr, "%lu keystrokes in %.1f ms (%.3f us per keystroke)\n",
+                keystrokes, msecs, 1000.0 * msecs / keystrokes);
+        }
     }
     catch (...)
     {
         std::cerr << "exception occured"<< std::endl;
     }
 
+    kmfl_free_batch(&batch);
+    kmfl_detach_keyboard(batchKmsi);
+    kmfl_delete_keyboard_instance(batchKmsi);
     kmfl_detach_keyboard(kmsi);
     kmfl_delete_keyboard_instance(kmsi);
     if (errorCount)
@@ -0,0 +1,265 @@
+/***************************************************************************
+ *   Copyright (C) 2026 ThanLwinSoft.org                                   *
+ *   devel@thanlwinsoft.org                                                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// Transliterates UTF-8 text files by typing them with a keyboard, and reports
+// the throughput. With -o, the files are transliterated into a directory by a
+// pool of worker threads, each with its own instance of the same keyboard
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include <sys/time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <kmfl/kmfl.h>
+#include <kmfl/kmflcomp.h>
+#include <kmfl/libkmfl.h>
+
+extern "C" {
+
+    // Not used: kmfl_transliterate_file() records the output of the keyboard itself
+    void output_string(void *contrack, char *ptr) {}
+    void output_char(void *contrack, unsigned char byte) {}
+    void forward_keyevent(void *contrack, unsigned int key, unsigned int state) {}
+    void output_beep(void *contrack) {}
+    void erase_char(void *contrack) {}
+
+    void log_message(const char *fmt, va_list args)
+    {
+        char buffer[1024];
+        vsnprintf(buffer, 1024, fmt, args);
+        std::cerr << buffer << std::endl;
+    }
+}                                /* extern "c" */
+
+struct TranslitJob
+{
+    std::string input;
+    std::string output;
+    unsigned long nread;
+    long nwritten;
+};
+
+static std::vector<TranslitJob> jobs;
+static size_t nextJob = 0;
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+static int keyboard = -1;
+
+static double now_ms()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return 1000.0 * tv.tv_sec + tv.tv_usec / 1000.0;
+}
+
+// Transliterate a file, returning the number of bytes written or -1
+static long transliterate(KMSI * kmsi, const char * input, const char * output, unsigned long * nread)
+{
+    FILE * in = stdin;
+    FILE * out = stdout;
+    long nwritten;
+
+    *nread = 0;
+    if (input && strcmp(input, "-") != 0 && (in = fopen(input, "rb")) == NULL)
+    {
+        std::cerr << "Failed to open " << input << std::endl;
+        return -1;
+    }
+    if (output && strcmp(output, "-") != 0 && (out = fopen(output, "wb")) == NULL)
+    {
+        std::cerr << "Failed to create " << output << std::endl;
+        if (in != stdin) fclose(in);
+        return -1;
+    }
+
+    // Each file starts with an empty context
+    clear_history(kmsi);
+    nwritten = kmfl_transliterate_file(kmsi, in, out, nread);
+
+    if (out != stdout && fclose(out) != 0) nwritten = -1;
+    if (in != stdin) fclose(in);
+    return nwritten;
+}
+
+// Take files from the list and transliterate them, with an instance of the keyboard
+// belonging to this worker, until there are none left
+static void * translit_worker(void * arg)
+{
+    KMSI * kmsi = kmfl_make_keyboard_instance(NULL);
+    if (kmsi == NULL || kmfl_attach_keyboard(kmsi, keyboard))
+    {
+        std::cerr << "Failed to attach keyboard" << std::endl;
+        if (kmsi) kmfl_delete_keyboard_instance(kmsi);
+        return NULL;
+    }
+
+    for (;;)
+    {
+        pthread_mutex_lock(&jobLock);
+        TranslitJob * jp = (nextJob < jobs.size()) ? &jobs[nextJob++] : NULL;
+        pthread_mutex_unlock(&jobLock);
+        if (jp == NULL) break;
+
+        jp->nwritten = transliterate(kmsi, jp->input.c_str(), jp->output.c_str(), &jp->nread);
+    }
+
+    kmfl_detach_keyboard(kmsi);
+    kmfl_delete_keyboard_instance(kmsi);
+    return NULL;
+}
+
+// Transliterate the files on nworkers threads. Returns the number that failed
+static int transliterate_files(int nworkers, unsigned long * nread)
+{
+    if (nworkers <= 0) nworkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nworkers > (int)jobs.size()) nworkers = (int)jobs.size();
+    if (nworkers <= 0) nworkers = 1;
+
+    std::vector<pthread_t> workers(nworkers);
+    int n;
+    for (n = 0; n < nworkers; n++)
+    {
+        if (pthread_create(&workers[n], NULL, translit_worker, NULL) != 0)
+            break;
+    }
+    if (n == 0)
+        translit_worker(NULL);
+    for (n--; n >= 0; n--)
+        pthread_join(workers[n], NULL);
+
+    int nfailed = 0;
+    *nread = 0;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (jobs[i].nwritten < 0)
+        {
+            std::cerr << "Failed to transliterate " << jobs[i].input << std::endl;
+            nfailed++;
+        }
+        else
+            *nread += jobs[i].nread;
+    }
+    return nfailed;
+}
+
+static void usage(const char * program)
+{
+    std::cerr << program << " file.kmn|file.kmfl [input [output]]" << std::endl;
+    std::cerr << "Types the UTF-8 text of input (default: standard input) with the keyboard," << std::endl;
+    std::cerr << "writes the text it makes to output (default: standard output)" << std::endl;
+    std::cerr << "and reports the throughput" << std::endl;
+    std::cerr << program << " -o directory [-j workers] file.kmn|file.kmfl input..." << std::endl;
+    std::cerr << "Transliterates each input into a file of the same name in the directory," << std::endl;
+    std::cerr << "on the given number of threads (default: one per processor)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    const char * outdir = NULL;
+    int nworkers = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:j:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o':
+            outdir = optarg;
+            break;
+        case 'j':
+            nworkers = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    int nargs = argc - optind;
+    if (nargs < 1 || (outdir == NULL && nargs > 3) || (outdir != NULL && nargs < 2))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    keyboard = kmfl_load_keyboard(argv[optind]);
+    if (keyboard < 0)
+    {
+        std::cerr << "Failed to load " << argv[optind] << std::endl;
+        return 2;
+    }
+
+    unsigned long nread = 0;
+    long nwritten = 0;
+    double startTime = now_ms();
+    double msecs;
+
+    if (outdir == NULL)
+    {
+        KMSI * kmsi = kmfl_make_keyboard_instance(NULL);
+        if (kmsi == NULL || kmfl_attach_keyboard(kmsi, keyboard))
+        {
+            std::cerr << "Failed to attach keyboard" << std::endl;
+            return 2;
+        }
+        startTime = now_ms();
+        nwritten = transliterate(kmsi, (nargs > 1) ? argv[optind + 1] : NULL,
+            (nargs > 2) ? argv[optind + 2] : NULL, &nread);
+        msecs = now_ms() - startTime;
+        kmfl_detach_keyboard(kmsi);
+        kmfl_delete_keyboard_instance(kmsi);
+    }
+    else
+    {
+        for (int i = optind + 1; i < argc; i++)
+        {
+            TranslitJob job;
+            const char * name = strrchr(argv[i], '/');
+            job.input = argv[i];
+            job.output = std::string(outdir) + "/" + (name ? name + 1 : argv[i]);
+            job.nread = 0;
+            job.nwritten = -1;
+            jobs.push_back(job);
+        }
+        if (transliterate_files(nworkers, &nread) > 0)
+            nwritten = -1;
+        msecs = now_ms() - startTime;
+    }
+
+    kmfl_unload_keyboard(keyboard);
+
+    if (nwritten < 0)
+    {
+        std::cerr << "Transliteration failed" << std::endl;
+        return 3;
+    }
+
+    fprintf(stderr, "%lu bytes read in %.1f ms (%.2f MB/s)\n",
+        nread, msecs, (msecs > 0) ? nread / (1000.0 * msecs) : 0.0);
+    return 0;
+}